@@ -34,8 +34,48 @@ StoredAttributeList<A>::operator<(const StoredAttributeList<A>& them) const
 
 template <class A>
 AttributeManager<A>::AttributeManager()
+    : _buckets(MIN_BUCKETS, 0), _lists(0), _total_references(0),
+      _canonical_bytes(0)
 {
-    _total_references = 0;
+}
+
+/*
+ * Return the link that points to the stored copy of palist, or to the
+ * NULL at the end of its bucket if there is no stored copy.
+ */
+template <class A>
+typename AttributeManager<A>::Bucket*
+AttributeManager<A>::find(const PathAttributeList<A>* palist)
+{
+    Bucket* link = &_buckets[palist->hash() & (_buckets.size() - 1)];
+    while (*link != 0) {
+	if (*link == palist || **link == *palist)
+	    break;
+	link = &(*link)->_next_managed;
+    }
+    return link;
+}
+
+template <class A>
+void
+AttributeManager<A>::resize(size_t buckets)
+{
+    debug_msg("resize %u -> %u buckets\n", XORP_UINT_CAST(_buckets.size()),
+	      XORP_UINT_CAST(buckets));
+    vector<Bucket> old(buckets, 0);
+    old.swap(_buckets);
+
+    typename vector<Bucket>::iterator i;
+    for (i = old.begin(); i != old.end(); ++i) {
+	Bucket palist = *i;
+	while (palist != 0) {
+	    Bucket next = palist->_next_managed;
+	    Bucket* link = &_buckets[palist->hash() & (buckets - 1)];
+	    palist->_next_managed = *link;
+	    *link = palist;
+	    palist = next;
+	}
+    }
 }
 
 template <class A>
@@ -43,25 +83,33 @@ PAListRef<A>
 AttributeManager<A>::add_attribute_list(PAListRef<A>& palist)
 {
     debug_msg("AttributeManager<A>::add_attribute_list\n");
-    typedef typename set<PAListRef<A>, Att_Ptr_Cmp<A> >::iterator Iter;
-    Iter i = _attribute_lists.find(palist);
+    Bucket* link = find(palist.attributes());
+    _total_references++;
 
-    if (i == _attribute_lists.end()) {
-	_attribute_lists.insert(palist);
+    if (*link == 0) {
+	palist->_next_managed = 0;
+	*link = palist.attributes();
 	palist->incr_managed_refcount(1);
+	_lists++;
+	_canonical_bytes += palist->canonical_length();
 	debug_msg("** new att list\n");
 	debug_msg("** (+) ref count for %p now %u\n",
 		  palist.attributes(), palist->managed_references());
+
+	// Keep the chains short.
+	if (_lists > _buckets.size())
+	    resize(_buckets.size() * 2);
+
 	return palist;
     }
 
-    (*i)->incr_managed_refcount(1);
+    (*link)->incr_managed_refcount(1);
     debug_msg("** old att list\n");
     debug_msg("** (+) ref count for %p now %u\n",
-	      (*i).attributes(), (*i)->managed_references());
+	      *link, (*link)->managed_references());
     debug_msg("done\n");
 
-    return *i;
+    return PAListRef<A>(*link);
 }
 
 template <class A>
@@ -70,19 +118,34 @@ AttributeManager<A>::delete_attribute_list(PAListRef<A>& palist)
 {
     debug_msg("AttributeManager<A>::delete_attribute_list %p\n",
 	      palist.attributes());
-    typedef typename set<PAListRef<A>, Att_Ptr_Cmp<A> >::iterator Iter;
-    Iter i = _attribute_lists.find(palist);
-    assert(i != _attribute_lists.end());
+    Bucket* link = find(palist.attributes());
+    assert(*link != 0);
 
-    XLOG_ASSERT((*i)->managed_references()>=1);
-    (*i)->decr_managed_refcount(1);
+    Bucket stored = *link;
+    XLOG_ASSERT(stored->managed_references()>=1);
+    XLOG_ASSERT(_total_references >= 1);
+    _total_references--;
 
     debug_msg("** (-) ref count for %p now %u\n",
-	      (*i).attributes(), (*i)->managed_references());
-
-    if ((*i)->managed_references() < 1) {
-	_attribute_lists.erase(i);
+	      stored, stored->managed_references() - 1);
+
+    if (stored->managed_references() == 1) {
+	// Unlink before the last reference goes, as that may delete it.
+	*link = stored->_next_managed;
+	stored->_next_managed = 0;
+	_lists--;
+	_canonical_bytes -= stored->canonical_length();
     }
+    stored->decr_managed_refcount(1);
+}
+
+template <class A>
+size_t
+AttributeManager<A>::memory_used() const
+{
+    return _buckets.size() * sizeof(Bucket)
+	+ _lists * sizeof(PathAttributeList<A>)
+	+ _canonical_bytes;
 }
 
 template class AttributeManager<IPv4>;
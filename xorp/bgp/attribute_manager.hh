@@ -59,32 +59,6 @@ private:
 
 #endif
 
-/**
- * Att_Ptr_Cmp is needed because we want BGPAttributeManager to use a
- * set of pointers, but when we check to see if something's in the set,
- * we want to compare the data and not the pointers themselves.  This
- * forces the right comparison.
- */
-template <class A>
-class Att_Ptr_Cmp {
-public:
-    bool operator() (const PAListRef<A>& a, const PAListRef<A>& b) const {
-/*	printf("Att_Ptr_Cmp [%s] < [%s] ?\n", a->attribute()->str().c_str(),
-	b->attribute()->str().c_str());*/
-#ifdef OLDWAY
-	if (*(a->attribute()) < *(b->attribute())) {
-	    //	    printf("true\n");
-	    return true;
-	} else {
-	    //	    printf("false\n");
-	    return false;
-	}
-#else
-	return a < b;
-#endif
-    }
-};
-
 /**
  * AttributeManager manages the storage of PathAttributeLists, so
  * that we don't store the same attribute list more than once.  The
@@ -92,6 +66,11 @@ public:
  * it gives you back a pointer to where it stored it.  To unstore
  * something, you just tell it to delete it, and the undeletion is
  * handled for you if no-one else is still referencing a copy.
+ *
+ * Stored lists are kept in a hash table keyed on their canonical
+ * data.  The hash is computed once by the PathAttributeList, and the
+ * lists in a bucket are chained through the lists themselves, so
+ * storing a list costs no allocation beyond the occasional rehash.
  */
 template <class A>
 class AttributeManager {
@@ -100,12 +79,33 @@ public:
     PAListRef<A> add_attribute_list(PAListRef<A>& attribute_list);
     void delete_attribute_list(PAListRef<A>& attribute_list);
     int number_of_managed_atts() const {
-	return _attribute_lists.size();
+	return _lists;
     }
+
+    /**
+     * @return the number of routes referencing a stored list.  Divided
+     * by number_of_managed_atts() this gives the dedup ratio.
+     */
+    uint32_t total_references() const { return _total_references; }
+
+    /**
+     * @return the approximate memory used by the stored lists and the
+     * hash table, in bytes.
+     */
+    size_t memory_used() const;
+
 private:
-    // set above for explanation of Att_Ptr_Cmp
-    set <PAListRef<A>, Att_Ptr_Cmp<A> > _attribute_lists;
-    int _total_references;
+    static const size_t MIN_BUCKETS = 1024;
+
+    typedef const PathAttributeList<A>* Bucket;
+
+    Bucket* find(const PathAttributeList<A>* palist);
+    void resize(size_t buckets);
+
+    vector<Bucket> _buckets;
+    uint32_t _lists;
+    uint32_t _total_references;
+    size_t _canonical_bytes;
 };
 
 #endif // __BGP_ATTRIBUTE_MANAGER_HH__
@@ -1616,6 +1616,22 @@ BGPMain::get_peer_msg_stats(const Iptuple& iptuple,
     return true;
 }
 
+bool
+BGPMain::get_peer_update_stats(const Iptuple& iptuple,
+			       uint32_t& out_update_packets,
+			       uint32_t& out_update_prefixes)
+{
+    BGPPeer *peer = find_peer(iptuple);
+
+    if (0 == peer) {
+	XLOG_WARNING("Could not find peer: %s", iptuple.str().c_str());
+	return false;
+    }
+
+    peer->get_update_stats(out_update_packets, out_update_prefixes);
+    return true;
+}
+
 bool
 BGPMain::get_peer_established_stats(const Iptuple& iptuple,
 				    uint32_t& transitions,
@@ -1902,6 +1918,11 @@ void
 BGPMain::configure_filter(const uint32_t& filter, const string& conf)
 {
     _policy_filters.configure(filter,conf);
+
+    if (filter == filter::EXPORT) {
+	_plumbing_unicast->export_policy_changed();
+	_plumbing_multicast->export_policy_changed();
+    }
 }
 
 void
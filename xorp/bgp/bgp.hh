@@ -34,6 +34,7 @@
 #include "plumbing.hh"
 #include "iptuple.hh"
 #include "path_attribute.hh"
+#include "attribute_manager.hh"
 #include "peer_handler.hh"
 #include "process_watch.hh"
 
@@ -529,6 +530,9 @@ public:
 			    uint32_t& out_msgs, 
 			    uint16_t& last_error, 
 			    uint32_t& in_update_elapsed);
+    bool get_peer_update_stats(const Iptuple& iptuple,
+			       uint32_t& out_update_packets,
+			       uint32_t& out_update_prefixes);
     bool get_peer_established_stats(const Iptuple& iptuple,  
 				    uint32_t& transitions, 
 				    uint32_t& established_time);
@@ -612,6 +616,20 @@ public:
 			      bool& unicast,
 			      bool& multicast);
 
+    /**
+     * Get statistics on the path attribute lists stored by the
+     * attribute manager.
+     *
+     * @param lists the number of distinct attribute lists stored.
+     * @param references the number of routes referencing them.
+     * @param bytes the approximate memory used to store them.
+     *
+     * @return true on success
+     */
+    template <typename A>
+    bool get_attribute_stats(uint32_t& lists, uint32_t& references,
+			     uint32_t& bytes) const;
+
     bool rib_client_route_info_changed4(
 					// Input values,
 					const IPv4&	addr,
@@ -1068,6 +1086,21 @@ private:
 #endif //ipv6
 };
 
+template <typename A>
+bool
+BGPMain::get_attribute_stats(uint32_t& lists, uint32_t& references,
+			     uint32_t& bytes) const
+{
+    const AttributeManager<A>* att_mgr = PAListRef<A>::attribute_manager();
+    if (att_mgr == 0)
+	return false;
+
+    lists = att_mgr->number_of_managed_atts();
+    references = att_mgr->total_references();
+    bytes = att_mgr->memory_used();
+    return true;
+}
+
 template <typename A>
 bool
 BGPMain::get_route_list_start(uint32_t& token,
@@ -41,6 +41,26 @@ ChainedSubnetRoute(const SubnetRoute<A>& route,
     }
 }
 
+template<class A>
+ChainedSubnetRoute<A>::
+ChainedSubnetRoute(const IPNet<A> &net,
+		   const PAListRef<A> attributes,
+		   const PolicyTags& policytags,
+		   const ChainedSubnetRoute<A>* prev)
+    : SubnetRoute<A>(net, attributes, NULL)
+{
+    this->set_policytags(policytags);
+    if (prev != NULL) {
+	set_prev(prev);
+	set_next(prev->next());
+	_prev->set_next(this);
+	_next->set_prev(this);
+    } else {
+	_prev = this;
+	_next = this;
+    }
+}
+
 template<class A>
 ChainedSubnetRoute<A>::
 ChainedSubnetRoute(const ChainedSubnetRoute<A>& original)
@@ -77,12 +97,13 @@ BgpTrie<A>::~BgpTrie()
 
 template<class A>
 typename BgpTrie<A>::iterator
-BgpTrie<A>::insert(const IPNet& net, const SubnetRoute<A>& route)
+BgpTrie<A>::insert(const IPNet& net, const PAListRef<A>& attributes,
+		   const PolicyTags& policytags)
 {
-    typename PathmapType::iterator pmi = _pathmap.find(route.attributes());
+    typename PathmapType::iterator pmi = _pathmap.find(attributes);
     const ChainedSubnetRoute* found = (pmi == _pathmap.end()) ? NULL : pmi->second;
     ChainedSubnetRoute* chained_rt 
-	= new ChainedSubnetRoute(route, found);
+	= new ChainedSubnetRoute(net, attributes, policytags, found);
 
     // The trie will copy chained_rt.  The copy constructor will insert
     // the copy into the chain after chained_rt.
@@ -90,7 +111,7 @@ BgpTrie<A>::insert(const IPNet& net, const SubnetRoute<A>& route)
 
     if (found == NULL) {
 	debug_msg(" on new chain");
-	_pathmap[route.attributes()] = &(iter.payload());
+	_pathmap[attributes] = &(iter.payload());
     }
     debug_msg("\n");
     chained_rt->unchain();
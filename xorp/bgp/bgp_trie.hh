@@ -44,6 +44,10 @@ public:
 
     ChainedSubnetRoute(const SubnetRoute<A>& route,
 		       const ChainedSubnetRoute<A>* prev);
+    ChainedSubnetRoute(const IPNet<A> &net,
+		       const PAListRef<A> attributes,
+		       const PolicyTags& policytags,
+		       const ChainedSubnetRoute<A>* prev);
 
     ChainedSubnetRoute(const ChainedSubnetRoute& csr);
 
@@ -123,7 +127,8 @@ public:
     BgpTrie();
     ~BgpTrie();
 
-    iterator insert(const IPNet& net, const SubnetRoute<A>& route);
+    iterator insert(const IPNet& net, const PAListRef<A>& attributes,
+		    const PolicyTags& policytags);
 
     void erase(const IPNet& net);
 
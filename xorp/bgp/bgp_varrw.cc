@@ -118,28 +118,28 @@ template <class A>
 Element*
 BGPVarRW<A>::read_filter_im()
 {
-    return new ElemFilter(_rtmsg->route()->policyfilter(0));
+    return arena().create<ElemFilter>(_rtmsg->route()->policyfilter(0));
 }
 
 template <class A>
 Element*
 BGPVarRW<A>::read_filter_sm()
 {
-    return new ElemFilter(_rtmsg->route()->policyfilter(1));
+    return arena().create<ElemFilter>(_rtmsg->route()->policyfilter(1));
 }
 
 template <class A>
 Element*
 BGPVarRW<A>::read_filter_ex()
 {
-    return new ElemFilter(_rtmsg->route()->policyfilter(2));
+    return arena().create<ElemFilter>(_rtmsg->route()->policyfilter(2));
 }
 
 template <>
 Element*
 BGPVarRW<IPv4>::read_network4()
 {
-    return new ElemIPv4Net(_rtmsg->route()->net());
+    return arena().create<ElemIPv4Net>(&_rtmsg->route()->net());
 }
 
 template <>
@@ -153,8 +153,7 @@ template <>
 Element*
 BGPVarRW<IPv6>::read_network6()
 {
-    return _ef.create(ElemIPv6Net::id, 
-		      _rtmsg->route()->net().str().c_str());
+    return arena().create<ElemIPv6Net>(&_rtmsg->route()->net());
 }
 
 template <>
@@ -168,8 +167,7 @@ template <>
 Element*
 BGPVarRW<IPv6>::read_nexthop6()
 {
-    return _ef.create(ElemIPv6NextHop::id, 
-		      _palist->nexthop().str().c_str());
+    return arena().create<ElemIPv6NextHop>(_palist->nexthop());
 }
 
 template <>
@@ -183,7 +181,7 @@ template <>
 Element*
 BGPVarRW<IPv4>::read_nexthop4()
 {
-    return new ElemIPv4NextHop(_palist->nexthop());
+    return arena().create<ElemIPv4NextHop>(_palist->nexthop());
 }
 
 template <>
@@ -197,7 +195,7 @@ template <class A>
 Element*
 BGPVarRW<A>::read_aspath()
 {
-    return new ElemASPath(_palist->aspath());
+    return arena().create<ElemASPath>(_palist->aspath());
 }
 
 template <class A>
@@ -205,7 +203,7 @@ Element*
 BGPVarRW<A>::read_origin()
 {
     uint32_t origin = _palist->origin();
-    return _ef.create(ElemU32::id, to_str(origin).c_str());
+    return arena().create<ElemU32>(origin);
 }
 
 template <class A>
@@ -214,7 +212,7 @@ BGPVarRW<A>::read_localpref()
 {
     const LocalPrefAttribute* lpref = _palist->local_pref_att(); 
     if (lpref) {
-	return _ef.create(ElemU32::id, to_str(lpref->localpref()).c_str());
+	return arena().create<ElemU32>(lpref->localpref());
     } else
 	return NULL;
 }
@@ -229,7 +227,7 @@ BGPVarRW<A>::read_community()
     if (!ca)
 	return NULL;
 
-    ElemSetCom32* es = new ElemSetCom32;
+    ElemSetCom32* es = arena().create<ElemSetCom32>();
 
     const set<uint32_t>& com = ca->community_set();
     for (set<uint32_t>::const_iterator i = com.begin(); i != com.end(); ++i) 
@@ -244,7 +242,7 @@ BGPVarRW<A>::read_med()
 {
     const MEDAttribute* med = _palist->med_att();
     if (med)
-	return new ElemU32(med->med());
+	return arena().create<ElemU32>(med->med());
     else
 	return NULL;
 }
@@ -255,7 +253,7 @@ BGPVarRW<A>::read_med_remove()
 {
     const MEDAttribute* med = _palist->med_att();
     if (med)
-	return new ElemBool(false);	// XXX: default is don't remove the MED
+	return arena().create<ElemBool>(false); // XXX: default is don't remove the MED
     else
 	return NULL;
 }
@@ -265,7 +263,7 @@ Element*
 BGPVarRW<A>::read_aggregate_prefix_len()
 {
     // No-op. Should never be called.
-    return new ElemU32(_aggr_prefix_len);
+    return arena().create<ElemU32>(_aggr_prefix_len);
 }
 
 template <class A>
@@ -273,17 +271,15 @@ Element*
 BGPVarRW<A>::read_aggregate_brief_mode()
 {
     // No-op. Should never be called.
-    return new ElemU32(_aggr_brief_mode);
+    return arena().create<ElemU32>(_aggr_brief_mode);
 }
 
 template <class A>
 Element*
 BGPVarRW<A>::read_was_aggregated()
 {
-    if (_aggr_prefix_len == SR_AGGR_EBGP_WAS_AGGREGATED)
-	return new ElemBool(true);
-    else
-	return new ElemBool(false);
+    return arena().create<ElemBool>(_aggr_prefix_len
+				    == SR_AGGR_EBGP_WAS_AGGREGATED);
 }
 
 template <class A>
@@ -308,11 +304,11 @@ BGPVarRW<A>::write_community(const Element& e)
     if (_palist->community_att())
 	_palist->remove_attribute_by_type(COMMUNITY);
 	
-    CommunityAttribute ca;
+    CommunityAttribute* ca = new CommunityAttribute;
    
     for (typename ElemSetCom32::const_iterator i = es.begin(); i != es.end(); 
 	 ++i) {
-	ca.add_community( (*i).val());
+	ca->add_community( (*i).val());
     }	
     
     _palist->add_path_attribute(ca);
@@ -325,7 +321,10 @@ BGPVarRW<A>::read_neighbor()
     Element* e = NULL;
     const PeerHandler* ph = _rtmsg->origin_peer();
     if (ph != NULL && !ph->originate_route_handler()) {
-	e = _ef.create(ElemIPv4::id, ph->get_peer_addr().c_str());
+	if (ph->get_peer_addr(_neighbor))
+	    e = arena().create<ElemIPv4>(_neighbor);
+	else
+	    e = _ef.create(ElemIPv4::id, ph->get_peer_addr().c_str());
     }
     return e;
 }
@@ -477,8 +476,7 @@ BGPVarRW<A>::write_med(const Element& e)
 	_palist->remove_attribute_by_type(MED);
 	
     const ElemU32& u32 = dynamic_cast<const ElemU32&>(e);	
-    MEDAttribute med(u32.val());
-    _palist->add_path_attribute(med);
+    _palist->add_path_attribute(new MEDAttribute(u32.val()));
 }
 
 template <class A>
@@ -545,8 +543,7 @@ BGPVarRW<A>::write_localpref(const Element& e)
 	_palist->remove_attribute_by_type(LOCAL_PREF);
 	
     const ElemU32& u32 = dynamic_cast<const ElemU32&>(e);	
-    LocalPrefAttribute lpref(u32.val());
-    _palist->add_path_attribute(lpref);
+    _palist->add_path_attribute(new LocalPrefAttribute(u32.val()));
 }
 
 template <class A>
@@ -195,6 +195,7 @@ private:
     bool			_route_modify;
     A				_self;
     A				_peer;
+    IPv4			_neighbor;	// referenced by neighbor reads
 
     // Aggregation -> we cannot write those directly into the subnet
     // route so must provide local volatile copies to be operated on
@@ -30,14 +30,23 @@
 template <class A>
 BGPVarRWExport<A>::BGPVarRWExport(const string& name,
 				  const string& neighbor)
-    : BGPVarRW<A>(name), _neighbor(neighbor)
+    : BGPVarRW<A>(name), _neighbor(neighbor), _neighbor_ipv4(false)
 {
+    try {
+	_neighbor_addr = IPv4(neighbor.c_str());
+	_neighbor_ipv4 = true;
+    } catch (const InvalidString&) {
+	// left to the element factory, on read
+    }
 }
 
 template <class A>
 Element*
 BGPVarRWExport<A>::read_neighbor()
 {
+    if (_neighbor_ipv4)
+	return this->arena().template create<ElemIPv4>(_neighbor_addr);
+
     return BGPVarRW<A>::_ef.create(ElemIPv4::id, _neighbor.c_str());
 }
 
@@ -52,6 +52,8 @@ protected:
 
 private:
     const string _neighbor;
+    IPv4	 _neighbor_addr;	// parsed once, if it is IPv4
+    bool	 _neighbor_ipv4;
 };
 
 #endif // __BGP_BGP_VARRW_EXPORT_HH__
@@ -65,7 +65,7 @@ Trie::lookup(const IPv4Net& n) const
     /*
     ** Look for this net in the matching update packet.
     */
-    list <BGPUpdateAttrib>::const_iterator ni;
+    BGPUpdateAttribList::const_iterator ni;
     ni = update->nlri_list().begin();
     for(; ni != update->nlri_list().end(); ni++)
 	if(ni->net() == n)
@@ -222,6 +222,7 @@ public:
     void add_nlri(const BGPUpdateAttrib& nlri);
     const BGPUpdateAttribList& wr_list() const		{ return _wr_list; }
     FPAList4Ref& pa_list() 	                        { return  _pa_list; }
+    const FPAList4Ref& pa_list() const			{ return  _pa_list; }
     const BGPUpdateAttribList& nlri_list() const	{ return _nlri_list; }
 
     template <typename A> const MPReachNLRIAttribute<A> *mpreach(Safi) const;
@@ -229,8 +230,6 @@ public:
 
     bool encode(uint8_t *buf, size_t& len, const BGPPeerData *peerdata) const;
 
-    bool big_enough() const;
-
     string str() const;
     bool operator==(const UpdatePacket& him) const;
 protected:
@@ -265,6 +264,41 @@ UpdatePacket::mpunreach(Safi safi) const
 }
 
 
+/* **************** EncodedPacket *********************** */
+
+/**
+ * @short An UPDATE in its wire format, shared by several peers.
+ *
+ * Peers which are members of the same update group are sent the same
+ * bytes, so the UPDATE is encoded once and every peer's socket holds a
+ * reference to the buffer until its own write has completed.
+ */
+class EncodedPacket {
+public:
+    EncodedPacket() : _len(0)			{}
+
+    /**
+     * Encode a packet into the buffer.
+     *
+     * @param p the packet to encode.
+     * @param peerdata the peer whose negotiated capabilities determine
+     * the encoding.
+     * @return true on success.
+     */
+    bool encode(const BGPPacket& p, const BGPPeerData *peerdata) {
+	_len = BGPPacket::MAXPACKETSIZE;
+	return p.encode(_data, _len, peerdata);
+    }
+
+    const uint8_t *data() const			{ return _data; }
+    size_t len() const				{ return _len; }
+private:
+    uint8_t	_data[BGPPacket::MAXPACKETSIZE];
+    size_t	_len;
+};
+
+typedef ref_ptr<EncodedPacket> EncodedPacketRef;
+
 /* **************** BGPNotificationPacket *********************** */
 
 class NotificationPacket : public BGPPacket {
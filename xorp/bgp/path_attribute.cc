@@ -2241,16 +2241,18 @@ PathAttribute::set_header(uint8_t *data, size_t payload_size, size_t &wire_size)
 
 template<class A>
 PathAttributeList<A>::PathAttributeList() 
-    : _refcount(0), _managed_refcount(0)
+    : _refcount(0), _managed_refcount(0), _next_managed(0)
 {
     debug_msg("%p\n", this);
     _canonical_data = 0;
     _canonical_length = 0;
+    compute_hash();
 }
 
 template<class A>
 PathAttributeList<A>::PathAttributeList(const PathAttributeList<A>& palist)
-    : _refcount(0), _managed_refcount(0)
+    : _refcount(0), _managed_refcount(0), _hash(palist._hash),
+      _next_managed(0)
 {
     debug_msg("%p\n", this);
 
@@ -2261,12 +2263,37 @@ PathAttributeList<A>::PathAttributeList(const PathAttributeList<A>& palist)
 
 template<class A>
 PathAttributeList<A>::PathAttributeList(FPAListRef& fpa_list)
-    : _refcount(0), _managed_refcount(0)
+    : _refcount(0), _managed_refcount(0), _next_managed(0)
 {
     fpa_list->canonicalize();
     _canonical_length = fpa_list->canonical_length();
     _canonical_data = new uint8_t[_canonical_length];
     memcpy(_canonical_data, fpa_list->canonical_data(), _canonical_length);
+    compute_hash();
+}
+
+/*
+ * 32-bit FNV-1a over the canonical data.  The canonical form is
+ * byte-for-byte identical for equal lists, so equal lists always hash
+ * the same.
+ */
+template<class A>
+uint32_t
+PathAttributeList<A>::hash(const uint8_t* data, size_t length)
+{
+    uint32_t h = 2166136261U;
+    for (size_t i = 0; i < length; i++) {
+	h ^= data[i];
+	h *= 16777619U;
+    }
+    return h;
+}
+
+template<class A>
+void
+PathAttributeList<A>::compute_hash()
+{
+    _hash = hash(_canonical_data, _canonical_length);
 }
     
 template<class A>
@@ -2339,6 +2366,8 @@ operator== (const PathAttributeList<A> &him) const
 {
     if (_canonical_length != him.canonical_length())
 	return false;
+    if (_hash != him.hash())
+	return false;
     return (memcmp(_canonical_data, him.canonical_data(), _canonical_length) == 0);
 }
 
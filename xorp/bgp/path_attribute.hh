@@ -688,6 +688,18 @@ public:
     const uint8_t* canonical_data() const {return _canonical_data;}
     size_t canonical_length() const {return _canonical_length;}
 
+    /**
+     * @return a hash of the canonical data, computed once when the
+     * list is created.  Used by the AttributeManager to find stored
+     * copies, and to reject unequal lists without comparing them.
+     */
+    uint32_t hash() const {return _hash;}
+
+    /**
+     * @return the hash() a list with this canonical data would have.
+     */
+    static uint32_t hash(const uint8_t* data, size_t length);
+
     void incr_refcount(uint32_t change) const {
 	XLOG_ASSERT(0xffffffff - change > _refcount);
 	_refcount += change;
@@ -713,7 +725,7 @@ public:
     }
 
     void decr_managed_refcount(uint32_t change) const {
-	XLOG_ASSERT(_refcount >= change);
+	XLOG_ASSERT(_managed_refcount >= change);
 	_managed_refcount -= change;
 	//	printf("decr_managed_refcount for %p: now %u\n", this, _managed_refcount);
 	if (_refcount == 0 && _managed_refcount == 0) {
@@ -735,6 +747,10 @@ protected:
     uint16_t _canonical_length;
 
 private:
+    friend class AttributeManager<A>;
+
+    void compute_hash();
+
     //    void assert_rehash() const;
     //    const PathAttribute* find_attribute_by_type(PathAttType type) const;
 
@@ -748,7 +764,10 @@ private:
     // list when this PA list is stored in the attribute manager.
     mutable uint32_t _managed_refcount;
 
-    //    uint8_t			_hash[16];	// used for fast comparisons
+    uint32_t _hash;			// used for fast comparisons
+
+    // chains PA lists in the same AttributeManager hash bucket.
+    mutable const PathAttributeList<A>* _next_managed;
 };
 
 template<class A>
@@ -778,6 +797,9 @@ public:
     void create_attribute_manager() {
 	_att_mgr = new AttributeManager<A>();
     };
+    static const AttributeManager<A>* attribute_manager() {
+	return _att_mgr;
+    }
 
    /**
      * DEBUGGING ONLY
@@ -454,6 +454,61 @@ BGPPeer::send_message_complete(SocketClient::Event ev, const uint8_t *buf)
     }
 }
 
+PeerOutputState
+BGPPeer::send_encoded_update(const EncodedPacketRef& p)
+{
+    XLOG_ASSERT(STATEESTABLISHED == _state);
+
+    _out_total_messages++;
+    _out_updates++;
+
+    /*
+    ** The callback holds a reference to the packet so the buffer
+    ** stays around until this peer's write has completed.
+    */
+    bool ret = _SocketClient->send_message(p->data(), p->len(),
+		       callback(this, &BGPPeer::send_encoded_complete, p));
+
+    if (ret) {
+	if (_SocketClient->output_queue_busy()) {
+	    _output_queue_was_busy = true;
+	    return PEER_OUTPUT_BUSY;
+	} else
+	    return PEER_OUTPUT_OK;
+    } else
+	return PEER_OUTPUT_FAIL;
+}
+
+void
+BGPPeer::send_encoded_complete(SocketClient::Event ev, const uint8_t *buf,
+			       EncodedPacketRef packet)
+{
+    TIMESPENT();
+
+    UNUSED(buf);
+    UNUSED(packet);
+
+    switch (ev) {
+    case SocketClient::DATA:
+	if (_output_queue_was_busy &&
+	    (_SocketClient->output_queue_busy() == false)) {
+	    debug_msg("Peer: output no longer busy\n");
+	    _output_queue_was_busy = false;
+	    if (_handler != NULL)
+		_handler->output_no_longer_busy();
+	}
+	TIMESPENT_CHECK();
+	break;
+    case SocketClient::FLUSHING:
+	// The buffer is released with the last reference to the packet.
+	break;
+    case SocketClient::ERROR:
+	event_closed();
+	TIMESPENT_CHECK();
+	break;
+    }
+}
+
 void
 BGPPeer::send_notification(const NotificationPacket& p, bool restart,
 			   bool automatic)
@@ -2196,6 +2251,18 @@ BGPPeer::get_msg_stats(uint32_t& in_updates,
     in_update_elapsed = now.sec() - _in_update_time.sec();
 }
 
+void
+BGPPeer::get_update_stats(uint32_t& out_update_packets,
+			  uint32_t& out_update_prefixes) const
+{
+    if (_handler == NULL) {
+	out_update_packets = out_update_prefixes = 0;
+	return;
+    }
+    out_update_packets = _handler->get_update_packets();
+    out_update_prefixes = _handler->get_update_prefixes();
+}
+
 bool 
 BGPPeer::remote_ip_ge_than(const BGPPeer& peer)
 {
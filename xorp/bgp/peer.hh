@@ -220,6 +220,8 @@ public:
 		     SocketClient *socket_client);
     PeerOutputState send_message(const BGPPacket& p);
     void send_message_complete(SocketClient::Event, const uint8_t *buf);
+    void send_encoded_complete(SocketClient::Event, const uint8_t *buf,
+			       EncodedPacketRef packet);
 
     string str() const			{ return _peername; }
     bool is_connected() const		{ return _SocketClient->is_connected(); }
@@ -245,6 +247,16 @@ public:
     */
     virtual PeerOutputState send_update_message(const UpdatePacket& p);
 
+    /**
+     * Send an UPDATE that has already been encoded for this peer.
+     *
+     * The buffer is shared with the other members of an update group
+     * and is only referenced until the write completes.
+     *
+     * Virtual so that it can be subclassed in the plumbing test code.
+     */
+    virtual PeerOutputState send_encoded_update(const EncodedPacketRef& p);
+
     uint32_t get_established_transitions() const {
 	return _established_transitions;
     }
@@ -255,6 +267,12 @@ public:
 		       uint32_t& out_msgs, 
 		       uint16_t& last_error, 
 		       uint32_t& in_update_elapsed) const;
+    /**
+     * The Update messages the output path has sent to this peer, and
+     * the prefixes they carried.
+     */
+    void get_update_stats(uint32_t& out_update_packets,
+			  uint32_t& out_update_prefixes) const;
 protected:
 private:
     LocalData* _localdata;
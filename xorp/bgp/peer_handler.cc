@@ -36,7 +36,7 @@ PeerHandler::PeerHandler(const string &init_peername,
     : _plumbing_unicast(plumbing_unicast), 
       _plumbing_multicast(plumbing_multicast),
       _peername(init_peername), _peer(peer),
-      _packet(NULL)
+      _packet(NULL), _packet_prefix_bytes(0), _packet_attr_bytes(0)
 {
     debug_msg("peername: %s peer %p unicast %p multicast %p\n", 
 	      _peername.c_str(), peer, _plumbing_unicast,
@@ -50,8 +50,7 @@ PeerHandler::PeerHandler(const string &init_peername,
 
     _peering_is_up = true;
 
-    // stats for debugging only
-    _nlri_total = 0;
+    _prefixes_total = 0;
     _packets = 0;
 }
 
@@ -543,9 +542,59 @@ PeerHandler::start_packet()
 {
     XLOG_ASSERT(_packet == NULL);
     _packet = new UpdatePacket();
+    _packet_prefix_bytes = 0;
+    _packet_attr_bytes = 0;
     return 0;
 }
 
+bool
+PeerHandler::packet_full(size_t prefix_bytes, size_t attr_bytes)
+{
+    XLOG_ASSERT(_packet != NULL);
+
+    // The path attributes are the same for the whole packet, so they
+    // are only encoded once to find their size.
+    if (_packet_attr_bytes == 0 && !_packet->pa_list()->is_empty()) {
+	uint8_t buf[BGPPacket::MAXPACKETSIZE];
+	size_t len = sizeof(buf);
+
+	if (!_packet->pa_list()->encode(buf, len, _peer->peerdata()))
+	    return true;
+	_packet_attr_bytes = len;
+    }
+
+    size_t bytes = BGPPacket::MINUPDATEPACKET + _packet_attr_bytes +
+	attr_bytes + PACKET_ATTR_SLACK + _packet_prefix_bytes + prefix_bytes;
+
+    return bytes > BGPPacket::MAXPACKETSIZE;
+}
+
+template <class A>
+void
+PeerHandler::add_prefix(const IPNet<A>& net,
+			const FastPathAttributeList<A>* pa_list)
+{
+    // An announcement into a packet that only holds withdrawals will
+    // bring its path attributes with it, so they must fit as well.
+    size_t attr_bytes = 0;
+    if (pa_list != NULL && _packet->pa_list()->is_empty()
+	&& !pa_list->is_empty()) {
+	uint8_t buf[BGPPacket::MAXPACKETSIZE];
+	size_t len = sizeof(buf);
+
+	if (!pa_list->encode(buf, len, _peer->peerdata()))
+	    XLOG_FATAL("Path attributes too big to encode: %s",
+		       pa_list->str().c_str());
+	attr_bytes = len;
+    }
+
+    if (packet_full(prefix_bytes(net), attr_bytes)) {
+	push_packet();
+	start_packet();
+    }
+    _packet_prefix_bytes += prefix_bytes(net);
+}
+
 int
 PeerHandler::add_route(const SubnetRoute<IPv4> &rt, 
 		       ref_ptr<FastPathAttributeList<IPv4> >& pa_list,
@@ -562,10 +611,7 @@ PeerHandler::add_route(const SubnetRoute<IPv4> &rt,
     if (!multiprotocol<IPv4>(safi, BGPPeerData::NEGOTIATED))
 	return 0;
 
-    if (_packet->big_enough()) {
-	push_packet();
-	start_packet();
-    }
+    add_prefix(rt.net(), pa_list.get());
 
     // did we already add the packet attribute list?
     if (_packet->pa_list()->is_empty()) {
@@ -646,10 +692,7 @@ PeerHandler::delete_route(const SubnetRoute<IPv4> &rt,
     if (!multiprotocol<IPv4>(safi, BGPPeerData::NEGOTIATED))
 	return 0;
 
-    if (_packet->big_enough()) {
-	push_packet();
-	start_packet();
-    }
+    add_prefix(rt.net());
 
     if (SAFI_MULTICAST == safi && 0 == _packet->pa_list()->mpunreach<IPv4>(safi)) {
 	MPUNReachNLRIAttribute<IPv4>* mp = new MPUNReachNLRIAttribute<IPv4>(safi);
@@ -713,17 +756,33 @@ PeerHandler::push_packet()
     if (nlri > 0)
 	XLOG_ASSERT(!_packet->pa_list()->is_empty());
 
-    _nlri_total += nlri;
+    _prefixes_total += nlri + wdr;
     _packets++;
-    debug_msg("Mean packet has %f nlri's\n", ((float)_nlri_total)/_packets);
+    debug_msg("Mean packet has %f prefixes\n",
+	      ((float)_prefixes_total)/_packets);
 
     PeerOutputState result;
-    result = _peer->send_update_message(*_packet);
+    result = send_packet(*_packet, nlri + wdr);
     delete _packet;
     _packet = NULL;
     return result;
 }
 
+PeerOutputState
+PeerHandler::send_packet(const UpdatePacket& p, int /*prefixes*/)
+{
+    return _peer->send_update_message(p);
+}
+
+PeerOutputState
+PeerHandler::send_encoded(const EncodedPacketRef& p, int prefixes)
+{
+    _prefixes_total += prefixes;
+    _packets++;
+
+    return _peer->send_encoded_update(p);
+}
+
 void
 PeerHandler::output_no_longer_busy()
 {
@@ -774,10 +833,7 @@ PeerHandler::add_route(const SubnetRoute<IPv6> &rt,
     if (!multiprotocol<IPv6>(safi, BGPPeerData::NEGOTIATED))
 	return 0;
 
-    if (_packet->big_enough()) {
-	push_packet();
-	start_packet();
-    }
+    add_prefix(rt.net(), pa_list.get());
 
     // did we already add the packet attribute list?
     if (_packet->pa_list()->is_empty() && !pa_list->is_empty()) {
@@ -836,10 +892,7 @@ PeerHandler::delete_route(const SubnetRoute<IPv6>& rt,
     if (!multiprotocol<IPv6>(safi, BGPPeerData::NEGOTIATED))
 	return 0;
 
-    if (_packet->big_enough()) {
-	push_packet();
-	start_packet();
-    }
+    add_prefix(rt.net());
 
     if (0 == _packet->pa_list()->mpunreach<IPv6>(safi)) {
 	MPUNReachNLRIAttribute<IPv6>* mp = new MPUNReachNLRIAttribute<IPv6>(safi);
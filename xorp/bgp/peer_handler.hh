@@ -38,6 +38,7 @@ class BGPPlumbing;
  * RIB.
  */
 class PeerHandler {
+    friend class UpdateGroup;
 public:
     PeerHandler(const string &peername, BGPPeer *peer,
 		BGPPlumbing *plumbing_unicast,
@@ -107,6 +108,27 @@ public:
     virtual PeerOutputState push_packet();
     virtual void output_no_longer_busy();
 
+    /**
+     * The routes passed in until the next call were learned from
+     * origin.  Only an update group takes notice, so that a member is
+     * never sent back the routes it announced.
+     *
+     * @param origin the peer the routes were learned from.
+     * @param origin_only the routes are for the origin alone rather
+     * than for every peer but the origin.
+     */
+    virtual void set_origin_peer(const PeerHandler *origin,
+				 bool origin_only = false) {
+	UNUSED(origin);
+	UNUSED(origin_only);
+    }
+
+    /**
+     * @return true if set_origin_peer() must be called before routes
+     * are passed in.
+     */
+    virtual bool per_origin_peer() const	{ return false; }
+
     /**
      * The AS number of this router.
      */
@@ -127,6 +149,12 @@ public:
 	return _peer->peerdata()->use_4byte_asnums();
     }
 
+    /**
+     * The session parameters, so that the plumbing can tell which
+     * peers would be sent identical UPDATEs.
+     */
+    const BGPPeerData* peerdata() const	{ return _peer->peerdata(); }
+
     virtual PeerType get_peer_type() const { 
 	return _peer->peerdata()->get_peer_type(); 
     }
@@ -195,6 +223,17 @@ public:
      */
     uint32_t get_prefix_count() const;
 
+    /**
+     * @return the number of UPDATE packets sent to the peer.
+     */
+    uint32_t get_update_packets() const	{ return _packets; }
+
+    /**
+     * @return the number of prefixes announced or withdrawn by the UPDATE
+     * packets sent to the peer.
+     */
+    uint32_t get_update_prefixes() const	{ return _prefixes_total; }
+
     virtual EventLoop& eventloop() const;
 
 
@@ -227,17 +266,71 @@ public:
 #endif //ipv6
 
 protected:
+    /**
+     * Hand a complete UPDATE to the peer.
+     *
+     * Virtual so that an update group can encode the packet once for
+     * all of its members.
+     *
+     * @param p the packet to send.
+     * @param prefixes the number of prefixes announced or withdrawn by the
+     * packet.
+     */
+    virtual PeerOutputState send_packet(const UpdatePacket& p, int prefixes);
+
     BGPPlumbing *_plumbing_unicast;
     BGPPlumbing *_plumbing_multicast;
 private:
+    /**
+     * Send an UPDATE that an update group has already encoded.
+     *
+     * @param p the encoded packet.
+     * @param prefixes the number of prefixes in the packet, for the stats.
+     */
+    PeerOutputState send_encoded(const EncodedPacketRef& p, int prefixes);
+
+    /**
+     * @return the size of a prefix in the NLRI or withdrawn routes.
+     */
+    template <class A>
+    static size_t prefix_bytes(const IPNet<A>& net) {
+	return 1 + (net.prefix_len() + 7) / 8;
+    }
+
+    /**
+     * @return true if a prefix of prefix_bytes, and attr_bytes of path
+     * attributes not yet in the packet, would not fit in the packet being
+     * built.
+     */
+    bool packet_full(size_t prefix_bytes, size_t attr_bytes);
+
+    /**
+     * Account for a prefix about to be added to the packet being built,
+     * sending the packet first if the prefix would not fit.
+     *
+     * @param net the prefix being announced or withdrawn.
+     * @param pa_list the path attributes of an announcement, NULL for a
+     * withdrawal.
+     */
+    template <class A>
+    void add_prefix(const IPNet<A>& net,
+		    const FastPathAttributeList<A>* pa_list = NULL);
+
+    // Room for the multiprotocol attributes of the packet growing once
+    // the path attributes have been measured: an MP_UNREACH_NLRI header
+    // and extended length fields.
+    static const size_t PACKET_ATTR_SLACK = 16;
+
     string _peername;
     BGPPeer *_peer;
     bool _peering_is_up; /*whether we still think it's up (it may be
                            down, but the FSM hasn't told us yet) */
     UpdatePacket *_packet; /* this is a packet we construct to send */
+    size_t _packet_prefix_bytes;	// NLRI and withdrawn bytes in _packet
+    size_t _packet_attr_bytes;		// encoded path attributes of _packet
 
     /*stats*/
-    uint32_t _nlri_total;
+    uint32_t _prefixes_total;
     uint32_t _packets;
 };
 
@@ -49,6 +49,8 @@ public:
 	_is_ready = true;
 	_has_queued_data = false;
 	_waiting_for_get = false;
+	_is_parked = false;
+	_is_update_group = false;
 	TimerList::system_gettimeofday(&_wakeup_sent);
     }
     PeerTableInfo(const PeerTableInfo& other) {
@@ -63,6 +65,8 @@ public:
 	}
 	_waiting_for_get = other._waiting_for_get;
 	_wakeup_sent = other._wakeup_sent;
+	_is_parked = other._is_parked;
+	_is_update_group = other._is_update_group;
     }
     ~PeerTableInfo() {
 	_wakeup_sent = TimeVal::ZERO();
@@ -87,6 +91,21 @@ public:
     void set_is_ready() {_is_ready = true;}
     void set_is_not_ready() {_is_ready = false;}
 
+    /**
+     * A parked table belongs to a member of an update group.  It is
+     * still listed, so that dumps know about the member's routes, but
+     * nothing is queued for it.
+     */
+    bool is_parked() const {return _is_parked;}
+    void set_parked(bool parked) {_is_parked = parked;}
+
+    /**
+     * The table is the output branch of an update group rather than
+     * of a peer that routes are learned from.
+     */
+    bool is_update_group() const {return _is_update_group;}
+    void set_update_group() {_is_update_group = true;}
+
     bool has_queued_data() const {return _has_queued_data;}
     void set_has_queued_data(bool has_data) {_has_queued_data = has_data;}
     
@@ -154,6 +173,9 @@ private:
 
     bool _waiting_for_get;
     TimeVal _wakeup_sent;
+
+    bool _is_parked;
+    bool _is_update_group;
 };
 
 #endif // __BGP_PEER_ROUTE_PAIR_HH__
@@ -35,9 +35,16 @@
 #include "route_table_reader.hh"
 #include "plumbing.hh"
 #include "bgp.hh"
+#include "bgp_varrw.hh"
 #include "profile_vars.hh"
 #include "dump_iterators.hh"
 
+/* how often to look for peers that can be put in an update group */
+static const uint32_t UPDATE_GROUP_INTERVAL_MS = 1000;
+
+/* how long a busy member may hold back the rest of its update group */
+static const int UPDATE_GROUP_SLOW_MEMBER_SECS = 10;
+
 
 BGPPlumbing::BGPPlumbing(const Safi safi,
 			 RibIpcHandler* ribhandler,
@@ -249,6 +256,14 @@ BGPPlumbing::push_routes() {
 #endif
 }
 
+void
+BGPPlumbing::export_policy_changed() {
+    plumbing_ipv4().export_policy_changed();
+#ifdef HAVE_IPV6
+    plumbing_ipv6().export_policy_changed();
+#endif
+}
+
 /***********************************************************************/
 
 template <class A>
@@ -418,6 +433,10 @@ BGPPlumbingAF<A>::~BGPPlumbingAF()
     delete _fanout_table;
     delete _ipc_rib_in_table;
     delete _ipc_rib_out_table;
+
+    typename map <string, UpdateGroup*>::iterator j;
+    for (j = _update_groups.begin(); j != _update_groups.end(); j++)
+	delete j->second;
 }
 
 template <class A>
@@ -781,6 +800,13 @@ BGPPlumbingAF<A>::add_peering(PeerHandler* peer_handler)
     if (_awaits_push)
 	push(peer_handler);
 
+    /* 5. once the dump is over the peer may be able to join an update
+       group */
+    if (!_update_group_timer.scheduled())
+	_update_group_timer = _master.main().eventloop().
+	    new_periodic_ms(UPDATE_GROUP_INTERVAL_MS,
+		callback(this, &BGPPlumbingAF<A>::update_group_timer));
+
     return 0;
 }
 
@@ -788,6 +814,11 @@ template <class A>
 int 
 BGPPlumbingAF<A>::stop_peering(PeerHandler* peer_handler) 
 {
+    /* The peer's own branch is still plumbed in, but parked. */
+    if (_update_group_members.find(peer_handler) != 
+	_update_group_members.end())
+	leave_update_group(peer_handler, false);
+    _update_group_slow.erase(peer_handler);
 
     /* Work our way back to the fanout table from the RibOut so we can
        find the relevant output from the fanout table.  On the way,
@@ -1184,6 +1215,15 @@ BGPPlumbingAF<A>::output_no_longer_busy(PeerHandler *peer_handler)
 PeerHandler that has no associated RibOut");
     rib_out = iter->second;
     rib_out->output_no_longer_busy();
+    _update_group_slow.erase(peer_handler);
+
+    typename map <PeerHandler*, UpdateGroup*>::iterator i;
+    i = _update_group_members.find(peer_handler);
+    if (i != _update_group_members.end()) {
+	UpdateGroup *group = i->second;
+	if (group->member_no_longer_busy(peer_handler))
+	    _update_group_out[group]->output_no_longer_busy();
+    }
 }
 
 template <class A>
@@ -1341,6 +1381,314 @@ BGPPlumbingAF<A>::push_routes() {
 
 }
 
+/*
+ * Update groups.
+ *
+ * Peers that would be sent identical UPDATEs share one output branch
+ * (FilterTable -> PolicyTableExport -> RibOutTable), and the UPDATEs
+ * are encoded once for all of them by the UpdateGroup handler.  A
+ * member's own branch stays plumbed into the fanout table, but is
+ * parked: the fanout table stops queueing for it while still listing
+ * it so that dumps and policy pushes see the member's routes.
+ *
+ * A member is still never sent the routes it announced: the RibOut
+ * table tells the UpdateGroup which peer each route came from, and
+ * the group leaves that member out of the UPDATE.
+ */
+
+template <class A>
+string
+BGPPlumbingAF<A>::update_group_key(PeerHandler* peer_handler) const
+{
+    if (peer_handler == _master.rib_handler() ||
+	peer_handler->originate_route_handler())
+	return "";
+
+    const BGPPeerData *peerdata = peer_handler->peerdata();
+    string key = c_format("type %u as %s my-as %s",
+			  XORP_UINT_CAST(peer_handler->get_peer_type()),
+			  peer_handler->AS_number().str().c_str(),
+			  peer_handler->my_AS_number().str().c_str());
+    key += " local " + peer_handler->get_local_addr();
+    key += " nexthop " + get_local_nexthop(peer_handler).str();
+
+    /* The nexthop filters look at the peer's address when it shares
+       a subnet with us. */
+    IPNet<A> subnet;
+    A peer;
+    if (directly_connected(peer_handler, subnet, peer))
+	key += " direct " + subnet.str() + " " + peer.str();
+
+    key += c_format(" as4 %d mp %d%d%d%d",
+		    peer_handler->use_4byte_asnums(),
+		    peerdata->template multiprotocol<IPv4>(SAFI_UNICAST),
+		    peerdata->template multiprotocol<IPv4>(SAFI_MULTICAST),
+		    peerdata->template multiprotocol<IPv6>(SAFI_UNICAST),
+		    peerdata->template multiprotocol<IPv6>(SAFI_MULTICAST));
+    return key;
+}
+
+template <class A>
+BGPRouteTable<A> *
+BGPPlumbingAF<A>::fanout_child(RibOutTable<A> *rib_out) const
+{
+    BGPRouteTable<A> *rt = rib_out;
+    while (rt != NULL && rt->parent() != _fanout_table) {
+	if (rt->type() == DUMP_TABLE)
+	    return NULL;
+	rt = rt->parent();
+    }
+    return rt;
+}
+
+template <class A>
+bool
+BGPPlumbingAF<A>::export_policy_per_neighbor() const
+{
+    return _master.policy_filters().reads(filter::EXPORT,
+					  BGPVarRW<A>::VAR_NEIGHBOR);
+}
+
+template <class A>
+UpdateGroup *
+BGPPlumbingAF<A>::update_group(PeerHandler* peer_handler) const
+{
+    typename map <PeerHandler*, UpdateGroup*>::const_iterator i;
+    i = _update_group_members.find(peer_handler);
+    if (i == _update_group_members.end())
+	return NULL;
+    return i->second;
+}
+
+template <class A>
+void
+BGPPlumbingAF<A>::form_update_groups()
+{
+    if (export_policy_per_neighbor())
+	return;
+
+    map <string, list<PeerHandler*> > waiting;
+    typename map <PeerHandler*, RibOutTable<A>*>::iterator i;
+    for (i = _out_map.begin(); i != _out_map.end(); i++) {
+	PeerHandler *peer_handler = i->first;
+	RibOutTable<A> *rib_out = i->second;
+
+	if (_update_group_members.find(peer_handler) !=
+	    _update_group_members.end())
+	    continue;
+	if (!peer_handler->peering_is_up() || !rib_out->queue_empty())
+	    continue;
+	if (_update_group_slow.find(peer_handler) !=
+	    _update_group_slow.end())
+	    continue;
+	BGPRouteTable<A> *child = fanout_child(rib_out);
+	if (child == NULL)
+	    continue;
+	string key = update_group_key(peer_handler);
+	if (key.empty())
+	    continue;
+
+	typename map <string, UpdateGroup*>::iterator g;
+	g = _update_groups.find(key);
+	if (g == _update_groups.end()) {
+	    waiting[key].push_back(peer_handler);
+	    continue;
+	}
+
+	UpdateGroup *group = g->second;
+	RibOutTable<A> *group_out = _update_group_out[group];
+	if (!group->empty() && group_out->queue_empty() &&
+	    _fanout_table->in_step(child, fanout_child(group_out)))
+	    join_update_group(group, peer_handler);
+    }
+
+    /* Start a group for the first peer with a key, if another peer
+       with the same key is in step with it. */
+    typename map <string, list<PeerHandler*> >::iterator w;
+    for (w = waiting.begin(); w != waiting.end(); w++) {
+	list<PeerHandler*>& peers = w->second;
+	PeerHandler *seed = peers.front();
+	BGPRouteTable<A> *seed_child = fanout_child(_out_map[seed]);
+	list<PeerHandler*> in_step;
+	typename list<PeerHandler*>::iterator p = peers.begin();
+	for (p++; p != peers.end(); p++) {
+	    if (_fanout_table->in_step(seed_child,
+				       fanout_child(_out_map[*p])))
+		in_step.push_back(*p);
+	}
+	if (in_step.empty())
+	    continue;
+
+	create_update_group(w->first, seed);
+	UpdateGroup *group = _update_groups[w->first];
+	for (p = in_step.begin(); p != in_step.end(); p++)
+	    join_update_group(group, *p);
+    }
+}
+
+template <class A>
+void
+BGPPlumbingAF<A>::create_update_group(const string& key, PeerHandler* seed)
+{
+    UpdateGroup *group = new UpdateGroup(key, seed);
+    string peername(group->peername());
+
+    A self_addr;
+    try {
+	self_addr = A(seed->get_local_addr().c_str()); 
+    } catch (...) {
+    }
+
+    FilterTable<A>* filter_out =
+	new FilterTable<A>(_ribname + "PeerOutputFilter" + peername,
+			   _master.safi(),
+			   _fanout_table,
+			   _next_hop_resolver);
+
+    /* The export policy doesn't read the neighbor, or there wouldn't
+       be a group, so any member's address will do. */
+    PolicyTable<A>* policy_filter_out =
+	new PolicyTableExport<A>(_ribname + "PeerOutputPolicyFilter" + peername,
+			         _master.safi(),
+				 filter_out,
+				 _master.policy_filters(),
+				 seed->get_peer_addr(),
+				 self_addr);
+    filter_out->set_next_table(policy_filter_out);
+
+    RibOutTable<A>* rib_out =
+	new RibOutTable<A>(_ribname + "RibOut" + peername,
+			   _master.safi(),
+			   policy_filter_out,
+			   group);
+    policy_filter_out->set_next_table(rib_out);
+
+    _tables.insert(filter_out);
+    _tables.insert(policy_filter_out);
+    _tables.insert(rib_out);
+    _update_groups[key] = group;
+    _update_group_out[group] = rib_out;
+
+    configure_outbound_filter(group, filter_out);
+
+    _fanout_table->add_update_group(filter_out, group,
+				    fanout_child(_out_map[seed]));
+    join_update_group(group, seed);
+}
+
+template <class A>
+void
+BGPPlumbingAF<A>::join_update_group(UpdateGroup *group,
+				    PeerHandler* peer_handler)
+{
+    debug_msg("%s joins %s\n", peer_handler->peername().c_str(),
+	      group->peername().c_str());
+
+    _fanout_table->park_next_table(fanout_child(_out_map[peer_handler]));
+    group->add_member(peer_handler);
+    _update_group_members[peer_handler] = group;
+}
+
+template <class A>
+void
+BGPPlumbingAF<A>::leave_update_group(PeerHandler* peer_handler, bool split)
+{
+    typename map <PeerHandler*, UpdateGroup*>::iterator i;
+    i = _update_group_members.find(peer_handler);
+    XLOG_ASSERT(i != _update_group_members.end());
+    UpdateGroup *group = i->second;
+    _update_group_members.erase(i);
+
+    debug_msg("%s leaves %s\n", peer_handler->peername().c_str(),
+	      group->peername().c_str());
+
+    RibOutTable<A> *group_out = _update_group_out[group];
+    if (split) {
+	/* Send the member what the group has already taken from the
+	   fanout table, then carry on from where the group is. */
+	if (!group_out->queue_empty())
+	    group_out->push(group_out->parent());
+	_fanout_table->unpark_next_table(fanout_child(_out_map[peer_handler]),
+					 fanout_child(group_out));
+    }
+
+    /* An empty group is cleaned up by the timer, as we may be called
+       from within the group's own output path. */
+    if (group->remove_member(peer_handler) && !group->empty())
+	group_out->output_no_longer_busy();
+}
+
+template <class A>
+void
+BGPPlumbingAF<A>::delete_update_group(UpdateGroup *group)
+{
+    XLOG_ASSERT(group->empty());
+
+    typename map <UpdateGroup*, RibOutTable<A>*>::iterator i;
+    i = _update_group_out.find(group);
+    XLOG_ASSERT(i != _update_group_out.end());
+    BGPRouteTable<A> *rt = i->second;
+    _update_group_out.erase(i);
+    _update_groups.erase(group->key());
+
+    _fanout_table->remove_next_table(fanout_child((RibOutTable<A>*)rt));
+    while (rt != _fanout_table) {
+	BGPRouteTable<A> *parent = rt->parent();
+	_tables.erase(rt);
+	delete rt;
+	rt = parent;
+    }
+    delete group;
+}
+
+template <class A>
+void
+BGPPlumbingAF<A>::export_policy_changed()
+{
+    if (!export_policy_per_neighbor())
+	return;
+
+    while (!_update_group_members.empty())
+	leave_update_group(_update_group_members.begin()->first, true);
+}
+
+template <class A>
+bool
+BGPPlumbingAF<A>::update_group_timer()
+{
+    /* Tidy up groups whose members have all gone. */
+    list <UpdateGroup*> empty;
+    typename map <string, UpdateGroup*>::iterator i;
+    for (i = _update_groups.begin(); i != _update_groups.end(); i++) {
+	if (i->second->empty())
+	    empty.push_back(i->second);
+    }
+    typename list <UpdateGroup*>::iterator j;
+    for (j = empty.begin(); j != empty.end(); j++)
+	delete_update_group(*j);
+
+    /* Don't let one slow member hold back the rest of its group; it
+       can go at its own pace, and may only join again once its
+       output queue has drained. */
+    TimeVal now;
+    _master.main().eventloop().current_time(now);
+    TimeVal limit(UPDATE_GROUP_SLOW_MEMBER_SECS, 0);
+    for (i = _update_groups.begin(); i != _update_groups.end(); i++) {
+	UpdateGroup *group = i->second;
+	if (group->members().size() < 2)
+	    continue;
+	PeerHandler *slow = group->slow_member(now, limit);
+	if (slow != NULL) {
+	    leave_update_group(slow, true);
+	    _update_group_slow.insert(slow);
+	}
+    }
+
+    form_update_groups();
+
+    return true;
+}
+
 template class BGPPlumbingAF<IPv4>;
 
 /** IPv6 stuff */
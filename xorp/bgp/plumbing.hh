@@ -41,6 +41,7 @@
 #include "route_table_policy_ex.hh"
 #include "peer.hh"
 #include "rib_ipc_handler.hh"
+#include "update_group.hh"
 #include "next_hop_resolver.hh"
 #include "parameter.hh"
 #include "policy/backend/policy_filters.hh"
@@ -108,6 +109,26 @@ public:
      */
     void push_routes();
 
+    /**
+     * Put peers that are sent identical UPDATEs into update groups.
+     *
+     * A peer can only join a group once its output branch is idle and
+     * has caught up with the group, so groups form after the initial
+     * route dump has completed.
+     */
+    void form_update_groups();
+
+    /**
+     * The export policy has changed.  If it now depends on which
+     * neighbor a route is sent to, split up all the update groups.
+     */
+    void export_policy_changed();
+
+    /**
+     * @return the update group the peer belongs to, or NULL.
+     */
+    UpdateGroup *update_group(PeerHandler* peer_handler) const;
+
 private:
     /**
      * A peering has just come up dump all the routes to it.
@@ -122,6 +143,25 @@ private:
 
     const A& get_local_nexthop(const PeerHandler *peer_handler) const;
 
+    /**
+     * @return a key that is the same for peers that would be sent the
+     * same UPDATEs, or an empty string if the peer may not be grouped.
+     */
+    string update_group_key(PeerHandler* peer_handler) const;
+
+    /**
+     * @return the table which attaches a branch to the fanout table,
+     * or NULL if the branch is unplumbed or a dump is in progress.
+     */
+    BGPRouteTable<A> *fanout_child(RibOutTable<A> *rib_out) const;
+
+    bool export_policy_per_neighbor() const;
+    void create_update_group(const string& key, PeerHandler* seed);
+    void join_update_group(UpdateGroup *group, PeerHandler* peer_handler);
+    void leave_update_group(PeerHandler* peer_handler, bool split);
+    void delete_update_group(UpdateGroup *group);
+    bool update_group_timer();
+
     /**
      * Is the peer directly connected and if it is return the common
      * subnet and the peer address.
@@ -151,6 +191,12 @@ private:
     BGPPlumbing& _master;
 
     NextHopResolver<A>& _next_hop_resolver;
+
+    map <string, UpdateGroup*> _update_groups;
+    map <UpdateGroup*, RibOutTable<A>*> _update_group_out;
+    map <PeerHandler*, UpdateGroup*> _update_group_members;
+    set <PeerHandler*> _update_group_slow;	// Split off until they drain.
+    XorpTimer _update_group_timer;
 };
 
 
@@ -238,6 +284,12 @@ public:
 
     PolicyFilters& policy_filters() { return _policy_filters; }
 
+    /**
+     * The export policy has changed, so update groups may need to be
+     * split up.
+     */
+    void export_policy_changed();
+
     /** IPv6 stuff */
 #ifdef HAVE_IPV6
     int add_route(const IPv6Net& net, 
@@ -42,6 +42,34 @@
 #define PARANOID_ASSERT(x) {}
 #endif
 
+template<class A>
+CandidateRoute<A>::CandidateRoute(const SubnetRoute<A>* route,
+				  const FPAListRef& pa_list,
+				  PeerTableInfo<A>* peer_info,
+				  uint32_t genid)
+    : _route(route), _peer_info(peer_info), _genid(genid),
+      _nexthop(pa_list->nexthop()), _neighbour_as(AsNum::AS_INVALID)
+{
+    /*
+     * Local Pref should be present on all routes.  If the route comes
+     * from EBGP, the incoming FilterTable should have added it.  If
+     * the route comes from IBGP, it should have been present on the
+     * incoming route.  
+     */
+    const LocalPrefAttribute* localpref_att = pa_list->local_pref_att();
+    _local_pref = localpref_att ? localpref_att->localpref() : 0;
+
+    const MEDAttribute* med_attribute = pa_list->med_att();
+    _med = med_attribute ? med_attribute->med() : 0;
+
+    const ASPath& aspath = pa_list->aspath();
+    _aspath_length = aspath.path_length();
+    if (0 != _aspath_length)
+	_neighbour_as = aspath.first_asnum();
+
+    _origin = pa_list->origin();
+}
+
 template<class A>
 DecisionTable<A>::DecisionTable(string table_name, 
 				Safi safi,
@@ -93,10 +121,96 @@ DecisionTable<A>::remove_parent(BGPRouteTable<A> *ex_parent) {
     const PeerHandler* peer = pti->peer_handler();
     _parents.erase(i);
     _sorted_parents.erase(_sorted_parents.find(peer->get_unique_id()));
+
+    // The parent's routes should all have been deleted by now, but
+    // make sure nothing refers to the parent once it has gone.
+    list<IPNet<A> > empty;
+    typename Trie<A, Candidates>::iterator j;
+    for (j = _candidates.begin(); j != _candidates.end(); j++) {
+	Candidates& candidates = j.payload();
+	typename Candidates::iterator k;
+	for (k = candidates.begin(); k != candidates.end(); k++) {
+	    if (k->peer_info() == pti) {
+		XLOG_WARNING("%s removed with route %s still present",
+			     ex_parent->tablename().c_str(),
+			     cstring(k->route()->net()));
+		candidates.erase(k);
+		break;
+	    }
+	}
+	if (candidates.empty())
+	    empty.push_back(j.key());
+    }
+    typename list<IPNet<A> >::const_iterator n;
+    for (n = empty.begin(); n != empty.end(); n++)
+	_candidates.erase(*n);
+
     delete pti;
     return 0;
 }
 
+template<class A>
+PeerTableInfo<A>*
+DecisionTable<A>::peer_info(BGPRouteTable<A> *caller) const
+{
+    typename map<BGPRouteTable<A>*, PeerTableInfo<A>* >::const_iterator i;
+    i = _parents.find(caller);
+    XLOG_ASSERT(i != _parents.end());
+    return i->second;
+}
+
+template<class A>
+void
+DecisionTable<A>::add_candidate(InternalMessage<A> &rtmsg,
+				BGPRouteTable<A> *caller)
+{
+    PeerTableInfo<A>* pti = peer_info(caller);
+    CandidateRoute<A> candidate(rtmsg.route(), rtmsg.attributes(), pti,
+				rtmsg.genid());
+
+    typename Trie<A, Candidates>::iterator i;
+    i = _candidates.lookup_node(rtmsg.net());
+    if (i == _candidates.end()) {
+	_candidates.insert(rtmsg.net(), Candidates(1, candidate));
+	return;
+    }
+
+    Candidates& candidates = i.payload();
+    less<BGPRouteTable<A>*> before;
+    typename Candidates::iterator j;
+    for (j = candidates.begin(); j != candidates.end(); j++) {
+	if (j->parent_table() == caller) {
+	    *j = candidate;
+	    return;
+	}
+	if (before(caller, j->parent_table()))
+	    break;
+    }
+    candidates.insert(j, candidate);
+}
+
+template<class A>
+void
+DecisionTable<A>::delete_candidate(InternalMessage<A> &rtmsg,
+				   BGPRouteTable<A> *caller)
+{
+    typename Trie<A, Candidates>::iterator i;
+    i = _candidates.lookup_node(rtmsg.net());
+    if (i == _candidates.end())
+	return;
+
+    Candidates& candidates = i.payload();
+    typename Candidates::iterator j;
+    for (j = candidates.begin(); j != candidates.end(); j++) {
+	if (j->parent_table() == caller && j->route() == rtmsg.route()) {
+	    candidates.erase(j);
+	    break;
+	}
+    }
+    if (candidates.empty())
+	_candidates.erase(i);
+}
+
 
 template<class A>
 int
@@ -107,6 +221,9 @@ DecisionTable<A>::add_route(InternalMessage<A> &rtmsg,
 
     debug_msg("DT:add_route %s\n", rtmsg.route()->str().c_str());
 
+    //unresolvable routes are still alternatives if they later resolve
+    add_candidate(rtmsg, caller);
+
     //if the nexthop isn't resolvable, don't even consider the route
     debug_msg("testing resolvability\n");
     XLOG_ASSERT(rtmsg.route()->nexthop_resolved() ==
@@ -131,8 +248,9 @@ DecisionTable<A>::add_route(InternalMessage<A> &rtmsg,
     }
     
     RouteData<A> *new_winner = NULL;
-    RouteData<A> new_route(rtmsg.route(), rtmsg.attributes(), caller, 
-			   rtmsg.origin_peer(), rtmsg.genid());
+    RouteData<A> new_route(rtmsg.route(), rtmsg.attributes(),
+			   peer_info(caller), rtmsg.origin_peer(),
+			   rtmsg.genid());
     if (!alternatives.empty()) {
 	//add the new route to the pool of possible winners.
 	alternatives.push_back(new_route);
@@ -167,7 +285,7 @@ DecisionTable<A>::add_route(InternalMessage<A> &rtmsg,
 
     //send an add for the new winner
     new_winner->route()->set_is_winner(
-		       igp_distance(new_winner->attributes()->nexthop()));
+		       igp_distance(new_winner->candidate().nexthop()));
     int result;
     if (new_winner->route() != rtmsg.route()) {
 	//we have a new winner, but it isn't the route that was just added.
@@ -203,6 +321,9 @@ DecisionTable<A>::replace_route(InternalMessage<A> &old_rtmsg,
 
     debug_msg("DT:replace_route.\nOld route: %s\nNew Route: %s\n", old_rtmsg.route()->str().c_str(), new_rtmsg.route()->str().c_str());
 
+    //the new route takes the place of the old one from this parent
+    add_candidate(new_rtmsg, caller);
+
     list <RouteData<A> > alternatives;
     RouteData<A> *old_winner, *old_winner_clone = NULL;
     old_winner = find_alternative_routes(caller, old_rtmsg.net(),alternatives);
@@ -215,7 +336,7 @@ DecisionTable<A>::replace_route(InternalMessage<A> &old_rtmsg,
 	//the route being deleted was the old winner
 	old_winner_clone = new RouteData<A>(old_rtmsg.route(), 
 					    old_rtmsg.attributes(),
-					    caller,
+					    peer_info(caller),
 					    old_rtmsg.origin_peer(),
 					    old_rtmsg.genid());
     }
@@ -228,7 +349,7 @@ DecisionTable<A>::replace_route(InternalMessage<A> &old_rtmsg,
 
     RouteData<A> *new_winner = NULL;
     RouteData<A> new_route(new_rtmsg.route(), new_rtmsg.attributes(),
-			   caller, new_rtmsg.origin_peer(),
+			   peer_info(caller), new_rtmsg.origin_peer(),
 			   new_rtmsg.genid());
     if (!alternatives.empty()) {
 	//add the new route to the pool of possible winners.
@@ -272,7 +393,7 @@ DecisionTable<A>::replace_route(InternalMessage<A> &old_rtmsg,
 
     //create the addition part of the message
     new_winner->route()->set_is_winner(
-                         igp_distance(new_winner->attributes()->nexthop()));
+                         igp_distance(new_winner->candidate().nexthop()));
     int result;
     if (new_winner->route() == new_rtmsg.route()) {
 	new_rtmsg_p = &new_rtmsg;
@@ -318,6 +439,8 @@ DecisionTable<A>::delete_route(InternalMessage<A> &rtmsg,
     PARANOID_ASSERT(_parents.find(caller) != _parents.end());
     XLOG_ASSERT(this->_next_table != NULL);
 
+    delete_candidate(rtmsg, caller);
+
     //find the alternative routes, and the old winner if there was one.
     RouteData<A> *old_winner = NULL, *old_winner_clone = NULL;
     list<RouteData<A> > alternatives;
@@ -333,7 +456,7 @@ DecisionTable<A>::delete_route(InternalMessage<A> &rtmsg,
 	//the route being deleted was the old winner
 	old_winner_clone = new RouteData<A>(rtmsg.route(), 
 					    rtmsg.attributes(),
-					    caller,
+					    peer_info(caller),
 					    rtmsg.origin_peer(), 
 					    rtmsg.genid());
     }
@@ -383,7 +506,7 @@ DecisionTable<A>::delete_route(InternalMessage<A> &rtmsg,
     if (new_winner != NULL) {
 	//send an add for the new winner
 	new_winner->route()->set_is_winner(
-		   igp_distance(new_winner->attributes()->nexthop()));
+		   igp_distance(new_winner->candidate().nexthop()));
 	InternalMessage<A> new_rt_msg(new_winner->route(), 
 				      new_winner->attributes(),
 				      new_winner->peer_handler(), 
@@ -467,63 +590,27 @@ DecisionTable<A>::find_alternative_routes(
     list <RouteData<A> >& alternatives) const 
 {
     RouteData<A>* previous_winner = NULL;
-    typename map<BGPRouteTable<A>*, PeerTableInfo<A>* >::const_iterator i;
-    const SubnetRoute<A>* found_route;
-    for (i = _parents.begin();  i != _parents.end();  i++) {
-	//We don't need to lookup the route in the parent that the new
-	//route came from - if this route replaced an earlier route
+    typename Trie<A, Candidates>::iterator i = _candidates.lookup_node(net);
+    if (i == _candidates.end())
+	return NULL;
+
+    const Candidates& candidates = i.payload();
+    typename Candidates::const_iterator j;
+    for (j = candidates.begin(); j != candidates.end(); j++) {
+	//We don't need to consider the route from the parent that the
+	//new route came from - if this route replaced an earlier route
 	//from the same parent we'd see it as a replace, not an add
- 	if (i->first != caller) {
-	    uint32_t found_genid;
-	    FPAListRef found_attributes;
-	    found_route = i->first->lookup_route(net, found_genid, 
-						 found_attributes);
-	    if (found_route != NULL) {
-		PeerTableInfo<A> *pti = i->second;
-		alternatives.push_back(RouteData<A>(found_route, 
-						    found_attributes,
-						    pti->route_table(),
-						    pti->peer_handler(),
-						    found_genid));
-		if (found_route->is_winner()) {
-		    XLOG_ASSERT(previous_winner == NULL);
-		    previous_winner = &(alternatives.back());
-		}
+	if (j->parent_table() != caller) {
+	    alternatives.push_back(RouteData<A>(*j));
+	    if (j->route()->is_winner()) {
+		XLOG_ASSERT(previous_winner == NULL);
+		previous_winner = &(alternatives.back());
 	    }
 	}
     }
     return previous_winner;
 }
 
-template<class A>
-uint32_t
-DecisionTable<A>::local_pref(const FPAListRef& pa_list) const
-{
-    /*
-     * Local Pref should be present on all routes.  If the route comes
-     * from EBGP, the incoming FilterTable should have added it.  If
-     * the route comes from IBGP, it should have been present on the
-     * incoming route.  
-     */
-    const LocalPrefAttribute* localpref_att = pa_list->local_pref_att();
-    if (localpref_att) {
-	return localpref_att->localpref();
-    }
-    return 0;
-}
-
-template<class A>
-uint32_t
-DecisionTable<A>::med(const FPAListRef& pa_list) const
-{
-    const MEDAttribute* med_attribute = pa_list->med_att();
-    if (med_attribute) {
-	return med_attribute->med();
-    }
-    
-    return 0;
-}
-
 /*
 ** Is this next hop resolvable. Ask the RIB via the next hop resolver.
 ** NOTE: If unsynchronised operation is required then this is the
@@ -611,10 +698,10 @@ DecisionTable<A>::find_winner(list<RouteData<A> >& alternatives) const
     /* 
     ** Phase 1: Calculation of degree of preference.
     */
-    int test_pref = local_pref(alternatives.front().attributes());
+    int test_pref = alternatives.front().candidate().local_pref();
     i = alternatives.begin(); i++;
     while(i!=alternatives.end()) {
-	int lp = local_pref(i->attributes());
+	int lp = i->candidate().local_pref();
 	XLOG_ASSERT(lp >= 0);
 	//prefer higher preference
 	if (lp < test_pref) {
@@ -647,12 +734,12 @@ DecisionTable<A>::find_winner(list<RouteData<A> >& alternatives) const
     /*
     ** Shortest AS path length.
     */
-    int test_aspath_length = alternatives.front().attributes()->
-	aspath().path_length();
+    int test_aspath_length = alternatives.front().candidate().
+	aspath_length();
 
     i = alternatives.begin(); i++;
     while(i!=alternatives.end()) {
-	int len = i->attributes()->aspath().path_length();
+	int len = i->candidate().aspath_length();
 	XLOG_ASSERT(len >= 0);
 	//prefer shortest path
 	if (len > test_aspath_length) {
@@ -674,10 +761,10 @@ DecisionTable<A>::find_winner(list<RouteData<A> >& alternatives) const
     /*
     ** Lowest origin value.
     */
-    int test_origin = alternatives.front().attributes()->origin();
+    int test_origin = alternatives.front().candidate().origin();
     i = alternatives.begin(); i++;
     while(i!=alternatives.end()) {
-	int origin = i->attributes()->origin();
+	int origin = i->candidate().origin();
 	//prefer lower origin
 	if (origin > test_origin) {
 	    i = alternatives.erase(i);
@@ -700,18 +787,14 @@ DecisionTable<A>::find_winner(list<RouteData<A> >& alternatives) const
     */
     typename list <RouteData<A> >::iterator j;
     for (i=alternatives.begin(); i!=alternatives.end();) {
-	ASPath aspath1 = i->attributes()->aspath();
- 	AsNum asnum1 = (0 == aspath1.path_length()) ? 
- 	    AsNum(AsNum::AS_INVALID) : aspath1.first_asnum();
-	int med1 = med(i->attributes());
+	AsNum asnum1 = i->candidate().neighbour_as();
+	int med1 = i->candidate().med();
 	bool del_i = false;
 	for (j=alternatives.begin(); j!=alternatives.end();) {
 	    bool del_j = false;
 	    if (i != j) {
-		ASPath aspath2 = j->attributes()->aspath();
-		AsNum asnum2 = (0 == aspath2.path_length()) ? 
-		    AsNum(AsNum::AS_INVALID) : aspath2.first_asnum();
-		int med2 = med(j->attributes());
+		AsNum asnum2 = j->candidate().neighbour_as();
+		int med2 = j->candidate().med();
 		if (asnum1 == asnum2) {
 		    if (med1 > med2) {
 			i = alternatives.erase(i);
@@ -769,10 +852,10 @@ DecisionTable<A>::find_winner(list<RouteData<A> >& alternatives) const
     /*
     ** Compare IGP distances.
     */
-    int test_igp_distance = igp_distance(alternatives.front().attributes()->nexthop());
+    int test_igp_distance = igp_distance(alternatives.front().candidate().nexthop());
     i = alternatives.begin(); i++;
     while(i!=alternatives.end()) {
-	int igp_dist = igp_distance(i->attributes()->nexthop());
+	int igp_dist = igp_distance(i->candidate().nexthop());
 	//prefer lower IGP distance
 	if (test_igp_distance < igp_dist) {
 	    i = alternatives.erase(i);
@@ -22,12 +22,54 @@
 #define __BGP_ROUTE_TABLE_DECISION_HH__
 
 
+#include "libxorp/trie.hh"
+
 #include "route_table_base.hh"
 #include "dump_iterators.hh"
 #include "peer_handler.hh"
 #include "next_hop_resolver.hh"
 #include "peer_route_pair.hh"
 
+/**
+ * A route that has reached the DecisionTable from one of its parents,
+ * together with the attributes the decision process compares, which
+ * are decoded once when the route arrives.
+ */
+
+template<class A>
+class CandidateRoute {
+public:
+    CandidateRoute(const SubnetRoute<A>* route,
+		   const FPAListRef& pa_list,
+		   PeerTableInfo<A>* peer_info,
+		   uint32_t genid);
+
+    const SubnetRoute<A>* route() const { return _route; }
+    PeerTableInfo<A>* peer_info() const { return _peer_info; }
+    BGPRouteTable<A>* parent_table() const {
+	return _peer_info->route_table();
+    }
+    uint32_t genid() const { return _genid; }
+
+    const A& nexthop() const { return _nexthop; }
+    uint32_t local_pref() const { return _local_pref; }
+    uint32_t med() const { return _med; }
+    int aspath_length() const { return _aspath_length; }
+    int origin() const { return _origin; }
+    const AsNum& neighbour_as() const { return _neighbour_as; }
+private:
+    const SubnetRoute<A>* _route;
+    PeerTableInfo<A>* _peer_info;
+    uint32_t _genid;
+
+    A _nexthop;
+    uint32_t _local_pref;
+    uint32_t _med;
+    int _aspath_length;
+    int _origin;
+    AsNum _neighbour_as;	// First AS in the AS path.
+};
+
 /**
  * Container for a route and the meta-data about the origin of a route
  * used in the DecisionTable decision process.
@@ -38,47 +80,60 @@ class RouteData {
 public:
     RouteData(const SubnetRoute<A>* route, 
 	      FPAListRef pa_list,
-	      BGPRouteTable<A>* parent_table,
+	      PeerTableInfo<A>* peer_info,
 	      const PeerHandler* peer_handler,
 	      uint32_t genid) 
-	: _route(route), _pa_list(pa_list), _parent_table(parent_table), 
-	  _peer_handler(peer_handler), _genid(genid) {}
+	: _candidate(route, pa_list, peer_info, genid), _pa_list(pa_list),
+	  _peer_handler(peer_handler) {}
+
+    /**
+     * The attributes of a stored candidate are only decoded again if
+     * they are needed.
+     */
+    RouteData(const CandidateRoute<A>& candidate)
+	: _candidate(candidate),
+	  _peer_handler(candidate.peer_info()->peer_handler()) {}
 
     RouteData(const RouteData<A>& him) :
-	    _route(him._route), _pa_list(him._pa_list), _parent_table(him._parent_table),
-	    _peer_handler(him._peer_handler), _genid(him._genid) { }
+	    _candidate(him._candidate), _pa_list(him._pa_list),
+	    _peer_handler(him._peer_handler) { }
 
     /* main reason for defining operator= is to keep the refcount
        correct on _pa_list */
     RouteData<A>& operator=(const RouteData<A>& him) {
-	_route = him._route;
+	_candidate = him._candidate;
 	_pa_list = him._pa_list;
-	_parent_table = him._parent_table;
 	_peer_handler = him._peer_handler;
-	_genid = him._genid;
 	return *this;
     }
 
     void set_is_not_winner() {
-	_parent_table->route_used(_route, false);
-	_route->set_is_not_winner();
+	parent_table()->route_used(route(), false);
+	route()->set_is_not_winner();
     }
 
     void set_is_winner(int igp_distance) {
-	_parent_table->route_used(_route, true);
-	_route->set_is_winner(igp_distance);
+	parent_table()->route_used(route(), true);
+	route()->set_is_winner(igp_distance);
     }
-    const SubnetRoute<A>* route() const { return _route; }
-    const FPAListRef& attributes() const { return _pa_list; }
+    const SubnetRoute<A>* route() const { return _candidate.route(); }
+    const FPAListRef& attributes() const {
+	if (_pa_list.is_empty()) {
+	    PAListRef<A> pa_list = route()->attributes();
+	    _pa_list = new FastPathAttributeList<A>(pa_list);
+	}
+	return _pa_list;
+    }
+    const CandidateRoute<A>& candidate() const { return _candidate; }
     const PeerHandler* peer_handler() const { return _peer_handler; }
-    BGPRouteTable<A>* parent_table() const { return _parent_table; }
-    uint32_t genid() const { return _genid; }
+    BGPRouteTable<A>* parent_table() const {
+	return _candidate.parent_table();
+    }
+    uint32_t genid() const { return _candidate.genid(); }
 private:
-    const SubnetRoute<A>* _route;
-    FPAListRef _pa_list;
-    BGPRouteTable<A>* _parent_table;
+    CandidateRoute<A> _candidate;
+    mutable FPAListRef _pa_list;
     const PeerHandler* _peer_handler;
-    uint32_t _genid;
 };
 
 /**
@@ -98,10 +153,12 @@ private:
  * BGP decision process are propagated downstream.
  *
  * When a new route reaches DecisionTable from one peer, we must
- * lookup that route in all the other upstream branches to see if this
- * route wins, or even if it doesn't win, if it causes a change of
- * winning route.  Similarly for route deletions coming from a peer,
- * etc.
+ * consider the routes to the same subnet from all the other upstream
+ * branches to see if this route wins, or even if it doesn't win, if it
+ * causes a change of winning route.  Similarly for route deletions
+ * coming from a peer, etc.  Rather than looking the subnet up in every
+ * branch, DecisionTable indexes each route it is sent by subnet, so
+ * the alternatives are found with a single lookup.
  */
 
 template<class A>
@@ -168,14 +225,31 @@ private:
         find_alternative_routes(const BGPRouteTable<A> *caller,
 				const IPNet<A>& net,
 				list <RouteData<A> >& alternatives) const;
-    uint32_t local_pref(const FPAListRef& pa_list) const;
-    uint32_t med(const FPAListRef& pa_list) const;
+    PeerTableInfo<A>* peer_info(BGPRouteTable<A> *caller) const;
+
+    /**
+     * Add a route to the candidate index, replacing any route to the
+     * same subnet from the same parent.
+     */
+    void add_candidate(InternalMessage<A> &rtmsg, BGPRouteTable<A> *caller);
+
+    /**
+     * Remove a route from the candidate index.
+     */
+    void delete_candidate(InternalMessage<A> &rtmsg,
+			  BGPRouteTable<A> *caller);
+
     bool resolvable(const A) const;
     uint32_t igp_distance(const A) const;
     RouteData<A>* find_winner(list<RouteData<A> >& alternatives) const;
     map<BGPRouteTable<A>*, PeerTableInfo<A>* > _parents;
     map<uint32_t, PeerTableInfo<A>* > _sorted_parents;
 
+    // The routes each parent has sent us, by subnet.  The routes for
+    // a subnet are kept in the same order as _parents.
+    typedef vector<CandidateRoute<A> > Candidates;
+    Trie<A, Candidates> _candidates;
+
     NextHopResolver<A>& _next_hop_resolver;
 };
 
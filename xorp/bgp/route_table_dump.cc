@@ -190,9 +190,9 @@ DumpTable<A>::route_dump(InternalMessage<A> &rtmsg,
     /* turn the route_dump into a route_add */
     _dump_iter.route_dump(rtmsg);
     _dumped++;
-    int result = this->_next_table->add_route(rtmsg, (BGPRouteTable<A>*)this);
-    this->_next_table->push((BGPRouteTable<A>*)this);
-    return result;
+    /* no push: the RibOut sends the routes it pulled from the dump
+       together, so they can share Update messages */
+    return this->_next_table->add_route(rtmsg, (BGPRouteTable<A>*)this);
 }
 
 /*
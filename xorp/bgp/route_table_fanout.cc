@@ -211,6 +211,94 @@ FanoutTable<A>::replace_next_table(BGPRouteTable<A> *old_next_table,
     return 0;
 }
 
+template<class A>
+int
+FanoutTable<A>::add_update_group(BGPRouteTable<A> *new_next_table,
+				 const PeerHandler *group,
+				 BGPRouteTable<A> *in_step_with)
+{
+    typename NextTableMap<A>::iterator member;
+    member = _next_tables.find(in_step_with);
+    XLOG_ASSERT(member != _next_tables.end());
+
+    if (_next_tables.find(new_next_table) != _next_tables.end()) {
+	// the next_table is already in the set
+	return -1;
+    }
+    _next_tables.insert(new_next_table, group, GENID_UNKNOWN);
+
+    typename NextTableMap<A>::iterator iter;
+    iter = _next_tables.find(new_next_table);
+    PeerTableInfo<A> *peer_info = &(iter.second());
+    peer_info->set_update_group();
+    new_next_table->peering_came_up(group, GENID_UNKNOWN, this);
+
+    member = _next_tables.find(in_step_with);
+    if (member.second().has_queued_data()) {
+	peer_info->set_queue_position(member.second().queue_position());
+	peer_info->set_has_queued_data(true);
+	peer_info->wakeup_sent();
+	new_next_table->wakeup();
+    }
+    return 0;
+}
+
+template<class A>
+bool
+FanoutTable<A>::in_step(BGPRouteTable<A> *a, BGPRouteTable<A> *b)
+{
+    typename NextTableMap<A>::iterator i = _next_tables.find(a);
+    typename NextTableMap<A>::iterator j = _next_tables.find(b);
+    if (i == _next_tables.end() || j == _next_tables.end())
+	return false;
+
+    PeerTableInfo<A>& ai = i.second();
+    PeerTableInfo<A>& bi = j.second();
+    if (ai.has_queued_data() != bi.has_queued_data())
+	return false;
+    if (ai.has_queued_data() == false)
+	return true;
+    return ai.queue_position() == bi.queue_position();
+}
+
+template<class A>
+void
+FanoutTable<A>::park_next_table(BGPRouteTable<A> *next_table)
+{
+    typename NextTableMap<A>::iterator iter;
+    iter = _next_tables.find(next_table);
+    XLOG_ASSERT(iter != _next_tables.end());
+
+    // The group's branch takes over this position in the queue.
+    PeerTableInfo<A> *peer_info = &(iter.second());
+    peer_info->set_has_queued_data(false);
+    peer_info->peer_reset();
+    peer_info->set_parked(true);
+}
+
+template<class A>
+void
+FanoutTable<A>::unpark_next_table(BGPRouteTable<A> *next_table,
+				  BGPRouteTable<A> *in_step_with)
+{
+    typename NextTableMap<A>::iterator iter;
+    iter = _next_tables.find(next_table);
+    XLOG_ASSERT(iter != _next_tables.end());
+    PeerTableInfo<A> *peer_info = &(iter.second());
+    XLOG_ASSERT(peer_info->is_parked());
+    peer_info->set_parked(false);
+
+    typename NextTableMap<A>::iterator group;
+    group = _next_tables.find(in_step_with);
+    XLOG_ASSERT(group != _next_tables.end());
+    if (group.second().has_queued_data()) {
+	peer_info->set_queue_position(group.second().queue_position());
+	peer_info->set_has_queued_data(true);
+	peer_info->wakeup_sent();
+	next_table->wakeup();
+    }
+}
+
 template<class A>
 int
 FanoutTable<A>::add_route(InternalMessage<A> &rtmsg,
@@ -240,7 +328,9 @@ FanoutTable<A>::add_route(InternalMessage<A> &rtmsg,
     list <PeerTableInfo<A>*> queued_peers;
     while (i != _next_tables.end()) {
 	const PeerHandler *next_peer = i.second().peer_handler();
-	if (origin_peer == next_peer) {
+	if (i.second().is_parked()) {
+	    // the peer is sent the route by its update group
+	} else if (origin_peer == next_peer) {
 	    // don't send the route back to the peer it came from
 	    debug_msg("FanoutTable<IPv%u%s>::add_route %p.\n  Don't send back to %s\n",
 		      XORP_UINT_CAST(A::ip_version()),
@@ -309,7 +399,9 @@ FanoutTable<A>::replace_route(InternalMessage<A> &old_rtmsg,
     typename NextTableMap<A>::iterator i;
     for (i = _next_tables.begin();  i != _next_tables.end();  i++) {
 	const PeerHandler *next_peer = i.second().peer_handler();
-	if (origin_peer == next_peer) {
+	if (i.second().is_parked()) {
+	    // the peer is sent the route by its update group
+	} else if (origin_peer == next_peer) {
 	    // don't send the route back to the peer it came from
 	} else {
 	    debug_msg("FanoutTable<IPv%u:%s>::replace_route %p -> %p to %s\n",
@@ -361,7 +453,9 @@ FanoutTable<A>::delete_route(InternalMessage<A> &rtmsg,
     typename NextTableMap<A>::iterator i;
     for (i = _next_tables.begin();  i != _next_tables.end();  i++) {
 	const PeerHandler *next_peer = i.second().peer_handler();
-	if (origin_peer == next_peer) {
+	if (i.second().is_parked()) {
+	    // the peer is sent the route by its update group
+	} else if (origin_peer == next_peer) {
 	    debug_msg("FanoutTable<IPv%u:%s>::delete_route %p.\n  Don't send back to %s\n",
 		      XORP_UINT_CAST(A::ip_version()),
 		      pretty_string_safi(this->safi()),
@@ -425,7 +519,8 @@ FanoutTable<A>::push(BGPRouteTable<A> *caller)
 	// a push needs to go to all peers because an add may cause a
 	// delete (or vice versa) of a route that originated from a
 	// different peer.
-	queued_peers.push_back(&(i.second()));
+	if (!i.second().is_parked())
+	    queued_peers.push_back(&(i.second()));
     }
 
     if (queued_peers.empty() == false) {
@@ -492,8 +587,11 @@ void
 FanoutTable<A>::peer_table_info(list<const PeerTableInfo<A>*>& peer_list) {
     typename NextTableMap<A>::iterator i;
     
+    // An update group's branch has no routes of its own; its
+    // members are still listed through their parked branches.
     for (i = _next_tables.begin(); i != _next_tables.end(); i++) {
-	if (i.second().peer_handler() != NULL)
+	if (i.second().peer_handler() != NULL
+	    && !i.second().is_update_group())
 	    peer_list.push_back(&(i.second()));
     }
 
@@ -511,7 +609,8 @@ FanoutTable<A>::dump_entire_table(BGPRouteTable<A> *child_to_dump_to,
     PeerTableInfo<A> *peer_info = NULL;
     list <const PeerTableInfo<A>*> peer_list;
     for (i = _next_tables.begin(); i != _next_tables.end(); i++) {
-	if (i.second().peer_handler() != NULL)
+	if (i.second().peer_handler() != NULL
+	    && !i.second().is_update_group())
 	    peer_list.push_back(&(i.second()));
 	if (i.first() == child_to_dump_to)
 	    peer_info = &(i.second());
@@ -88,6 +88,40 @@ public:
     int remove_next_table(BGPRouteTable<A> *next_table);
     int replace_next_table(BGPRouteTable<A> *old_next_table,
 			   BGPRouteTable<A> *new_next_table);
+
+    /**
+     * Add the output branch of an update group.
+     *
+     * The group starts at the same point in the queue as one of its
+     * members, so that nothing is sent twice or lost when the member
+     * is parked.
+     *
+     * @param next_table the first table of the group's branch.
+     * @param group the update group.
+     * @param in_step_with the branch of a member.
+     */
+    int add_update_group(BGPRouteTable<A> *next_table,
+			 const PeerHandler *group,
+			 BGPRouteTable<A> *in_step_with);
+
+    /**
+     * @return true if both next tables will next be sent the same
+     * queue entry.
+     */
+    bool in_step(BGPRouteTable<A> *a, BGPRouteTable<A> *b);
+
+    /**
+     * Stop queueing anything for the branch of a peer that has joined
+     * an update group.  The branch must be in step with the group.
+     */
+    void park_next_table(BGPRouteTable<A> *next_table);
+
+    /**
+     * Resume queueing for the branch of a peer that has left an
+     * update group, starting where the group has got to.
+     */
+    void unpark_next_table(BGPRouteTable<A> *next_table,
+			   BGPRouteTable<A> *in_step_with);
     int add_route(InternalMessage<A> &rtmsg,
 		  BGPRouteTable<A> *caller);
     int replace_route(InternalMessage<A> &old_rtmsg,
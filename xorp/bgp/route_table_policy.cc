@@ -42,7 +42,8 @@ PolicyTable<A>::PolicyTable(const string& tablename, const Safi& safi,
       _filter_type(type),
       _varrw(NULL),
       _policy_filters(pfs),
-      _enable_filtering(true)
+      _enable_filtering(true),
+      _version_filters(dynamic_cast<const VersionFilters*>(&pfs))
 {
     this->_parent = parent;
     // XXX: For clarity, explicitly call the local virtual init_varrw()
@@ -72,26 +73,171 @@ PolicyTable<A>::do_filtering(InternalMessage<A>& rtmsg,
 	return true;
     }
 
+    Generation* gen = verdict_filter(rtmsg);
+    if (gen == NULL)
+	return run_filter(rtmsg, no_modify);
+
+    VerdictCache& verdicts = gen->_verdicts;
+
+    FPAListRef& fpa_list = rtmsg.attributes();
+    fpa_list->canonicalize();
+
+    typename VerdictCache::const_iterator i
+	= verdicts.find(VerdictKey(fpa_list->canonical_data(),
+				   fpa_list->canonical_length()));
+    if (i != verdicts.end()) {
+	replay_verdict(rtmsg, no_modify, gen->_pf, i->second);
+	return i->second._accepted;
+    }
+
+    // The filter modifies the attributes in place, so keep a copy.
+    PAListRef<A> in = new PathAttributeList<A>(fpa_list);
+
+    bool accepted = run_filter(rtmsg, no_modify);
+
+    // Only keep the verdict if the filter had its full effect.
+    if (no_modify || rtmsg.route()->policyfilter(filter_index()).get()
+		     != gen->_pf.get())
+	return accepted;
+
+    if (verdicts.size() >= MAX_VERDICTS)
+	verdicts.clear();
+
+    Verdict v;
+    v._in = in;
+    v._accepted = accepted;
+    if (_varrw->modified())
+	v._out = new PathAttributeList<A>(rtmsg.attributes());
+
+    verdicts.insert(make_pair(VerdictKey(in->canonical_data(),
+					 in->canonical_length()), v));
+
+    return accepted;
+}
+
+template <class A>
+typename PolicyTable<A>::Generation*
+PolicyTable<A>::verdict_filter(InternalMessage<A>& rtmsg) const
+{
+    if (_version_filters == NULL)
+	return NULL;
+
+    const RefPf& latest = _version_filters->latest(_filter_type);
+
+    if (latest.get() != _latest._pf.get()) {
+	// The old verdicts serve the routes not yet pushed again.
+	_previous._verdicts.clear();
+	_previous._verdicts.swap(_latest._verdicts);
+	_previous._pf = _latest._pf;
+	_previous._enabled = _latest._enabled;
+
+	_latest._pf = latest;
+	_latest._enabled = !latest.is_empty() && attributes_only(*latest);
+    }
+
+    const RefPf& bound = rtmsg.route()->policyfilter(filter_index());
+    Generation* gen = &_latest;
+
+    // Routes bound to an older filter run it as before.
+    if (!bound.is_empty() && bound.get() != latest.get()) {
+	if (bound.get() != _previous._pf.get())
+	    return NULL;
+	gen = &_previous;
+    }
+
+    if (!gen->_enabled)
+	return NULL;
+
+    return gen;
+}
+
+template <class A>
+bool
+PolicyTable<A>::attributes_only(const PolicyFilter& pf) const
+{
+    // Variables that come from the route rather than its path attributes.
+    static const VarRW::Id route_vars[] = {
+	VarRW::VAR_TRACE,
+	VarRW::VAR_POLICYTAGS,
+	VarRW::VAR_FILTER_IM,
+	VarRW::VAR_FILTER_SM,
+	VarRW::VAR_FILTER_EX,
+	VarRW::VAR_TAG,
+	BGPVarRW<A>::VAR_NETWORK4,
+	BGPVarRW<A>::VAR_NETWORK6,
+	BGPVarRW<A>::VAR_AGGREGATE_PREFIX_LEN,
+	BGPVarRW<A>::VAR_AGGREGATE_BRIEF_MODE,
+	BGPVarRW<A>::VAR_WAS_AGGREGATED,
+    };
+
+    for (size_t i = 0; i < sizeof(route_vars) / sizeof(route_vars[0]); i++) {
+	if (pf.reads(route_vars[i]) || pf.writes(route_vars[i]))
+	    return false;
+    }
+
+    // The neighbor is fixed, except for routes from all peers on their way
+    // to the source match filter.
+    if (_filter_type == filter::EXPORT_SOURCEMATCH
+	&& pf.reads(BGPVarRW<A>::VAR_NEIGHBOR))
+	return false;
+
+    return true;
+}
+
+template <class A>
+void
+PolicyTable<A>::replay_verdict(InternalMessage<A>& rtmsg, bool no_modify,
+			       const RefPf& pf, const Verdict& verdict) const
+{
+    if (no_modify)
+	return;
+
+    // Bind the route to the filter, as running it would have.
+    const SubnetRoute<A>* route = rtmsg.route();
+    uint32_t pfi = filter_index();
+
+    if (route->policyfilter(pfi).is_empty())
+	route->set_policyfilter(pfi, pf);
+
+    if (verdict._out.is_empty())
+	return;
+
+    PAListRef<A> out = verdict._out;
+    rtmsg.attributes() = new FastPathAttributeList<A>(out);
+    rtmsg.set_changed();
+}
+
+template <class A>
+uint32_t
+PolicyTable<A>::filter_index() const
+{
+    switch (_filter_type) {
+    case filter::IMPORT:
+	return 0;
+
+    case filter::EXPORT_SOURCEMATCH:
+	return 1;
+
+    case filter::EXPORT:
+	return 2;
+    }
+
+    XLOG_UNREACHABLE();
+    return 0;
+}
+
+template <class A>
+bool
+PolicyTable<A>::run_filter(InternalMessage<A>& rtmsg, bool no_modify) const
+{
     _varrw->attach_route(rtmsg, no_modify);
 
     try {
 	bool accepted = true;
 
 	void* pf = NULL;
-	int pfi = 0;
-	switch (_filter_type) {
-	    case filter::IMPORT:
-		pfi = 0;
-		break;
-
-	    case filter::EXPORT_SOURCEMATCH:
-		pfi = 1;
-		break;
-	
-	    case filter::EXPORT:
-		pfi = 2;
-		break;
-	}
+	int pfi = filter_index();
+
 	pf = rtmsg.route()->policyfilter(pfi).get();
 	debug_msg("[BGP] running filter %s on route: %s (filter=%p)\n",
 		  filter::filter2str(_filter_type),
@@ -367,7 +513,9 @@ PolicyTable<A>::lookup_route(const IPNet<A> &net,
 #endif 
 
     bool accepted = do_filtering(rtmsg, false);
-    
+
+    // the filter may have replaced the attributes rather than modify them
+    pa_list = rtmsg.attributes();
     
     if (!accepted) {
 	return NULL;
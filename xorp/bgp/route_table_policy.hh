@@ -25,7 +25,7 @@
 
 #include "route_table_base.hh"
 #include "bgp_varrw.hh"
-#include "policy/backend/policy_filters.hh"
+#include "policy/backend/version_filters.hh"
 
 /**
  * @short Generic Policy filter table suitable for export filters.
@@ -98,8 +98,87 @@ protected:
     BGPVarRW<A>*		_varrw;
 
 private:
+    /**
+     * @short Result of filtering one path attribute list.
+     */
+    struct Verdict {
+	PAListRef<A>	_in;		// the attributes that were filtered
+	PAListRef<A>	_out;		// the attributes after filtering,
+					// empty if the filter changed nothing
+	bool		_accepted;
+    };
+
+    /**
+     * @short Canonical data of a path attribute list, used for lookups.
+     */
+    struct VerdictKey {
+	VerdictKey(const uint8_t* data, size_t length)
+	    : _data(data), _length(length),
+	      _hash(PathAttributeList<A>::hash(data, length)) {}
+
+	bool operator<(const VerdictKey& him) const {
+	    if (_hash != him._hash)
+		return _hash < him._hash;
+	    if (_length != him._length)
+		return _length < him._length;
+	    return memcmp(_data, him._data, _length) < 0;
+	}
+
+	const uint8_t*	_data;
+	size_t		_length;
+	uint32_t	_hash;
+    };
+
+    typedef map<VerdictKey, Verdict> VerdictCache;
+
+    /**
+     * @short Verdicts of one version of the filter.
+     */
+    struct Generation {
+	Generation() : _enabled(false) {}
+
+	RefPf		_pf;
+	bool		_enabled;	// the filter only reads attributes
+	VerdictCache	_verdicts;
+    };
+
+    // Flush the cache rather than let it grow without bound.
+    static const size_t MAX_VERDICTS = 65536;
+
+    bool run_filter(InternalMessage<A>& rtmsg, bool no_modify) const;
+
+    /**
+     * @return the index of the policy filter pointer of routes in this table.
+     */
+    uint32_t filter_index() const;
+
+    /**
+     * Decide whether a route may be answered from the verdict cache.
+     *
+     * @return the verdicts of the filter the route will be run through, or
+     * NULL if the cache does not apply to the route.
+     */
+    Generation* verdict_filter(InternalMessage<A>& rtmsg) const;
+
+    /**
+     * @return true if the filter only looks at the path attributes, so that
+     * routes with equal attributes always get the same verdict.
+     */
+    bool attributes_only(const PolicyFilter& pf) const;
+
+    void replay_verdict(InternalMessage<A>& rtmsg, bool no_modify,
+			const RefPf& pf, const Verdict& verdict) const;
+
     PolicyFilters&		_policy_filters;
     bool _enable_filtering;
+
+    // Verdicts of the latest version of the filter, if it only reads path
+    // attributes.  When the filter is reconfigured they are kept as the
+    // previous generation, so that the routes still bound to the old filter
+    // are answered from them while a policy push re-filters the table.
+    const VersionFilters*	_version_filters;
+    mutable Generation		_latest;
+    mutable Generation		_previous;
 };
 
 #endif // __BGP_ROUTE_TABLE_POLICY_HH__
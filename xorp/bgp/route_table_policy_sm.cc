@@ -36,7 +36,8 @@ PolicyTableSourceMatch<A>::PolicyTableSourceMatch(const string& tablename,
 						  PolicyFilters& pfs,
 						  EventLoop& ev)
     : PolicyTable<A>(tablename, safi, parent, pfs, filter::EXPORT_SOURCEMATCH),
-      _pushing_routes(false), _dump_iter(NULL), _ev(ev)
+      _pushing_routes(false), _dump_iter(NULL), _ev(ev),
+      _dump_slice(20000, 16)		// 20ms, test every 16th route
 
 {
     this->_parent = parent;		
@@ -113,15 +114,19 @@ PolicyTableSourceMatch<A>::do_background_dump()
 {
     debug_msg("[BGP] doing a background dump step\n");
 
-    // we are done...
-    if (!_pushing_routes)
-	return false;
+    _dump_slice.reset();
 
-    // do a dump
-    do_next_route_dump();
+    do {
+	// we are done...
+	if (!_pushing_routes)
+	    return false;
+
+	// do a dump
+	do_next_route_dump();
+    } while (!_dump_slice.is_expired());
 
     // continue in background...
-    return true;
+    return _pushing_routes;
 }
 
 template<class A>
@@ -26,6 +26,7 @@
 #include "route_table_policy.hh"
 #include "peer_route_pair.hh"
 #include "libxorp/eventloop.hh"
+#include "libxorp/time_slice.hh"
 
 /**
  * @short SourceMatch table has the aditional ability to perform route dumps.
@@ -58,6 +59,13 @@ public:
      */
     void push_routes(list<const PeerTableInfo<A>*>& peer_list);
 
+    /**
+     * Check whether a policy push is occuring 
+     *
+     * @return true if routes are being pushed
+     */
+    bool pushing_routes();
+
     /*
      * Need to keep track what is going on with dump iterators which peers go
      * down and up
@@ -85,16 +93,15 @@ private:
     void end_route_dump();
 
     /**
-     * Do a background route dump
-     */
-    bool do_background_dump();
-
-    /**
-     * Check whether a policy push is occuring 
+     * Do a background route dump.
      *
-     * @return true if routes are being pushed
+     * Routes are dumped until the time slice expires, so a whole table is
+     * re-filtered in a few slices rather than one route per pass of the
+     * event loop.  Timers and I/O are still serviced between slices.
+     *
+     * @return true if there are more routes to dump.
      */
-    bool pushing_routes();
+    bool do_background_dump();
 
 private:
     EventLoop&		eventloop();
@@ -103,6 +110,7 @@ private:
     DumpIterator<A>*	_dump_iter;
     EventLoop&		_ev;
     XorpTask		_dump_task;
+    TimeSlice		_dump_slice;
 };
 
 #endif // __BGP_ROUTE_TABLE_POLICY_SM_HH__
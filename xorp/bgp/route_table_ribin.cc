@@ -170,12 +170,9 @@ RibInTable<A>::add_route(const IPNet<A>& net,
 	PAListRef<A> pa_list = new PathAttributeList<A>(fpa_list);
 	pa_list.register_with_attmgr();
 
-	// Store it locally.  The BgpTrie will copy it into a ChainedSubnetRoute
-	SubnetRoute<A>* tmp_route = new SubnetRoute<A>(net, pa_list, NULL);
-	tmp_route->set_policytags(policy_tags);
+	// Store it locally in a ChainedSubnetRoute.
 	typename BgpTrie<A>::iterator iter =
-	    _route_table->insert(net, *tmp_route);
-	tmp_route->unref();
+	    _route_table->insert(net, pa_list, policy_tags);
 	new_route = &(iter.payload());
 
 	// propagate downstream
@@ -188,11 +185,8 @@ RibInTable<A>::add_route(const IPNet<A>& net,
 	PAListRef<A> pa_list = new PathAttributeList<A>(fpa_list);
 	pa_list.register_with_attmgr();
 
-	SubnetRoute<A>* tmp_route = new SubnetRoute<A>(net, pa_list, NULL);
-	tmp_route->set_policytags(policy_tags);
 	typename BgpTrie<A>::iterator iter =
-	    _route_table->insert(net, *tmp_route);
-	tmp_route->unref();
+	    _route_table->insert(net, pa_list, policy_tags);
 	new_route = &(iter.payload());
 
 	// progogate downstream
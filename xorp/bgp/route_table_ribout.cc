@@ -273,120 +273,155 @@ RibOutTable<A>::push(BGPRouteTable<A> *caller)
 
     // In push, we need to collect together all the SubnetRoutes that
     // have the same Path Attributes, and send them together in an
-    // Update message.  We repeatedly do this until the queue is empty.
+    // Update message.  The queue is split into groups in one pass,
+    // indexed by a hash of the attributes, and the groups are sent in
+    // the order their first route was queued.  We repeat this until the
+    // queue is empty, in case sending queues more routes.
 
     while (_queue.empty() == false) {
+	typedef list<const RouteQueueEntry<A>*> Queue;
+	vector<Queue> groups;
+	vector<FPAListRef> group_attributes;
+	multimap<uint32_t, size_t> by_hash;
+
+	while (_queue.empty() == false) {
+	    const RouteQueueEntry<A>* entry = _queue.front();
+	    const RouteQueueEntry<A>* new_entry = NULL;
+	    _queue.pop_front();
+
+	    // we have to handle replace differently from the rest because
+	    // replace uses two paired queue entries, and we must move them
+	    // together.  We only care about the attributes on the new one
+	    // of the pair.
+	    FPAListRef attributes = entry->attributes();
+	    if (entry->op() == RTQUEUE_OP_REPLACE_OLD) {
+		XLOG_ASSERT(_queue.empty() == false);
+		new_entry = _queue.front();
+		_queue.pop_front();
+		XLOG_ASSERT(new_entry->op() == RTQUEUE_OP_REPLACE_NEW);
+		attributes = new_entry->attributes();
+	    }
 
-	// go through _queue and move all of the queue elements that
-	// have the same attribute list as the first element to
-	// tmp_queue
-
-	list <const RouteQueueEntry<A>*> tmp_queue;
-	FPAListRef attributes = NULL;
-	int ctr = 1;
-	typedef typename list<const RouteQueueEntry<A>*>::iterator Iter;
-	Iter i = _queue.begin();
-	while (i != _queue.end()) {
-	    if ((*i)->op() == RTQUEUE_OP_REPLACE_OLD) {
-		// we have to handle replace differently from the rest
-		// because replace uses two paired queue entries, and
-		// we must move them together.  We only care about the
-		// attributes on the new one of the pair.
-		Iter i2 = i;
-		i2++;
-		XLOG_ASSERT((*i2)->op() == RTQUEUE_OP_REPLACE_NEW);
-		if (attributes == NULL)
-		    attributes = (*i2)->attributes();
-		if ((*i2)->attributes() == attributes) {
-		    tmp_queue.push_back(*i);
-		    tmp_queue.push_back(*i2);
-		    _queue.erase(i);
-		    i = _queue.erase(i2);
-		    ctr++;
-		} else {
-		    ++i;
-		    XLOG_ASSERT(i != _queue.end());
-		    ++i;
-		}
-	    } else {
-		if (attributes == NULL)
-		    attributes = (*i)->attributes();
-		if (*((*i)->attributes()) == *attributes) {
-		    tmp_queue.push_back((*i));
-		    i = _queue.erase(i);
-		    ctr++;
-		} else {
-		    ++i;
+	    attributes->canonicalize();
+	    uint32_t hash = PathAttributeList<A>::hash(
+		attributes->canonical_data(), attributes->canonical_length());
+
+	    size_t g = groups.size();
+	    typedef typename multimap<uint32_t, size_t>::const_iterator Iter;
+	    pair<Iter, Iter> range = by_hash.equal_range(hash);
+	    for (Iter i = range.first; i != range.second; ++i) {
+		if (group_attributes[i->second] == attributes
+		    || *(group_attributes[i->second]) == *attributes) {
+		    g = i->second;
+		    break;
 		}
 	    }
-	}
-	print_queue(tmp_queue);
-
-	// at this point we pass the tmp_queue to the output BGP
-	// session object for output
-	debug_msg("************************************\n");
-	debug_msg("* Outputting route to BGP peer\n");
-	debug_msg("* Attributes: %s\n", attributes->str().c_str());
-	i = tmp_queue.begin();
-	_peer->start_packet();
-	while (i != tmp_queue.end()) {
-	    debug_msg("* Subnet: %s\n", (*i)->net().str().c_str());
-	    if ((*i)->op() == RTQUEUE_OP_ADD ) {
-		debug_msg("* Announce %s\n", (*i)->route()->net().str().c_str());
-		// the sanity checking was done in add_route...
-		FPAListRef pa_list = (*i)->attributes();
-		pa_list->unlock();
-		_peer->add_route(*((*i)->route()), 
-				 pa_list,
-				 (*i)->origin_peer()->ibgp(), this->safi());
-		delete (*i);
-	    } else if ((*i)->op() == RTQUEUE_OP_DELETE ) {
-		// the sanity checking was done in delete_route...
-		debug_msg("* Withdraw\n");
-		FPAListRef pa_list = (*i)->attributes();
-		pa_list->unlock();
-		_peer->delete_route(*((*i)->route()), 
-				    pa_list,
-				    (*i)->origin_peer()->ibgp(), this->safi());
-		delete (*i);
-	    } else if ((*i)->op() == RTQUEUE_OP_REPLACE_OLD ) {
-		debug_msg("* Replace\n");
-		const SubnetRoute<A> *old_route = (*i)->route();
-		bool old_ibgp = (*i)->origin_peer()->ibgp();
-		const RouteQueueEntry<A> *old_queue_entry = (*i);
-		i++;
-		XLOG_ASSERT(i != tmp_queue.end());
-		XLOG_ASSERT((*i)->op() == RTQUEUE_OP_REPLACE_NEW);
-		const SubnetRoute<A> *new_route = (*i)->route();
-		bool new_ibgp = (*i)->origin_peer()->ibgp();
-		FPAListRef pa_list = (*i)->attributes();
-		pa_list->unlock();
-		old_queue_entry->attributes()->unlock();
-		_peer->replace_route(*old_route, old_ibgp,
-				     *new_route, new_ibgp,
-				     pa_list,
-				     this->safi());
-		delete old_queue_entry;
-		delete (*i);
-	    } else {
-		XLOG_UNREACHABLE();
+	    if (g == groups.size()) {
+		groups.push_back(Queue());
+		group_attributes.push_back(attributes);
+		by_hash.insert(make_pair(hash, g));
 	    }
-	    ++i;
+
+	    groups[g].push_back(entry);
+	    if (new_entry != NULL)
+		groups[g].push_back(new_entry);
 	}
 
-	/* push the packet */
-	/* if the peer is busy (a queue has built up), there's not
-           much the RibOut can do for the things already in its
-           output queue - we just keep sending those to the
-           peer_handler.  But we want to not request any more data for now. */
-	if (_peer->push_packet() == PEER_OUTPUT_BUSY)
-	    _peer_busy = true;
+	for (size_t g = 0; g < groups.size(); g++)
+	    send_group(groups[g], group_attributes[g]);
+    }
 
+    return 0;
+}
 
-	debug_msg("************************************\n");
+template<class A>
+void
+RibOutTable<A>::send_group(list<const RouteQueueEntry<A>*>& tmp_queue,
+			   FPAListRef& attributes)
+{
+    typedef typename list<const RouteQueueEntry<A>*>::iterator Iter;
+
+    print_queue(tmp_queue);
+
+    // at this point we pass the tmp_queue to the output BGP
+    // session object for output
+    debug_msg("************************************\n");
+    debug_msg("* Outputting route to BGP peer\n");
+    debug_msg("* Attributes: %s\n", attributes->str().c_str());
+    Iter i = tmp_queue.begin();
+    bool per_origin = _peer->per_origin_peer();
+    _peer->start_packet();
+    while (i != tmp_queue.end()) {
+	debug_msg("* Subnet: %s\n", (*i)->net().str().c_str());
+	if ((*i)->op() == RTQUEUE_OP_ADD ) {
+	    debug_msg("* Announce %s\n", (*i)->route()->net().str().c_str());
+	    // the sanity checking was done in add_route...
+	    FPAListRef pa_list = (*i)->attributes();
+	    pa_list->unlock();
+	    if (per_origin)
+		_peer->set_origin_peer((*i)->origin_peer());
+	    _peer->add_route(*((*i)->route()), 
+			     pa_list,
+			     (*i)->origin_peer()->ibgp(), this->safi());
+	    delete (*i);
+	} else if ((*i)->op() == RTQUEUE_OP_DELETE ) {
+	    // the sanity checking was done in delete_route...
+	    debug_msg("* Withdraw\n");
+	    FPAListRef pa_list = (*i)->attributes();
+	    pa_list->unlock();
+	    if (per_origin)
+		_peer->set_origin_peer((*i)->origin_peer());
+	    _peer->delete_route(*((*i)->route()), 
+				pa_list,
+				(*i)->origin_peer()->ibgp(), this->safi());
+	    delete (*i);
+	} else if ((*i)->op() == RTQUEUE_OP_REPLACE_OLD ) {
+	    debug_msg("* Replace\n");
+	    const SubnetRoute<A> *old_route = (*i)->route();
+	    bool old_ibgp = (*i)->origin_peer()->ibgp();
+	    const RouteQueueEntry<A> *old_queue_entry = (*i);
+	    i++;
+	    XLOG_ASSERT(i != tmp_queue.end());
+	    XLOG_ASSERT((*i)->op() == RTQUEUE_OP_REPLACE_NEW);
+	    const SubnetRoute<A> *new_route = (*i)->route();
+	    bool new_ibgp = (*i)->origin_peer()->ibgp();
+	    FPAListRef pa_list = (*i)->attributes();
+	    pa_list->unlock();
+	    FPAListRef old_pa_list = old_queue_entry->attributes();
+	    old_pa_list->unlock();
+	    const PeerHandler *old_origin = old_queue_entry->origin_peer();
+	    const PeerHandler *new_origin = (*i)->origin_peer();
+	    if (per_origin)
+		_peer->set_origin_peer(new_origin);
+	    _peer->replace_route(*old_route, old_ibgp,
+				 *new_route, new_ibgp,
+				 pa_list,
+				 this->safi());
+	    // The peer the new route was learned from was sent the old
+	    // one, and must now have it withdrawn.
+	    if (per_origin && old_origin != new_origin) {
+		_peer->set_origin_peer(new_origin, true);
+		_peer->delete_route(*old_route, old_pa_list, old_ibgp,
+				    this->safi());
+	    }
+	    delete old_queue_entry;
+	    delete (*i);
+	} else {
+	    XLOG_UNREACHABLE();
+	}
+	++i;
     }
 
-    return 0;
+    /* push the packet */
+    /* if the peer is busy (a queue has built up), there's not
+       much the RibOut can do for the things already in its
+       output queue - we just keep sending those to the
+       peer_handler.  But we want to not request any more data for now. */
+    if (_peer->push_packet() == PEER_OUTPUT_BUSY)
+	_peer_busy = true;
+
+
+    debug_msg("************************************\n");
 }
 
 template<class A>
@@ -397,8 +432,10 @@ RibOutTable<A>::wakeup()
 }
 
 /* value is a tradeoff between not too many calls to timers, and not
-   being away from eventloop for too long - probably needs tuning*/
-#define MAX_MSGS_IN_BATCH 10
+   being away from eventloop for too long - probably needs tuning.
+   Routes from a dump are not pushed individually, so a batch is also
+   the window over which dumped routes can share an Update message */
+#define MAX_MSGS_IN_BATCH 500
 
 template<class A>
 bool
@@ -412,6 +449,7 @@ RibOutTable<A>::pull_next_route()
     if (_peer_is_up == false)
 	return false;
 
+    bool more = true;
     for (int msgs = 0; msgs < MAX_MSGS_IN_BATCH; msgs++) {
 	/* only request a limited about of messages, so we don't hog
 	   the eventloop for too long */
@@ -424,15 +462,22 @@ RibOutTable<A>::pull_next_route()
 	if (upstream_queue_exists == false) {
 	    /*the queue upstream has now drained*/
 	    /*there's nothing left to do here*/
-	    return false;
+	    more = false;
+	    break;
 	}
 	if (_peer_busy == true) {
 	    /*stop requesting messages because the output queue filled
               up again*/
-	    return false;
+	    more = false;
+	    break;
 	}
     }
-    return true;
+
+    /* a route dump doesn't push, so send whatever it queued */
+    if (!_queue.empty())
+	push(this->_parent);
+
+    return more && !_peer_busy;
 }
 
 template<class A>
@@ -77,6 +77,11 @@ public:
 
     void reschedule_self();
 
+    /**
+     * @return true if nothing is waiting for a push.
+     */
+    bool queue_empty() const { return _queue.empty(); }
+
     void peering_went_down(const PeerHandler *peer, uint32_t genid,
 			   BGPRouteTable<A> *caller);
     void peering_down_complete(const PeerHandler *peer, uint32_t genid,
@@ -84,6 +89,13 @@ public:
     void peering_came_up(const PeerHandler *peer, uint32_t genid,
 			 BGPRouteTable<A> *caller);
 private:
+    /**
+     * Send a group of queued routes that share path attributes,
+     * packing as many of them as will fit into each Update message.
+     */
+    void send_group(list<const RouteQueueEntry<A> *>& tmp_queue,
+		    FPAListRef& attributes);
+
     //the queue that builds, prior to receiving a push, so we can
     //send updates to our peers atomically
     list <const RouteQueueEntry<A> *> _queue;
@@ -149,6 +149,7 @@ SocketClient::SocketClient(const Iptuple& iptuple, EventLoop& e, bool md5sig)
     debug_msg("SocketClient constructor called\n");
     _async_writer = 0;
     _async_reader = 0;
+    _read_done = 0;
     _disconnecting = false;
     _connecting = false;
 }
@@ -262,7 +263,7 @@ SocketClient::flush_transmit_queue()
 }
 
 void
-SocketClient::async_read_start(size_t cnt, size_t offset)
+SocketClient::async_read_start(size_t offset)
 {
     debug_msg("start reading %s\n", get_remote_host());
 
@@ -270,7 +271,7 @@ SocketClient::async_read_start(size_t cnt, size_t offset)
 
     _async_reader->
 	add_buffer_with_offset(_read_buf, 
-			       cnt,
+			       sizeof(_read_buf),
 			       offset,
 			       callback(this,
 					&SocketClient::async_read_message));
@@ -280,18 +281,17 @@ SocketClient::async_read_start(size_t cnt, size_t offset)
 /*
  * Handler for reading incoming data on a BGP connection.
  *
- * When a packet first comes in, we read the default amount of data,
- * which is BGPPacket::MINPACKETSIZE (i.e. the minimum size of a BGP message).
- * This callback is then invoked a first time, and it can check the
- * actual message length. If more bytes are needed, we call again
- * async_read_start with the desired length (instructing it to skip
- * whatever we already read).
- * Once the packet is complete, we invoke the packet decoder with dispatch()
+ * Reads fill _read_buf with whatever the socket has available, which
+ * during a table transfer is usually many messages.  Every complete
+ * message in the buffer is handed to the packet decoder with dispatch(),
+ * and _read_done is advanced past it.  A partial message is left where it
+ * is until more data arrives.  Once the buffer is full, the unread tail is
+ * moved to the front and reading continues behind it.
  */
 void
 SocketClient::async_read_message(AsyncFileWriter::Event ev,
 		const uint8_t *buf,	// the base of the buffer
-		const size_t buf_bytes,	// desired message size
+		const size_t buf_bytes,	// size of the buffer
 		const size_t offset)	// where we got so far (next free byte)
 {
     debug_msg("async_read_message %d %u %u %s\n", ev,
@@ -301,29 +301,53 @@ SocketClient::async_read_message(AsyncFileWriter::Event ev,
     XLOG_ASSERT(_async_reader);
 
     switch (ev) {
-    case AsyncFileReader::DATA:
+    case AsyncFileReader::DATA: {
 	XLOG_ASSERT(offset <= buf_bytes);
-	if (offset == buf_bytes) {		// message complete so far
-	    size_t fh_length = extract_16(buf + BGPPacket::LENGTH_OFFSET);
+	XLOG_ASSERT(_read_done <= offset);
+
+	AsyncFileReader* reader = _async_reader;
+
+	while (offset - _read_done >= BGPPacket::COMMON_HEADER_LEN) {
+	    const uint8_t* msg = buf + _read_done;
+	    size_t fh_length = extract_16(msg + BGPPacket::LENGTH_OFFSET);
 
 	    if (fh_length < BGPPacket::MINPACKETSIZE
-		|| fh_length > sizeof(_read_buf)) {
+		|| fh_length > BGPPacket::MAXPACKETSIZE) {
 		XLOG_ERROR("Illegal length value %u",
 			   XORP_UINT_CAST(fh_length));
 		if (!_callback->dispatch(BGPPacket::ILLEGAL_MESSAGE_LENGTH,
-					 buf, buf_bytes, this))
+					 msg, BGPPacket::COMMON_HEADER_LEN,
+					 this))
 		    return;
+		// The stream can no longer be framed.
+		if (_async_reader)
+		    _async_reader->stop();
+		return;
 	    }
-	    /*
-	     * Keep reading until we have the whole message.
-	     */
-	    if (buf_bytes == fh_length) {
-		if (_callback->dispatch(BGPPacket::GOOD_MESSAGE,
-					buf, buf_bytes, this))
-		    async_read_start();		// ready for next message
-	    } else {				// read rest of the message
-		async_read_start(fh_length, buf_bytes);
+
+	    // Wait for the rest of the message.
+	    if (offset - _read_done < fh_length)
+		break;
+
+	    _read_done += fh_length;
+	    if (!_callback->dispatch(BGPPacket::GOOD_MESSAGE,
+				     msg, fh_length, this)) {
+		if (_async_reader)
+		    _async_reader->stop();
+		return;
 	    }
+
+	    // The session was torn down or restarted by the message.
+	    if (_async_reader != reader)
+		return;
+	}
+
+	if (offset == buf_bytes) {		// buffer full
+	    size_t left = offset - _read_done;
+
+	    memmove(_read_buf, _read_buf + _read_done, left);
+	    _read_done = 0;
+	    async_read_start(left);
 	}
 	/*
 	** At this point if we have a valid _async_reader then it should
@@ -337,6 +361,7 @@ SocketClient::async_read_message(AsyncFileWriter::Event ev,
 	XLOG_ASSERT(!_async_reader ||
 		    (_async_reader &&
 		     _async_reader->buffers_remaining() > 0));
+    }
 	break;
 
     case AsyncFileReader::WOULDBLOCK:
@@ -593,6 +618,7 @@ SocketClient::async_add(XorpFd sock)
     _async_reader = new AsyncFileReader(eventloop(), sock,
 					XorpTask::PRIORITY_BACKGROUND);
 
+    _read_done = 0;
     async_read_start();
 }
 
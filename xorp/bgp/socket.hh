@@ -266,8 +266,7 @@ private:
 			      const size_t offset,
 			      SendCompleteCallback cb);
 
-    void async_read_start(size_t cnt = BGPPacket::COMMON_HEADER_LEN,
-			  size_t ofset = 0);
+    void async_read_start(size_t offset = 0);
     void async_read_message(AsyncFileWriter::Event ev,
 			   const uint8_t *buf,
 			   const size_t buf_bytes,
@@ -281,7 +280,12 @@ private:
     bool _connecting;
     bool _md5sig;
 
-    uint8_t _read_buf[BGPPacket::MAXPACKETSIZE]; // Maximum allowed BGP message
+    // Messages are framed out of the read buffer, so that a single read
+    // brings in as many messages as the socket has queued.
+    static const size_t READ_BUF_SIZE = 16 * BGPPacket::MAXPACKETSIZE;
+
+    uint8_t _read_buf[READ_BUF_SIZE];
+    size_t _read_done;		// bytes of _read_buf already dispatched
 };
 
 class SocketServer : public Socket {
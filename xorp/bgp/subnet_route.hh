@@ -28,6 +28,7 @@
 #include "libxorp/xorp.h"
 #include "libxorp/ipv4net.hh"
 #include "libxorp/ipv6net.hh"
+#include "libxorp/memory_pool.hh"
 
 #include "policy/backend/policytags.hh"
 #include "policy/backend/policy_filter.hh"
@@ -55,6 +56,8 @@
 template<class A>
 class SubnetRouteRef;
 template<class A>
+class ChainedSubnetRoute;
+template<class A>
 class SubnetRouteConstRef;
 
 class RouteMetaData {
@@ -609,6 +612,14 @@ public:
 	return _metadata.aggr_prefix_len();
     }
 
+    /**
+     * SubnetRoutes are allocated from a pool of slots large enough
+     * for a ChainedSubnetRoute, since routes are deleted through
+     * SubnetRoute and the RibIn stores its routes chained.
+     */
+    void* operator new(size_t size);
+    void operator delete(void* ptr);
+
 protected:
     /**
      * @short protected SubnetRoute destructor.
@@ -649,6 +660,8 @@ private:
     const SubnetRoute<A> *_parent_route;
 
     mutable RouteMetaData _metadata;
+
+    static MemoryPool<ChainedSubnetRoute<A>, 1024>& memory_pool();
 };
 
 
@@ -0,0 +1,301 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+// vim:set sts=4 ts=8:
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+//
+// Measure how long a policy push takes to re-filter a full table.
+//
+// Routes are loaded into a RibIn with an import policy, a new import policy
+// is configured and the routes are pushed again through the source match table, as on a policy
+// change.  The time until the push completes is reported, together with the
+// longest pass of the event loop, which bounds how late a keepalive may be.
+//
+
+#include "bgp_module.h"
+
+#include "libxorp/xorp.h"
+#include "libxorp/eventloop.hh"
+#include "libxorp/xlog.h"
+#include "libxorp/timer.hh"
+#include "libxorp/test_main.hh"
+
+#include "policy/backend/version_filters.hh"
+
+#include "bgp.hh"
+#include "route_table_base.hh"
+#include "route_table_ribin.hh"
+#include "route_table_policy.hh"
+#include "route_table_policy_im.hh"
+#include "route_table_policy_sm.hh"
+#include "route_table_nhlookup.hh"
+#include "route_table_decision.hh"
+#include "path_attribute.hh"
+#include "local_data.hh"
+#include "dummy_next_hop_resolver.hh"
+
+
+namespace {
+
+/**
+ * Last table of the plumbing.  It counts the messages it receives.
+ */
+template <class A>
+class SinkTable : public BGPRouteTable<A> {
+public:
+    SinkTable(BGPRouteTable<A>* parent)
+	: BGPRouteTable<A>("SINK", SAFI_UNICAST), _msgs(0)
+    {
+	this->_parent = parent;
+    }
+
+    int add_route(InternalMessage<A>&, BGPRouteTable<A>*) {
+	_msgs++;
+	return ADD_USED;
+    }
+
+    int replace_route(InternalMessage<A>&, InternalMessage<A>&,
+		      BGPRouteTable<A>*) {
+	_msgs++;
+	return ADD_USED;
+    }
+
+    int delete_route(InternalMessage<A>&, BGPRouteTable<A>*) {
+	_msgs++;
+	return 0;
+    }
+
+    int route_dump(InternalMessage<A>&, BGPRouteTable<A>*,
+		   const PeerHandler*) {
+	_msgs++;
+	return ADD_USED;
+    }
+
+    int push(BGPRouteTable<A>*) { return 0; }
+
+    const SubnetRoute<A>* lookup_route(const IPNet<A>& net, uint32_t& genid,
+				       FPAListRef& pa_list) const {
+	return this->_parent->lookup_route(net, genid, pa_list);
+    }
+
+    void route_used(const SubnetRoute<A>*, bool) {}
+
+    RouteTableType type() const { return DEBUG_TABLE; }
+    string str() const { return "SinkTable " + this->tablename(); }
+
+    uint32_t msgs() const { return _msgs; }
+
+private:
+    uint32_t	_msgs;
+};
+
+const uint32_t NEXTHOPS = 250;
+
+// keeps EventLoop::run() from blocking once the push is done
+bool
+wakeup_hook()
+{
+    return true;
+}
+
+double
+seconds(const TimeVal& tv)
+{
+    return tv.sec() + tv.usec() / 1000000.0;
+}
+
+}  // anonymous namespace
+
+int
+main(int argc, char** argv)
+{
+    XorpUnexpectedHandler x(xorp_unexpected_handler);
+
+    xlog_init(argv[0], NULL);
+    xlog_set_verbose(XLOG_VERBOSE_LOW);
+    xlog_disable(XLOG_LEVEL_WARNING);
+    xlog_add_default_output();
+    xlog_start();
+
+    TestMain t(argc, argv);
+
+    string routes_arg = t.get_optional_args("-n", "--routes",
+					    "number of routes to re-filter");
+    string attrs_arg = t.get_optional_args("-a", "--attributes",
+					   "number of distinct path attributes");
+    bool by_net = t.get_optional_flag("-r", "--network",
+				      "filter on the network of the route");
+    t.complete_args_parsing();
+    if (t.exit() != 0)
+	return t.exit();
+
+    uint32_t nroutes = routes_arg.empty() ? 1000000 : atoi(routes_arg.c_str());
+    uint32_t nattrs = attrs_arg.empty() ? 1000 : atoi(attrs_arg.c_str());
+
+    if (nattrs == 0)
+	nattrs = 1;
+
+    EventLoop eventloop;
+    BGPMain bgpmain(eventloop);
+    LocalData localdata(bgpmain.eventloop());
+    Iptuple iptuple;
+    BGPPeerData* pd = new BGPPeerData(localdata, iptuple, AsNum(0), IPv4(), 0);
+    BGPPeer peer(&localdata, pd, NULL, &bgpmain);
+    PeerHandler handler("bench", &peer, NULL, NULL);
+
+    VersionFilters policy_filters;
+    DummyNextHopResolver<IPv4> next_hop_resolver(bgpmain.eventloop(), bgpmain);
+
+    RibInTable<IPv4>* ribin_table
+	= new RibInTable<IPv4>("RIB-in", SAFI_UNICAST, &handler);
+
+    PolicyTableImport<IPv4>* policy_table_import
+	= new PolicyTableImport<IPv4>("POLICY", SAFI_UNICAST, ribin_table,
+				      policy_filters,
+				      IPv4("1.2.3.4"),	// peer
+				      IPv4("1.2.3.5"));	// self
+    ribin_table->set_next_table(policy_table_import);
+
+    NhLookupTable<IPv4>* nhlookup_table
+	= new NhLookupTable<IPv4>("NHLOOKUP", SAFI_UNICAST, &next_hop_resolver,
+				  policy_table_import);
+    policy_table_import->set_next_table(nhlookup_table);
+
+    DecisionTable<IPv4>* decision_table
+	= new DecisionTable<IPv4>("DECISION", SAFI_UNICAST, next_hop_resolver);
+    nhlookup_table->set_next_table(decision_table);
+    decision_table->add_parent(nhlookup_table, &handler, ribin_table->genid());
+
+    PolicyTableSourceMatch<IPv4>* policy_table_sm
+	= new PolicyTableSourceMatch<IPv4>("POLICY_SM", SAFI_UNICAST,
+					   decision_table, policy_filters,
+					   bgpmain.eventloop());
+    decision_table->set_next_table(policy_table_sm);
+
+    SinkTable<IPv4>* sink_table = new SinkTable<IPv4>(policy_table_sm);
+    policy_table_sm->set_next_table(sink_table);
+
+    // the path attributes the routes are spread over
+    vector<FPAList4Ref> attrs;
+    OriginAttribute origin_att(IGP);
+
+    for (uint32_t i = 0; i < NEXTHOPS; i++)
+	next_hop_resolver.set_nexthop_metric(IPv4(htonl(0x02000001 + i)), 27);
+
+    for (uint32_t i = 0; i < nattrs; i++) {
+	IPv4 nexthop(htonl(0x02000001 + i % NEXTHOPS));
+
+	ASPath aspath;
+	aspath.prepend_as(AsNum(65000 + i % 1000));
+	aspath.prepend_as(AsNum(1 + i / 1000));
+
+	attrs.push_back(new FastPathAttributeList<IPv4>(
+			    NextHopAttribute<IPv4>(nexthop),
+			    ASPathAttribute(aspath), origin_att));
+    }
+
+    // the import policy the routes are loaded with
+    policy_filters.configure(filter::IMPORT,
+			     "POLICY_START bench\n"
+			     "TERM_START localpref\n"
+			     "PUSH u32 100\n"
+			     "STORE 17\n"
+			     "ACCEPT\n"
+			     "TERM_END\n"
+			     "POLICY_END\n");
+
+    TimeVal start, end;
+    PolicyTags pt;
+
+    TimerList::system_gettimeofday(&start);
+    for (uint32_t i = 0; i < nroutes; i++) {
+	IPNet<IPv4> net(IPv4(htonl(0x01000000 + (i << 8))), 24);
+	FPAList4Ref fpa = new FastPathAttributeList<IPv4>(*attrs[i % nattrs]);
+
+	ribin_table->add_route(net, fpa, pt);
+    }
+    TimerList::system_gettimeofday(&end);
+
+    printf("loaded %u routes over %u path attributes in %.3f s\n",
+	   nroutes, nattrs, seconds(end - start));
+
+    // the new import policy
+    string conf = "POLICY_START bench\n"
+		  "TERM_START localpref\n";
+    if (by_net)
+	conf += "PUSH ipv4net 0.0.0.0/1\n"
+		"LOAD 10\n"
+		"<=\n"
+		"ONFALSE_EXIT\n";
+    conf += "PUSH u32 200\n"
+	    "STORE 17\n"
+	    "ACCEPT\n"
+	    "TERM_END\n"
+	    "POLICY_END\n";
+
+    policy_filters.configure(filter::IMPORT, conf);
+
+    uint32_t before = sink_table->msgs();
+    list<const PeerTableInfo<IPv4>*> peer_list;
+    peer_list.push_back(new PeerTableInfo<IPv4>(NULL, &handler,
+						ribin_table->genid()));
+
+    TimeVal longest;
+    uint32_t passes = 0;
+    XorpTimer wakeup = bgpmain.eventloop().new_periodic_ms(10,
+						callback(wakeup_hook));
+
+    TimerList::system_gettimeofday(&start);
+    policy_table_sm->push_routes(peer_list);
+    while (policy_table_sm->pushing_routes()) {
+	TimeVal pass_start, pass_end;
+
+	TimerList::system_gettimeofday(&pass_start);
+	bgpmain.eventloop().run();
+	TimerList::system_gettimeofday(&pass_end);
+
+	if (pass_end - pass_start > longest)
+	    longest = pass_end - pass_start;
+	passes++;
+    }
+    TimerList::system_gettimeofday(&end);
+    delete peer_list.front();
+
+    double elapsed = seconds(end - start);
+
+    printf("re-filtered %u routes (%s policy) in %.3f s, %.0f routes/s\n",
+	   nroutes, by_net ? "network" : "attribute", elapsed,
+	   elapsed > 0 ? nroutes / elapsed : 0.0);
+    printf("%u messages in %u event loop passes, longest pass %.3f ms\n",
+	   sink_table->msgs() - before, passes, seconds(longest) * 1000);
+
+    ribin_table->flush();
+    delete ribin_table;
+    delete policy_table_import;
+    delete nhlookup_table;
+    delete decision_table;
+    delete policy_table_sm;
+    delete sink_table;
+
+    xlog_stop();
+    xlog_exit();
+
+    return 0;
+}
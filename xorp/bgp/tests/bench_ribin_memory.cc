@@ -0,0 +1,218 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+// vim:set sts=4 ts=8:
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+//
+// Measure how much memory the RibIn tables take per route.
+//
+// The same prefixes are loaded into one RibIn per peer, spread over a
+// set of path attribute lists shared by all peers, as in a full table
+// learnt from several peers.  The growth of the resident set is reported
+// per route stored.
+//
+
+#include "bgp_module.h"
+
+#include "libxorp/xorp.h"
+#include "libxorp/eventloop.hh"
+#include "libxorp/xlog.h"
+#include "libxorp/timer.hh"
+#include "libxorp/test_main.hh"
+
+#ifdef HAVE_SYS_RESOURCE_H
+#include <sys/resource.h>
+#endif
+
+#include "bgp.hh"
+#include "bgp_trie.hh"
+#include "route_table_base.hh"
+#include "route_table_ribin.hh"
+#include "path_attribute.hh"
+#include "local_data.hh"
+
+
+namespace {
+
+/**
+ * Last table of the plumbing.  It accepts everything.
+ */
+template <class A>
+class SinkTable : public BGPRouteTable<A> {
+public:
+    SinkTable(BGPRouteTable<A>* parent)
+	: BGPRouteTable<A>("SINK", SAFI_UNICAST)
+    {
+	this->_parent = parent;
+    }
+
+    int add_route(InternalMessage<A>&, BGPRouteTable<A>*) {
+	return ADD_USED;
+    }
+
+    int replace_route(InternalMessage<A>&, InternalMessage<A>&,
+		      BGPRouteTable<A>*) {
+	return ADD_USED;
+    }
+
+    int delete_route(InternalMessage<A>&, BGPRouteTable<A>*) {
+	return 0;
+    }
+
+    int push(BGPRouteTable<A>*) { return 0; }
+
+    const SubnetRoute<A>* lookup_route(const IPNet<A>& net, uint32_t& genid,
+				       FPAListRef& pa_list) const {
+	return this->_parent->lookup_route(net, genid, pa_list);
+    }
+
+    void route_used(const SubnetRoute<A>*, bool) {}
+
+    RouteTableType type() const { return DEBUG_TABLE; }
+    string str() const { return "SinkTable " + this->tablename(); }
+};
+
+/**
+ * @return the peak resident set size in kilobytes.
+ */
+long
+max_rss_kb()
+{
+#ifdef HAVE_SYS_RESOURCE_H
+    struct rusage ru;
+
+    if (getrusage(RUSAGE_SELF, &ru) == 0)
+	return ru.ru_maxrss;
+#endif
+    return 0;
+}
+
+}  // anonymous namespace
+
+int
+main(int argc, char** argv)
+{
+    XorpUnexpectedHandler x(xorp_unexpected_handler);
+
+    xlog_init(argv[0], NULL);
+    xlog_set_verbose(XLOG_VERBOSE_LOW);
+    xlog_disable(XLOG_LEVEL_WARNING);
+    xlog_add_default_output();
+    xlog_start();
+
+    TestMain t(argc, argv);
+
+    string routes_arg = t.get_optional_args("-n", "--routes",
+					    "number of prefixes per peer");
+    string peers_arg = t.get_optional_args("-p", "--peers",
+					   "number of peers");
+    string attrs_arg = t.get_optional_args("-a", "--attributes",
+					   "number of distinct path attributes");
+    t.complete_args_parsing();
+    if (t.exit() != 0)
+	return t.exit();
+
+    uint32_t nroutes = routes_arg.empty() ? 1000000 : atoi(routes_arg.c_str());
+    uint32_t npeers = peers_arg.empty() ? 4 : atoi(peers_arg.c_str());
+    uint32_t nattrs = attrs_arg.empty() ? 10000 : atoi(attrs_arg.c_str());
+
+    if (nattrs == 0)
+	nattrs = 1;
+
+    EventLoop eventloop;
+    BGPMain bgpmain(eventloop);
+    LocalData localdata(bgpmain.eventloop());
+    Iptuple iptuple;
+    BGPPeerData* pd = new BGPPeerData(localdata, iptuple, AsNum(0), IPv4(), 0);
+    BGPPeer peer(&localdata, pd, NULL, &bgpmain);
+    PeerHandler handler("bench", &peer, NULL, NULL);
+
+    // the path attributes the routes are spread over, the same for all
+    // peers
+    vector<FPAList4Ref> attrs;
+    OriginAttribute origin_att(IGP);
+
+    for (uint32_t i = 0; i < nattrs; i++) {
+	IPv4 nexthop(htonl(0x02000001 + i % 250));
+
+	ASPath aspath;
+	aspath.prepend_as(AsNum(65000 + i % 1000));
+	aspath.prepend_as(AsNum(1 + i / 1000));
+
+	attrs.push_back(new FastPathAttributeList<IPv4>(
+			    NextHopAttribute<IPv4>(nexthop),
+			    ASPathAttribute(aspath), origin_att));
+    }
+
+    printf("ChainedSubnetRoute<IPv4> %u bytes, RefTrieNode %u bytes\n",
+	   XORP_UINT_CAST(sizeof(ChainedSubnetRoute<IPv4>)),
+	   XORP_UINT_CAST(sizeof(RefTrieNode<IPv4,
+				 const ChainedSubnetRoute<IPv4> >)));
+
+    vector<RibInTable<IPv4>*> ribins;
+    vector<SinkTable<IPv4>*> sinks;
+    PolicyTags pt;
+
+    long rss_start = max_rss_kb();
+    TimeVal start, end;
+    TimerList::system_gettimeofday(&start);
+
+    for (uint32_t p = 0; p < npeers; p++) {
+	RibInTable<IPv4>* ribin_table
+	    = new RibInTable<IPv4>(c_format("RIB-in%u", p), SAFI_UNICAST,
+				   &handler);
+	SinkTable<IPv4>* sink_table = new SinkTable<IPv4>(ribin_table);
+	ribin_table->set_next_table(sink_table);
+	ribins.push_back(ribin_table);
+	sinks.push_back(sink_table);
+
+	for (uint32_t i = 0; i < nroutes; i++) {
+	    IPNet<IPv4> net(IPv4(htonl(0x01000000 + (i << 8))), 24);
+	    FPAList4Ref fpa
+		= new FastPathAttributeList<IPv4>(*attrs[(i + p) % nattrs]);
+
+	    ribin_table->add_route(net, fpa, pt);
+	}
+    }
+
+    TimerList::system_gettimeofday(&end);
+    long rss_end = max_rss_kb();
+
+    double routes = (double)nroutes * npeers;
+    printf("loaded %u prefixes x %u peers over %u path attributes "
+	   "in %.3f s\n", nroutes, npeers, nattrs,
+	   (end - start).sec() + (end - start).usec() / 1000000.0);
+    if (rss_end > 0 && routes > 0) {
+	printf("resident set grew %ld kB, %.1f bytes per route\n",
+	       rss_end - rss_start,
+	       (rss_end - rss_start) * 1024.0 / routes);
+    }
+
+    for (uint32_t p = 0; p < npeers; p++) {
+	ribins[p]->flush();
+	delete ribins[p];
+	delete sinks[p];
+    }
+
+    xlog_stop();
+    xlog_exit();
+
+    return 0;
+}
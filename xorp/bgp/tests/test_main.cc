@@ -35,6 +35,7 @@ bool test_filter(TestInfo& info);
 bool test_policy(TestInfo& info);
 bool test_policy_export(TestInfo& info);
 bool test_policy_dump(TestInfo& info);
+bool test_policy_verdicts(TestInfo& info);
 bool test_cache(TestInfo& info);
 bool test_nhlookup(TestInfo& info);
 bool test_decision(TestInfo& info);
@@ -42,6 +43,12 @@ bool test_fanout(TestInfo& info);
 bool test_dump_create(TestInfo& info);
 bool test_dump(TestInfo& info);
 bool test_ribout(TestInfo& info);
+bool test_peer_handler_packing(TestInfo& info);
+bool test_fanout_update_group(TestInfo& info);
+bool test_update_group(TestInfo& info);
+bool test_socket_framing(TestInfo& info);
+bool test_socket_framing_split(TestInfo& info);
+bool test_socket_framing_batch(TestInfo& info);
 template <class A> bool test_subnet_route1(TestInfo& info, IPNet<A> net);
 template <class A> bool test_subnet_route2(TestInfo& info, IPNet<A> net);
 
@@ -151,6 +158,7 @@ main(int argc, char** argv)
 	    {"PolicyExport", callback(test_policy_export)},
 	    {"Policy", callback(test_policy)},
 	    {"PolicyDump", callback(test_policy_dump)},
+	    {"PolicyVerdicts", callback(test_policy_verdicts)},
 	    {"Cache", callback(test_cache)},
 	    {"NhLookup", callback(test_nhlookup)},
 	    {"Decision", callback(test_decision)},
@@ -158,6 +166,12 @@ main(int argc, char** argv)
 	    {"DumpCreate", callback(test_dump_create)},
 	    {"Dump", callback(test_dump)},
 	    {"Ribout", callback(test_ribout)},
+	    {"PeerHandlerPacking", callback(test_peer_handler_packing)},
+	    {"FanoutUpdateGroup", callback(test_fanout_update_group)},
+	    {"UpdateGroup", callback(test_update_group)},
+	    {"SocketFraming", callback(test_socket_framing)},
+	    {"SocketFramingSplit", callback(test_socket_framing_split)},
+	    {"SocketFramingBatch", callback(test_socket_framing_batch)},
 	    {"SubnetRoute1", callback(test_subnet_route1<IPv4>, route4)},
 	    {"SubnetRoute1.ipv6", callback(test_subnet_route1<IPv6>, route6)},
 	    {"SubnetRoute2", callback(test_subnet_route2<IPv4>, route4)},
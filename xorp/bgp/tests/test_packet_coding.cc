@@ -25,6 +25,7 @@
 #include "libxorp/xlog.h"
 #include "libxorp/exceptions.hh"
 #include "libxorp/test_main.hh"
+#include "libxorp/timer.hh"
 
 #include "libproto/packet.hh"
 
@@ -837,6 +838,105 @@ test_announce_packet2(TestInfo& info, BGPPeer* peer)
     return true;
 }
 
+/*
+ * A prefix repeated in an UPDATE is only decoded once.
+ */
+bool
+test_duplicate_nlri(TestInfo& info, BGPPeer* peer)
+{
+    UpdatePacket updatepacket;
+    FPAList4Ref fpa_list = updatepacket.pa_list();
+
+    fpa_list->add_path_attribute(NextHopAttribute<IPv4>(IPv4("10.0.0.1")));
+    fpa_list->add_path_attribute(ASPathAttribute(ASPath("1,2,3")));
+    fpa_list->add_path_attribute(OriginAttribute(IGP));
+
+    IPv4Net n1("1.2.3.0/24");
+    IPv4Net n2("1.2.4.0/24");
+    IPv4Net n3("1.2.3.0/25");
+    updatepacket.add_nlri(BGPUpdateAttrib(n1));
+    updatepacket.add_nlri(BGPUpdateAttrib(n2));
+    updatepacket.add_nlri(BGPUpdateAttrib(n1));
+    updatepacket.add_nlri(BGPUpdateAttrib(n3));
+    updatepacket.add_nlri(BGPUpdateAttrib(n2));
+
+    uint8_t buf[BGPPacket::MAXPACKETSIZE];
+    size_t len = BGPPacket::MAXPACKETSIZE;
+    assert(updatepacket.encode(buf, len, peer->peerdata()));
+
+    UpdatePacket receivedpacket(buf, len, peer->peerdata(), peer->main(),
+				true);
+    const BGPUpdateAttribList& nlri = receivedpacket.nlri_list();
+
+    DOUT(info) << nlri.str("Nlri");
+    assert(nlri.size() == 3);
+    assert(nlri[0].net() == n1);
+    assert(nlri[1].net() == n2);
+    assert(nlri[2].net() == n3);
+
+    return true;
+}
+
+/*
+ * Measure how fast full UPDATE packets are decoded, as during the initial
+ * table transfer from a peer.
+ */
+bool
+test_decode_throughput(TestInfo& info, BGPPeer* peer)
+{
+    const uint32_t nets = 800;
+    const uint32_t packets = 2000;
+
+    UpdatePacket updatepacket;
+    FPAList4Ref fpa_list = updatepacket.pa_list();
+
+    fpa_list->add_path_attribute(NextHopAttribute<IPv4>(IPv4("10.0.0.1")));
+
+    ASPath aspath;
+    for (uint32_t i = 0; i < 5; i++)
+	aspath.prepend_as(AsNum(64512 + i));
+    fpa_list->add_path_attribute(ASPathAttribute(aspath));
+    fpa_list->add_path_attribute(OriginAttribute(IGP));
+    fpa_list->add_path_attribute(MEDAttribute(515));
+
+    CommunityAttribute com_att;
+    com_att.add_community(57);
+    com_att.add_community(58);
+    fpa_list->add_path_attribute(com_att);
+
+    for (uint32_t i = 0; i < nets; i++)
+	updatepacket.add_nlri(BGPUpdateAttrib(IPv4Net(IPv4(htonl(0x0a000000 +
+								 (i << 8))),
+						      24)));
+
+    uint8_t buf[BGPPacket::MAXPACKETSIZE];
+    size_t len = BGPPacket::MAXPACKETSIZE;
+    assert(updatepacket.encode(buf, len, peer->peerdata()));
+
+    TimeVal start, end;
+    size_t decoded = 0;
+
+    TimerList::system_gettimeofday(&start);
+    for (uint32_t i = 0; i < packets; i++) {
+	UpdatePacket receivedpacket(buf, len, peer->peerdata(), peer->main(),
+				    true);
+	decoded += receivedpacket.nlri_list().size();
+    }
+    TimerList::system_gettimeofday(&end);
+
+    assert(decoded == nets * packets);
+
+    double elapsed = (end - start).to_ms() / 1000.0;
+    if (elapsed > 0) {
+	DOUT(info) << packets << " packets of " << len << " bytes and "
+		   << nets << " prefixes decoded in " << elapsed << " s, "
+		   << packets / elapsed << " packets/s, "
+		   << decoded / elapsed << " prefixes/s" << endl;
+    }
+
+    return true;
+}
+
 int
 main(int argc, char** argv) 
 {
@@ -904,6 +1004,8 @@ main(int argc, char** argv)
 	    {"withdraw_packet", callback(test_withdraw_packet, &peer)},
 	    {"announce_packet1", callback(test_announce_packet1, &peer)},
 	    {"announce_packet2", callback(test_announce_packet2, &peer)},
+	    {"duplicate_nlri", callback(test_duplicate_nlri, &peer)},
+	    {"decode_throughput", callback(test_decode_throughput, &peer)},
 	};
 
 	if("" == test_name) {
@@ -0,0 +1,169 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+#include "bgp_module.h"
+
+#include "libxorp/xorp.h"
+#include "libxorp/eventloop.hh"
+#include "libxorp/xlog.h"
+#include "libxorp/asnum.hh"
+#include "libxorp/test_main.hh"
+
+#include "bgp.hh"
+#include "peer_handler.hh"
+#include "path_attribute.hh"
+#include "local_data.hh"
+
+
+/**
+ * A PeerHandler that measures every UPDATE it is asked to send rather
+ * than sending it.
+ */
+class PackingPeerHandler : public PeerHandler {
+public:
+    PackingPeerHandler(BGPPeer *peer)
+	: PeerHandler("packing", peer, NULL, NULL),
+	  _peerdata(peer->peerdata()), _packets(0), _prefixes(0), _max_len(0), _too_big(0)
+    {}
+
+    int packets() const { return _packets; }
+    int prefixes() const { return _prefixes; }
+    size_t max_len() const { return _max_len; }
+    int too_big() const { return _too_big; }
+
+protected:
+    PeerOutputState send_packet(const UpdatePacket& p, int prefixes) {
+	// Work out the size the way UpdatePacket::encode() does, so an
+	// oversized packet is counted rather than being fatal.
+	uint8_t buf[BGPPacket::MAXPACKETSIZE];
+	size_t pa_len = sizeof(buf);
+	if (p.pa_list()->is_empty())
+	    pa_len = 0;
+	else if (!p.pa_list()->encode(buf, pa_len, _peerdata))
+	    pa_len = sizeof(buf);
+	size_t len = BGPPacket::MINUPDATEPACKET + p.wr_list().wire_size()
+	    + pa_len + p.nlri_list().wire_size();
+
+	_packets++;
+	_prefixes += prefixes;
+	if (len > _max_len)
+	    _max_len = len;
+	if (len > BGPPacket::MAXPACKETSIZE) {
+	    _too_big++;
+	    return PEER_OUTPUT_OK;
+	}
+
+	size_t enc_len = sizeof(buf);
+	if (!p.encode(buf, enc_len, _peerdata) || enc_len != len)
+	    _too_big++;
+	return PEER_OUTPUT_OK;
+    }
+
+private:
+    const BGPPeerData* _peerdata;
+    int _packets;
+    int _prefixes;
+    size_t _max_len;
+    int _too_big;
+};
+
+/**
+ * Pack rounds of withdrawals followed by announcements carrying large
+ * path attributes, in the order RibOutTable hands them to the
+ * PeerHandler, and check that every UPDATE fits in a BGP message.
+ */
+bool
+test_peer_handler_packing(TestInfo& info)
+{
+    EventLoop eventloop;
+    BGPMain bgpmain(eventloop);
+    LocalData localdata(bgpmain.eventloop());
+    localdata.set_as(AsNum(1));
+    Iptuple iptuple;
+    BGPPeerData *peer_data
+	= new BGPPeerData(localdata, iptuple, AsNum(2), IPv4("2.0.0.2"), 30);
+    peer_data->compute_peer_type();
+    peer_data->set_multiprotocol<IPv4>(SAFI_UNICAST, BGPPeerData::NEGOTIATED);
+    BGPPeer peer(&localdata, peer_data, NULL, &bgpmain);
+    PackingPeerHandler handler(&peer);
+
+    int sent = 0;
+    uint32_t next_net = ntohl(IPv4("10.0.0.0").addr());
+    for (int round = 0; round < 20; round++) {
+	// A long AS path and a lot of communities make the attributes
+	// more than half a packet.
+	ASPath aspath;
+	for (int i = 0; i < 200; i++)
+	    aspath.prepend_as(AsNum(1000 + round + i));
+	ASPathAttribute aspathatt(aspath);
+	NextHopAttribute<IPv4> nhatt(IPv4("2.0.0.2"));
+	OriginAttribute igp_origin_att(IGP);
+	FPAList4Ref fpalist =
+	    new FastPathAttributeList<IPv4>(nhatt, aspathatt, igp_origin_att);
+	CommunityAttribute comm_att;
+	for (uint32_t i = 0; i < 400; i++)
+	    comm_att.add_community((round << 16) | i);
+	fpalist->add_path_attribute(comm_att);
+	PAListRef<IPv4> palist = new PathAttributeList<IPv4>(fpalist);
+
+	// Vary how much of the last packet the withdrawals fill.
+	int withdrawals = 150 * round + 37;
+	int announcements = 100 + 13 * round;
+
+	handler.start_packet();
+	for (int i = 0; i < withdrawals; i++) {
+	    IPNet<IPv4> net(IPv4(htonl(next_net)), 24);
+	    next_net += 256;
+	    SubnetRoute<IPv4>* route = new SubnetRoute<IPv4>(net, palist, NULL);
+	    handler.delete_route(*route, fpalist, false, SAFI_UNICAST);
+	    route->unref();
+	}
+	for (int i = 0; i < announcements; i++) {
+	    IPNet<IPv4> net(IPv4(htonl(next_net)), 24);
+	    next_net += 256;
+	    SubnetRoute<IPv4>* route = new SubnetRoute<IPv4>(net, palist, NULL);
+	    handler.add_route(*route, fpalist, false, SAFI_UNICAST);
+	    route->unref();
+	}
+	handler.push_packet();
+	sent += withdrawals + announcements;
+
+	palist.release();
+	fpalist = 0;
+    }
+
+    DOUT(info) << handler.packets() << " packets, "
+	       << handler.prefixes() << " prefixes, largest "
+	       << handler.max_len() << " bytes\n";
+
+    if (handler.too_big() != 0) {
+	DOUT(info) << handler.too_big() << " packets larger than "
+		   << BGPPacket::MAXPACKETSIZE << " bytes\n";
+	return false;
+    }
+    if (handler.prefixes() != sent) {
+	DOUT(info) << "sent " << sent << " prefixes but "
+		   << handler.prefixes() << " were packed\n";
+	return false;
+    }
+
+    return true;
+}
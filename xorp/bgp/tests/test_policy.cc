@@ -889,3 +889,133 @@ POLICY_END\n";
 }
 
 
+
+/*
+ * Run one route through a policy table.
+ *
+ * @return -1 if the route was rejected, otherwise its local preference,
+ * 0 if it has none.
+ */
+static int
+filter_route(PolicyTable<IPv4>* policy_table, PeerHandler* handler,
+	     const char* net, PAListRef<IPv4> palist, const PolicyTags& tags)
+{
+    SubnetRoute<IPv4>* sr = new SubnetRoute<IPv4>(IPNet<IPv4>(net), palist,
+						  NULL);
+    sr->set_policytags(tags);
+    InternalMessage<IPv4>* msg = new InternalMessage<IPv4>(sr, handler, 1);
+
+    int result = -1;
+    if (policy_table->do_filtering(*msg, false)) {
+	LocalPrefAttribute* lpa = msg->attributes()->local_pref_att();
+	result = lpa ? lpa->localpref() : 0;
+    }
+
+    sr->unref();
+    delete msg;
+    return result;
+}
+
+/*
+ * Routes sharing one path attribute list are answered from the verdict
+ * cache.  Check that a new version of the filter is not answered from
+ * the verdicts of the old one, and that a filter that reads the policy
+ * tags or the tag runs for every route rather than once per attribute
+ * list.
+ */
+bool
+test_policy_verdicts(TestInfo& info)
+{
+    EventLoop eventloop;
+    BGPMain bgpmain(eventloop);
+    LocalData localdata(bgpmain.eventloop());
+    Iptuple iptuple;
+    BGPPeerData *pd1 = new BGPPeerData(localdata, iptuple, AsNum(0), IPv4(),0);
+    BGPPeer peer1(&localdata, pd1, NULL, &bgpmain);
+    PeerHandler handler1("test1", &peer1, NULL, NULL);
+
+    VersionFilters policy_filters;
+
+    RibInTable<IPv4> *ribin_table
+	= new RibInTable<IPv4>("RIB-in", SAFI_UNICAST, &handler1);
+    PolicyTableExport<IPv4> *policy_table
+	= new PolicyTableExport<IPv4>("POLICY", SAFI_UNICAST, ribin_table,
+				      policy_filters, "test_neighbour",
+				      IPv4("1.2.3.4"));
+    ribin_table->set_next_table(policy_table);
+
+    ASPath aspath1;
+    aspath1.prepend_as(AsNum(1));
+    FPAList4Ref fpalist1 =
+	new FastPathAttributeList<IPv4>(NextHopAttribute<IPv4>(IPv4("2.0.0.1")),
+					ASPathAttribute(aspath1),
+					OriginAttribute(IGP));
+    PAListRef<IPv4> palist1 = new PathAttributeList<IPv4>(fpalist1);
+
+    PolicyTags none;
+    PolicyTags tagged;
+    tagged.insert(5);
+    PolicyTags tag7;
+    tag7.set_tag(ElemU32(7));
+
+    struct {
+	const char*	conf;		// filter to configure, NULL to keep
+	const char*	net;
+	const PolicyTags* tags;
+	int		result;
+    } steps[] = {
+	// The same attributes, answered from the cache the second time.
+	{ "POLICY_START p\nTERM_START t\n"
+	  "PUSH u32 200\nSTORE 17\nACCEPT\n"
+	  "TERM_END\nPOLICY_END\n", "1.0.1.0/24", &none, 200 },
+	{ NULL, "1.0.2.0/24", &none, 200 },
+
+	// A policy change: the old verdict must not be replayed.
+	{ "POLICY_START p\nTERM_START t\n"
+	  "PUSH u32 300\nSTORE 17\nACCEPT\n"
+	  "TERM_END\nPOLICY_END\n", "1.0.3.0/24", &none, 300 },
+	{ NULL, "1.0.4.0/24", &none, 300 },
+	{ "POLICY_START p\nTERM_START t\n"
+	  "REJECT\n"
+	  "TERM_END\nPOLICY_END\n", "1.0.5.0/24", &none, -1 },
+
+	// The policy tags decide, so equal attributes get different
+	// verdicts.
+	{ "POLICY_START p\nTERM_START t\n"
+	  "LOAD 1\nPUSH u32 5\n<=\nONFALSE_EXIT\n"
+	  "PUSH u32 200\nSTORE 17\nACCEPT\n"
+	  "TERM_END\nPOLICY_END\n", "1.0.6.0/24", &none, 0 },
+	{ NULL, "1.0.7.0/24", &tagged, 200 },
+	{ NULL, "1.0.8.0/24", &none, 0 },
+	{ NULL, "1.0.9.0/24", &tagged, 200 },
+
+	// The same for the tag.
+	{ "POLICY_START p\nTERM_START t\n"
+	  "LOAD 5\nPUSH u32 7\n==\nONFALSE_EXIT\n"
+	  "PUSH u32 300\nSTORE 17\nACCEPT\n"
+	  "TERM_END\nPOLICY_END\n", "1.0.10.0/24", &tag7, 300 },
+	{ NULL, "1.0.11.0/24", &none, 0 },
+	{ NULL, "1.0.12.0/24", &tag7, 300 },
+    };
+
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+	if (steps[i].conf != NULL)
+	    policy_filters.configure(filter::EXPORT, steps[i].conf);
+
+	int result = filter_route(policy_table, &handler1, steps[i].net,
+				  palist1, *steps[i].tags);
+	if (result != steps[i].result) {
+	    DOUT(info) << steps[i].net << ": got " << result
+		       << ", expected " << steps[i].result << endl;
+	    ok = false;
+	}
+    }
+
+    delete ribin_table;
+    delete policy_table;
+    palist1.release();
+    fpalist1 = 0;
+
+    return ok;
+}
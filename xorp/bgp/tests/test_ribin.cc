@@ -236,6 +236,7 @@ test_ribin(TestInfo& /*info*/)
 
     //check we only ended up with one copy of the PA list
     assert(dummy_palist.number_of_managed_atts() == 1);
+    assert(PAListRef<IPv4>::attribute_manager()->total_references() == 1);
 
     //check there's one route in the RIB-IN
     assert(ribin->route_count() == 1);
@@ -248,6 +249,7 @@ test_ribin(TestInfo& /*info*/)
     //check there's still one copy of the PA list
     //XXX now there is no copy list - think this is better
     assert(dummy_palist.number_of_managed_atts() == 0);
+    assert(PAListRef<IPv4>::attribute_manager()->total_references() == 0);
 
     //check there are no routes in the RIB-IN
     assert(ribin->route_count() == 0);
@@ -322,6 +324,7 @@ test_ribin(TestInfo& /*info*/)
 
     //check we only ended up with two PA lists
     assert(dummy_palist.number_of_managed_atts() == 2);
+    assert(PAListRef<IPv4>::attribute_manager()->total_references() == 2);
 
     debug_table->write_separator();
 
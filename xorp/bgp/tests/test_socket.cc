@@ -0,0 +1,282 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+#include "bgp_module.h"
+
+#include "libxorp/xorp.h"
+#include "libxorp/eventloop.hh"
+#include "libxorp/xlog.h"
+#include "libxorp/random.h"
+#include "libxorp/test_main.hh"
+
+#include "libcomm/comm_api.h"
+
+#include "socket.hh"
+
+
+/**
+ * Feeds a SocketClient through one end of a socketpair and collects
+ * the messages it frames out of the other.
+ */
+class FramingHarness {
+public:
+    FramingHarness(EventLoop& eventloop)
+	: _eventloop(eventloop), _client(Iptuple(), eventloop),
+	  _writer(XORP_BAD_SOCKET), _bad(0)
+    {
+	xsock_t sv[2];
+	if (comm_sock_pair(AF_UNIX, SOCK_STREAM, 0, sv) != XORP_OK)
+	    XLOG_FATAL("comm_sock_pair failed");
+	_writer = sv[1];
+	comm_sock_set_blocking(_writer, COMM_SOCK_NONBLOCKING);
+
+	_client.set_callback(callback(this, &FramingHarness::message));
+	_client.connected(XorpFd(sv[0]));
+    }
+
+    ~FramingHarness() {
+	_client.disconnect();
+	comm_sock_close(_writer);
+    }
+
+    /**
+     * Write the whole of buf, letting the client read whenever the
+     * socket fills up.
+     *
+     * @return false if the client stopped reading.
+     */
+    bool write(const uint8_t *buf, size_t len) {
+	bool timeout = false;
+	XorpTimer t = _eventloop.set_flag_after_ms(5000, &timeout);
+	while (len > 0 && !timeout) {
+	    ssize_t done = ::write(_writer, buf, len);
+	    if (done > 0) {
+		buf += done;
+		len -= done;
+	    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+		_eventloop.run();
+	    } else {
+		return false;
+	    }
+	}
+	return len == 0;
+    }
+
+    /**
+     * Run the event loop until at least count messages have been
+     * framed.
+     *
+     * @return the number of messages framed.
+     */
+    size_t wait_for(size_t count) {
+	bool timeout = false;
+	XorpTimer t = _eventloop.set_flag_after_ms(5000, &timeout);
+	while (_lengths.size() < count && !timeout)
+	    _eventloop.run();
+	return _lengths.size();
+    }
+
+    bool message(BGPPacket::Status status, const uint8_t *buf, size_t len,
+		 SocketClient *) {
+	if (status != BGPPacket::GOOD_MESSAGE) {
+	    _bad++;
+	    return false;
+	}
+	_received.insert(_received.end(), buf, buf + len);
+	_lengths.push_back(len);
+	return true;
+    }
+
+    const vector<uint8_t>& received() const	{ return _received; }
+    const vector<size_t>& lengths() const	{ return _lengths; }
+    int bad() const				{ return _bad; }
+
+private:
+    EventLoop& _eventloop;
+    SocketClient _client;
+    xsock_t _writer;
+
+    vector<uint8_t> _received;	// The messages in the order framed.
+    vector<size_t> _lengths;	// The length of each message framed.
+    int _bad;			// Messages that were not GOOD_MESSAGE.
+};
+
+/*
+ * Append a message of len bytes to stream.  The body is a pattern
+ * seeded by seq, so that a message that is cut short, shifted or
+ * delivered out of order does not compare equal.
+ */
+static void
+add_message(vector<uint8_t>& stream, size_t len, uint32_t seq)
+{
+    XLOG_ASSERT(len >= BGPPacket::MINPACKETSIZE &&
+		len <= BGPPacket::MAXPACKETSIZE);
+
+    for (size_t i = 0; i < BGPPacket::MARKER_SIZE; i++)
+	stream.push_back(0xff);
+    stream.push_back((len >> 8) & 0xff);
+    stream.push_back(len & 0xff);
+    stream.push_back(MESSAGETYPEUPDATE);
+    for (size_t i = BGPPacket::COMMON_HEADER_LEN; i < len; i++)
+	stream.push_back((seq * 7 + i) & 0xff);
+}
+
+static bool
+check_framing(TestInfo& info, const string& when, const FramingHarness& h,
+	      const vector<uint8_t>& stream, const vector<size_t>& lengths)
+{
+    if (h.bad() != 0) {
+	DOUT(info) << when << ": " << h.bad() << " bad messages\n";
+	return false;
+    }
+    if (h.lengths() != lengths) {
+	DOUT(info) << when << ": framed " << h.lengths().size()
+		   << " messages, expected " << lengths.size() << endl;
+	return false;
+    }
+    if (h.received() != stream) {
+	DOUT(info) << when << ": messages corrupted\n";
+	return false;
+    }
+    return true;
+}
+
+/*
+ * Many messages of random sizes, written in random sized pieces, so
+ * that messages straddle reads and the end of the read buffer.
+ */
+bool
+test_socket_framing(TestInfo& info)
+{
+    EventLoop eventloop;
+    FramingHarness h(eventloop);
+
+    xorp_srandom(1);
+    vector<uint8_t> stream;
+    vector<size_t> lengths;
+    for (uint32_t seq = 0; seq < 5000; seq++) {
+	size_t len = BGPPacket::MINPACKETSIZE + xorp_random() %
+	    (BGPPacket::MAXPACKETSIZE - BGPPacket::MINPACKETSIZE + 1);
+	add_message(stream, len, seq);
+	lengths.push_back(len);
+    }
+
+    size_t sent = 0;
+    while (sent < stream.size()) {
+	size_t chunk = 1 + xorp_random() % (3 * BGPPacket::MAXPACKETSIZE);
+	chunk = min(chunk, stream.size() - sent);
+	if (!h.write(&stream[sent], chunk)) {
+	    DOUT(info) << "write failed after " << sent << " bytes\n";
+	    return false;
+	}
+	sent += chunk;
+    }
+
+    h.wait_for(lengths.size());
+
+    return check_framing(info, "random", h, stream, lengths);
+}
+
+/*
+ * A short run of messages split into two writes at every byte offset.
+ * Only the messages wholly in the first write may be framed before
+ * the second one is sent.
+ */
+bool
+test_socket_framing_split(TestInfo& info)
+{
+    EventLoop eventloop;
+    FramingHarness h(eventloop);
+
+    const size_t sizes[] = { BGPPacket::MINPACKETSIZE, 45, 300,
+			     BGPPacket::MAXPACKETSIZE,
+			     BGPPacket::MINPACKETSIZE };
+    const size_t count = sizeof(sizes) / sizeof(sizes[0]);
+
+    vector<uint8_t> run;
+    for (size_t i = 0; i < count; i++)
+	add_message(run, sizes[i], i);
+
+    // All the runs go through the same client, so the partial message
+    // is also carried across the end of the read buffer.
+    vector<uint8_t> stream;
+    vector<size_t> lengths;
+    for (size_t split = 1; split < run.size(); split++) {
+	size_t whole = 0, end = 0;
+	while (whole < count && end + sizes[whole] <= split)
+	    end += sizes[whole++];
+
+	if (!h.write(&run[0], split)) {
+	    DOUT(info) << "split " << split << ": write failed\n";
+	    return false;
+	}
+	if (h.wait_for(lengths.size() + whole) != lengths.size() + whole) {
+	    DOUT(info) << "split " << split << ": framed "
+		       << h.lengths().size() - lengths.size()
+		       << " messages, expected " << whole << endl;
+	    return false;
+	}
+	if (!h.write(&run[split], run.size() - split)) {
+	    DOUT(info) << "split " << split << ": write failed\n";
+	    return false;
+	}
+
+	stream.insert(stream.end(), run.begin(), run.end());
+	lengths.insert(lengths.end(), sizes, sizes + count);
+	if (h.wait_for(lengths.size()) != lengths.size()) {
+	    DOUT(info) << "split " << split << ": framed "
+		       << h.lengths().size() << " messages, expected "
+		       << lengths.size() << endl;
+	    return false;
+	}
+    }
+
+    return check_framing(info, "split", h, stream, lengths);
+}
+
+/*
+ * Several messages that are already queued on the socket must all be
+ * framed out of a single read.
+ */
+bool
+test_socket_framing_batch(TestInfo& info)
+{
+    EventLoop eventloop;
+    FramingHarness h(eventloop);
+
+    vector<uint8_t> stream;
+    vector<size_t> lengths;
+    for (uint32_t seq = 0; seq < 10; seq++) {
+	size_t len = BGPPacket::MINPACKETSIZE + seq * 50;
+	add_message(stream, len, seq);
+	lengths.push_back(len);
+    }
+
+    if (!h.write(&stream[0], stream.size())) {
+	DOUT(info) << "write failed\n";
+	return false;
+    }
+
+    // The first read brings in everything that was written.
+    h.wait_for(1);
+
+    return check_framing(info, "batch", h, stream, lengths);
+}
@@ -0,0 +1,716 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+#include "bgp_module.h"
+
+#include "libxorp/xorp.h"
+#include "libxorp/eventloop.hh"
+#include "libxorp/xlog.h"
+#include "libxorp/asnum.hh"
+#include "libxorp/test_main.hh"
+
+#include "policy/common/filter.hh"
+
+#include "bgp.hh"
+#include "peer_handler.hh"
+#include "update_group.hh"
+#include "route_table_fanout.hh"
+#include "route_table_debug.hh"
+#include "path_attribute.hh"
+#include "local_data.hh"
+
+
+/*
+ * The peer each route is held from, which is the peer it must never
+ * be sent back to.
+ */
+typedef map<IPNet<IPv4>, const PeerHandler*> Origins;
+
+/*
+ * How many times each route is held by each peer.
+ */
+typedef map<IPNet<IPv4>, int> View;
+typedef map<const PeerHandler*, View> Views;
+
+/**
+ * Compare the routes a peer holds with the routes it should have
+ * been sent: everything in origins except the routes it announced.
+ */
+static bool
+check_view(TestInfo& info, const string& when, const string& peername,
+	   const PeerHandler *peer, const View& view, const Origins& origins)
+{
+    bool ok = true;
+    size_t expected = 0;
+
+    Origins::const_iterator i;
+    for (i = origins.begin(); i != origins.end(); ++i) {
+	View::const_iterator v = view.find(i->first);
+	int held = v == view.end() ? 0 : v->second;
+	if (i->second == peer) {
+	    if (held != 0) {
+		DOUT(info) << when << ": " << peername << " was sent back "
+			   << i->first.str() << "\n";
+		ok = false;
+	    }
+	    continue;
+	}
+	expected++;
+	if (held != 1) {
+	    DOUT(info) << when << ": " << peername << " holds "
+		       << i->first.str() << " " << held << " times\n";
+	    ok = false;
+	}
+    }
+
+    if (view.size() != expected) {
+	DOUT(info) << when << ": " << peername << " holds " << view.size()
+		   << " routes, expected " << expected << "\n";
+	ok = false;
+    }
+
+    return ok;
+}
+
+/**
+ * Stands in for the output branch of a peer or of an update group,
+ * and applies what it is sent to the routes held by each of its
+ * peers.  A group's branch is sent the members' own routes, which are
+ * kept from the member they came from.
+ */
+class ViewTable : public DebugTable<IPv4> {
+public:
+    ViewTable(const string& tablename, BGPRouteTable<IPv4> *parent,
+	      Views& views)
+	: DebugTable<IPv4>(tablename, parent), _views(views)
+    {}
+
+    void add_peer(const PeerHandler *peer)	{ _peers.insert(peer); }
+    void remove_peer(const PeerHandler *peer)	{ _peers.erase(peer); }
+
+    int add_route(InternalMessage<IPv4> &rtmsg, BGPRouteTable<IPv4> *) {
+	apply(rtmsg, 1);
+	return ADD_USED;
+    }
+    int replace_route(InternalMessage<IPv4> &old_rtmsg,
+		      InternalMessage<IPv4> &new_rtmsg,
+		      BGPRouteTable<IPv4> *) {
+	apply(old_rtmsg, -1);
+	apply(new_rtmsg, 1);
+	return ADD_USED;
+    }
+    int delete_route(InternalMessage<IPv4> &rtmsg, BGPRouteTable<IPv4> *) {
+	apply(rtmsg, -1);
+	return 0;
+    }
+    int push(BGPRouteTable<IPv4> *)		{ return 0; }
+
+private:
+    void apply(InternalMessage<IPv4> &rtmsg, int count) {
+	set<const PeerHandler*>::const_iterator i;
+	for (i = _peers.begin(); i != _peers.end(); ++i) {
+	    if (*i == rtmsg.origin_peer())
+		continue;
+	    View& view = _views[*i];
+	    if ((view[rtmsg.net()] += count) == 0)
+		view.erase(rtmsg.net());
+	}
+    }
+
+    Views& _views;
+    set<const PeerHandler*> _peers;
+};
+
+/**
+ * Feed routes into a FanoutTable the way the decision table does.
+ */
+class FanoutFeed {
+public:
+    FanoutFeed(FanoutTable<IPv4> *fanout, Origins& origins)
+	: _fanout(fanout), _origins(origins)
+    {
+	IPv4 nexthop("2.0.0.1");
+	NextHopAttribute<IPv4> nhatt(nexthop);
+	OriginAttribute igp_origin_att(IGP);
+	for (int i = 0; i < 2; i++) {
+	    ASPath aspath;
+	    aspath.prepend_as(AsNum(100 + i));
+	    ASPathAttribute aspathatt(aspath);
+	    FPAList4Ref fpalist =
+		new FastPathAttributeList<IPv4>(nhatt, aspathatt,
+						igp_origin_att);
+	    _palist[i] = new PathAttributeList<IPv4>(fpalist);
+	}
+    }
+
+    ~FanoutFeed() {
+	map<IPNet<IPv4>, SubnetRoute<IPv4>*>::iterator i;
+	for (i = _routes.begin(); i != _routes.end(); ++i)
+	    i->second->unref();
+	list<SubnetRoute<IPv4>*>::iterator j;
+	for (j = _done.begin(); j != _done.end(); ++j)
+	    (*j)->unref();
+    }
+
+    void add(const IPNet<IPv4>& net, PeerHandler *origin) {
+	SubnetRoute<IPv4> *route = new SubnetRoute<IPv4>(net, _palist[0],
+							 NULL);
+	route->set_nexthop_resolved(true);
+	InternalMessage<IPv4> msg(route, origin, 0);
+	_fanout->add_route(msg, NULL);
+	_routes[net] = route;
+	_origins[net] = origin;
+    }
+
+    void replace(const IPNet<IPv4>& net) {
+	PeerHandler *origin = const_cast<PeerHandler*>(_origins[net]);
+	SubnetRoute<IPv4> *old_route = _routes[net];
+	SubnetRoute<IPv4> *new_route = new SubnetRoute<IPv4>(net, _palist[1],
+							     NULL);
+	new_route->set_nexthop_resolved(true);
+	InternalMessage<IPv4> old_msg(old_route, origin, 0);
+	InternalMessage<IPv4> new_msg(new_route, origin, 0);
+	_fanout->replace_route(old_msg, new_msg, NULL);
+	_routes[net] = new_route;
+	_done.push_back(old_route);
+    }
+
+    void remove(const IPNet<IPv4>& net) {
+	PeerHandler *origin = const_cast<PeerHandler*>(_origins[net]);
+	SubnetRoute<IPv4> *route = _routes[net];
+	InternalMessage<IPv4> msg(route, origin, 0);
+	_fanout->delete_route(msg, NULL);
+	_routes.erase(net);
+	_origins.erase(net);
+	_done.push_back(route);
+    }
+
+private:
+    FanoutTable<IPv4> *_fanout;
+    Origins& _origins;
+    PAListRef<IPv4> _palist[2];
+    map<IPNet<IPv4>, SubnetRoute<IPv4>*> _routes;
+    list<SubnetRoute<IPv4>*> _done;	// Routes the queue may still hold.
+};
+
+static IPNet<IPv4>
+test_net(int block, int i)
+{
+    return IPNet<IPv4>(IPv4(htonl((10 << 24) | (block << 16) | (i << 8))),
+		       24);
+}
+
+static int
+drain(FanoutTable<IPv4> *fanout, BGPRouteTable<IPv4> *next_table,
+      int messages = -1)
+{
+    int got = 0;
+    while (messages < 0 || got < messages) {
+	if (!fanout->get_next_message(next_table))
+	    break;
+	got++;
+    }
+    return got;
+}
+
+/**
+ * Move the branches of three peers in and out of an update group's
+ * branch at the FanoutTable: the group starts where a member is, and
+ * a member that leaves carries on from where the group is.  No route
+ * may be lost or sent twice to any peer.
+ */
+bool
+test_fanout_update_group(TestInfo& info)
+{
+    EventLoop eventloop;
+    BGPMain bgpmain(eventloop);
+    LocalData localdata(bgpmain.eventloop());
+    localdata.set_as(AsNum(1));
+
+    BGPPeer *peer[4];
+    PeerHandler *handler[4];
+    for (int i = 0; i < 4; i++) {
+	string addr = c_format("10.0.0.%d", i + 1);
+	Iptuple tuple("lo", "127.0.0.1", 179, addr.c_str(), 179);
+	BGPPeerData *pd = new BGPPeerData(localdata, tuple, AsNum(2),
+					  IPv4("10.0.0.100"), 30);
+	pd->set_id(IPv4(addr.c_str()));
+	peer[i] = new BGPPeer(&localdata, pd, NULL, &bgpmain);
+	handler[i] = new PeerHandler(c_format("peer%d", i), peer[i],
+				     NULL, NULL);
+    }
+    PeerHandler *source = handler[0];
+    PeerHandler **member = &handler[1];
+
+    FanoutTable<IPv4> *fanout
+	= new FanoutTable<IPv4>("FANOUT", SAFI_UNICAST, NULL, NULL, NULL);
+    Views views;
+    Origins origins;
+
+    ViewTable *source_table = new ViewTable("SOURCE", fanout, views);
+    fanout->add_next_table(source_table, source, 1);
+    ViewTable *table[3];
+    for (int i = 0; i < 3; i++) {
+	table[i] = new ViewTable(c_format("MEMBER%d", i), fanout, views);
+	table[i]->add_peer(member[i]);
+	fanout->add_next_table(table[i], member[i], 1);
+    }
+
+    bool ok = true;
+    {
+	FanoutFeed feed(fanout, origins);
+
+	for (int i = 0; i < 10; i++)
+	    feed.add(test_net(1, i), source);
+	for (int i = 0; i < 4; i++)
+	    feed.add(test_net(2, i), member[0]);
+	fanout->push(NULL);
+
+	drain(fanout, source_table);
+	drain(fanout, table[0]);
+	drain(fanout, table[1]);
+	drain(fanout, table[2], 5);
+	if (!fanout->in_step(table[0], table[1]) ||
+	    fanout->in_step(table[0], table[2])) {
+	    DOUT(info) << "in_step is wrong after a partial drain\n";
+	    ok = false;
+	}
+
+	// Members 0 and 1 form a group.
+	UpdateGroup group("test", member[0]);
+	ViewTable *group_table = new ViewTable("GROUP", fanout, views);
+	group_table->add_peer(member[0]);
+	group_table->add_peer(member[1]);
+	fanout->add_update_group(group_table, &group, table[0]);
+	fanout->park_next_table(table[0]);
+	fanout->park_next_table(table[1]);
+
+	for (int i = 0; i < 4; i++)
+	    feed.add(test_net(3, i), member[1]);
+	for (int i = 0; i < 3; i++)
+	    feed.remove(test_net(1, i));
+	feed.replace(test_net(2, 0));
+	feed.replace(test_net(2, 1));
+	fanout->push(NULL);
+
+	drain(fanout, source_table);
+	drain(fanout, group_table, 3);
+	drain(fanout, table[2]);
+	if (fanout->in_step(group_table, table[2])) {
+	    DOUT(info) << "a partly drained group is in step\n";
+	    ok = false;
+	}
+	drain(fanout, group_table);
+	if (!fanout->in_step(group_table, table[2])) {
+	    DOUT(info) << "a drained group is not in step\n";
+	    ok = false;
+	}
+	for (int i = 0; i < 3; i++)
+	    ok &= check_view(info, "group formed", c_format("member%d", i),
+			     member[i], views[member[i]], origins);
+
+	// Member 2 joins.
+	fanout->park_next_table(table[2]);
+	group_table->add_peer(member[2]);
+
+	for (int i = 0; i < 3; i++)
+	    feed.add(test_net(4, i), member[2]);
+	feed.remove(test_net(3, 0));
+	feed.remove(test_net(3, 1));
+	fanout->push(NULL);
+	drain(fanout, source_table);
+	drain(fanout, group_table, 2);
+
+	// Member 1 leaves part way through.
+	fanout->unpark_next_table(table[1], group_table);
+	group_table->remove_peer(member[1]);
+
+	feed.add(test_net(1, 20), source);
+	feed.add(test_net(1, 21), source);
+	feed.remove(test_net(4, 0));
+	feed.replace(test_net(3, 2));
+	fanout->push(NULL);
+
+	drain(fanout, source_table);
+	drain(fanout, group_table);
+	drain(fanout, table[1]);
+	for (int i = 0; i < 3; i++)
+	    ok &= check_view(info, "member left", c_format("member%d", i),
+			     member[i], views[member[i]], origins);
+
+	fanout->remove_next_table(group_table);
+	delete group_table;
+    }
+
+    for (int i = 0; i < 3; i++) {
+	fanout->remove_next_table(table[i]);
+	delete table[i];
+    }
+    fanout->remove_next_table(source_table);
+    delete source_table;
+    delete fanout;
+    for (int i = 0; i < 4; i++) {
+	delete handler[i];
+	delete peer[i];
+    }
+
+    return ok;
+}
+
+/**
+ * A peer that decodes the UPDATEs it is sent, whether on its own or
+ * as a member of an update group, and keeps the routes it holds.
+ */
+class RecordingPeer : public BGPPeer {
+public:
+    RecordingPeer(LocalData *ld, BGPPeerData *pd, BGPMain *m,
+		  const Origins& origins)
+	: BGPPeer(ld, pd, NULL, m), _main(m), _origins(origins),
+	  _owner(NULL), _busy(false), _errors(0), _encoded(0)
+    {}
+
+    void set_owner(const PeerHandler *owner)	{ _owner = owner; }
+
+    /**
+     * Have writes report a full output queue, as a slow peer would.
+     */
+    void set_busy(bool busy)			{ _busy = busy; }
+
+    /**
+     * The session went down, so the peer forgets what it was sent.
+     */
+    void reset() {
+	_view.clear();
+	_attributes.clear();
+    }
+
+    const View& view() const			{ return _view; }
+    int errors() const				{ return _errors; }
+    int encoded() const				{ return _encoded; }
+
+    PeerOutputState send_update_message(const UpdatePacket& p) {
+	record(p);
+	return _busy ? PEER_OUTPUT_BUSY : PEER_OUTPUT_OK;
+    }
+
+    PeerOutputState send_encoded_update(const EncodedPacketRef& p) {
+	_encoded++;
+	try {
+	    UpdatePacket packet(p->data(), p->len(), peerdata(), _main, false);
+	    record(packet);
+	} catch (XorpException& e) {
+	    XLOG_WARNING("%s: %s", str().c_str(), e.str().c_str());
+	    _errors++;
+	}
+	return _busy ? PEER_OUTPUT_BUSY : PEER_OUTPUT_OK;
+    }
+
+private:
+    void record(const UpdatePacket& p) {
+	BGPUpdateAttribList::const_iterator i;
+	for (i = p.wr_list().begin(); i != p.wr_list().end(); ++i) {
+	    if (_view.erase(i->net()) == 0) {
+		XLOG_WARNING("%s: %s withdrawn but not held", str().c_str(),
+			     i->net().str().c_str());
+		_errors++;
+	    }
+	}
+	for (i = p.nlri_list().begin(); i != p.nlri_list().end(); ++i) {
+	    Origins::const_iterator o = _origins.find(i->net());
+	    if (o != _origins.end() && o->second == _owner) {
+		XLOG_WARNING("%s: sent back %s", str().c_str(),
+			     i->net().str().c_str());
+		_errors++;
+	    }
+	    // Each announcement carries a different MED, which is only
+	    // passed on to IBGP peers.
+	    string attributes = p.pa_list()->str();
+	    if (peerdata()->ibgp() && _view.find(i->net()) != _view.end() &&
+		_attributes[i->net()] == attributes) {
+		XLOG_WARNING("%s: sent %s twice", str().c_str(),
+			     i->net().str().c_str());
+		_errors++;
+	    }
+	    _view[i->net()] = 1;
+	    _attributes[i->net()] = attributes;
+	}
+    }
+
+    BGPMain *_main;
+    const Origins& _origins;
+    const PeerHandler *_owner;
+    bool _busy;
+    View _view;
+    map<IPNet<IPv4>, string> _attributes;
+    int _errors;
+    int _encoded;
+};
+
+static void
+run_for(EventLoop& eventloop, int ms)
+{
+    bool done = false;
+    XorpTimer t = eventloop.set_flag_after_ms(ms, &done);
+    while (!done)
+	eventloop.run();
+}
+
+static bool
+check_members(TestInfo& info, const string& when, PeerHandler **member,
+	      RecordingPeer **member_peer, const Origins& origins)
+{
+    bool ok = true;
+    for (int i = 0; i < 3; i++)
+	ok &= check_view(info, when, member[i]->peername(), member[i],
+			 member_peer[i]->view(), origins);
+    return ok;
+}
+
+/**
+ * Announce a route the way a peer's UPDATE is fed to the plumbing.
+ */
+static void
+announce(BGPPlumbing *plumbing, Origins& origins, const IPNet<IPv4>& net,
+	 PeerHandler *from, uint32_t localpref = 100)
+{
+    static uint32_t med = 0;
+
+    ASPath aspath;
+    if (!from->ibgp())
+	aspath.prepend_as(from->AS_number());
+    FPAList4Ref fpalist =
+	new FastPathAttributeList<IPv4>(NextHopAttribute<IPv4>(IPv4("10.0.2.1")),
+					ASPathAttribute(aspath),
+					OriginAttribute(IGP));
+    if (from->ibgp())
+	fpalist->add_path_attribute(LocalPrefAttribute(localpref));
+    // Every announcement differs, so that one sent twice is caught.
+    fpalist->add_path_attribute(MEDAttribute(med++));
+
+    plumbing->add_route(net, fpalist, PolicyTags(), from);
+    plumbing->push<IPv4>(from);
+    origins[net] = from;
+}
+
+static void
+withdraw(BGPPlumbing *plumbing, Origins& origins, const IPNet<IPv4>& net,
+	 PeerHandler *from)
+{
+    plumbing->delete_route(net, from);
+    plumbing->push<IPv4>(from);
+    origins.erase(net);
+}
+
+/**
+ * Route reflector clients that form an update group through the
+ * plumbing.  Each is still never sent its own routes, including when
+ * the best route for a prefix moves from one member to another, and
+ * nothing is lost or sent twice as members join and leave: a slow
+ * member is split off, a member goes down and comes back, and an
+ * export policy that matches on the neighbor splits the group.
+ */
+bool
+test_update_group(TestInfo& info)
+{
+    EventLoop eventloop;
+    BGPMain bgpmain(eventloop);
+    LocalData *localdata = bgpmain.get_local_data();
+    localdata->set_as(AsNum(1));
+    localdata->set_id(IPv4("10.0.0.1"));
+    localdata->set_route_reflector(true);
+    localdata->set_cluster_id(IPv4("10.0.0.1"));
+
+    BGPPlumbing *plumbing = bgpmain.plumbing_unicast();
+    BGPPlumbingAF<IPv4>& plumbing_ipv4 = plumbing->plumbing_ipv4();
+    Origins origins;
+
+    // An EBGP peer and three route reflector clients.
+    RecordingPeer *peer[4];
+    PeerHandler *handler[4];
+    for (int i = 0; i < 4; i++) {
+	string addr = c_format("10.0.1.%d", i + 1);
+	Iptuple tuple("lo", "10.0.0.1", 179, addr.c_str(), 179);
+	BGPPeerData *pd = new BGPPeerData(*localdata, tuple,
+					  AsNum(i == 0 ? 2 : 1),
+					  IPv4("10.0.0.1"), 30);
+	pd->set_id(IPv4(addr.c_str()));
+	pd->set_route_reflector(i != 0);
+	pd->compute_peer_type();
+	pd->set_multiprotocol<IPv4>(SAFI_UNICAST, BGPPeerData::NEGOTIATED);
+	peer[i] = new RecordingPeer(localdata, pd, &bgpmain, origins);
+	handler[i] = new PeerHandler(c_format("peer%d", i), peer[i],
+				     plumbing, bgpmain.plumbing_multicast());
+	peer[i]->set_owner(handler[i]);
+    }
+    PeerHandler *source = handler[0];
+    PeerHandler **member = &handler[1];
+    RecordingPeer **member_peer = &peer[1];
+
+    bool ok = true;
+
+    for (int i = 0; i < 20; i++)
+	announce(plumbing, origins, test_net(1, i), source);
+    for (int i = 0; i < 5; i++)
+	announce(plumbing, origins, test_net(2, i), member[0]);
+    run_for(eventloop, 200);
+    ok &= check_members(info, "initial dump", member, member_peer, origins);
+
+    plumbing_ipv4.form_update_groups();
+    UpdateGroup *group = plumbing_ipv4.update_group(member[0]);
+    if (group == NULL || group->members().size() != 3) {
+	DOUT(info) << "the clients did not form a group\n";
+	ok = false;
+    }
+
+    for (int i = 0; i < 5; i++)
+	announce(plumbing, origins, test_net(3, i), member[1]);
+    for (int i = 0; i < 5; i++)
+	withdraw(plumbing, origins, test_net(1, i), source);
+    announce(plumbing, origins, test_net(2, 0), member[0]);
+    run_for(eventloop, 200);
+    ok &= check_members(info, "grouped", member, member_peer, origins);
+
+    // The best route moves from one member to another and back.
+    IPNet<IPv4> moving = test_net(9, 0);
+    announce(plumbing, origins, moving, member[2]);
+    run_for(eventloop, 200);
+    announce(plumbing, origins, moving, member[0], 200);
+    run_for(eventloop, 200);
+    ok &= check_members(info, "best route moved", member, member_peer,
+			origins);
+    withdraw(plumbing, origins, moving, member[0]);
+    origins[moving] = member[2];
+    run_for(eventloop, 200);
+    ok &= check_members(info, "best route moved back", member, member_peer,
+			origins);
+
+    if (group != NULL && member_peer[0]->encoded() == 0) {
+	DOUT(info) << "the group encoded nothing\n";
+	ok = false;
+    }
+
+    // A member that stays busy is split off, and the rest of the
+    // group carries on without it.
+    member_peer[2]->set_busy(true);
+    for (int i = 20; i < 30; i++)
+	announce(plumbing, origins, test_net(1, i), source);
+    run_for(eventloop, 200);
+    for (int i = 30; i < 40; i++)
+	announce(plumbing, origins, test_net(1, i), source);
+    // A member may hold back its group for 10 seconds.
+    run_for(eventloop, 12 * 1000);
+    if (plumbing_ipv4.update_group(member[2]) != NULL ||
+	plumbing_ipv4.update_group(member[0]) == NULL) {
+	DOUT(info) << "the slow member was not split off\n";
+	ok = false;
+    }
+    for (int i = 0; i < 2; i++)
+	ok &= check_view(info, "slow member split", member[i]->peername(),
+			 member[i], member_peer[i]->view(), origins);
+    member_peer[2]->set_busy(false);
+    member[2]->output_no_longer_busy();
+    run_for(eventloop, 200);
+    ok &= check_members(info, "slow member caught up", member, member_peer,
+			origins);
+    plumbing_ipv4.form_update_groups();
+    if (plumbing_ipv4.update_group(member[2]) == NULL) {
+	DOUT(info) << "the slow member did not rejoin\n";
+	ok = false;
+    }
+
+    // A member goes down, its routes go with it, and it is sent the
+    // whole table when it comes back.
+    member[1]->peering_went_down();
+    member_peer[1]->reset();
+    for (int i = 0; i < 5; i++)
+	origins.erase(test_net(3, i));
+    run_for(eventloop, 200);
+    if (plumbing_ipv4.update_group(member[1]) != NULL) {
+	DOUT(info) << "a member that went down is still in the group\n";
+	ok = false;
+    }
+    member[1]->peering_came_up();
+    run_for(eventloop, 200);
+    ok &= check_members(info, "member came back", member, member_peer,
+			origins);
+    plumbing_ipv4.form_update_groups();
+    for (int i = 0; i < 3; i++)
+	announce(plumbing, origins, test_net(3, 10 + i), member[1]);
+    run_for(eventloop, 200);
+    ok &= check_members(info, "member rejoined", member, member_peer, origins);
+
+    // An export policy that matches on the neighbor splits the group,
+    // and the group forms again once it is gone.
+    bgpmain.configure_filter(filter::EXPORT,
+			     "POLICY_START neighbor\n"
+			     "TERM_START term\n"
+			     "LOAD 16\n"
+			     "PUSH ipv4 10.9.9.9\n"
+			     "==\n"
+			     "ONFALSE_EXIT\n"
+			     "REJECT\n"
+			     "TERM_END\n"
+			     "POLICY_END\n");
+    for (int i = 0; i < 3; i++) {
+	if (plumbing_ipv4.update_group(member[i]) != NULL) {
+	    DOUT(info) << "the neighbor policy did not split the group\n";
+	    ok = false;
+	}
+    }
+    for (int i = 40; i < 45; i++)
+	announce(plumbing, origins, test_net(1, i), source);
+    withdraw(plumbing, origins, test_net(2, 1), member[0]);
+    run_for(eventloop, 200);
+    ok &= check_members(info, "policy split", member, member_peer, origins);
+
+    // The emptied group is tidied up and the group formed again by the
+    // timer.
+    bgpmain.configure_filter(filter::EXPORT, "");
+    run_for(eventloop, 1200);
+    if (plumbing_ipv4.update_group(member[0]) == NULL) {
+	DOUT(info) << "the group did not form again\n";
+	ok = false;
+    }
+    withdraw(plumbing, origins, test_net(2, 2), member[0]);
+    announce(plumbing, origins, test_net(4, 0), member[2]);
+    run_for(eventloop, 200);
+    ok &= check_members(info, "group formed again", member, member_peer,
+			origins);
+
+    for (int i = 0; i < 4; i++) {
+	if (peer[i]->errors() != 0) {
+	    DOUT(info) << handler[i]->peername() << " had "
+		       << peer[i]->errors() << " errors\n";
+	    ok = false;
+	}
+    }
+
+    // Let the RibIns empty before the tables are torn down.
+    for (int i = 0; i < 4; i++)
+	handler[i]->peering_went_down();
+    run_for(eventloop, 200);
+    for (int i = 0; i < 4; i++) {
+	delete handler[i];
+	delete peer[i];
+    }
+
+    return ok;
+}
@@ -178,6 +178,12 @@ PrintPeers::print_peer_verbose(const string& local_ip,
     send_get_peer_msg_stats("bgp", local_ip, local_port, 
 			    peer_ip, peer_port, cb5);
 
+    XorpCallback3<void, const XrlError&, const uint32_t*, 
+	const uint32_t*>::RefPtr cb8;
+    cb8 = callback(this, &PrintPeers::get_peer_update_stats_done);
+    send_get_peer_update_stats("bgp", local_ip, local_port, 
+			       peer_ip, peer_port, cb8);
+
     XorpCallback3<void, const XrlError&, const uint32_t*, 
 	const uint32_t*>::RefPtr cb6;
     cb6 = callback(this, &PrintPeers::get_peer_established_stats_done);
@@ -204,7 +210,7 @@ PrintPeers::get_peer_id_done(const XrlError& e,
     }
     _peer_id = *peer_id;
     _received++;
-    if (_received == 7)
+    if (_received == 8)
 	do_verbose_peer_print();
 }
 
@@ -222,7 +228,7 @@ PrintPeers::get_peer_status_done(const XrlError& e,
     _peer_state = *peer_state;
     _admin_state = *admin_status;
     _received++;
-    if (_received == 7)
+    if (_received == 8)
 	do_verbose_peer_print();
 }
 
@@ -238,7 +244,7 @@ PrintPeers::get_peer_negotiated_version_done(const XrlError& e,
     }
     _negotiated_version = *neg_version;
     _received++;
-    if (_received == 7)
+    if (_received == 8)
 	do_verbose_peer_print();
 }
 
@@ -255,7 +261,7 @@ PrintPeers::get_peer_as_done(const XrlError& e,
     AsNum asn(*peer_as);
     _peer_as = asn.as4();
     _received++;
-    if (_received == 7)
+    if (_received == 8)
 	do_verbose_peer_print();
 }
 
@@ -281,7 +287,25 @@ PrintPeers::get_peer_msg_stats_done(const XrlError& e,
     _last_error = *last_error;
     _in_update_elapsed = *in_update_elapsed;
     _received++;
-    if (_received == 7)
+    if (_received == 8)
+	do_verbose_peer_print();
+}
+
+void 
+PrintPeers::get_peer_update_stats_done(const XrlError& e, 
+				       const uint32_t* out_update_packets, 
+				       const uint32_t* out_update_prefixes)
+{
+    if (e != XrlError::OKAY()) {
+	//printf("Failed to retrieve verbose data\n");
+	if (_more)
+	    get_peer_list_next();
+	return;
+    }
+    _out_update_packets = *out_update_packets;
+    _out_update_prefixes = *out_update_prefixes;
+    _received++;
+    if (_received == 8)
 	do_verbose_peer_print();
 }
 
@@ -299,7 +323,7 @@ PrintPeers::get_peer_established_stats_done(const XrlError& e,
     _transitions = *transitions;
     _established_time = *established_time;
     _received++;
-    if (_received == 7)
+    if (_received == 8)
 	do_verbose_peer_print();
 }
 
@@ -329,7 +353,7 @@ PrintPeers::get_peer_timer_config_done(const XrlError& e,
     _min_as_origination_interval = *min_as_origination_interval;
     _min_route_adv_interval = *min_route_adv_interval;
     _received++;
-    if (_received == 7)
+    if (_received == 8)
 	do_verbose_peer_print();
 }
 
@@ -400,6 +424,12 @@ PrintPeers::do_verbose_peer_print()
 	   XORP_UINT_CAST(_in_updates), XORP_UINT_CAST(_out_updates));
     printf("  Messages Received: %u,  Messages Sent: %u\n",
 	   XORP_UINT_CAST(_in_msgs), XORP_UINT_CAST(_out_msgs));
+    if (_out_update_packets > 0) {
+	printf("  Prefixes per Update Sent: %.1f\n",
+	       (double)_out_update_prefixes / _out_update_packets);
+    } else {
+	printf("  Prefixes per Update Sent: n/a\n");
+    }
     if (_in_updates > 0) {
 	printf("  Time since last received update: %s\n",
 	       time_units(_in_update_elapsed).c_str());
@@ -67,6 +67,9 @@ public:
 				 const uint32_t* out_msgs, 
 				 const uint32_t* last_error, 
 				 const uint32_t* in_update_elapsed);
+    void get_peer_update_stats_done(const XrlError& e, 
+				    const uint32_t* out_update_packets, 
+				    const uint32_t* out_update_prefixes);
     void get_peer_established_stats_done(const XrlError&, 
 					 const uint32_t* transitions, 
 					 const uint32_t* established_time);
@@ -105,6 +108,8 @@ private:
     uint32_t _out_msgs;
     uint32_t _last_error;
     uint32_t _in_update_elapsed;
+    uint32_t _out_update_packets;
+    uint32_t _out_update_prefixes;
     uint32_t _transitions;
     uint32_t _established_time;
     uint32_t _retry_interval;
@@ -133,25 +133,54 @@ BGPUpdateAttribList::decode(const uint8_t *d, size_t len)
 	throw(CorruptMessage)
 {
     clear();
-    set <IPv4Net> x_set;
 
-    while (len >0 && len >= BGPUpdateAttrib::size(d)) {
-        BGPUpdateAttrib wr(d);
-        len -= BGPUpdateAttrib::size(d);
-        d += BGPUpdateAttrib::size(d);
-        if (x_set.find(wr.net()) == x_set.end()) {
-            push_back(wr);
-            x_set.insert(wr.net());
-        } else
-            XLOG_WARNING("Received duplicate %s in update message",
-			 wr.str("nlri or withdraw").c_str());
+    // Frame the prefixes first, so that the list is allocated once.
+    const uint8_t* p = d;
+    size_t left = len;
+    size_t count = 0;
+    while (left > 0 && left >= BGPUpdateAttrib::size(p)) {
+	size_t s = BGPUpdateAttrib::size(p);
+	left -= s;
+	p += s;
+	count++;
     }
-    if (len != 0)
+    if (left != 0)
         xorp_throw(CorruptMessage,
-                   c_format("leftover bytes %u", XORP_UINT_CAST(len)),
+                   c_format("leftover bytes %u", XORP_UINT_CAST(left)),
                    UPDATEMSGERR, ATTRLEN);
-}
 
+    reserve(count);
+    for (size_t i = 0; i < count; i++) {
+	push_back(BGPUpdateAttrib(d));
+	d += BGPUpdateAttrib::size(d);
+    }
+
+    if (count < 2)
+	return;
+
+    // Look for duplicates on a sorted copy of the prefixes, which for
+    // the usual message without any is a single allocation.
+    vector<uint64_t> keys;
+    keys.reserve(count);
+    for (const_iterator i = begin(); i != end(); ++i)
+	keys.push_back((static_cast<uint64_t>(ntohl(i->masked_addr().addr()))
+			<< 8) | i->prefix_len());
+    sort(keys.begin(), keys.end());
+    if (adjacent_find(keys.begin(), keys.end()) == keys.end())
+	return;
+
+    // Keep the first of each prefix.
+    set <IPv4Net> x_set;
+    iterator out = begin();
+    for (iterator i = begin(); i != end(); ++i) {
+        if (x_set.insert(i->net()).second)
+	    *out++ = *i;
+        else
+            XLOG_WARNING("Received duplicate %s in update message",
+			 i->str("nlri or withdraw").c_str());
+    }
+    erase(out, end());
+}
 
 string
 BGPUpdateAttribList::str(string nlri_or_withdraw) const
@@ -89,10 +89,15 @@ private:
 };
 
 
-class BGPUpdateAttribList : public list <BGPUpdateAttrib> {
+/**
+ * The withdrawn routes or NLRI of an UPDATE message.  A full message holds
+ * hundreds of prefixes, so they are kept in one contiguous array rather
+ * than a node per prefix.
+ */
+class BGPUpdateAttribList : public vector <BGPUpdateAttrib> {
 public:
-    typedef list <BGPUpdateAttrib>::const_iterator const_iterator;
-    typedef list <BGPUpdateAttrib>::iterator iterator;
+    typedef vector <BGPUpdateAttrib>::const_iterator const_iterator;
+    typedef vector <BGPUpdateAttrib>::iterator iterator;
 
     size_t wire_size() const;
     uint8_t *encode(size_t &l, uint8_t *buf = 0) const;
@@ -106,8 +111,8 @@ public:
 	    return false;
         BGPUpdateAttribList me(*this);
         BGPUpdateAttribList him(other);
-	me.sort();
-	him.sort();
+	sort(me.begin(), me.end());
+	sort(him.begin(), him.end());
  	const_iterator i, j;
 	// only check one iterator as we know length is the same
 	for (i=me.begin(), j=him.begin(); i!=me.end(); ++i, ++j)
@@ -0,0 +1,174 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+// #define DEBUG_LOGGING
+// #define DEBUG_PRINT_FUNCTION_NAME
+
+#include "bgp_module.h"
+#include "libxorp/xlog.h"
+#include "libxorp/eventloop.hh"
+#include "update_group.hh"
+#include "bgp.hh"
+
+uint32_t UpdateGroup::_unique_id_allocator = UPDATE_GROUP_UNIQUE_ID_START;
+
+UpdateGroup::UpdateGroup(const string& key, PeerHandler *member)
+    : PeerHandler("UpdateGroup" +
+		  c_format("%u", XORP_UINT_CAST(_unique_id_allocator
+						 - UPDATE_GROUP_UNIQUE_ID_START)),
+		  member->_peer, NULL, NULL),
+      _key(key),
+      _packet_origin(NULL),
+      _packet_origin_only(false),
+      _unique_id(_unique_id_allocator++),
+      _packets_encoded(0),
+      _packets_sent(0)
+{
+    _id = IPv4(htonl(_unique_id - UPDATE_GROUP_UNIQUE_ID_START + 1));
+    debug_msg("%s key %s\n", peername().c_str(), _key.c_str());
+}
+
+UpdateGroup::~UpdateGroup()
+{
+    debug_msg("%s encoded %u sent %u\n", peername().c_str(),
+	      XORP_UINT_CAST(_packets_encoded),
+	      XORP_UINT_CAST(_packets_sent));
+}
+
+void
+UpdateGroup::add_member(PeerHandler *member)
+{
+    XLOG_ASSERT(find(_members.begin(), _members.end(), member)
+		== _members.end());
+
+    _members.push_back(member);
+}
+
+bool
+UpdateGroup::remove_member(PeerHandler *member)
+{
+    list<PeerHandler *>::iterator i = find(_members.begin(), _members.end(),
+					   member);
+    XLOG_ASSERT(i != _members.end());
+    _members.erase(i);
+
+    // Hand the representative role on to another member.
+    if (member->_peer == _peer && !_members.empty())
+	_peer = _members.front()->_peer;
+
+    if (_packet_origin == member) {
+	_packet_origin = NULL;
+	_packet_origin_only = false;
+    }
+
+    if (_busy.erase(member) == 0)
+	return false;
+
+    return _busy.empty();
+}
+
+bool
+UpdateGroup::member_no_longer_busy(PeerHandler *member)
+{
+    if (_busy.erase(member) == 0)
+	return false;
+
+    return _busy.empty();
+}
+
+PeerHandler *
+UpdateGroup::slow_member(const TimeVal& now, const TimeVal& limit) const
+{
+    map<PeerHandler *, TimeVal>::const_iterator i;
+    for (i = _busy.begin(); i != _busy.end(); ++i) {
+	if (now - i->second > limit)
+	    return i->first;
+    }
+
+    return NULL;
+}
+
+void
+UpdateGroup::set_origin_peer(const PeerHandler *origin, bool origin_only)
+{
+    // Routes from outside the group go to every member, and routes
+    // for an outsider alone go nowhere.
+    if (!origin_only &&
+	find(_members.begin(), _members.end(), origin) == _members.end())
+	origin = NULL;
+
+    if (origin == _packet_origin && origin_only == _packet_origin_only)
+	return;
+
+    if (_packet != NULL) {
+	PeerHandler::push_packet();
+	start_packet();
+    }
+    _packet_origin = origin;
+    _packet_origin_only = origin_only;
+}
+
+PeerOutputState
+UpdateGroup::push_packet()
+{
+    PeerOutputState result = PeerHandler::push_packet();
+
+    // A member may have filled up on an UPDATE that was sent off early.
+    if (result == PEER_OUTPUT_OK && busy())
+	return PEER_OUTPUT_BUSY;
+
+    return result;
+}
+
+PeerOutputState
+UpdateGroup::send_packet(const UpdatePacket& p, int prefixes)
+{
+    EncodedPacketRef packet = new EncodedPacket;
+    if (!packet->encode(p, _peer->peerdata())) {
+	XLOG_ERROR("%s: failed to encode %s", peername().c_str(), cstring(p));
+	return PEER_OUTPUT_FAIL;
+    }
+    _packets_encoded++;
+
+    TimeVal now;
+    eventloop().current_time(now);
+
+    // A failed write can take the member down and out of the group
+    // while we are still walking it.
+    list<PeerHandler *> members = _members;
+    list<PeerHandler *>::iterator i;
+    for (i = members.begin(); i != members.end(); ++i) {
+	PeerHandler *member = *i;
+	if (!member->peering_is_up())
+	    continue;
+	if ((member == _packet_origin) != _packet_origin_only)
+	    continue;
+
+	_packets_sent++;
+	if (member->send_encoded(packet, prefixes) != PEER_OUTPUT_BUSY)
+	    continue;
+	if (find(_members.begin(), _members.end(), member) != _members.end()
+	    && _busy.find(member) == _busy.end())
+	    _busy[member] = now;
+    }
+
+    return _busy.empty() ? PEER_OUTPUT_OK : PEER_OUTPUT_BUSY;
+}
@@ -0,0 +1,138 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+#ifndef __BGP_UPDATE_GROUP_HH__
+#define __BGP_UPDATE_GROUP_HH__
+
+#include "libxorp/timeval.hh"
+#include "peer_handler.hh"
+
+/**
+ * Unique IDs for update groups are kept well clear of the IDs handed
+ * out to real peers.
+ */
+const uint32_t UPDATE_GROUP_UNIQUE_ID_START = 0x80000000;
+
+/**
+ * An UpdateGroup stands in for a set of peers which would all be sent
+ * exactly the same UPDATEs: same outbound filters, same export policy
+ * and same negotiated capabilities.
+ *
+ * The plumbing gives the group a single output branch, so each route
+ * is filtered and queued once, and the group encodes each UPDATE once
+ * and writes the same buffer to every member.  Each member's socket
+ * keeps its own write position, and a member whose output queue fills
+ * up only holds back the group until it drains.
+ *
+ * One of the members is used as the representative: the filters and
+ * the encoding are set up from its session parameters, which by
+ * construction are the same for every member.
+ */
+class UpdateGroup : public PeerHandler {
+public:
+    /**
+     * @param key the parameters shared by every member.
+     * @param member the first member of the group.
+     */
+    UpdateGroup(const string& key, PeerHandler *member);
+    ~UpdateGroup();
+
+    const string& key() const			{ return _key; }
+
+    void add_member(PeerHandler *member);
+
+    /**
+     * @return true if the group was waiting only on this member.
+     */
+    bool remove_member(PeerHandler *member);
+
+    const list<PeerHandler *>& members() const	{ return _members; }
+    bool empty() const				{ return _members.empty(); }
+
+    /**
+     * The member's output queue has drained.
+     *
+     * @return true if the group is no longer waiting on any member.
+     */
+    bool member_no_longer_busy(PeerHandler *member);
+
+    /**
+     * @return true if a member's output queue is full.
+     */
+    bool busy() const				{ return !_busy.empty(); }
+
+    /**
+     * @param now the current time.
+     * @param limit how long a member may hold back the group.
+     * @return a member that has been busy for longer than limit, or
+     * NULL if there is none.
+     */
+    PeerHandler *slow_member(const TimeVal& now, const TimeVal& limit) const;
+
+    /**
+     * @return the number of UPDATEs that have been encoded.
+     */
+    uint32_t packets_encoded() const		{ return _packets_encoded; }
+
+    /**
+     * @return the number of UPDATEs that have been written to members.
+     */
+    uint32_t packets_sent() const		{ return _packets_sent; }
+
+    uint32_t get_unique_id() const		{ return _unique_id; }
+
+    /**
+     * The group must have an ID of its own, as the FanoutTable orders
+     * its next tables by ID and the members keep theirs.  IDs in
+     * 0.0.0.0/8 are never valid BGP IDs.
+     */
+    const IPv4& id() const			{ return _id; }
+
+    /**
+     * Routes are kept from the member they were learned from, as its
+     * own branch would do: the UPDATE being built is sent off as soon
+     * as the routes passed in come from a different member.
+     */
+    void set_origin_peer(const PeerHandler *origin, bool origin_only = false);
+    bool per_origin_peer() const		{ return true; }
+
+    PeerOutputState push_packet();
+
+protected:
+    PeerOutputState send_packet(const UpdatePacket& p, int prefixes);
+
+private:
+    static uint32_t _unique_id_allocator;
+
+    string _key;
+    list<PeerHandler *> _members;
+    map<PeerHandler *, TimeVal> _busy;	// Members that are busy and since when.
+
+    const PeerHandler *_packet_origin;	// Member the routes came from.
+    bool _packet_origin_only;		// Send to that member alone.
+
+    uint32_t _unique_id;
+    IPv4 _id;
+
+    uint32_t _packets_encoded;
+    uint32_t _packets_sent;
+};
+
+#endif // __BGP_UPDATE_GROUP_HH__
@@ -87,22 +87,6 @@ UpdatePacket::add_withdrawn(const BGPUpdateAttrib& wdr)
     _wr_list.push_back(wdr);
 }
 
-bool 
-UpdatePacket::big_enough() const
-{
-    /* is the packet now large enough that we'd be best to send the
-       part we already have before it exceeds the 4K size limit? */
-    //XXXX needs additional tests for v6
-
-    //quick and dirty check
-    if (((_wr_list.size() + _nlri_list.size())* 4) > 2048) {
-	debug_msg("withdrawn size = %u\n", XORP_UINT_CAST(_wr_list.size()));
-	debug_msg("nlri size = %u\n", XORP_UINT_CAST(_wr_list.size()));
-	return true;
-    }
-    return false;
-}
-
 bool
 UpdatePacket::encode(uint8_t *d, size_t &len, const BGPPeerData *peerdata) const
 {
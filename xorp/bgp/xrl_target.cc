@@ -1023,6 +1023,32 @@ XrlBgpTarget::bgp_0_3_get_peer_msg_stats(
     return XrlCmdError::OKAY();
 }
 
+XrlCmdError 
+XrlBgpTarget::bgp_0_3_get_peer_update_stats(
+					    // Input values, 
+					    const string& local_ip, 
+					    const uint32_t& local_port, 
+					    const string& peer_ip, 
+					    const uint32_t& peer_port, 
+					    // Output values, 
+					    uint32_t& out_update_packets, 
+					    uint32_t& out_update_prefixes)
+{
+    try {
+	Iptuple iptuple("", local_ip.c_str(), local_port, peer_ip.c_str(),
+			peer_port);
+
+	if (!_bgp.get_peer_update_stats(iptuple, out_update_packets,
+					out_update_prefixes)) {
+	    return XrlCmdError::COMMAND_FAILED();
+	}
+    } catch(XorpException& e) {
+	return XrlCmdError::COMMAND_FAILED(e.str());
+    }
+
+    return XrlCmdError::OKAY();
+}
+
 XrlCmdError 
 XrlBgpTarget::bgp_0_3_get_peer_established_stats(
 						 // Input values, 
@@ -1157,6 +1183,19 @@ XrlBgpTarget::bgp_0_3_get_v4_route_list_next(
     return XrlCmdError::OKAY();
 }
 
+XrlCmdError
+XrlBgpTarget::bgp_0_3_get_v4_attribute_stats(
+	// Output values, 
+	uint32_t& lists, 
+	uint32_t& references, 
+	uint32_t& bytes)
+{
+    if (!_bgp.get_attribute_stats<IPv4>(lists, references, bytes))
+	return XrlCmdError::COMMAND_FAILED("Attribute manager not running");
+
+    return XrlCmdError::OKAY();
+}
+
 XrlCmdError XrlBgpTarget::rib_client_0_1_route_info_changed4(
         // Input values, 
         const IPv4& addr,
@@ -1193,6 +1232,55 @@ XrlCmdError XrlBgpTarget::rib_client_0_1_route_info_invalid4(
     return XrlCmdError::OKAY();
 }
 
+XrlCmdError XrlBgpTarget::rib_client_0_1_route_info_batch4(
+	// Input values,
+	const XrlAtomList&	invalid_addrs,
+	const XrlAtomList&	invalid_prefix_lens,
+	const XrlAtomList&	addrs,
+	const XrlAtomList&	prefix_lens,
+	const XrlAtomList&	nexthops,
+	const XrlAtomList&	metrics,
+	const XrlAtomList&	admin_distances,
+	const XrlAtomList&	protocol_origins)
+{
+    size_t changed = addrs.size();
+    if (invalid_prefix_lens.size() != invalid_addrs.size()
+	|| prefix_lens.size() != changed || nexthops.size() != changed
+	|| metrics.size() != changed || admin_distances.size() != changed
+	|| protocol_origins.size() != changed)
+	return XrlCmdError::BAD_ARGS("Mismatched list lengths");
+
+    debug_msg("IGP route info batch: %u invalid %u changed\n",
+	      XORP_UINT_CAST(invalid_addrs.size()), XORP_UINT_CAST(changed));
+
+    // Apply the whole batch, even if some of it is refused
+    bool ok = true;
+    try {
+	for (size_t i = 0; i < invalid_addrs.size(); i++) {
+	    if (!_bgp.rib_client_route_info_invalid4(
+		    invalid_addrs.get(i).ipv4(),
+		    invalid_prefix_lens.get(i).uint32()))
+		ok = false;
+	}
+
+	// TODO: admin_distance and protocol_origin are not used
+	for (size_t i = 0; i < changed; i++) {
+	    if (!_bgp.rib_client_route_info_changed4(addrs.get(i).ipv4(),
+						      prefix_lens.get(i).uint32(),
+						      nexthops.get(i).ipv4(),
+						      metrics.get(i).uint32()))
+		ok = false;
+	}
+    } catch (const XrlAtom::WrongType& e) {
+	return XrlCmdError::BAD_ARGS(e.str());
+    }
+
+    if (!ok)
+	return XrlCmdError::COMMAND_FAILED();
+
+    return XrlCmdError::OKAY();
+}
+
 XrlCmdError XrlBgpTarget::bgp_0_3_set_parameter(
 				  // Input values,
 				  const string&	local_ip, 
@@ -1563,6 +1651,19 @@ XrlBgpTarget::bgp_0_3_get_v6_route_list_next(
     return XrlCmdError::OKAY();
 }
 
+XrlCmdError
+XrlBgpTarget::bgp_0_3_get_v6_attribute_stats(
+	// Output values, 
+	uint32_t& lists, 
+	uint32_t& references, 
+	uint32_t& bytes)
+{
+    if (!_bgp.get_attribute_stats<IPv6>(lists, references, bytes))
+	return XrlCmdError::COMMAND_FAILED("Attribute manager not running");
+
+    return XrlCmdError::OKAY();
+}
+
 XrlCmdError XrlBgpTarget::rib_client_0_1_route_info_changed6(
 	// Input values, 
 	const IPv6&	addr, 
@@ -1599,6 +1700,55 @@ XrlCmdError XrlBgpTarget::rib_client_0_1_route_info_invalid6(
     return XrlCmdError::OKAY();
 }
 
+XrlCmdError XrlBgpTarget::rib_client_0_1_route_info_batch6(
+	// Input values,
+	const XrlAtomList&	invalid_addrs,
+	const XrlAtomList&	invalid_prefix_lens,
+	const XrlAtomList&	addrs,
+	const XrlAtomList&	prefix_lens,
+	const XrlAtomList&	nexthops,
+	const XrlAtomList&	metrics,
+	const XrlAtomList&	admin_distances,
+	const XrlAtomList&	protocol_origins)
+{
+    size_t changed = addrs.size();
+    if (invalid_prefix_lens.size() != invalid_addrs.size()
+	|| prefix_lens.size() != changed || nexthops.size() != changed
+	|| metrics.size() != changed || admin_distances.size() != changed
+	|| protocol_origins.size() != changed)
+	return XrlCmdError::BAD_ARGS("Mismatched list lengths");
+
+    debug_msg("IGP route info batch: %u invalid %u changed\n",
+	      XORP_UINT_CAST(invalid_addrs.size()), XORP_UINT_CAST(changed));
+
+    // Apply the whole batch, even if some of it is refused
+    bool ok = true;
+    try {
+	for (size_t i = 0; i < invalid_addrs.size(); i++) {
+	    if (!_bgp.rib_client_route_info_invalid6(
+		    invalid_addrs.get(i).ipv6(),
+		    invalid_prefix_lens.get(i).uint32()))
+		ok = false;
+	}
+
+	// TODO: admin_distance and protocol_origin are not used
+	for (size_t i = 0; i < changed; i++) {
+	    if (!_bgp.rib_client_route_info_changed6(addrs.get(i).ipv6(),
+						      prefix_lens.get(i).uint32(),
+						      nexthops.get(i).ipv6(),
+						      metrics.get(i).uint32()))
+		ok = false;
+	}
+    } catch (const XrlAtom::WrongType& e) {
+	return XrlCmdError::BAD_ARGS(e.str());
+    }
+
+    if (!ok)
+	return XrlCmdError::COMMAND_FAILED();
+
+    return XrlCmdError::OKAY();
+}
+
 
 XrlCmdError 
 XrlBgpTarget::policy_redist6_0_1_add_route6(
@@ -326,6 +326,16 @@ public:
 	uint32_t&	last_error,
 	uint32_t&	in_update_elapsed);
 
+    XrlCmdError bgp_0_3_get_peer_update_stats(
+        // Input values,
+        const string& local_ip,
+	const uint32_t& local_port,
+	const string& peer_ip,
+	const uint32_t& peer_port,
+	// Output values,
+	uint32_t& out_update_packets,
+	uint32_t& out_update_prefixes);
+
     XrlCmdError bgp_0_3_get_peer_established_stats(
         // Input values,
         const string& local_ip,
@@ -382,6 +392,12 @@ public:
 	bool& unicast,
 	bool& multicast);
 
+    XrlCmdError bgp_0_3_get_v4_attribute_stats(
+	// Output values,
+	uint32_t& lists,
+	uint32_t& references,
+	uint32_t& bytes);
+
     XrlCmdError rib_client_0_1_route_info_changed4(
 	// Input values,
 	const IPv4&	addr,
@@ -396,6 +412,17 @@ public:
 	const IPv4&	addr,
 	const uint32_t&	prefix_len);
 
+    XrlCmdError rib_client_0_1_route_info_batch4(
+	// Input values,
+	const XrlAtomList&	invalid_addrs,
+	const XrlAtomList&	invalid_prefix_lens,
+	const XrlAtomList&	addrs,
+	const XrlAtomList&	prefix_lens,
+	const XrlAtomList&	nexthops,
+	const XrlAtomList&	metrics,
+	const XrlAtomList&	admin_distances,
+	const XrlAtomList&	protocol_origins);
+
     XrlCmdError bgp_0_3_set_parameter(
         // Input values,
 	const string&	local_ip,
@@ -502,6 +529,12 @@ public:
 	bool& unicast,
 	bool& multicast);
 
+    XrlCmdError bgp_0_3_get_v6_attribute_stats(
+	// Output values,
+	uint32_t& lists,
+	uint32_t& references,
+	uint32_t& bytes);
+
     XrlCmdError rib_client_0_1_route_info_changed6(
 	// Input values,
 	const IPv6&	addr,
@@ -515,6 +548,17 @@ public:
 	// Input values,
 	const IPv6&	addr,
 	const uint32_t&	prefix_len);
+
+    XrlCmdError rib_client_0_1_route_info_batch6(
+	// Input values,
+	const XrlAtomList&	invalid_addrs,
+	const XrlAtomList&	invalid_prefix_lens,
+	const XrlAtomList&	addrs,
+	const XrlAtomList&	prefix_lens,
+	const XrlAtomList&	nexthops,
+	const XrlAtomList&	metrics,
+	const XrlAtomList&	admin_distances,
+	const XrlAtomList&	protocol_origins);
         
     XrlCmdError policy_redist6_0_1_add_route6(
         // Input values,
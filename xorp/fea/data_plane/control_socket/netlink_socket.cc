@@ -85,6 +85,7 @@ NetlinkSocket::NetlinkSocket(EventLoop& eventloop, uint32_t table_id)
       _fd(-1),
       _seqno(0),
       _instance_no(_instance_cnt++),
+      _nl_pid(0),
       _nl_groups(0),		// XXX: no netlink multicast groups
       _table_id(table_id),
       _is_multipart_message_read(false),
@@ -434,14 +435,17 @@ NetlinkSocket::force_recvmsg_flgs(int flags, bool only_kernel_messages,
     //XLOG_WARNING("Got a netlink message: %s  nlm_count: %u",
     //	 NlmUtils::nlm_print_msg(message).c_str(), _nlm_count);
 
-    //
-    // Notify observers
-    //
+    notify_observers(message);
+
+    return (XORP_OK);
+}
+
+void
+NetlinkSocket::notify_observers(vector<uint8_t>& message)
+{
     for (ObserverList::iterator i = _ol.begin(); i != _ol.end(); i++) {
 	(*i)->netlink_socket_data(message);
     }
-
-    return (XORP_OK);
 }
 
 void
@@ -596,4 +600,131 @@ NetlinkSocketReader::netlink_socket_data(vector<uint8_t>& buffer)
     _cache_data.resize(off);
 }
 
+NetlinkSocketBatch::NetlinkSocketBatch(NetlinkSocket& ns, size_t max_bytes,
+				       size_t max_requests)
+    : NetlinkSocketObserver(ns),
+      _ns(ns),
+      _max_bytes(max_bytes),
+      _max_requests(max_requests),
+      _requests(0),
+      _writes(0)
+{
+    _buffer.reserve(max_bytes);
+}
+
+NetlinkSocketBatch::~NetlinkSocketBatch()
+{
+
+}
+
+void
+NetlinkSocketBatch::add_request(const struct nlmsghdr* nlh)
+{
+    XLOG_ASSERT(nlh->nlmsg_flags & NLM_F_ACK);
+
+    size_t off = _buffer.size();
+    _buffer.resize(off + NLMSG_ALIGN(nlh->nlmsg_len), 0);
+    memcpy(&_buffer[off], nlh, nlh->nlmsg_len);
+    _pending.insert(nlh->nlmsg_seq);
+}
+
+int
+NetlinkSocketBatch::flush(string& error_msg)
+{
+    struct sockaddr_nl	snl;
+    set<uint32_t>::iterator iter;
+
+    if (_pending.empty())
+	return (XORP_OK);
+
+    // Set the socket
+    memset(&snl, 0, sizeof(snl));
+    snl.nl_family = AF_NETLINK;
+    snl.nl_pid    = 0;		// nl_pid = 0 if destination is the kernel
+    snl.nl_groups = 0;
+
+    _writes++;
+    _requests += _pending.size();
+    if (_ns.sendto(&_buffer[0], _buffer.size(), 0,
+		   reinterpret_cast<struct sockaddr*>(&snl), sizeof(snl))
+	!= (ssize_t)_buffer.size()) {
+	int last_errno = errno;
+	error_msg = c_format("Error writing to netlink socket: %s",
+			     strerror(last_errno));
+	for (iter = _pending.begin(); iter != _pending.end(); ++iter)
+	    _failures[*iter] = last_errno;
+	_pending.clear();
+	_buffer.clear();
+	return (XORP_ERROR);
+    }
+    _outstanding.insert(_pending.begin(), _pending.end());
+    _pending.clear();
+    _buffer.clear();
+
+    //
+    // Read the acknowledgements.  The acknowledgements may also have
+    // been read already by the netlink socket on its own.
+    //
+    string dummy_error_msg;
+    bool acks_dropped = false;
+    int last_errno = 0;
+    while (! _outstanding.empty()) {
+	errno = 0;
+	if (_ns.force_recvmsg(true, dummy_error_msg) == XORP_OK)
+	    continue;
+	last_errno = errno;
+	// On ENOBUFS some acknowledgements were dropped, but there may be
+	// more to read.
+	if (last_errno != ENOBUFS)
+	    break;
+	acks_dropped = true;
+    }
+
+    //
+    // If the kernel could not queue an acknowledgement, then we don't
+    // know whether the request was applied.  Otherwise the receive
+    // failed: record why (a failure that did not set errno, such as a
+    // truncated message, is an I/O error).
+    //
+    int error = last_errno;
+    if (acks_dropped && ((error == EAGAIN) || (error == EWOULDBLOCK)))
+	error = ENOBUFS;
+    else if (error == 0)
+	error = EIO;
+    for (iter = _outstanding.begin(); iter != _outstanding.end(); ++iter)
+	_failures[*iter] = error;
+    _outstanding.clear();
+
+    return (XORP_OK);
+}
+
+void
+NetlinkSocketBatch::netlink_socket_data(vector<uint8_t>& buffer)
+{
+    size_t buffer_bytes = buffer.size();
+    struct nlmsghdr* nlh;
+
+    for (nlh = (struct nlmsghdr*)(&buffer[0]);
+	 NLMSG_OK(nlh, buffer_bytes);
+	 nlh = NLMSG_NEXT(nlh, buffer_bytes)) {
+	if ((nlh->nlmsg_type != NLMSG_ERROR)
+	    || (nlh->nlmsg_pid != _ns.nl_pid()))
+	    continue;
+
+	set<uint32_t>::iterator iter = _outstanding.find(nlh->nlmsg_seq);
+	if (iter == _outstanding.end())
+	    continue;
+	_outstanding.erase(iter);
+
+	const struct nlmsgerr* err;
+	err = reinterpret_cast<const struct nlmsgerr*>(NLMSG_DATA(nlh));
+	if (nlh->nlmsg_len < NLMSG_LENGTH(sizeof(*err))) {
+	    _failures[nlh->nlmsg_seq] = EINVAL;
+	    continue;
+	}
+	if (err->error != 0)
+	    _failures[nlh->nlmsg_seq] = -err->error;
+    }
+}
+
 #endif // HAVE_NETLINK_SOCKETS
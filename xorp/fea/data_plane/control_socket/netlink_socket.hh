@@ -89,8 +89,8 @@ public:
      *
      * @return the number of bytes which were written, or -1 if error.
      */
-    ssize_t sendto(const void* data, size_t nbytes, int flags,
-		   const struct sockaddr* to, socklen_t tolen);
+    virtual ssize_t sendto(const void* data, size_t nbytes, int flags,
+			   const struct sockaddr* to, socklen_t tolen);
 
     /**
      * Get the sequence number for next message written into the kernel.
@@ -103,6 +103,17 @@ public:
      */
     uint32_t seqno() const { return (_instance_no << 16 | _seqno); }
 
+    /**
+     * Get the sequence number for the next message and advance it.
+     *
+     * This is used when several messages are written into the kernel
+     * with a single write, so that each reply can be matched with its
+     * request.
+     *
+     * @return the sequence number for the next message.
+     */
+    uint32_t next_seqno() { return (_instance_no << 16 | _seqno++); }
+
     /**
      * Get cached netlink socket identifier value.
      *
@@ -124,7 +135,8 @@ public:
      * @param error_msg the error message (if error).
      * @return XORP_OK on success, otherwise XORP_ERROR.
      */
-    int force_recvmsg_flgs(int flags, bool only_kernel_messages, string& error_msg);
+    virtual int force_recvmsg_flgs(int flags, bool only_kernel_messages,
+				   string& error_msg);
 
     /** Same as above, but always passes MSG_DONTWAIT as flags so that we don't block
      * if packet is filtered, for example.
@@ -162,6 +174,15 @@ public:
      */
     virtual int notify_table_id_change(uint32_t new_tbl);
 
+protected:
+    /**
+     * Invoke NetlinkSocketObserver::netlink_socket_data() on all observers
+     * of the netlink socket.
+     *
+     * @param message the received data.
+     */
+    void notify_observers(vector<uint8_t>& message);
+
 private:
     typedef list<NetlinkSocketObserver*> ObserverList;
 
@@ -264,6 +285,104 @@ private:
     vector<uint8_t> _cache_data;	// Cached netlink socket data.
 };
 
+/**
+ * NetlinkSocketBatch packs netlink requests into a single buffer, writes
+ * them to the kernel with a single sendto(), and collects the
+ * acknowledgements for all of them.
+ *
+ * Every request must carry NLM_F_ACK and a sequence number obtained with
+ * NetlinkSocket::next_seqno().  The kernel processes the requests and
+ * queues the acknowledgements before sendto() returns, so all of them
+ * are read back without blocking.  The number of requests in a batch is
+ * limited so that their acknowledgements fit in the receive buffer of
+ * the socket.
+ */
+class NetlinkSocketBatch : public NetlinkSocketObserver {
+public:
+    typedef map<uint32_t, int> FailureMap;	// Seqno to errno
+
+    /**
+     * Constructor.
+     *
+     * @param ns the netlink socket to write the requests to.
+     * @param max_bytes the size of the buffer at which the batch is full.
+     * @param max_requests the number of requests at which the batch is
+     * full.
+     */
+    NetlinkSocketBatch(NetlinkSocket& ns, size_t max_bytes,
+		       size_t max_requests);
+    virtual ~NetlinkSocketBatch();
+
+    /**
+     * Append a request to the batch.
+     *
+     * @param nlh the request to append.
+     */
+    void add_request(const struct nlmsghdr* nlh);
+
+    /**
+     * @return true if the batch should be flushed before more requests
+     * are added.
+     */
+    bool is_full() const {
+	return (_buffer.size() >= _max_bytes || _pending.size() >= _max_requests);
+    }
+
+    /**
+     * @return true if there are no requests waiting to be written.
+     */
+    bool empty() const { return (_pending.empty()); }
+
+    /**
+     * Write all requests to the kernel and collect the acknowledgements.
+     *
+     * On return no request is outstanding: each of them was either
+     * acknowledged, or added to the failures.
+     *
+     * @param error_msg the error message (if error).
+     * @return XORP_OK if all requests were written, otherwise XORP_ERROR.
+     */
+    int flush(string& error_msg);
+
+    /**
+     * @return the requests that failed since the failures were last
+     * cleared, and the error returned by the kernel for each of them.
+     */
+    const FailureMap& failures() const { return (_failures); }
+
+    void clear_failures() { _failures.clear(); }
+
+    /**
+     * @return the number of requests written.
+     */
+    uint32_t requests() const { return (_requests); }
+
+    /**
+     * @return the number of writes to the kernel.
+     */
+    uint32_t writes() const { return (_writes); }
+
+    /**
+     * Receive data from the netlink socket.
+     *
+     * @param buffer the buffer with the received data.
+     */
+    virtual void netlink_socket_data(vector<uint8_t>& buffer);
+
+private:
+    NetlinkSocket&  _ns;
+
+    size_t	    _max_bytes;
+    size_t	    _max_requests;
+    vector<uint8_t> _buffer;		// Requests not yet written
+    set<uint32_t>   _pending;		// Seqnos not yet written
+    set<uint32_t>   _outstanding;	// Seqnos written but not acked
+    FailureMap	    _failures;
+
+    uint32_t	    _requests;
+    uint32_t	    _writes;
+};
+
 
 
 #endif // HAVE_NETLINK_SOCKETS
@@ -54,7 +54,8 @@ FibConfigEntrySetNetlinkSocket::FibConfigEntrySetNetlinkSocket(FeaDataPlaneManag
     : FibConfigEntrySet(fea_data_plane_manager),
       NetlinkSocket(fea_data_plane_manager.eventloop(),
 		    fea_data_plane_manager.fibconfig().get_netlink_filter_table_id()),
-      _ns_reader(*(NetlinkSocket *)this)
+      _ns_reader(*(NetlinkSocket *)this),
+      _batch(*(NetlinkSocket *)this, BATCH_BYTES, BATCH_REQUESTS)
 {
 }
 
@@ -104,6 +105,42 @@ FibConfigEntrySetNetlinkSocket::stop(string& error_msg)
     return (XORP_OK);
 }
 
+int
+FibConfigEntrySetNetlinkSocket::start_configuration(string& error_msg)
+{
+    _batch_error.erase();
+
+    return (mark_configuration_start(error_msg));
+}
+
+int
+FibConfigEntrySetNetlinkSocket::end_configuration(string& error_msg)
+{
+    flush_batch();
+
+    if (mark_configuration_end(error_msg) != XORP_OK)
+	return (XORP_ERROR);
+
+    if (! _batch_error.empty()) {
+	error_msg = _batch_error;
+	_batch_error.erase();
+	return (XORP_ERROR);
+    }
+
+    return (XORP_OK);
+}
+
+int
+FibConfigEntrySetNetlinkSocket::flush_configuration(string& error_msg)
+{
+    UNUSED(error_msg);
+
+    // XXX: a failed request is kept in _batch_error for end_configuration()
+    flush_batch();
+
+    return (XORP_OK);
+}
+
 int
 FibConfigEntrySetNetlinkSocket::add_entry4(const Fte4& fte)
 {
@@ -358,6 +395,11 @@ FibConfigEntrySetNetlinkSocket::add_entry(const FteX& fte)
     // we don't add it.
     //
 
+    if (in_configuration()) {
+	nlh->nlmsg_seq = ns.next_seqno();
+	return (batch_request(nlh, fte, true));
+    }
+
     string error_msg;
     int last_errno = 0;
     if (ns.sendto(&buffer, nlh->nlmsg_len, 0,
@@ -524,6 +566,11 @@ FibConfigEntrySetNetlinkSocket::delete_entry(const FteX& fte)
 	break;
     } while (false);
 
+    if (in_configuration()) {
+	nlh->nlmsg_seq = ns.next_seqno();
+	return (batch_request(nlh, fte, false));
+    }
+
     int last_errno = 0;
     string error_msg;
     if (ns.sendto(&buffer, nlh->nlmsg_len, 0,
@@ -592,4 +639,60 @@ FibConfigEntrySetNetlinkSocket::delete_entry(const FteX& fte)
     return (XORP_OK);
 }
 
+int
+FibConfigEntrySetNetlinkSocket::batch_request(const struct nlmsghdr* nlh,
+					      const FteX& fte, bool is_add)
+{
+    _batch.add_request(nlh);
+    _batched_requests.insert(make_pair(nlh->nlmsg_seq,
+				       BatchedRequest(fte, is_add)));
+
+    if (_batch.is_full())
+	flush_batch();
+
+    return (XORP_OK);
+}
+
+void
+FibConfigEntrySetNetlinkSocket::flush_batch()
+{
+    string error_msg;
+
+    if (_batch.flush(error_msg) != XORP_OK)
+	XLOG_ERROR("%s", error_msg.c_str());
+
+    //
+    // Map each failure back to the entry, and report it the same way
+    // as the corresponding transaction operation.
+    //
+    const NetlinkSocketBatch::FailureMap& failures = _batch.failures();
+    NetlinkSocketBatch::FailureMap::const_iterator iter;
+    for (iter = failures.begin(); iter != failures.end(); ++iter) {
+	map<uint32_t, BatchedRequest>::const_iterator req_iter;
+	req_iter = _batched_requests.find(iter->first);
+	XLOG_ASSERT(req_iter != _batched_requests.end());
+	const BatchedRequest& req = req_iter->second;
+
+	// If the route doesn't exist, maybe something else deleted it.
+	// See delete_entry().
+	if ((! req.is_add) && (iter->second == ESRCH)) {
+	    XLOG_WARNING("Delete route entry failed, route was already gone (will continue), route: %s",
+			 req.fte.str().c_str());
+	    continue;
+	}
+
+	error_msg = c_format("%s%s: %s: %s",
+			     req.is_add ? "AddEntry" : "DeleteEntry",
+			     req.fte.net().is_ipv4() ? "4" : "6",
+			     req.fte.str().c_str(),
+			     strerror(iter->second));
+	XLOG_ERROR("Error checking netlink request: %s", error_msg.c_str());
+	if (_batch_error.empty())
+	    _batch_error = error_msg;
+    }
+
+    _batch.clear_failures();
+    _batched_requests.clear();
+}
+
 #endif // HAVE_NETLINK_SOCKETS
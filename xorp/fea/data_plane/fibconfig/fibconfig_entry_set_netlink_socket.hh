@@ -61,6 +61,40 @@ public:
      */
     virtual int stop(string& error_msg);
 
+    /**
+     * Start a configuration interval.
+     *
+     * Within a configuration interval the requests to the kernel are
+     * batched, and a request that fails is reported when the interval
+     * ends.
+     *
+     * @param error_msg the error message (if error).
+     * @return XORP_OK on success, otherwise XORP_ERROR.
+     */
+    virtual int start_configuration(string& error_msg);
+
+    /**
+     * End of configuration interval.
+     *
+     * Write any batched requests to the kernel and wait for their
+     * acknowledgements.
+     *
+     * @param error_msg the error message for the first request that
+     * failed (if error).
+     * @return XORP_OK on success, otherwise XORP_ERROR.
+     */
+    virtual int end_configuration(string& error_msg);
+
+    /**
+     * Write the batched requests to the kernel.
+     *
+     * A request that failed is reported when the interval ends.
+     *
+     * @param error_msg the error message (if error).
+     * @return XORP_OK on success, otherwise XORP_ERROR.
+     */
+    virtual int flush_configuration(string& error_msg);
+
     /**
      * Add a single IPv4 forwarding entry.
      *
@@ -109,7 +143,38 @@ private:
     int add_entry(const FteX& fte);
     int delete_entry(const FteX& fte);
 
+    /**
+     * Add a request to the batch, and write the batch if it is full.
+     *
+     * @param nlh the request.
+     * @param fte the entry the request is for.
+     * @param is_add true if the request adds the entry, false if it
+     * deletes it.
+     * @return XORP_OK on success, otherwise XORP_ERROR.
+     */
+    int batch_request(const struct nlmsghdr* nlh, const FteX& fte,
+		      bool is_add);
+
+    /**
+     * Write the batched requests and check their acknowledgements.
+     */
+    void flush_batch();
+
+    // The largest batch we write with a single sendto()
+    static const size_t BATCH_BYTES = 32*1024;
+    // At most this many acknowledgements are queued on the socket
+    static const size_t BATCH_REQUESTS = 128;
+
+    struct BatchedRequest {
+	BatchedRequest(const FteX& f, bool a) : fte(f), is_add(a) {}
+	FteX	fte;
+	bool	is_add;
+    };
+
     NetlinkSocketReader _ns_reader;
+    NetlinkSocketBatch	_batch;
+    map<uint32_t, BatchedRequest> _batched_requests; // Keyed by seqno
+    string		_batch_error;	// The first failure in this interval
 };
 
 #endif
@@ -939,6 +939,25 @@ FibConfig::end_configuration(string& error_msg)
     return (ret_value);
 }
 
+void
+FibConfig::flush_configuration()
+{
+    list<FibConfigEntrySet*>::iterator fibconfig_entry_set_iter;
+    string error_msg;
+
+    //
+    // XXX: a failure is reported again by end_configuration(), which
+    // ends the interval the requests belong to.
+    //
+    for (fibconfig_entry_set_iter = _fibconfig_entry_sets.begin();
+	 fibconfig_entry_set_iter != _fibconfig_entry_sets.end();
+	 ++fibconfig_entry_set_iter) {
+	FibConfigEntrySet* fibconfig_entry_set = *fibconfig_entry_set_iter;
+	if (fibconfig_entry_set->flush_configuration(error_msg) != XORP_OK)
+	    XLOG_ERROR("%s", error_msg.c_str());
+    }
+}
+
 int
 FibConfig::set_unicast_forwarding_entries_retain_on_startup4(bool retain,
 							     string& error_msg)
@@ -1257,6 +1276,8 @@ FibConfig::delete_all_entries4()
     if (_fibconfig_table_sets.empty())
 	return (XORP_ERROR);
 
+    flush_configuration();
+
     for (fibconfig_table_set_iter = _fibconfig_table_sets.begin();
 	 fibconfig_table_set_iter != _fibconfig_table_sets.end();
 	 ++fibconfig_table_set_iter) {
@@ -1274,6 +1295,8 @@ FibConfig::lookup_route_by_dest4(const IPv4& dst, Fte4& fte)
     if (_fibconfig_entry_gets.empty())
 	return (XORP_ERROR);
 
+    flush_configuration();
+
     //
     // XXX: We pull the information by using only the first method.
     // In the future we need to rething this and be more flexible.
@@ -1292,6 +1315,8 @@ FibConfig::lookup_route_by_network4(const IPv4Net& dst, Fte4& fte)
     if (_fibconfig_entry_gets.empty())
 	return (XORP_ERROR);
 
+    flush_configuration();
+
     //
     // XXX: We pull the information by using only the first method.
     // In the future we need to rething this and be more flexible.
@@ -1310,6 +1335,8 @@ FibConfig::get_table4(list<Fte4>& fte_list)
     if (_fibconfig_table_gets.empty())
 	return (XORP_ERROR);
 
+    flush_configuration();
+
     //
     // XXX: We pull the information by using only the first method.
     // In the future we need to rething this and be more flexible.
@@ -1393,6 +1420,8 @@ FibConfig::delete_all_entries6()
     if (_fibconfig_table_sets.empty())
 	return (XORP_ERROR);
 
+    flush_configuration();
+
     for (fibconfig_table_set_iter = _fibconfig_table_sets.begin();
 	 fibconfig_table_set_iter != _fibconfig_table_sets.end();
 	 ++fibconfig_table_set_iter) {
@@ -1410,6 +1439,8 @@ FibConfig::lookup_route_by_dest6(const IPv6& dst, Fte6& fte)
     if (_fibconfig_entry_gets.empty())
 	return (XORP_ERROR);
 
+    flush_configuration();
+
     //
     // XXX: We pull the information by using only the first method.
     // In the future we need to rething this and be more flexible.
@@ -1428,6 +1459,8 @@ FibConfig::lookup_route_by_network6(const IPv6Net& dst, Fte6& fte)
     if (_fibconfig_entry_gets.empty())
 	return (XORP_ERROR);
 
+    flush_configuration();
+
     //
     // XXX: We pull the information by using only the first method.
     // In the future we need to rething this and be more flexible.
@@ -1446,6 +1479,8 @@ FibConfig::get_table6(list<Fte6>& fte_list)
     if (_fibconfig_table_gets.empty())
 	return (XORP_ERROR);
 
+    flush_configuration();
+
     //
     // XXX: We pull the information by using only the first method.
     // In the future we need to rething this and be more flexible.
@@ -743,6 +743,13 @@ protected:
     Trie6	_trie6;		// IPv6 trie (used for testing purpose)
 
 private:
+    /**
+     * Write the requests that the entry plugins hold back within a
+     * configuration interval, so that a read of the forwarding table
+     * sees them.
+     */
+    void flush_configuration();
+
     mutable bool vrf_queried;
     mutable string vrf_name;
 
@@ -117,6 +117,22 @@ public:
 	// Nothing particular to do, just label start.
 	return mark_configuration_end(error_msg);
     }
+
+    /**
+     * Write any requests held back within the current configuration
+     * interval.
+     *
+     * A read of the forwarding table only sees the requests that have
+     * been written, so it is preceded by a call to this method.
+     *
+     * @param error_msg the error message (if error).
+     * @return XORP_OK on success, otherwise XORP_ERROR.
+     */
+    virtual int flush_configuration(string& error_msg) {
+	UNUSED(error_msg);
+	// Nothing particular to do, no requests are held back.
+	return (XORP_OK);
+    }
     
     /**
      * Add a single IPv4 forwarding entry.
@@ -0,0 +1,435 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+// vim:set sts=4 ts=8:
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+#include "fea_module.h"
+
+#include "libxorp/xorp.h"
+#include "libxorp/xlog.h"
+#include "libxorp/debug.h"
+#include "libxorp/eventloop.hh"
+#include "libxorp/ipv4net.hh"
+
+#ifdef HAVE_GETOPT_H
+#include <getopt.h>
+#endif
+#ifdef HAVE_SYS_SOCKET_H
+#include <sys/socket.h>
+#endif
+#ifdef HAVE_LINUX_TYPES_H
+#include <linux/types.h>
+#endif
+#ifdef HAVE_LINUX_RTNETLINK_H
+#include <linux/rtnetlink.h>
+#endif
+
+#include "data_plane/control_socket/netlink_socket.hh"
+
+#ifdef HAVE_NETLINK_SOCKETS
+
+//
+// Measure the rate at which routes can be written to the kernel with
+// one request and acknowledgement at a time, as FibConfigEntrySetNetlinkSocket
+// does outside a configuration interval, against writing them in batches.
+//
+// The kernel is replaced by DummyNetlinkSocket, so that no privileges
+// are needed and the forwarding table of the host is left alone.  Each
+// write is carried over a socket pair and every request is acknowledged
+// with a datagram of its own, as the kernel does, so the number of
+// system calls per route is the same as with a real netlink socket.
+//
+
+namespace {
+
+/**
+ * A netlink socket that talks to a fake kernel over a socket pair.
+ *
+ * Every request is acknowledged with NLMSG_ERROR.  Every fail_every'th
+ * request is refused with EEXIST.
+ */
+class DummyNetlinkSocket : public NetlinkSocket {
+public:
+    DummyNetlinkSocket(EventLoop& eventloop, uint32_t fail_every);
+    ~DummyNetlinkSocket();
+
+    ssize_t sendto(const void* data, size_t nbytes, int flags,
+		   const struct sockaddr* to, socklen_t tolen);
+    int force_recvmsg_flgs(int flags, bool only_kernel_messages,
+			   string& error_msg);
+
+    uint32_t refused() const { return _refused; }
+
+private:
+    /**
+     * Read the requests from the socket pair, and queue an
+     * acknowledgement for each of them.
+     */
+    void kernel();
+
+    /**
+     * Move the queued acknowledgements to the socket pair until it is
+     * full.
+     */
+    void pump();
+
+    static const size_t BUFFER_BYTES = 256*1024;
+
+    int			_fds[2];	// User end, kernel end
+    list<vector<uint8_t> > _backlog;	// Acknowledgements not yet written
+    vector<uint8_t>	_buffer;
+    uint32_t		_fail_every;
+    uint32_t		_requests;
+    uint32_t		_refused;
+};
+
+DummyNetlinkSocket::DummyNetlinkSocket(EventLoop& eventloop,
+				       uint32_t fail_every)
+    : NetlinkSocket(eventloop, 0),
+      _buffer(BUFFER_BYTES),
+      _fail_every(fail_every),
+      _requests(0),
+      _refused(0)
+{
+    if (socketpair(AF_UNIX, SOCK_DGRAM, 0, _fds) < 0)
+	XLOG_FATAL("socketpair() failed: %s", strerror(errno));
+}
+
+DummyNetlinkSocket::~DummyNetlinkSocket()
+{
+    close(_fds[0]);
+    close(_fds[1]);
+}
+
+ssize_t
+DummyNetlinkSocket::sendto(const void* data, size_t nbytes, int flags,
+			   const struct sockaddr* to, socklen_t tolen)
+{
+    UNUSED(to);
+    UNUSED(tolen);
+
+    next_seqno();		// XXX: keep the seqno as NetlinkSocket does
+    ssize_t sent = ::send(_fds[0], data, nbytes, flags);
+    if (sent < 0)
+	return (sent);
+
+    // The kernel processes the requests before sendto() returns.
+    kernel();
+
+    return (sent);
+}
+
+int
+DummyNetlinkSocket::force_recvmsg_flgs(int flags, bool only_kernel_messages,
+				       string& error_msg)
+{
+    UNUSED(only_kernel_messages);
+
+    ssize_t got = ::recv(_fds[0], &_buffer[0], _buffer.size(), flags);
+    if (got < 0) {
+	if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+	    return (XORP_ERROR);
+	error_msg = c_format("Dummy netlink socket recv error: %s",
+			     strerror(errno));
+	return (XORP_ERROR);
+    }
+    pump();
+
+    vector<uint8_t> message(_buffer.begin(), _buffer.begin() + got);
+    notify_observers(message);
+
+    return (XORP_OK);
+}
+
+void
+DummyNetlinkSocket::kernel()
+{
+    ssize_t got = ::recv(_fds[1], &_buffer[0], _buffer.size(), 0);
+    if (got < 0)
+	XLOG_FATAL("Dummy kernel recv error: %s", strerror(errno));
+
+    size_t buffer_bytes = got;
+    for (struct nlmsghdr* nlh = (struct nlmsghdr*)(&_buffer[0]);
+	 NLMSG_OK(nlh, buffer_bytes);
+	 nlh = NLMSG_NEXT(nlh, buffer_bytes)) {
+	vector<uint8_t> ack(NLMSG_SPACE(sizeof(struct nlmsgerr)), 0);
+	struct nlmsghdr* ack_nlh = (struct nlmsghdr*)(&ack[0]);
+	struct nlmsgerr* err = (struct nlmsgerr*)(NLMSG_DATA(ack_nlh));
+
+	ack_nlh->nlmsg_len = NLMSG_LENGTH(sizeof(*err));
+	ack_nlh->nlmsg_type = NLMSG_ERROR;
+	ack_nlh->nlmsg_seq = nlh->nlmsg_seq;
+	ack_nlh->nlmsg_pid = nlh->nlmsg_pid;
+	err->msg = *nlh;
+	if ((_fail_every != 0) && (++_requests % _fail_every == 0)) {
+	    err->error = -EEXIST;
+	    _refused++;
+	}
+	_backlog.push_back(ack);
+    }
+
+    pump();
+}
+
+void
+DummyNetlinkSocket::pump()
+{
+    while (! _backlog.empty()) {
+	const vector<uint8_t>& ack = _backlog.front();
+	if (::send(_fds[1], &ack[0], ack.size(), MSG_DONTWAIT) < 0)
+	    break;
+	_backlog.pop_front();
+    }
+}
+
+/**
+ * Encode the request to add a route, the way that
+ * FibConfigEntrySetNetlinkSocket::add_entry() does.
+ */
+void
+encode_route(vector<uint8_t>& buffer, uint32_t seqno, uint32_t pid,
+	     const IPv4Net& net, const IPv4& nexthop)
+{
+    buffer.assign(NLMSG_SPACE(sizeof(struct rtmsg))
+		  + RTA_SPACE(IPv4::addr_bytelen()) * 2
+		  + RTA_SPACE(sizeof(int)) * 2, 0);
+
+    struct nlmsghdr* nlh = (struct nlmsghdr*)(&buffer[0]);
+    nlh->nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
+    nlh->nlmsg_type = RTM_NEWROUTE;
+    nlh->nlmsg_flags = NLM_F_REQUEST | NLM_F_CREATE | NLM_F_REPLACE | NLM_F_ACK;
+    nlh->nlmsg_seq = seqno;
+    nlh->nlmsg_pid = pid;
+
+    struct rtmsg* rtmsg = static_cast<struct rtmsg*>(NLMSG_DATA(nlh));
+    rtmsg->rtm_family = AF_INET;
+    rtmsg->rtm_dst_len = net.prefix_len();
+    rtmsg->rtm_protocol = RTPROT_STATIC;
+    rtmsg->rtm_scope = RT_SCOPE_UNIVERSE;
+    rtmsg->rtm_type = RTN_UNICAST;
+    rtmsg->rtm_flags = RTM_F_NOTIFY;
+    rtmsg->rtm_table = RT_TABLE_MAIN;
+
+    int if_index = 2;
+    int priority = 1;
+    struct {
+	int		type;
+	const void*	data;
+	size_t		len;
+    } attrs[] = {
+	{ RTA_DST, 0, IPv4::addr_bytelen() },
+	{ RTA_GATEWAY, 0, IPv4::addr_bytelen() },
+	{ RTA_OIF, &if_index, sizeof(if_index) },
+	{ RTA_PRIORITY, &priority, sizeof(priority) },
+    };
+    for (size_t i = 0; i < sizeof(attrs) / sizeof(attrs[0]); i++) {
+	struct rtattr* rtattr = (struct rtattr*)(&buffer[0]
+						 + NLMSG_ALIGN(nlh->nlmsg_len));
+	rtattr->rta_type = attrs[i].type;
+	rtattr->rta_len = RTA_LENGTH(attrs[i].len);
+	uint8_t* data = static_cast<uint8_t*>(RTA_DATA(rtattr));
+	if (attrs[i].type == RTA_DST)
+	    net.masked_addr().copy_out(data);
+	else if (attrs[i].type == RTA_GATEWAY)
+	    nexthop.copy_out(data);
+	else
+	    memcpy(data, attrs[i].data, attrs[i].len);
+	nlh->nlmsg_len = NLMSG_ALIGN(nlh->nlmsg_len) + rtattr->rta_len;
+    }
+}
+
+IPv4Net
+route_net(uint32_t i)
+{
+    return IPv4Net(IPv4(htonl(0x0a000000 + (i << 8))), 24);
+}
+
+struct Result {
+    Result() : writes(0), failures(0), usecs(0.0) {}
+    uint32_t	writes;
+    uint32_t	failures;
+    double	usecs;
+};
+
+/**
+ * Add the routes one at a time, waiting for each acknowledgement.
+ */
+Result
+one_by_one(EventLoop& eventloop, uint32_t routes, uint32_t fail_every)
+{
+    DummyNetlinkSocket ns(eventloop, fail_every);
+    NetlinkSocketReader reader(ns);
+    vector<uint8_t> buffer;
+    IPv4 nexthop("192.0.2.1");
+    Result result;
+    TimeVal start, end;
+
+    TimerList::system_gettimeofday(&start);
+    for (uint32_t i = 0; i < routes; i++) {
+	string error_msg;
+	encode_route(buffer, ns.seqno(), ns.nl_pid(), route_net(i), nexthop);
+	struct nlmsghdr* nlh = (struct nlmsghdr*)(&buffer[0]);
+	uint32_t seqno = nlh->nlmsg_seq;
+
+	result.writes++;
+	if (ns.sendto(&buffer[0], nlh->nlmsg_len, 0, NULL, 0)
+	    != (ssize_t)nlh->nlmsg_len)
+	    XLOG_FATAL("Error writing to netlink socket: %s", strerror(errno));
+	if (reader.receive_data(ns, seqno, error_msg) != XORP_OK)
+	    XLOG_FATAL("No acknowledgement: %s", error_msg.c_str());
+
+	const vector<uint8_t>& ack = reader.buffer();
+	const struct nlmsghdr* ack_nlh = (const struct nlmsghdr*)(&ack[0]);
+	const struct nlmsgerr* err
+	    = (const struct nlmsgerr*)(NLMSG_DATA(ack_nlh));
+	XLOG_ASSERT(ack_nlh->nlmsg_type == NLMSG_ERROR);
+	if (err->error != 0)
+	    result.failures++;
+    }
+    TimerList::system_gettimeofday(&end);
+
+    XLOG_ASSERT(result.failures == ns.refused());
+    result.usecs = (end - start).get_double() * 1.0e6;
+
+    return result;
+}
+
+/**
+ * Add the routes in batches.
+ */
+Result
+batched(EventLoop& eventloop, uint32_t routes, uint32_t fail_every,
+	size_t max_bytes, size_t max_requests)
+{
+    DummyNetlinkSocket ns(eventloop, fail_every);
+    NetlinkSocketBatch batch(ns, max_bytes, max_requests);
+    vector<uint8_t> buffer;
+    IPv4 nexthop("192.0.2.1");
+    Result result;
+    TimeVal start, end;
+    string error_msg;
+
+    TimerList::system_gettimeofday(&start);
+    for (uint32_t i = 0; i < routes; i++) {
+	encode_route(buffer, ns.next_seqno(), ns.nl_pid(), route_net(i),
+		     nexthop);
+	batch.add_request((struct nlmsghdr*)(&buffer[0]));
+	if (batch.is_full() && batch.flush(error_msg) != XORP_OK)
+	    XLOG_FATAL("%s", error_msg.c_str());
+    }
+    if (batch.flush(error_msg) != XORP_OK)
+	XLOG_FATAL("%s", error_msg.c_str());
+    TimerList::system_gettimeofday(&end);
+
+    XLOG_ASSERT(batch.requests() == routes);
+    result.writes = batch.writes();
+    result.failures = batch.failures().size();
+    XLOG_ASSERT(result.failures == ns.refused());
+    result.usecs = (end - start).get_double() * 1.0e6;
+
+    return result;
+}
+
+void
+print_result(const char* mode, uint32_t routes, const Result& result)
+{
+    printf("%-12s %8u %8u %8u %12.2f %12.0f\n", mode, routes,
+	   result.writes, result.failures, result.usecs / routes,
+	   routes * 1.0e6 / result.usecs);
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char *argv[])
+{
+    uint32_t routes = 100000;
+    uint32_t fail_every = 0;
+    size_t max_bytes = 32*1024;
+    size_t max_requests = 128;
+    int ch;
+
+    xlog_init(argv[0], NULL);
+    xlog_set_verbose(XLOG_VERBOSE_LOW);
+    xlog_level_set_verbose(XLOG_LEVEL_ERROR, XLOG_VERBOSE_HIGH);
+    xlog_add_default_output();
+    xlog_start();
+
+    while ((ch = getopt(argc, argv, "hn:f:b:r:")) != -1) {
+	switch (ch) {
+	case 'n':
+	    routes = atoi(optarg);
+	    break;
+	case 'f':
+	    fail_every = atoi(optarg);
+	    break;
+	case 'b':
+	    max_bytes = atoi(optarg);
+	    break;
+	case 'r':
+	    max_requests = atoi(optarg);
+	    break;
+	case 'h':
+	default:
+	    printf("Usage: %s <opts>\n"
+		   "-h\thelp\n"
+		   "-n <n>\tnumber of routes [%u]\n"
+		   "-f <n>\trefuse every n'th request, 0 for none [%u]\n"
+		   "-b <n>\tlargest batch in bytes [%u]\n"
+		   "-r <n>\tlargest batch in requests [%u]\n"
+		   , argv[0], routes, fail_every,
+		   XORP_UINT_CAST(max_bytes), XORP_UINT_CAST(max_requests));
+	    exit(1);
+	}
+    }
+    if (routes == 0)
+	routes = 1;
+    if (max_requests == 0)
+	max_requests = 1;
+
+    EventLoop eventloop;
+
+    printf("%-12s %8s %8s %8s %12s %12s\n", "mode", "routes", "writes",
+	   "failed", "usec/route", "routes/sec");
+    print_result("one-by-one", routes,
+		 one_by_one(eventloop, routes, fail_every));
+    print_result("batched", routes,
+		 batched(eventloop, routes, fail_every, max_bytes,
+			 max_requests));
+
+    xlog_stop();
+    xlog_exit();
+
+    return 0;
+}
+
+#else // ! HAVE_NETLINK_SOCKETS
+
+int
+main(int argc, char *argv[])
+{
+    UNUSED(argc);
+
+    printf("%s: netlink sockets are not supported\n", argv[0]);
+
+    return 0;
+}
+
+#endif // ! HAVE_NETLINK_SOCKETS
@@ -0,0 +1,278 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+// vim:set sts=4 ts=8:
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+#include "fea/fea_module.h"
+
+#include "libxorp/xorp.h"
+#include "libxorp/xlog.h"
+#include "libxorp/eventloop.hh"
+#include "libxorp/test_main.hh"
+
+#include "fea/fea_io.hh"
+#include "fea/fea_node.hh"
+#include "fea/fibconfig.hh"
+#include "fea/data_plane/managers/fea_data_plane_manager_dummy.hh"
+#include "fea/data_plane/fibconfig/fibconfig_entry_set_dummy.hh"
+#include "fea/data_plane/fibconfig/fibconfig_table_get_dummy.hh"
+#include "fea/data_plane/fibconfig/fibconfig_table_set_netlink_socket.hh"
+
+#ifdef HAVE_NETLINK_SOCKETS
+
+//
+// Within a configuration interval FibConfigEntrySetNetlinkSocket holds
+// the requests back and writes them in batches.  A read of the
+// forwarding table, such as the one delete_all_entries4() makes to find
+// the XORP routes, must first write the requests held back, or it
+// misses the routes just added.
+//
+// DeferredEntrySet holds the requests back in the same way, on top of
+// the dummy forwarding table, so that no privileges are needed.
+//
+
+namespace {
+
+class DeferredEntrySet : public FibConfigEntrySetDummy {
+public:
+    DeferredEntrySet(FeaDataPlaneManager& fea_data_plane_manager)
+	: FibConfigEntrySetDummy(fea_data_plane_manager) {}
+
+    int end_configuration(string& error_msg) {
+	flush_configuration(error_msg);
+	return (FibConfigEntrySetDummy::end_configuration(error_msg));
+    }
+
+    int flush_configuration(string& error_msg) {
+	UNUSED(error_msg);
+
+	for (size_t i = 0; i < _held4.size(); i++) {
+	    if (_held4[i].second)
+		FibConfigEntrySetDummy::add_entry4(_held4[i].first);
+	    else
+		FibConfigEntrySetDummy::delete_entry4(_held4[i].first);
+	}
+	for (size_t i = 0; i < _held6.size(); i++) {
+	    if (_held6[i].second)
+		FibConfigEntrySetDummy::add_entry6(_held6[i].first);
+	    else
+		FibConfigEntrySetDummy::delete_entry6(_held6[i].first);
+	}
+	_held4.clear();
+	_held6.clear();
+
+	return (XORP_OK);
+    }
+
+    int add_entry4(const Fte4& fte) { return hold(_held4, fte, true); }
+    int delete_entry4(const Fte4& fte) { return hold(_held4, fte, false); }
+    int add_entry6(const Fte6& fte) { return hold(_held6, fte, true); }
+    int delete_entry6(const Fte6& fte) { return hold(_held6, fte, false); }
+
+private:
+    template <class F>
+    int hold(vector<pair<F, bool> >& held, const F& fte, bool is_add) {
+	if (in_configuration() == false)
+	    return (XORP_ERROR);
+	held.push_back(make_pair(fte, is_add));
+	return (XORP_OK);
+    }
+
+    vector<pair<Fte4, bool> >	_held4;
+    vector<pair<Fte6, bool> >	_held6;
+};
+
+/**
+ * A FeaIo with no one to watch.
+ */
+class DummyFeaIo : public FeaIo {
+public:
+    DummyFeaIo(EventLoop& eventloop) : FeaIo(eventloop) {}
+
+    int register_instance_event_interest(const string& instance_name,
+					 string& error_msg) {
+	UNUSED(instance_name);
+	UNUSED(error_msg);
+	return (XORP_OK);
+    }
+
+    int deregister_instance_event_interest(const string& instance_name,
+					   string& error_msg) {
+	UNUSED(instance_name);
+	UNUSED(error_msg);
+	return (XORP_OK);
+    }
+};
+
+/**
+ * A FibConfig whose entry and table plugins are the ones above.
+ */
+class FlushTest {
+public:
+    FlushTest()
+	: _fea_io(_eventloop),
+	  _fea_node(_eventloop, _fea_io, true),
+	  _manager(_fea_node),
+	  _entry_set(_manager),
+	  _table_get(_manager),
+	  _table_set(_manager) {
+	fibconfig().register_fibconfig_entry_set(&_entry_set, true);
+	fibconfig().register_fibconfig_table_get(&_table_get, true);
+	fibconfig().register_fibconfig_table_set(&_table_set, true);
+    }
+
+    ~FlushTest() {
+	fibconfig().unregister_fibconfig_table_set(&_table_set);
+	fibconfig().unregister_fibconfig_table_get(&_table_get);
+	fibconfig().unregister_fibconfig_entry_set(&_entry_set);
+    }
+
+    FibConfig& fibconfig() { return _fea_node.fibconfig(); }
+
+private:
+    EventLoop				_eventloop;
+    DummyFeaIo				_fea_io;
+    FeaNode				_fea_node;
+    FeaDataPlaneManagerDummy		_manager;
+    DeferredEntrySet			_entry_set;
+    FibConfigTableGetDummy		_table_get;
+    FibConfigTableSetNetlinkSocket	_table_set;
+};
+
+}
+
+bool
+test_get_table(TestInfo& info)
+{
+    FlushTest t;
+    FibConfig& fc = t.fibconfig();
+    string error_msg;
+
+    Fte4 fte4(IPv4Net("10.0.1.0/24"), IPv4("192.168.0.1"), "eth0", "eth0",
+	      1, 1, true);
+    Fte6 fte6(IPv6Net("2001:db8:1::/48"), IPv6("fe80::1"), "eth0", "eth0",
+	      1, 1, true);
+
+    fc.start_configuration(error_msg);
+    fc.add_entry4(fte4);
+    fc.add_entry6(fte6);
+
+    list<Fte4> table4;
+    list<Fte6> table6;
+    fc.get_table4(table4);
+    fc.get_table6(table6);
+
+    fc.end_configuration(error_msg);
+
+    if (table4.size() != 1 || table6.size() != 1) {
+	DOUT(info) << "the table read holds " << table4.size() << " IPv4 and "
+		   << table6.size() << " IPv6 entries, not 1 of each\n";
+	return false;
+    }
+
+    return true;
+}
+
+bool
+test_delete_all(TestInfo& info)
+{
+    FlushTest t;
+    FibConfig& fc = t.fibconfig();
+    string error_msg;
+
+    Fte4 old4(IPv4Net("10.0.1.0/24"), IPv4("192.168.0.1"), "eth0", "eth0",
+	      1, 1, true);
+    Fte4 fte4(IPv4Net("10.0.2.0/24"), IPv4("192.168.0.1"), "eth0", "eth0",
+	      1, 1, true);
+    Fte6 fte6(IPv6Net("2001:db8:2::/48"), IPv6("fe80::1"), "eth0", "eth0",
+	      1, 1, true);
+
+    fc.start_configuration(error_msg);
+    fc.add_entry4(old4);
+    fc.end_configuration(error_msg);
+
+    fc.start_configuration(error_msg);
+    fc.add_entry4(fte4);
+    fc.add_entry6(fte6);
+    fc.delete_all_entries4();
+    fc.delete_all_entries6();
+    fc.end_configuration(error_msg);
+
+    if (fc.trie4().route_count() != 0 || fc.trie6().route_count() != 0) {
+	DOUT(info) << fc.trie4().route_count() << " IPv4 and "
+		   << fc.trie6().route_count()
+		   << " IPv6 entries are left after deleting them all\n";
+	return false;
+    }
+
+    return true;
+}
+
+#endif // HAVE_NETLINK_SOCKETS
+
+int
+main(int argc, char** argv)
+{
+    XorpUnexpectedHandler x(xorp_unexpected_handler);
+
+    xlog_init(argv[0], NULL);
+    xlog_set_verbose(XLOG_VERBOSE_HIGH);
+    xlog_add_default_output();
+    xlog_start();
+
+    TestMain t(argc, argv);
+
+    string test_name =
+	t.get_optional_args("-t", "--test", "run only the specified test");
+    t.complete_args_parsing();
+
+#ifdef HAVE_NETLINK_SOCKETS
+    try {
+	struct test {
+	    string test_name;
+	    XorpCallback1<bool, TestInfo&>::RefPtr cb;
+	} tests[] = {
+	    {"get_table", callback(test_get_table)},
+	    {"delete_all", callback(test_delete_all)},
+	};
+
+	if ("" == test_name) {
+	    for (unsigned int i = 0; i < sizeof(tests) / sizeof(struct test);
+		 i++)
+		t.run(tests[i].test_name, tests[i].cb);
+	} else {
+	    for (unsigned int i = 0; i < sizeof(tests) / sizeof(struct test);
+		 i++)
+		if (test_name == tests[i].test_name) {
+		    t.run(tests[i].test_name, tests[i].cb);
+		    return t.exit();
+		}
+	    t.failed("No test with name " + test_name + " found\n");
+	}
+    } catch (...) {
+	xorp_catch_standard_exceptions();
+    }
+#endif
+
+    xlog_stop();
+    xlog_exit();
+
+    return t.exit();
+}
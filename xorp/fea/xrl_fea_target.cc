@@ -2189,6 +2189,57 @@ XrlFeaTarget::redist_transaction6_0_1_delete_route(
     return XrlCmdError::OKAY();
 }
 
+XrlCmdError
+XrlFeaTarget::redist_transaction6_0_1_update_routes(
+    // Input values,
+    const uint32_t&	tid,
+    const XrlAtomList&	adds,
+    const XrlAtomList&	dsts,
+    const XrlAtomList&	nexthops,
+    const XrlAtomList&	ifnames,
+    const XrlAtomList&	vifnames,
+    const XrlAtomList&	metrics,
+    const XrlAtomList&	admin_distances,
+    const string&	cookie,
+    const XrlAtomList&	protocol_origins)
+{
+    size_t n = adds.size();
+    if (dsts.size() != n || nexthops.size() != n || ifnames.size() != n
+	|| vifnames.size() != n || metrics.size() != n
+	|| admin_distances.size() != n || protocol_origins.size() != n)
+	return XrlCmdError::BAD_ARGS("Mismatched list lengths");
+
+    debug_msg("redist_transaction6_0_1_update_routes(): %u updates\n",
+	      XORP_UINT_CAST(n));
+
+    XrlCmdError result = XrlCmdError::OKAY();
+    try {
+	for (size_t i = 0; i < n; i++) {
+	    XrlCmdError e = XrlCmdError::OKAY();
+	    if (adds.get(i).boolean()) {
+		e = redist_transaction6_0_1_add_route(
+		    tid, dsts.get(i).ipv6net(), nexthops.get(i).ipv6(),
+		    ifnames.get(i).text(), vifnames.get(i).text(),
+		    metrics.get(i).uint32(), admin_distances.get(i).uint32(),
+		    cookie, protocol_origins.get(i).text());
+	    } else {
+		e = redist_transaction6_0_1_delete_route(
+		    tid, dsts.get(i).ipv6net(), nexthops.get(i).ipv6(),
+		    ifnames.get(i).text(), vifnames.get(i).text(),
+		    metrics.get(i).uint32(), admin_distances.get(i).uint32(),
+		    cookie, protocol_origins.get(i).text());
+	    }
+	    // Apply the rest of the batch, but report the first failure
+	    if (! e.isOK() && result.isOK())
+		result = e;
+	}
+    } catch (const XrlAtom::WrongType& e) {
+	return XrlCmdError::BAD_ARGS(e.str());
+    }
+
+    return result;
+}
+
 XrlCmdError
 XrlFeaTarget::redist_transaction6_0_1_delete_all_routes(
     // Input values,
@@ -3529,6 +3580,57 @@ XrlFeaTarget::redist_transaction4_0_1_delete_route(
     return XrlCmdError::OKAY();
 }
 
+XrlCmdError
+XrlFeaTarget::redist_transaction4_0_1_update_routes(
+    // Input values,
+    const uint32_t&	tid,
+    const XrlAtomList&	adds,
+    const XrlAtomList&	dsts,
+    const XrlAtomList&	nexthops,
+    const XrlAtomList&	ifnames,
+    const XrlAtomList&	vifnames,
+    const XrlAtomList&	metrics,
+    const XrlAtomList&	admin_distances,
+    const string&	cookie,
+    const XrlAtomList&	protocol_origins)
+{
+    size_t n = adds.size();
+    if (dsts.size() != n || nexthops.size() != n || ifnames.size() != n
+	|| vifnames.size() != n || metrics.size() != n
+	|| admin_distances.size() != n || protocol_origins.size() != n)
+	return XrlCmdError::BAD_ARGS("Mismatched list lengths");
+
+    debug_msg("redist_transaction4_0_1_update_routes(): %u updates\n",
+	      XORP_UINT_CAST(n));
+
+    XrlCmdError result = XrlCmdError::OKAY();
+    try {
+	for (size_t i = 0; i < n; i++) {
+	    XrlCmdError e = XrlCmdError::OKAY();
+	    if (adds.get(i).boolean()) {
+		e = redist_transaction4_0_1_add_route(
+		    tid, dsts.get(i).ipv4net(), nexthops.get(i).ipv4(),
+		    ifnames.get(i).text(), vifnames.get(i).text(),
+		    metrics.get(i).uint32(), admin_distances.get(i).uint32(),
+		    cookie, protocol_origins.get(i).text());
+	    } else {
+		e = redist_transaction4_0_1_delete_route(
+		    tid, dsts.get(i).ipv4net(), nexthops.get(i).ipv4(),
+		    ifnames.get(i).text(), vifnames.get(i).text(),
+		    metrics.get(i).uint32(), admin_distances.get(i).uint32(),
+		    cookie, protocol_origins.get(i).text());
+	    }
+	    // Apply the rest of the batch, but report the first failure
+	    if (! e.isOK() && result.isOK())
+		result = e;
+	}
+    } catch (const XrlAtom::WrongType& e) {
+	return XrlCmdError::BAD_ARGS(e.str());
+    }
+
+    return result;
+}
+
 XrlCmdError
 XrlFeaTarget::redist_transaction4_0_1_delete_all_routes(
     // Input values,
@@ -24,8 +24,6 @@
 #ifndef __LIBPROTO_SPT_HH__
 #define __LIBPROTO_SPT_HH__
 
-// #define INCREMENTAL_SPT
-
 #include "libxorp/ref_ptr.hh"
 #include "libxorp/c_format.hh"
 
@@ -50,7 +48,7 @@ class Spt {
     //    typedef Node<A>::NodeRef NodeRef;
     typedef map<A, typename Node<A>::NodeRef> Nodes;
 
-    Spt(bool trace = true) : _trace(trace)
+    Spt(bool trace = true) : _trace(trace), _next_id(0), _full(true)
     {}
 
     ~Spt();
@@ -135,15 +133,41 @@ class Spt {
      */
     bool remove_edge(const A& src, const A& dst);
     
+    /**
+     * Make this graph the same as another graph.
+     *
+     * Nodes and edges are added, updated and removed as necessary. The
+     * changes are recorded so that the next compute() only has to
+     * revisit the part of the tree that they affect. Used by clients
+     * that find it easier to build a new graph from scratch than to
+     * work out what has changed.
+     *
+     * @param graph the graph to copy, it must have an origin.
+     * @return true on success.
+     */
+    bool sync(Spt<A>& graph);
+
     /**
      * Compute the tree.
      *
+     * After the first computation only the subtrees affected by the
+     * changes made since the previous computation are recomputed,
+     * unless the changes are too large or the origin has moved.
+     *
      * @param routes a list of route adds, deletes and replaces that must be
      * performed.
      * @return true on success
      */
     bool compute(list<RouteCmd<A> >& routes);
 
+    /**
+     * The routes to all the reachable nodes as found by the last
+     * compute(), presented as adds.
+     *
+     * @param routes the list to append the routes to.
+     */
+    void current_routes(list<RouteCmd<A> >& routes);
+
     /**
      * Convert this graph to presentation format.
      *
@@ -178,9 +202,47 @@ class Spt {
      */
     void garbage_collect();
 
+    /**
+     * Forget the changes recorded for the incremental computation.
+     */
+    void clear_changes();
+
+    /**
+     * @return the path length to a node that is not tentative.
+     */
+    int path_length(typename Node<A>::NodeRef n) {
+	return n == _origin ? 0 : n->get_path_length();
+    }
+
     typename Node<A>::NodeRef _origin;	// Origin node
 
     Nodes _nodes;		// Nodes
+
+    // Every node is given a dense identifier so that per node state
+    // in the PriorityQueue can be held in arrays rather than in trees.
+    size_t _next_id;		// Next never used identifier.
+    vector<size_t> _free_ids;	// Identifiers of freed nodes.
+
+    /**
+     * @return an identifier not in use by any node.
+     */
+    size_t allocate_id() {
+	if (_free_ids.empty())
+	    return _next_id++;
+	size_t id = _free_ids.back();
+	_free_ids.pop_back();
+	return id;
+    }
+
+    typedef vector<pair<typename Node<A>::NodeRef,
+			typename Node<A>::NodeRef> > EdgeChanges;
+
+    // Changes since the last computation.
+    bool _full;			// True if the next computation must
+				// start from scratch.
+    EdgeChanges _longer;	// Edges removed or made more expensive.
+    EdgeChanges _shorter;	// Edges added or made cheaper.
+    list<typename Node<A>::NodeRef> _removed; // Nodes removed.
 };
 
 template <typename A>
@@ -236,6 +298,11 @@ class Node {
      */
     bool remove_edge(NodeRef dst);
 
+    /**
+     * @return the adjacency list.
+     */
+    const adjacency& get_adjacencies() const { return _adjacencies; }
+
     /**
      * Drop all adjacencies.
      * Used to revive invalid nodes.
@@ -247,6 +314,16 @@ class Node {
      */
     void garbage_collect();
 
+    /**
+     * Set the dense identifier, unique among the nodes of one Spt.
+     */
+    void set_id(size_t id) { _id = id; }
+
+    /**
+     * @return the dense identifier.
+     */
+    size_t id() const { return _id; }
+
     /**
      * Set the valid state.
      */
@@ -288,6 +365,29 @@ class Node {
     void set_adjacent_weights(NodeRef me, int delta_weight,
 			      PriorityQueue<A>& tentative);
 
+    /**
+     * Offer a shorter path.
+     * Used by the incremental computation, if this node is no longer
+     * tentative and the path is shorter than the one already found
+     * the node is made tentative again.
+     *
+     * @param me this node.
+     * @param prev the node before this one on the offered path.
+     * @param weight the length of the offered path.
+     * @param tentative the tentative set.
+     * @return true if the path was accepted.
+     */
+    bool offer_weight(NodeRef me, NodeRef prev, int weight,
+		      PriorityQueue<A>& tentative);
+
+    /**
+     * Offer paths through this node to all the adjacent nodes.
+     * As set_adjacent_weights() but also considers nodes that are no
+     * longer tentative.
+     */
+    void offer_adjacent_weights(NodeRef me, int delta_weight,
+				PriorityQueue<A>& tentative);
+
     /**
      * Set local weight.
      * Set the weight on this node if its tentative and less than the
@@ -303,6 +403,14 @@ class Node {
      */
     int get_local_weight();
 
+    /**
+     * The path length found by the last computation.
+     */
+    int get_path_length() {
+	XLOG_ASSERT(_current._valid);
+	return _current._path_length;
+    }
+
     /**
      * The first hop to this node.
      */
@@ -337,6 +445,14 @@ class Node {
      */
     bool delta(RouteCmd<A>& rcmd);
 
+    /**
+     * The current route to this node.
+     *
+     * @param rcmd filled in with an add for the route.
+     * @return true if the node is reachable.
+     */
+    bool route(RouteCmd<A>& rcmd);
+
     /**
      * Clear all the references to other nodes as well as possible
      * references to ourselves.
@@ -362,6 +478,8 @@ class Node {
     A _nodename;		// Node name, external name of this node.
     adjacency _adjacencies;	// Adjacency list
     bool _trace;		// True of tracing is enabled.
+    size_t _id;			// Dense identifier, used to index the
+				// PriorityQueue.
 
     // private:
     //    friend class Spt<A>;
@@ -407,10 +525,25 @@ class Edge {
 
 /**
  * Tentative nodes in a priority queue.
+ *
+ * An indexed d-ary heap ordered by the local weight of each node. The
+ * position of every queued node is kept in an array indexed by the
+ * node's dense identifier, so lowering the weight of a node that is
+ * already queued is a sift up rather than an erase and an insert.
  */
 template <typename A> 
 class PriorityQueue {
  public:
+    /**
+     * @param ids the number of node identifiers in use, only a hint
+     * used to size the arrays.
+     */
+    PriorityQueue(size_t ids = 0) {
+	_heap.reserve(ids);
+	_position.resize(ids, NOT_QUEUED);
+	_nodes.resize(ids);
+    }
+
     /**
      * Add or Update the weight of a node.
      * @return true if the weight was used.
@@ -422,37 +555,38 @@ class PriorityQueue {
      */
     typename Node<A>::NodeRef pop();
 
-    bool empty() { return _tentative.empty(); }
+    bool empty() { return _heap.empty(); }
  private:
-#ifndef XORP_USE_USTL
-    template <typename B>
-    struct lweight {
-	bool
-	operator ()(const typename Node<B>::NodeRef& a,
-		    const typename Node<B>::NodeRef& b) const {
-	    int aw = a->get_local_weight();
-	    int bw = b->get_local_weight();
-
-	    // If the weights match then sort on node names which must
-	    // be unique.
-	    if (aw == bw)
-		return a.get() < b.get();
-
-	    return aw < bw;
+    static const size_t ARITY = 4;
+    static const size_t NOT_QUEUED = static_cast<size_t>(-1);
+
+    struct Entry {
+	int	_weight;
+	size_t	_id;
+
+	// If the weights match then sort on the identifiers which
+	// are unique.
+	bool operator<(const Entry& other) const {
+	    if (_weight == other._weight)
+		return _id < other._id;
+	    return _weight < other._weight;
 	}
     };
-#endif
 
-#ifdef XORP_USE_USTL
-    // TODO:  I tried making ref-ptr compare work..but don't know if
-    // it is actually functional.  Need to fix up uSTL probably.
-    typedef set<typename Node<A>::NodeRef> Tent;
-#else
-    typedef set<typename Node<A>::NodeRef, lweight<A> > Tent;
-#endif
-    Tent _tentative;
+    void sift_up(size_t i);
+    void sift_down(size_t i);
+
+    vector<Entry> _heap;
+    vector<size_t> _position;	// Heap position by identifier.
+    vector<typename Node<A>::NodeRef> _nodes; // Queued nodes by identifier.
 };
 
+template <typename A>
+const size_t PriorityQueue<A>::ARITY;
+
+template <typename A>
+const size_t PriorityQueue<A>::NOT_QUEUED;
+
 /**
  * The idealised command to execute.
  */
@@ -540,6 +674,10 @@ Spt<A>::clear()
     // Release the origin node by assigning an empty value to its ref_ptr.
     _origin = typename Node<A>::NodeRef();
 
+    // The recorded changes hold references to nodes.
+    clear_changes();
+    _full = true;
+
     // Free all node state in the Spt.
     // A depth first traversal might be more efficient, but we just want
     // to free memory here. Container Nodes knows nothing about the
@@ -560,6 +698,9 @@ Spt<A>::clear()
 	    }
 	}
     }
+
+    _next_id = 0;
+    _free_ids.clear();
 }
 
 template <typename A>
@@ -573,6 +714,10 @@ Spt<A>::set_origin(const A& node)
 	return false;
     }
 
+    // Every path starts at the origin, a new one invalidates them all.
+    if (_origin != srcnode)
+	_full = true;
+
     _origin = srcnode;
     return true;
 }
@@ -593,11 +738,13 @@ Spt<A>::add_node(const A& node)
 	    // info.
 	    srcnode->drop_adjacencies();
 	    srcnode->set_valid(true);
+	    _full = true;
 	    return true;
 	}
     }
 
     Node<A> *n = new Node<A>(node, _trace);
+    n->set_id(allocate_id());
     _nodes[node] = typename Node<A>::NodeRef(n);
 
     //debug_msg("added node %p\n", n);
@@ -641,6 +788,8 @@ Spt<A>::remove_node(const A& node)
 	return false;
     }
     srcnode->set_valid(false);
+    if (!_full)
+	_removed.push_back(srcnode);
 
     return true;
 }
@@ -678,7 +827,13 @@ Spt<A>::add_edge(const A& src, int weight, const A& dst)
 	return false;
     }
 
-    return srcnode->add_edge(dstnode, weight);
+    if (!srcnode->add_edge(dstnode, weight))
+	return false;
+
+    if (!_full)
+	_shorter.push_back(make_pair(srcnode, dstnode));
+
+    return true;
 }
 
 template <typename A>
@@ -697,7 +852,22 @@ Spt<A>::update_edge_weight(const A& src, int weight, const A& dst)
 	return false;
     }
 
-    return srcnode->update_edge_weight(dstnode, weight);
+    int old_weight;
+    if (!srcnode->get_edge_weight(dstnode, old_weight))
+	return false;
+
+    if (!srcnode->update_edge_weight(dstnode, weight))
+	return false;
+
+    if (_full)
+	return true;
+
+    if (weight > old_weight)
+	_longer.push_back(make_pair(srcnode, dstnode));
+    else if (weight < old_weight)
+	_shorter.push_back(make_pair(srcnode, dstnode));
+
+    return true;
 }
 
 template <typename A>
@@ -735,20 +905,96 @@ Spt<A>::remove_edge(const A& src, const A& dst)
 	return false;
     }
 
-    return srcnode->remove_edge(dstnode);
+    if (!srcnode->remove_edge(dstnode))
+	return false;
+
+    if (!_full)
+	_longer.push_back(make_pair(srcnode, dstnode));
+
+    return true;
+}
+
+template <typename A>
+bool
+Spt<A>::sync(Spt<A>& graph)
+{
+    if (graph._origin.is_empty()) {
+	XLOG_WARNING("No origin");
+	return false;
+    }
+
+    typename Nodes::iterator ni;
+
+    // Remove the nodes that are not in the new graph.
+    for (ni = _nodes.begin(); ni != _nodes.end(); ni++) {
+	if (!ni->second->valid())
+	    continue;
+	typename Node<A>::NodeRef n = graph.find_node(ni->first);
+	if (n.is_empty() || !n->valid())
+	    remove_node(ni->first);
+    }
+
+    // Add the new nodes and pick up the new names of the others, the
+    // name may carry state that is not used for the comparison.
+    for (ni = graph._nodes.begin(); ni != graph._nodes.end(); ni++) {
+	if (!ni->second->valid())
+	    continue;
+	typename Node<A>::NodeRef n = find_node(ni->first);
+	if (n.is_empty() || !n->valid())
+	    add_node(ni->second->nodename());
+	else
+	    n->set_nodename(ni->second->nodename());
+    }
+
+    // Bring the edges into line.
+    for (ni = graph._nodes.begin(); ni != graph._nodes.end(); ni++) {
+	if (!ni->second->valid())
+	    continue;
+	typename Node<A>::NodeRef src = find_node(ni->first);
+	XLOG_ASSERT(!src.is_empty());
+
+	const typename Node<A>::adjacency& want =
+	    ni->second->get_adjacencies();
+	const typename Node<A>::adjacency& have = src->get_adjacencies();
+	typename Node<A>::adjacency::const_iterator ai, wi;
+
+	list<A> gone;
+	for (ai = have.begin(); ai != have.end(); ai++) {
+	    wi = want.find(ai->first);
+	    if (wi == want.end() || !wi->second._dst->valid())
+		gone.push_back(ai->first);
+	}
+	typename list<A>::const_iterator gi;
+	for (gi = gone.begin(); gi != gone.end(); gi++)
+	    remove_edge(ni->first, *gi);
+
+	for (wi = want.begin(); wi != want.end(); wi++) {
+	    if (!wi->second._dst->valid())
+		continue;
+	    ai = have.find(wi->first);
+	    if (ai == have.end())
+		add_edge(ni->first, wi->second._weight, wi->first);
+	    else if (ai->second._weight != wi->second._weight)
+		update_edge_weight(ni->first, wi->second._weight, wi->first);
+	}
+    }
+
+    return set_origin(graph._origin->nodename());
 }
 
 template <typename A>
 bool
 Spt<A>::compute(list<RouteCmd<A> >& routes)
 {
-#ifdef	INCREMENTAL_SPT
-    if (!incremental_spt())
-	return false;
-#else
-    if (!dijkstra())
-	return false;
-#endif
+    if (_full) {
+	if (!dijkstra())
+	    return false;
+    } else {
+	if (!incremental_spt())
+	    return false;
+    }
+    _full = false;
+    clear_changes();
 
     for(typename Nodes::const_iterator ni = _nodes.begin();
 	ni != _nodes.end(); ni++) {
@@ -766,6 +1012,29 @@ Spt<A>::compute(list<RouteCmd<A> >& routes)
     return true;
 }
 
+template <typename A>
+void
+Spt<A>::current_routes(list<RouteCmd<A> >& routes)
+{
+    for(typename Nodes::const_iterator ni = _nodes.begin();
+	ni != _nodes.end(); ni++) {
+	if (ni->second == _origin)
+	    continue;
+	RouteCmd<A> rcmd;
+	if (ni->second->route(rcmd))
+	    routes.push_back(rcmd);
+    }
+}
+
+template <typename A>
+void
+Spt<A>::clear_changes()
+{
+    _longer.clear();
+    _shorter.clear();
+    _removed.clear();
+}
+
 template <typename A>
 string
 Spt<A>::str() const
@@ -810,7 +1079,7 @@ Spt<A>::dijkstra()
 
     int weight = 0;
     // Map of tentative nodes.
-    PriorityQueue<A> tentative;
+    PriorityQueue<A> tentative(_next_id);
 
     for(;;) {
 	// Set the weight on all the nodes that are adjacent to this one.
@@ -849,7 +1118,103 @@ template <typename A>
 bool
 Spt<A>::incremental_spt()
 {
-    XLOG_UNFINISHED();
+    if (_origin.is_empty()) {
+	XLOG_WARNING("No origin");
+	return false;
+    }
+
+    typedef typename Node<A>::NodeRef NodeRef;
+
+    // The nodes that have been removed and the nodes that were reached
+    // over an edge that has since been removed or become more
+    // expensive may now have longer paths. They are the roots of the
+    // subtrees that have to be recomputed.
+    list<NodeRef> roots = _removed;
+    typename EdgeChanges::const_iterator ei;
+    for (ei = _longer.begin(); ei != _longer.end(); ei++) {
+	NodeRef dst = ei->second;
+	if (dst->valid() && !dst->tentative() && dst->valid_weight() &&
+	    dst->get_last_hop() == ei->first)
+	    roots.push_back(dst);
+    }
+
+    // Make every node in these subtrees tentative again.
+    size_t affected = 0;
+    if (!roots.empty()) {
+	map<Node<A> *, list<NodeRef> > children;
+	typename Nodes::const_iterator ni;
+	for (ni = _nodes.begin(); ni != _nodes.end(); ni++) {
+	    const NodeRef& n = ni->second;
+	    if (n == _origin || n->tentative() || !n->valid_weight())
+		continue;
+	    children[n->get_last_hop().get()].push_back(n);
+	}
+	while (!roots.empty()) {
+	    NodeRef n = roots.front();
+	    roots.pop_front();
+	    if (n->tentative())
+		continue;
+	    n->set_tentative(true);
+	    n->invalidate_weights();
+	    affected++;
+	    typename map<Node<A> *, list<NodeRef> >::iterator ci =
+		children.find(n.get());
+	    if (ci != children.end())
+		roots.splice(roots.end(), ci->second);
+	}
+    }
+
+    debug_msg("Incremental SPT %u of %u nodes affected\n",
+	      XORP_UINT_CAST(affected), XORP_UINT_CAST(_nodes.size()));
+
+    // If most of the tree has gone it is cheaper to start again.
+    if (2 * affected > _nodes.size())
+	return dijkstra();
+
+    PriorityQueue<A> tentative(_next_id);
+
+    // Offer the affected nodes the paths through their neighbours
+    // that are still in the tree.
+    if (0 != affected) {
+	typename Nodes::const_iterator ni;
+	for (ni = _nodes.begin(); ni != _nodes.end(); ni++) {
+	    const NodeRef& n = ni->second;
+	    if (!n->valid() || n->tentative())
+		continue;
+	    n->set_adjacent_weights(n, path_length(n), tentative);
+	}
+    }
+
+    // Offer the paths over the new or cheaper edges.
+    for (ei = _shorter.begin(); ei != _shorter.end(); ei++) {
+	NodeRef src = ei->first;
+	NodeRef dst = ei->second;
+	if (!src->valid() || src->tentative() || !dst->valid() ||
+	    dst == _origin)
+	    continue;
+	int weight;
+	if (!src->get_edge_weight(dst, weight))
+	    continue;
+	dst->offer_weight(dst, src, path_length(src) + weight, tentative);
+    }
+
+    // Dijkstra over the tentative nodes, any shorter path found to a
+    // node that is already in the tree puts it back in the tentative set.
+    while (!tentative.empty()) {
+	NodeRef current = tentative.pop();
+	XLOG_ASSERT(!current.is_empty());
+
+	int weight = current->get_local_weight();
+	current->set_tentative(false);
+
+	NodeRef prev = current->get_last_hop();
+	if (prev == _origin)
+	    current->set_first_hop(current);
+	else
+	    current->set_first_hop(prev->get_first_hop());
+
+	current->offer_adjacent_weights(current, weight, tentative);
+    }
 
     return true;
 }
@@ -873,7 +1238,8 @@ Spt<A>::find_node(const A& node)
 
 template <typename A>
 Node<A>::Node(A nodename, bool trace)
-    :  _valid(true), _nodename(nodename), _trace(trace)
+    :  _valid(true), _nodename(nodename), _trace(trace), _id(0),
+       _tentative(true)
 {
 }
 
@@ -1005,7 +1371,7 @@ Node<A>::set_adjacent_weights(NodeRef me, int delta_weight,
 {
     typename adjacency::iterator i;
     for(i = _adjacencies.begin(); i != _adjacencies.end(); i++) {
-	NodeRef n = i->second._dst;
+	const NodeRef& n = i->second._dst;
 	debug_msg("Node: %s\n", n->str().c_str());
 	if (n->valid() && n->tentative()) {
 	    // It is critial that the weight of a node is not changed
@@ -1016,6 +1382,41 @@ Node<A>::set_adjacent_weights(NodeRef me, int delta_weight,
     }
 }
 
+template <typename A>
+bool
+Node<A>::offer_weight(NodeRef me, NodeRef prev, int weight,
+		      PriorityQueue<A>& tentative)
+{
+    if (!valid())
+	return false;
+
+    if (!_tentative) {
+	// The origin has no weight and can't be improved upon.
+	if (!_current._valid || weight >= _current._path_length)
+	    return false;
+	set_tentative(true);
+    }
+
+    if (!tentative.add(me, weight))
+	return false;
+
+    set_last_hop(prev);
+
+    return true;
+}
+
+template <typename A>
+void
+Node<A>::offer_adjacent_weights(NodeRef me, int delta_weight,
+				PriorityQueue<A>& tentative)
+{
+    typename adjacency::iterator i;
+    for(i = _adjacencies.begin(); i != _adjacencies.end(); i++) {
+	const NodeRef& n = i->second._dst;
+	n->offer_weight(n, me, delta_weight + i->second._weight, tentative);
+    }
+}
+
 template <typename A>
 bool
 Node<A>::set_local_weight(int weight)
@@ -1111,6 +1512,21 @@ Node<A>::delta(RouteCmd<A>& rcmd)
     return true;
 }
 
+template <typename A>
+bool
+Node<A>::route(RouteCmd<A>& rcmd)
+{
+    if (!valid() || !_current._valid)
+	return false;
+
+    rcmd = RouteCmd<A>(RouteCmd<A>::ADD, nodename(),
+		       _current._first_hop->nodename(),
+		       _current._last_hop->nodename(),
+		       _current._path_length);
+
+    return true;
+}
+
 template <typename A>
 class Pa: public unary_function<pair<A, Edge<A> >, void> {
  public:
@@ -1171,6 +1587,10 @@ Spt<A>::garbage_collect()
     for(typename Nodes::iterator ni = _nodes.begin(); ni != _nodes.end();) {
 	typename Node<A>::NodeRef& node = ni->second;
 	if (!node->valid()) {
+	    // A removed node may only be reachable from other removed
+	    // nodes, drop its references so that they can all be freed.
+	    node->clear();
+	    _free_ids.push_back(node->id());
 	    _nodes.erase(ni++);
 	} else {
 	    ni++;
@@ -1185,39 +1605,98 @@ template <typename A>
 bool
 PriorityQueue<A>::add(typename Node<A>::NodeRef n, int weight)
 {
-    // Find this node if its already in set and remove it.
-    if (n->valid_weight()) {
-	typename Tent::iterator i = _tentative.find(n);
-	for(; i != _tentative.end(); i++) {
-	    if ((*i) == n) {
-// 		debug_msg("Erase %s\n", (*i)->str().c_str());
-		_tentative.erase(i);
-		break;
-	    }
-	}
+    size_t id = n->id();
+    if (id >= _position.size()) {
+	_position.resize(id + 1, NOT_QUEUED);
+	_nodes.resize(id + 1);
     }
+
     bool accepted = n->set_local_weight(weight);
-    _tentative.insert(n);
+
+    // The weight of a node can only go down, so a node that is
+    // already queued can only move towards the top.
+    size_t i = _position[id];
+    if (NOT_QUEUED != i) {
+	if (accepted) {
+	    _heap[i]._weight = n->get_local_weight();
+	    sift_up(i);
+	}
+	return accepted;
+    }
+
+    Entry e;
+    e._weight = n->get_local_weight();
+    e._id = id;
+    _heap.push_back(e);
+    _position[id] = _heap.size() - 1;
+    _nodes[id] = n;
+    sift_up(_heap.size() - 1);
 
     return accepted;
-//     debug_msg("Insert %s\n", n->str().c_str());
 }
 
 template <typename A> 
 typename Node<A>::NodeRef
 PriorityQueue<A>::pop()
 {
-    // Find this node if its already in set and remove it.
-    typename Tent::iterator i = _tentative.begin();
-    if (i == _tentative.end())
+    if (_heap.empty())
 	return typename Node<A>::NodeRef();
 
-    typename Node<A>::NodeRef n = *i;
-    _tentative.erase(i);
+    size_t id = _heap[0]._id;
+    typename Node<A>::NodeRef n = _nodes[id];
+    _nodes[id] = typename Node<A>::NodeRef();
+    _position[id] = NOT_QUEUED;
 
-//     debug_msg("Pop %s\n", n->str().c_str());
+    _heap[0] = _heap.back();
+    _heap.pop_back();
+    if (!_heap.empty()) {
+	_position[_heap[0]._id] = 0;
+	sift_down(0);
+    }
 
     return n;
 }
 
+template <typename A> 
+void
+PriorityQueue<A>::sift_up(size_t i)
+{
+    Entry e = _heap[i];
+    while (i > 0) {
+	size_t parent = (i - 1) / ARITY;
+	if (!(e < _heap[parent]))
+	    break;
+	_heap[i] = _heap[parent];
+	_position[_heap[i]._id] = i;
+	i = parent;
+    }
+    _heap[i] = e;
+    _position[e._id] = i;
+}
+
+template <typename A> 
+void
+PriorityQueue<A>::sift_down(size_t i)
+{
+    Entry e = _heap[i];
+    size_t size = _heap.size();
+    for (;;) {
+	size_t first = i * ARITY + 1;
+	if (first >= size)
+	    break;
+	size_t last = first + ARITY < size ? first + ARITY : size;
+	size_t best = first;
+	for (size_t c = first + 1; c < last; c++)
+	    if (_heap[c] < _heap[best])
+		best = c;
+	if (!(_heap[best] < e))
+	    break;
+	_heap[i] = _heap[best];
+	_position[_heap[i]._id] = i;
+	i = best;
+    }
+    _heap[i] = e;
+    _position[e._id] = i;
+}
+
 #endif // __LIBPROTO_SPT_HH__
@@ -0,0 +1,243 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+// vim:set sts=4 ts=8:
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License, Version
+// 2.1, June 1999 as published by the Free Software Foundation.
+// Redistribution and/or modification of this program under the terms of
+// any other version of the GNU Lesser General Public License is not
+// permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU Lesser General Public License, Version 2.1, a copy of
+// which can be found in the XORP LICENSE.lgpl file.
+//
+// XORP, Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+#include "libproto_module.h"
+#include "libxorp/xorp.h"
+#include "libxorp/xlog.h"
+#include "libxorp/debug.h"
+#include "libxorp/clock.hh"
+#include "libxorp/timeval.hh"
+#include "libxorp/random.h"
+
+#ifdef HAVE_GETOPT_H
+#include <getopt.h>
+#endif
+
+#include "spt.hh"
+
+//
+// Measure the cost of a shortest path computation against the size of
+// the graph.
+//
+// The graph is a ring, so that every node is reachable, with random
+// chords added until the requested average degree is reached. All the
+// edges are bidirectional with random weights, which is roughly the
+// shape of a large OSPF area or OLSR mesh.
+//
+// A full computation is forced by moving the origin between two nodes.
+// An incremental computation follows the change of a single edge
+// weight.
+//
+
+template <>
+string
+Node<uint32_t>::str() const
+{
+    return c_format("%u", XORP_UINT_CAST(_nodename));
+}
+
+template <>
+string
+RouteCmd<uint32_t>::str() const
+{
+    return c() + c_format(" node: %u nexthop: %u prevhop: %u weight: %d",
+			  XORP_UINT_CAST(_node), XORP_UINT_CAST(_nexthop),
+			  XORP_UINT_CAST(_prevhop), _weight);
+}
+
+namespace {
+
+struct Link {
+    uint32_t	_src;
+    uint32_t	_dst;
+};
+
+class Bench {
+public:
+    Bench(unsigned nodes, unsigned degree);
+
+    unsigned edges() const { return _links.size() * 2; }
+
+    // Return the average time of a full computation in microseconds.
+    double full(unsigned iterations);
+
+    // Return the average time of an incremental computation in
+    // microseconds.
+    double incremental(unsigned iterations);
+
+private:
+    void link(uint32_t src, uint32_t dst);
+    bool compute();
+
+    SystemClock		_clock;
+    Spt<uint32_t>	_spt;
+    vector<Link>	_links;
+};
+
+Bench::Bench(unsigned nodes, unsigned degree)
+    : _spt(false)
+{
+    for (uint32_t n = 0; n < nodes; n++)
+	_spt.add_node(n);
+    _spt.set_origin(0);
+
+    for (uint32_t n = 0; n < nodes; n++)
+	link(n, (n + 1) % nodes);
+
+    unsigned chords = nodes * degree / 2;
+    while (_links.size() < chords) {
+	uint32_t src = xorp_random() % nodes;
+	uint32_t dst = xorp_random() % nodes;
+	int weight;
+	if (src == dst || _spt.get_edge_weight(src, weight, dst))
+	    continue;
+	link(src, dst);
+    }
+}
+
+void
+Bench::link(uint32_t src, uint32_t dst)
+{
+    int weight = 1 + xorp_random() % 100;
+
+    _spt.add_edge(src, weight, dst);
+    _spt.add_edge(dst, weight, src);
+
+    Link l;
+    l._src = src;
+    l._dst = dst;
+    _links.push_back(l);
+}
+
+bool
+Bench::compute()
+{
+    list<RouteCmd<uint32_t> > routes;
+
+    return _spt.compute(routes);
+}
+
+double
+Bench::full(unsigned iterations)
+{
+    TimeVal start, end;
+
+    _clock.advance_time();
+    _clock.current_time(start);
+    for (unsigned i = 0; i < iterations; i++) {
+	_spt.set_origin(i % 2);
+	if (!compute())
+	    return -1.0;
+    }
+    _clock.advance_time();
+    _clock.current_time(end);
+
+    return (end - start).get_double() * 1.0e6 / iterations;
+}
+
+double
+Bench::incremental(unsigned iterations)
+{
+    TimeVal start, end;
+
+    // Start from a complete tree.
+    if (!compute())
+	return -1.0;
+
+    _clock.advance_time();
+    _clock.current_time(start);
+    for (unsigned i = 0; i < iterations; i++) {
+	const Link& l = _links[xorp_random() % _links.size()];
+	int weight = 1 + xorp_random() % 100;
+	_spt.update_edge_weight(l._src, weight, l._dst);
+	_spt.update_edge_weight(l._dst, weight, l._src);
+	if (!compute())
+	    return -1.0;
+    }
+    _clock.advance_time();
+    _clock.current_time(end);
+
+    return (end - start).get_double() * 1.0e6 / iterations;
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char *argv[])
+{
+    unsigned max_nodes = 20000;
+    unsigned degree = 4;
+    unsigned iterations = 20;
+    int ch;
+
+    xlog_init(argv[0], NULL);
+    xlog_set_verbose(XLOG_VERBOSE_LOW);
+    xlog_level_set_verbose(XLOG_LEVEL_ERROR, XLOG_VERBOSE_HIGH);
+    xlog_add_default_output();
+    xlog_start();
+
+    while ((ch = getopt(argc, argv, "hn:d:i:")) != -1) {
+	switch (ch) {
+	case 'n':
+	    max_nodes = atoi(optarg);
+	    break;
+	case 'd':
+	    degree = atoi(optarg);
+	    break;
+	case 'i':
+	    iterations = atoi(optarg);
+	    break;
+	case 'h':
+	default:
+	    printf("Usage: %s <opts>\n"
+		   "-h\thelp\n"
+		   "-n <n>\tlargest number of nodes [%u]\n"
+		   "-d <n>\taverage node degree [%u]\n"
+		   "-i <n>\tcomputations per measurement [%u]\n"
+		   , argv[0], max_nodes, degree, iterations);
+	    exit(1);
+	}
+    }
+    if (iterations == 0)
+	iterations = 1;
+    if (degree < 2)
+	degree = 2;
+
+    xorp_srandom(1);
+
+    printf("%8s %8s %14s %14s\n", "nodes", "edges", "usec/full",
+	   "usec/incr");
+    for (unsigned n = 100; n <= max_nodes; n *= 10) {
+	Bench bench(n, degree);
+	double full = bench.full(iterations);
+	double incr = bench.incremental(iterations);
+	printf("%8u %8u %14.1f %14.1f\n", n, bench.edges(), full, incr);
+	if (n < max_nodes && n * 10 > max_nodes)
+	    n = max_nodes / 10;
+    }
+
+    xlog_stop();
+    xlog_exit();
+
+    return 0;
+}
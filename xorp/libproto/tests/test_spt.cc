@@ -38,6 +38,7 @@
 #include "libxorp/xlog.h"
 #include "libxorp/exceptions.hh"
 #include "libxorp/tokenize.hh"
+#include "libxorp/random.h"
 
 #include "spt.hh"
 
@@ -594,6 +595,152 @@ test8(TestInfo& info)
     return true;
 }
 
+/**
+ * The path length to every reachable node.
+ */
+map<string, int>
+path_lengths(Spt<string>& spt)
+{
+    list<RouteCmd<string> > routes;
+    spt.current_routes(routes);
+
+    map<string, int> lengths;
+    list<RouteCmd<string> >::const_iterator ri;
+    for (ri = routes.begin(); ri != routes.end(); ri++)
+	lengths[ri->node()] = ri->weight();
+
+    return lengths;
+}
+
+/**
+ * Apply the route commands from a computation to a set of path lengths.
+ */
+void
+apply_routes(map<string, int>& lengths, const list<RouteCmd<string> >& routes)
+{
+    list<RouteCmd<string> >::const_iterator ri;
+    for (ri = routes.begin(); ri != routes.end(); ri++) {
+	switch (ri->cmd()) {
+	case RouteCmd<string>::ADD:
+	case RouteCmd<string>::REPLACE:
+	    lengths[ri->node()] = ri->weight();
+	    break;
+	case RouteCmd<string>::DELETE:
+	    lengths.erase(ri->node());
+	    break;
+	}
+    }
+}
+
+/**
+ * Make random changes to a graph and check that the incremental
+ * computations agree with a computation from scratch. One graph is
+ * changed in place and another is brought up to date with sync().
+ */
+bool
+test9(TestInfo& info, int nodes, int rounds)
+{
+    xorp_srandom(1);
+
+    Spt<string> inc(info.verbose() /* enable tracing */);
+    Spt<string> synced(info.verbose() /* enable tracing */);
+    map<pair<int, int>, int> edges;
+    vector<bool> present(nodes, true);
+    map<string, int> inc_lengths, synced_lengths;
+
+    for (int i = 0; i < nodes; i++)
+	inc.add_node(c_format("n%d", i));
+    inc.set_origin("n0");
+
+    for (int round = 0; round <= rounds; round++) {
+	// The first round builds the graph, the rest make small changes.
+	int changes = 0 == round ? 4 * nodes : 1 + xorp_random() % 3;
+	for (int c = 0; c < changes; c++) {
+	    int src = xorp_random() % nodes;
+	    int dst = xorp_random() % nodes;
+	    int weight = 1 + xorp_random() % 20;
+	    string s = c_format("n%d", src);
+	    string d = c_format("n%d", dst);
+	    map<pair<int, int>, int>::iterator ei =
+		edges.find(make_pair(src, dst));
+
+	    if (!present[src]) {
+		inc.add_node(s);
+		present[src] = true;
+		continue;
+	    }
+	    if (0 != round && 0 != src && 0 == xorp_random() % 25) {
+		inc.remove_node(s);
+		present[src] = false;
+		for (ei = edges.begin(); ei != edges.end();) {
+		    if (ei->first.first == src || ei->first.second == src)
+			edges.erase(ei++);
+		    else
+			ei++;
+		}
+		continue;
+	    }
+	    if (src == dst || !present[dst])
+		continue;
+	    if (edges.end() == ei) {
+		inc.add_edge(s, weight, d);
+		edges[make_pair(src, dst)] = weight;
+	    } else if (0 == xorp_random() % 2) {
+		inc.remove_edge(s, d);
+		edges.erase(ei);
+	    } else {
+		inc.update_edge_weight(s, weight, d);
+		ei->second = weight;
+	    }
+	}
+
+	Spt<string> full(info.verbose() /* enable tracing */);
+	for (int i = 0; i < nodes; i++)
+	    if (present[i])
+		full.add_node(c_format("n%d", i));
+	map<pair<int, int>, int>::const_iterator ei;
+	for (ei = edges.begin(); ei != edges.end(); ei++)
+	    full.add_edge(c_format("n%d", ei->first.first), ei->second,
+			  c_format("n%d", ei->first.second));
+	full.set_origin("n0");
+
+	if (!synced.sync(full)) {
+	    DOUT(info) << "sync failed" << endl;
+	    return false;
+	}
+
+	list<RouteCmd<string> > full_routes, inc_routes, synced_routes;
+	if (!full.compute(full_routes) || !inc.compute(inc_routes) ||
+	    !synced.compute(synced_routes)) {
+	    DOUT(info) << "compute failed" << endl;
+	    return false;
+	}
+	apply_routes(inc_lengths, inc_routes);
+	apply_routes(synced_lengths, synced_routes);
+
+	// A computation from scratch only adds routes.
+	map<string, int> expected;
+	apply_routes(expected, full_routes);
+	if (expected != path_lengths(full)) {
+	    DOUT(info) << "Full result differs in round " << round
+		       << endl << full.str();
+	    return false;
+	}
+	if (expected != path_lengths(inc) || expected != inc_lengths) {
+	    DOUT(info) << "Incremental result differs in round " << round
+		       << endl << inc.str();
+	    return false;
+	}
+	if (expected != path_lengths(synced) || expected != synced_lengths) {
+	    DOUT(info) << "Synced result differs in round " << round
+		       << endl << synced.str();
+	    return false;
+	}
+    }
+
+    return true;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -631,6 +778,7 @@ main(int argc, char **argv)
 	{"test6", callback(test6)},
 	{"test7", callback(test7)},
 	{"test8", callback(test8)},
+	{"test9", callback(test9, 200, 500)},
     };
 
     try {
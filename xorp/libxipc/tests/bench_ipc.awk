@@ -46,7 +46,7 @@ function dump_stats() {
     m = t / n;
     msq = tsq / n;
 
-    sigma = (msq - m * m) ** 0.5;
+    sigma = sqrt(msq - m * m);
 
     print n_xrl, m, sigma, min, max;
 }
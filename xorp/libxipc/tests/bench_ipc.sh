@@ -7,23 +7,40 @@
 #
 # A script to perform IPC performance measurements
 #
+# Usage: bench_ipc.sh [<bench_stcp binary>]
+#
+# The benchmark runs the STCP listener and sender in one process, so no
+# Finder is needed.  Without an argument the binary is looked for in
+# ${BENCH_BINDIR}, the current directory and the directory holding this
+# script, under the SCons and the CMake names.
+#
 
 # Conditionally set ${srcdir} if it wasn't assigned (e.g., by `gmake check`)
 if [ "X${srcdir}" = "X" ] ; then srcdir=`dirname $0` ; fi
 
-# XXX
-BINDIR=/tmp/xorp/libxipc
-TBINDIR=/home/bms/svn/xorp/xorp/obj/x86_64-unknown-freebsd7.2/libxipc/tests
-
-#${BINDIR}/xorp_finder &
-${BINDIR}/xorp_finder &
-FINDER_PID=$!
+BENCH=$1
+if [ "X${BENCH}" = "X" ] ; then
+    for dir in ${BENCH_BINDIR} . ${srcdir} ; do
+	for name in bench_stcp bench_xipc_stcp ; do
+	    if [ -x ${dir}/${name} ] ; then
+		BENCH=${dir}/${name}
+		break 2
+	    fi
+	done
+    done
+fi
+if [ "X${BENCH}" = "X" ] ; then
+    echo "Cannot find bench_stcp, set BENCH_BINDIR or pass its path" >&2
+    exit 1
+fi
+
+# XRLs per run and runs per measurement
+COUNT=${COUNT:-10000}
+RUNS=${RUNS:-5}
 
 test_pf()
 {
     local pfname=$1
-    local pfenv=$2
-    local pfcmd=$3
     local rawfile=${pfname}.log
     local i
 
@@ -32,7 +49,7 @@ test_pf()
     echo "-------------------------------------"
 
     for i in 0 1 2 3 4 5 6 7 8 9 10 12 15 18 20 25; do
-	XORP_PF=${pfenv} ${TBINDIR}/test_xrl_sender ${pfcmd} -n $i
+	${BENCH} -a $i -N ${COUNT} -i ${RUNS} || exit 1
     done | tee ${rawfile}
     outfile=${pfname}.dat
     cat ${rawfile} | awk -f ${srcdir}/bench_ipc.awk > $outfile
@@ -42,7 +59,4 @@ test_pf()
     echo "    Processed data file = ${outfile}"
 }
 
-test_pf "tcp" "t" "-m 0 -r"
-test_pf "local" "x" "-m 0 -r"
-
-kill ${FINDER_PID}
+test_pf "tcp"
@@ -0,0 +1,208 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+// vim:set sts=4 ts=8:
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License, Version
+// 2.1, June 1999 as published by the Free Software Foundation.
+// Redistribution and/or modification of this program under the terms of
+// any other version of the GNU Lesser General Public License is not
+// permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU Lesser General Public License, Version 2.1, a copy of
+// which can be found in the XORP LICENSE.lgpl file.
+//
+// XORP, Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+#include "xrl_module.h"
+
+#include "libxorp/xorp.h"
+#include "libxorp/xlog.h"
+#include "libxorp/debug.h"
+#include "libxorp/clock.hh"
+#include "libxorp/eventloop.hh"
+
+#ifdef HAVE_GETOPT_H
+#include <getopt.h>
+#endif
+
+#include "xrl_error.hh"
+#include "xrl_pf_stcp.hh"
+#include "xrl_dispatcher.hh"
+
+//
+// Measure XRL throughput over the STCP protocol family.
+//
+// The listener and the sender run in the same process, so no Finder is
+// needed and nothing depends on where the tree was built.  Each XRL
+// carries a number of u32 atoms and is answered with an empty response.
+// The sender is kept as full as its in-flight window allows, so the
+// window, the coalescing of writes and the cost of dispatch all show.
+//
+// The output can be processed with bench_ipc.awk, see bench_ipc.sh.
+//
+
+namespace {
+
+const XrlCmdError
+bench_recv_handler(const XrlArgs& /* inputs */, XrlArgs* /* outputs */)
+{
+    return XrlCmdError::OKAY();
+}
+
+class Bench {
+public:
+    Bench(EventLoop& e, const char* address, uint32_t atoms);
+
+    /**
+     * Send XRLs and wait for all of the responses.
+     *
+     * @return the time taken in seconds, or a negative value on error.
+     */
+    double run(uint32_t count);
+
+    const XrlPFSTCPSender& sender() const	{ return _sender; }
+
+private:
+    void reply(const XrlError& e, XrlArgs* response);
+
+    EventLoop&		_e;
+    SystemClock		_clock;
+    XrlPFSTCPSender	_sender;
+    Xrl			_xrl;
+    uint32_t		_received;
+    bool		_failed;
+};
+
+XrlArgs
+make_args(uint32_t atoms)
+{
+    XrlArgs args;
+    for (uint32_t i = 0; i < atoms; i++)
+	args.add_uint32(c_format("a%u", XORP_UINT_CAST(i)).c_str(), i);
+    return args;
+}
+
+Bench::Bench(EventLoop& e, const char* address, uint32_t atoms)
+    : _e(e),
+      _sender("bench", e, address),
+      _xrl("anywhere", "bench", make_args(atoms)),
+      _received(0),
+      _failed(false)
+{
+    // Keepalives would only add noise.
+    _sender.set_keepalive_time(TimeVal::ZERO());
+}
+
+void
+Bench::reply(const XrlError& e, XrlArgs* /* response */)
+{
+    if (e != XrlError::OKAY()) {
+	fprintf(stderr, "bench failed: %s\n", e.str().c_str());
+	_failed = true;
+    }
+    _received++;
+}
+
+double
+Bench::run(uint32_t count)
+{
+    TimeVal start, end;
+    uint32_t sent = 0;
+
+    _received = 0;
+    _clock.advance_time();
+    _clock.current_time(start);
+    while (_received < count && !_failed) {
+	while (sent < count
+	       && _sender.send(_xrl, true, callback(this, &Bench::reply)))
+	    sent++;
+	_e.run();
+    }
+    _clock.advance_time();
+    _clock.current_time(end);
+
+    if (_failed)
+	return -1.0;
+
+    return (end - start).get_double();
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char *argv[])
+{
+    uint32_t atoms = 0;
+    uint32_t count = 10000;
+    uint32_t runs = 5;
+    bool verbose = false;
+    int ch;
+
+    xlog_init(argv[0], NULL);
+    xlog_set_verbose(XLOG_VERBOSE_LOW);
+    xlog_level_set_verbose(XLOG_LEVEL_ERROR, XLOG_VERBOSE_HIGH);
+    xlog_add_default_output();
+    xlog_start();
+
+    while ((ch = getopt(argc, argv, "ha:N:i:v")) != -1) {
+	switch (ch) {
+	case 'a':
+	    atoms = atoi(optarg);
+	    break;
+	case 'N':
+	    count = atoi(optarg);
+	    break;
+	case 'i':
+	    runs = atoi(optarg);
+	    break;
+	case 'v':
+	    verbose = true;
+	    break;
+	case 'h':
+	default:
+	    printf("Usage: %s <opts>\n"
+		   "-h\thelp\n"
+		   "-a <n>\tXrlAtoms in each XRL [%u]\n"
+		   "-N <n>\tXRLs per run [%u]\n"
+		   "-i <n>\tnumber of runs [%u]\n"
+		   "-v\tprint the sender statistics after each run\n"
+		   , argv[0], XORP_UINT_CAST(atoms), XORP_UINT_CAST(count),
+		   XORP_UINT_CAST(runs));
+	    exit(1);
+	}
+    }
+    if (count == 0)
+	count = 1;
+
+    EventLoop eventloop;
+    XrlDispatcher dispatcher("bench");
+    dispatcher.add_handler("bench", callback(bench_recv_handler));
+    XrlPFSTCPListener listener(eventloop, &dispatcher);
+
+    Bench bench(eventloop, listener.address(), atoms);
+
+    printf("XrlAtoms per call = %u\n", XORP_UINT_CAST(atoms));
+    for (uint32_t i = 0; i < runs; i++) {
+	double secs = bench.run(count);
+	if (secs < 0)
+	    return 1;
+	printf("Received %u XRLs; delta_time = %.6f secs; speed = %f XRLs/s\n",
+	       XORP_UINT_CAST(count), secs,
+	       secs > 0 ? count / secs : 0.0);
+	if (verbose)
+	    printf("Sender %s\n", bench.sender().stats().c_str());
+    }
+
+    xlog_stop();
+    xlog_exit();
+
+    return 0;
+}
@@ -194,6 +194,97 @@ run_serialization_test()
     return 0;
 }
 
+static int
+pack_args(const XrlArgs& args, vector<uint8_t>& buf)
+{
+    buf.resize(args.packed_bytes());
+    if (args.pack(&buf[0], buf.size()) != buf.size()) {
+	verbose_log("Failed to pack %s\n", args.str().c_str());
+	return 1;
+    }
+    return 0;
+}
+
+// XrlArgs::fill() takes the atoms that follow the header.
+static bool
+fill_args(XrlArgs& args, const vector<uint8_t>& buf)
+{
+    uint32_t cnt;
+    size_t header_bytes = XrlArgs::unpack_header(cnt, &buf[0], buf.size());
+    if (header_bytes == 0 || cnt != args.size())
+	return false;
+
+    size_t atom_bytes = buf.size() - header_bytes;
+    return (args.fill(&buf[header_bytes], atom_bytes) == atom_bytes);
+}
+
+//
+// Decode a stream of requests for the same command into the same atoms,
+// as STCPRequestHandler does, and check that the atoms keep their storage.
+//
+static int
+run_fill_test()
+{
+    vector<uint8_t> buf;
+
+    XrlArgs first;
+    first.add("protocol", string("ebgp-with-a-long-name"));
+    first.add("network", IPv6Net("2001:db8::/32"));
+    first.add("data", vector<uint8_t>(64, 0xa5));
+    if (pack_args(first, buf))
+	return 1;
+
+    XrlArgs recycled;
+    if (recycled.unpack(&buf[0], buf.size()) != buf.size()) {
+	verbose_log("Failed to unpack %s\n", first.str().c_str());
+	return 1;
+    }
+    const string* text = &recycled[0].text();
+    const vector<uint8_t>* binary = &recycled[2].binary();
+    const uint8_t* binary_data = &(*binary)[0];
+
+    for (uint32_t i = 0; i < 16; i++) {
+	XrlArgs next;
+	next.add("protocol", string(i % 4 + 1, 'x'));
+	next.add("network", IPv6Net(c_format("2001:db8:%x::/48", i).c_str()));
+	next.add("data", vector<uint8_t>(i + 1, i));
+	if (pack_args(next, buf))
+	    return 1;
+
+	if (!fill_args(recycled, buf)) {
+	    verbose_log("Failed to fill %s\n", next.str().c_str());
+	    return 1;
+	}
+	if (recycled != next) {
+	    verbose_log("Filled %s expected %s\n", recycled.str().c_str(),
+			next.str().c_str());
+	    return 1;
+	}
+	if (&recycled[0].text() != text || &recycled[2].binary() != binary
+	    || &recycled[2].binary()[0] != binary_data) {
+	    verbose_log("Atom storage was not reused\n");
+	    return 1;
+	}
+    }
+
+    //
+    // A peer sending a different type for an atom must not have its data
+    // decoded into the storage of the old type.
+    //
+    XrlArgs other;
+    other.add("protocol", uint32_t(1));
+    other.add("network", string("2001:db8::/32"));
+    other.add("data", IPv4("192.0.2.1"));
+    if (pack_args(other, buf))
+	return 1;
+    if (!fill_args(recycled, buf) || recycled != other) {
+	verbose_log("Failed to fill %s\n", other.str().c_str());
+	return 1;
+    }
+
+    return 0;
+}
+
 static int
 run_test()
 {
@@ -341,6 +432,9 @@ main(int argc, char * const argv[])
 	if (ret_value == 0) {
 	    ret_value = run_serialization_test();
 	}
+	if (ret_value == 0) {
+	    ret_value = run_fill_test();
+	}
     }
     catch (...) {
 	xorp_catch_standard_exceptions();
@@ -1182,11 +1182,13 @@ XrlAtom::unpack_binary(const uint8_t* buffer, size_t buffer_bytes)
 	return 0;
     }
 
-    if (_type != xrlatom_no_type)
-	delete _binary;
+    const uint8_t* data = buffer + sizeof(len);
+
+    if (_type == xrlatom_no_type)
+	_binary = new vector<uint8_t>(data, data + len);
+    else
+	_binary->assign(data, data + len);
 
-    _binary = new vector<uint8_t>(buffer + sizeof(len),
-				  buffer + sizeof(len) + len);
     return sizeof(len) + len;
 }
 
@@ -1333,6 +1335,18 @@ XrlAtom::unpack(const uint8_t* buffer, size_t buffer_bytes)
 	    debug_msg("Type %d invalid\n", t);
 	}
 
+	//
+	// A recycled atom (see XrlArgs::fill()) decodes into the storage
+	// it already has, so that a stream of requests for the same
+	// command doesn't allocate.  That is only safe if the atom owns
+	// data of the same type, so otherwise start afresh.
+	//
+	if (_type != XrlAtomType(t) || !_have_data || !_own) {
+	    discard_dynamic();
+	    _type = xrlatom_no_type;
+	    _own = true;
+	}
+
 	XrlAtomType old_type = _type;
 	XrlAtomType type = _type = XrlAtomType(t);
 	_have_data = true;
@@ -39,7 +39,7 @@ XrlAtomList::prepend(const XrlAtom& xa) throw (BadAtomType)
 		   c_format("Head type = %d, added type %d\n",
 			    _list.front().type(), xa.type()));
     }
-    _list.push_front(xa);
+    _list.insert(_list.begin(), xa);
     _size++;
 }
 
@@ -71,39 +71,25 @@ XrlAtomList::do_append(const XrlAtom& xa)
 const XrlAtom&
 XrlAtomList::get(size_t itemno) const throw (InvalidIndex)
 {
-    list<XrlAtom>::const_iterator ci = _list.begin();
-    size_t size = _size;
-
-    if (ci == _list.end() || size == 0) {
+    if (_list.empty() || _size == 0) {
 	xorp_throw(InvalidIndex, "Index out of range: empty list.");
     }
-    while (itemno != 0) {
-	++ci;
-	if (ci == _list.end() || size-- == 0) {
-	    xorp_throw(InvalidIndex, "Index out of range.");
-	}
-	itemno--;
+    if (itemno >= _list.size() || itemno > _size) {
+	xorp_throw(InvalidIndex, "Index out of range.");
     }
-    return *ci;
+    return _list[itemno];
 }
 
 void
 XrlAtomList::remove(size_t itemno) throw (InvalidIndex)
 {
-    list<XrlAtom>::iterator i = _list.begin();
-    size_t size = _size;
-
-    if (i == _list.end() || size == 0) {
+    if (_list.empty() || _size == 0) {
 	xorp_throw(InvalidIndex, "Index out of range: empty list.");
     }
-    while (itemno != 0) {
-	i++;
-	if (i == _list.end() || size-- == 0) {
-	    xorp_throw(InvalidIndex, "Index out of range.");
-	}
-	itemno--;
+    if (itemno >= _list.size() || itemno > _size) {
+	xorp_throw(InvalidIndex, "Index out of range.");
     }
-    _list.erase(i);
+    _list.erase(_list.begin() + itemno);
     _size--;
 }
 
@@ -115,8 +101,8 @@ size_t XrlAtomList::size() const
 bool
 XrlAtomList::operator==(const XrlAtomList& other) const
 {
-    list<XrlAtom>::const_iterator a = _list.begin();
-    list<XrlAtom>::const_iterator b = other._list.begin();
+    vector<XrlAtom>::const_iterator a = _list.begin();
+    vector<XrlAtom>::const_iterator b = other._list.begin();
     int i = 0;
     size_t size = _size;
 
@@ -143,7 +129,7 @@ string
 XrlAtomList::str() const
 {
     string r;
-    list<XrlAtom>::const_iterator ci = _list.begin();
+    vector<XrlAtom>::const_iterator ci = _list.begin();
     size_t size = _size;
 
     while (ci != _list.end() && size--) {
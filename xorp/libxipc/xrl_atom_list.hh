@@ -112,7 +112,7 @@ private:
     void    check_type(const XrlAtom& xa) throw (BadAtomType);
     void    do_append(const XrlAtom& xa);
 
-    list<XrlAtom> _list;
+    vector<XrlAtom> _list;
     size_t	  _size;
 };
 
@@ -63,3 +63,9 @@ string XrlPFSender::toString() const {
     oss << _name << ": address: " << _address << " alive: " << alive();
     return oss.str();
 }
+
+string
+XrlPFSender::stats() const
+{
+    return c_format("%s %s %s", _name.c_str(), protocol(), _address.c_str());
+}
@@ -122,6 +122,12 @@ public:
     virtual void set_address(const char* a) { _address = a; }
     virtual string toString() const;
 
+    /**
+     * @return a one line summary of the sender's transmission
+     * statistics, as reported by the xrl_stats interface.
+     */
+    virtual string stats() const;
+
 protected:
     EventLoop& _eventloop;
     string _address;
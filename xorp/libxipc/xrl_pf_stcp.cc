@@ -53,19 +53,28 @@
 const char* XrlPFSTCPSender::_protocol   = "stcp";
 const char* XrlPFSTCPListener::_protocol = "stcp";
 
-// The maximum number of bytes worth of XRL buffered before send()
-// returns false.  Resource preservation.
-static const size_t 	MAX_ACTIVE_BYTES 	    = 100000;
-
-// The maximum number of XRLs buffered at the sender.
-static const size_t 	MAX_ACTIVE_REQUESTS  	    = 100;
+// The number of XRLs a sender may have in flight before send() returns
+// false.  The window starts at the initial size and adapts to the
+// measured round trip time between the bounds.
+static const size_t 	MIN_ACTIVE_REQUESTS  	    = 16;
+static const size_t 	INITIAL_ACTIVE_REQUESTS	    = 100;
+static const size_t 	MAX_ACTIVE_REQUESTS  	    = 1000;
+
+// The number of bytes worth of XRL a sender may have in flight scales
+// with the window.  Resource preservation.
+static const size_t 	ACTIVE_BYTES_PER_REQUEST    = 1000;
+
+// The window shrinks once the smoothed round trip time exceeds twice
+// the quickest seen plus this slack, ie once requests are queueing at
+// the receiver.
+static const TimeVal	RTT_SLACK		    = TimeVal(0, 5000);
 
 // The maximum number of XRLs the receiver will dispatch per read event, ie
 // per read() system call.
 static const uint32_t   MAX_XRLS_DISPATCHED	    = 100;
 
 // The maximum number of buffers the AsyncFileWriters should coalesce.
-static const uint32_t   MAX_WRITES		    = 16;
+static const uint32_t   MAX_WRITES		    = 64;
 
 #define xassert(x) // An expensive - assert(x)
 
@@ -192,6 +201,10 @@ private:
     TimeVal		_keepalive_timeout;
     XorpTimer		_life_timer;
 
+    // Command of the request being dispatched.  Kept here so that its
+    // storage is reused from one request to the next.
+    string		_command;
+
     void parse_header(const uint8_t* buffer, size_t buffer_bytes);
     void parse_payload();
 };
@@ -284,17 +297,16 @@ STCPRequestHandler::do_dispatch(const uint8_t* packed_xrl,
     const XrlDispatcher* d = _parent.dispatcher();
     assert(d != 0);
 
-    string command;
-    size_t cmdsz = Xrl::unpack_command(command, packed_xrl, packed_xrl_bytes);
+    size_t cmdsz = Xrl::unpack_command(_command, packed_xrl, packed_xrl_bytes);
 
     if (xrl_trace.on()) {
-	XLOG_INFO("req-handler rcv, command: %s\n", command.c_str());
+	XLOG_INFO("req-handler rcv, command: %s\n", _command.c_str());
     }
 
     if (!cmdsz)
 	return response->dispatch(e, NULL);
 
-    XrlDispatcher::XI* xi = d->lookup_xrl(command);
+    XrlDispatcher::XI* xi = d->lookup_xrl(_command);
     if (!xi)
 	return response->dispatch(e, NULL);
 
@@ -627,6 +639,8 @@ public:
     uint8_t*		buffer() 		{ return _b; }
     Callback&		cb() 			{ return _cb; }
     uint32_t		size() const		{ return _size; }
+    const TimeVal&	sent() const		{ return _sent; }
+    void		set_sent(const TimeVal& t) { _sent = t; }
 
     bool is_keepalive()
     {
@@ -651,6 +665,7 @@ private:
     uint8_t		_buffer[256];	// XXX important performance parameter
     uint32_t		_size;
     Callback		_cb;
+    TimeVal		_sent;				// when written
 };
 
 
@@ -769,6 +784,20 @@ XrlPFSTCPSender::construct()
     _active_requests = 0;
     _keepalive_sent  = false;
 
+    _window_requests = INITIAL_ACTIVE_REQUESTS;
+    _window_bytes    = _window_requests * ACTIVE_BYTES_PER_REQUEST;
+    _window_seqno    = 0;
+    _srtt	     = TimeVal::ZERO();
+    _rtt_min	     = TimeVal::MAXIMUM();
+
+    _eventloop.current_time(_start_time);
+    _bytes_sent	     = 0;
+    _bytes_received  = 0;
+    _responses	     = 0;
+    _refused	     = 0;
+    for (uint32_t i = 0; i < RTT_BUCKETS; i++)
+	_rtt_histogram[i] = 0;
+
     // Set the STCP keepalive timeout from environment variable if it is set.
     char* value = getenv("XORP_SENDER_KEEPALIVE_TIME");
     if (value != NULL) {
@@ -873,14 +902,16 @@ XrlPFSTCPSender::send(const Xrl&	x,
 
     if (direct_call) {
 	// We don't want to accept if we are short of resources
-	if (_active_requests >= MAX_ACTIVE_REQUESTS) {
+	if (_active_requests >= _window_requests) {
 	    debug_msg("too many requests %u\n",
 		      XORP_UINT_CAST(_active_requests));
+	    _refused++;
 	    return false;
 	}
-	if (x.packed_bytes() + _active_bytes > MAX_ACTIVE_BYTES) {
+	if (x.packed_bytes() + _active_bytes > _window_bytes) {
 	    debug_msg("too many bytes %u\n",
 		      XORP_UINT_CAST(x.packed_bytes()));
+	    _refused++;
 	    return false;
 	}
     }
@@ -951,10 +982,55 @@ XrlPFSTCPSender::update_writer(AsyncFileWriter::Event	e,
     }
 
     ref_ptr<RequestState> rrp = _requests_waiting.front();
+    TimeVal now;
+    _eventloop.current_time(now);
+    rrp->set_sent(now);
+    _bytes_sent += rrp->size();
     _requests_sent[rrp->seqno()] = rrp;
     _requests_waiting.pop_front();
 }
 
+void
+XrlPFSTCPSender::update_window(const RequestState& rs)
+{
+    TimeVal now;
+    _eventloop.current_time(now);
+    TimeVal rtt = now - rs.sent();
+
+    uint32_t bucket = 0;
+    for (TimeVal b(0, 1000); bucket < RTT_BUCKETS - 1 && rtt >= b; b = b * 10)
+	bucket++;
+    _rtt_histogram[bucket]++;
+
+    if (rtt < _rtt_min)
+	_rtt_min = rtt;
+    if (_responses++ == 0)
+	_srtt = rtt;
+    else
+	_srtt = (_srtt * 7 + rtt) / 8;
+
+    //
+    // As long as requests come back about as quickly as the quickest
+    // seen, the receiver is draining them as fast as they arrive and a
+    // window that is in use may grow.  Once they take longer, they are
+    // queueing at the receiver, so back off.  The window shrinks at
+    // most once per round trip, ie only for requests sent after the
+    // last time it shrank.
+    //
+    if (_srtt > _rtt_min * 2 + RTT_SLACK) {
+	if (rs.seqno() >= _window_seqno) {
+	    _window_requests -= _window_requests / 8;
+	    if (_window_requests < MIN_ACTIVE_REQUESTS)
+		_window_requests = MIN_ACTIVE_REQUESTS;
+	    _window_seqno = _current_seqno;
+	}
+    } else if (_active_requests * 2 >= _window_requests) {
+	if (_window_requests < MAX_ACTIVE_REQUESTS)
+	    _window_requests++;
+    }
+    _window_bytes = _window_requests * ACTIVE_BYTES_PER_REQUEST;
+}
+
 void
 XrlPFSTCPSender::read_event(BufferedAsyncReader* reader,
 			    BufferedAsyncReader::Event	ev,
@@ -1041,6 +1117,8 @@ XrlPFSTCPSender::read_event(BufferedAsyncReader* reader,
 
     // Get ref_ptr to callback from request state and discard the rest
     XrlPFSender::SendCallback cb = stptr->second->cb();
+    update_window(*stptr->second);
+    _bytes_received += sph.frame_bytes();
     dispose_request(stptr);
 
     xassert(_active_requests == _requests_waiting.size() + _requests_sent.size());
@@ -1122,6 +1200,37 @@ XrlPFSTCPSender::defer_keepalives()
     }
 }
 
+string
+XrlPFSTCPSender::stats() const
+{
+    TimeVal now;
+    _eventloop.current_time(now);
+    double elapsed = (now - _start_time).get_double();
+    if (elapsed <= 0)
+	elapsed = 1;
+
+    string rtt_min = _responses ? c_format("%.0f", _rtt_min.get_double() * 1e6)
+				: string("-");
+    return c_format("%s window %u/%u queued %u in-flight %u "
+		    "srtt %.0fus min %sus rtt <1ms:%u <10ms:%u <100ms:%u "
+		    "<1s:%u >=1s:%u responses %u refused %u "
+		    "sent %.0fB/s received %.0fB/s",
+		    XrlPFSender::stats().c_str(),
+		    XORP_UINT_CAST(_window_requests),
+		    XORP_UINT_CAST(_window_bytes),
+		    XORP_UINT_CAST(_requests_waiting.size()),
+		    XORP_UINT_CAST(_requests_sent.size()),
+		    _srtt.get_double() * 1e6, rtt_min.c_str(),
+		    XORP_UINT_CAST(_rtt_histogram[0]),
+		    XORP_UINT_CAST(_rtt_histogram[1]),
+		    XORP_UINT_CAST(_rtt_histogram[2]),
+		    XORP_UINT_CAST(_rtt_histogram[3]),
+		    XORP_UINT_CAST(_rtt_histogram[4]),
+		    XORP_UINT_CAST(_responses),
+		    XORP_UINT_CAST(_refused),
+		    _bytes_sent / elapsed, _bytes_received / elapsed);
+}
+
 string XrlPFSTCPSender::toString() const {
     ostringstream oss;
     TimeVal now;
@@ -1133,7 +1242,9 @@ string XrlPFSTCPSender::toString() const {
     oss << "writer: " << _writer << " uid: " << _uid << " requests-waiting: "
 	<< _requests_waiting.size() << " requests_sent: " << _requests_sent.size()
 	<< " current_seqno: " << _current_seqno << " active_bytes: " << _active_bytes
-	<< "\nactive_requests: " << _active_requests << " keepalive_time: "
+	<< "\nactive_requests: " << _active_requests << " window_requests: "
+	<< _window_requests << " window_bytes: " << _window_bytes
+	<< " keepalive_time: "
 	<< _keepalive_time.str() << " reader: " << _reader << " keepalive_sent: "
 	<< _keepalive_sent << " keepalive_liast_fired: " << _keepalive_last_fired.str()
 	<< " ago: " << ago.str() << "\nprotocol: " << _protocol
@@ -90,6 +90,31 @@ public:
     const TimeVal&	keepalive_time() const	    { return _keepalive_time; }
     virtual string toString() const; // for debugging
 
+    /**
+     * @return the number of requests that may currently be in flight
+     * before direct calls to send() are refused.
+     */
+    size_t		window_requests() const	    { return _window_requests; }
+
+    /**
+     * @return the number of bytes that may currently be in flight
+     * before direct calls to send() are refused.
+     */
+    size_t		window_bytes() const	    { return _window_bytes; }
+
+    /**
+     * @return the smoothed round trip time of requests.
+     */
+    const TimeVal&	srtt() const		    { return _srtt; }
+
+    virtual string stats() const;
+
+    /**
+     * Round trip times are counted in decades from below 1ms to 1s
+     * and above.
+     */
+    static const uint32_t RTT_BUCKETS = 5;
+
 protected:
     void construct();
 
@@ -113,6 +138,7 @@ private:
     typedef map<uint32_t, ref_ptr<RequestState> > RequestMap;
     void send_request(RequestState*);
     void dispose_request(RequestMap::iterator ptr);
+    void update_window(const RequestState& rs);
 
     void start_keepalives();
     void stop_keepalives();
@@ -136,6 +162,21 @@ private:
     size_t			 _active_bytes;
     size_t			 _active_requests;
 
+    // Adaptive in-flight window
+    size_t			 _window_requests;
+    size_t			 _window_bytes;
+    uint32_t			 _window_seqno;	// Seqno sent when last shrunk
+    TimeVal			 _srtt;
+    TimeVal			 _rtt_min;
+
+    // Statistics
+    TimeVal			 _start_time;
+    uint64_t			 _bytes_sent;
+    uint64_t			 _bytes_received;
+    uint32_t			 _responses;
+    uint32_t			 _refused;
+    uint32_t			 _rtt_histogram[RTT_BUCKETS];
+
     // Tunable timer variables
     TimeVal			_keepalive_time;
 
@@ -144,6 +144,9 @@ mk_instance_name(EventLoop& e, const char* classname)
 
 static const uint32_t DEFAULT_FINDER_CONNECT_TIMEOUT_MS = 30 * 1000;
 
+// Method registered by every router, see xrl/interfaces/xrl_stats.xif.
+static const char* XRL_STATS_GET_SENDER_STATS = "xrl_stats/0.1/get_sender_stats";
+
 uint32_t XrlRouter::_icnt = 0;
 
 void
@@ -229,6 +232,9 @@ XrlRouter::initialize(const char* class_name,
 	XLOG_FATAL("Failed to register target %s\n", class_name);
     }
 
+    add_handler(XRL_STATS_GET_SENDER_STATS,
+		callback(this, &XrlRouter::get_sender_stats));
+
     if (_icnt == 0)
 	XrlPFSenderFactory::startup();
     _icnt++;
@@ -753,6 +759,20 @@ string XrlRouter::toString() const {
 
 
 
+const XrlCmdError
+XrlRouter::get_sender_stats(const XrlArgs& /* inputs */, XrlArgs* outputs)
+{
+    XrlAtomList senders;
+    for (list< ref_ptr<XrlPFSender> >::const_iterator si = _senders.begin();
+	 si != _senders.end(); ++si) {
+	senders.append(XrlAtom((*si)->stats()));
+    }
+    if (outputs != NULL)
+	outputs->add_list("senders", senders);
+    return XrlCmdError::OKAY();
+}
+
+
 // ----------------------------------------------------------------------------
 // wait_until_xrl_router_is_ready
 
@@ -213,6 +213,13 @@ protected:
 		    IPv4	finder_addr,
 		    uint16_t	finder_port);
 
+    /**
+     * Handler for xrl_stats/0.1/get_sender_stats, which every router
+     * registers on behalf of its target.
+     */
+    const XrlCmdError get_sender_stats(const XrlArgs& inputs,
+				       XrlArgs*	      outputs);
+
 private:
     ref_ptr<XrlPFSender> lookup_sender(const Xrl& xrl, FinderDBEntry *dbe);
 
@@ -394,18 +394,14 @@ string AsyncFileReader::toString() const {
 // AsyncFileWriter write method and entry hook
 
 #ifndef MAX_IOVEC
-#define MAX_IOVEC 16
+#define MAX_IOVEC 64
 #endif
 
 AsyncFileWriter::AsyncFileWriter(EventLoop& e, XorpFd fd, uint32_t coalesce,
 				 int priority)
     : AsyncFileOperator(e, fd, priority)
 {
-    static const uint32_t max_coalesce = 16;
     _coalesce = (coalesce > MAX_IOVEC) ? MAX_IOVEC : coalesce;
-    if (_coalesce > max_coalesce) {
-	_coalesce = max_coalesce;
-    }
     _iov = new iovec[_coalesce];
     _dtoken = new int;
 }
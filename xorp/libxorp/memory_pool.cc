@@ -0,0 +1,92 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+// vim:set sts=4 ts=8:
+
+// Copyright (c) 2012 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+#include "libxorp_module.h"
+
+#include "xorp.h"
+#include "memory_pool.hh"
+
+#ifdef HOST_OS_WINDOWS
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+void*
+slab_alloc(size_t bytes)
+{
+#ifdef HOST_OS_WINDOWS
+    return _aligned_malloc(bytes, bytes);
+#else
+    //
+    // mmap() only aligns to a page, so map twice the size and unmap
+    // the parts before and after the aligned slab.
+    //
+    size_t len = 2 * bytes;
+    void* p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON,
+		   -1, 0);
+    if (p == MAP_FAILED)
+	return NULL;
+
+    char* start = static_cast<char*>(p);
+    uintptr_t addr = reinterpret_cast<uintptr_t>(p);
+    size_t head = ((addr + bytes - 1) & ~static_cast<uintptr_t>(bytes - 1))
+	- addr;
+    size_t tail = len - head - bytes;
+
+    if (head != 0)
+	munmap(start, head);
+    if (tail != 0)
+	munmap(start + head + bytes, tail);
+    return start + head;
+#endif
+}
+
+void
+slab_free(void* slab, size_t bytes)
+{
+#ifdef HOST_OS_WINDOWS
+    UNUSED(bytes);
+    _aligned_free(slab);
+#else
+    munmap(slab, bytes);
+#endif
+}
+
+static const size_t SLAB_MIN_BYTES = 64 * 1024;
+
+size_t
+slab_min_bytes()
+{
+    static size_t min_bytes = 0;
+
+    if (min_bytes == 0) {
+	min_bytes = SLAB_MIN_BYTES;
+#ifndef HOST_OS_WINDOWS
+	long page_size = sysconf(_SC_PAGESIZE);
+	while (page_size > 0 && min_bytes < static_cast<size_t>(page_size))
+	    min_bytes *= 2;
+#endif
+    }
+    return min_bytes;
+}
@@ -22,7 +22,51 @@
 #define _LIBXORP_MEMORY_POOL_HH_
 
 #include "xorp.h"
+#include "c_format.hh"
 
+/**
+ * Allocate a slab: a block of memory that is aligned to its own size.
+ *
+ * Where the system allows it the slab is mapped straight from the
+ * operating system, so that freeing it gives the memory back.
+ *
+ * @param bytes the size of the slab, a power of two no smaller than
+ * @ref slab_min_bytes.
+ * @return the slab, or NULL if there is no memory for it.
+ */
+void* slab_alloc(size_t bytes);
+
+/**
+ * Free a slab allocated by @ref slab_alloc.
+ *
+ * @param slab the slab.
+ * @param bytes the size the slab was allocated with.
+ */
+void slab_free(void* slab, size_t bytes);
+
+/**
+ * @return the smallest slab that may be allocated: 64KB, or the system
+ * page size if that is larger.  Slabs are large enough that a big table
+ * needs few mappings.
+ */
+size_t slab_min_bytes();
+
+/**
+ * @short A slab allocator for fixed size elements.
+ *
+ * Elements are carved from slabs holding at least EXPANSION_SIZE
+ * elements, so that they cost no allocator header each and elements
+ * allocated together are close together in memory.  Each slab is
+ * aligned to its size, so the slab an element belongs to is found from
+ * the element's address, and keeps its own free list.  Elements are
+ * carved from a new slab only as they are needed, so the untouched end
+ * of a slab costs no resident memory.
+ *
+ * Elements are allocated from the slabs that are already in use before
+ * a new slab is started.  When every element of a slab is free again
+ * the slab is returned to the operating system, except for one spare
+ * kept so that churn at a slab boundary does not map and unmap slabs.
+ */
 template <class T, size_t EXPANSION_SIZE = 100>
 class MemoryPool : public NONCOPYABLE {
 public:
@@ -34,67 +78,242 @@ public:
 
     // Return element to the free list
     void free(void* doomed);
+
+    // Bytes used by each element
+    size_t element_size() const { return _size; }
+
+    // Bytes in each slab
+    size_t slab_bytes() const { return _slab_bytes; }
+
+    // Elements carved from each slab
+    size_t slab_elements() const { return _slab_elements; }
+
+    // Elements allocated now, and the most that ever were
+    size_t in_use() const { return _in_use; }
+    size_t max_in_use() const { return _max_in_use; }
+
+    // Slabs held now, and the most that ever were
+    size_t slabs() const { return _slabs; }
+    size_t max_slabs() const { return _max_slabs; }
+
+    // Slabs returned to the operating system
+    size_t slabs_released() const { return _slabs_released; }
+
+    // Bytes held from the operating system
+    size_t bytes_allocated() const { return _slabs * _slab_bytes; }
+
+    /**
+     * @return the usage statistics as a string for debugging purposes.
+     */
+    string str() const;
+
 private:
-    // next element on the free list
-    MemoryPool<T, EXPANSION_SIZE>* _next;
+    struct FreeElement {
+	FreeElement* _next;
+    };
 
-    // Add free elements to the list
-    void expand_free_list();
+    // Header at the start of each slab
+    struct Slab {
+	Slab*		_prev;		// Slabs with free elements
+	Slab*		_next;
+	FreeElement*	_free;		// Freed elements of this slab
+	size_t		_carved;	// Elements ever allocated from it
+	size_t		_in_use;	// Elements allocated from it now
+    };
+
+    // Start a new slab
+    Slab* new_slab();
+
+    // Whether every element of a slab is allocated
+    bool is_full(const Slab* slab) const {
+	return slab->_free == NULL && slab->_carved == _slab_elements;
+    }
+
+    // Give an empty slab back to the operating system
+    void release_slab(Slab* slab);
+
+    // The slab an element was carved from
+    Slab* slab_of(void* element) const {
+	return reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(element)
+				       & ~static_cast<uintptr_t>(_slab_bytes - 1));
+    }
+
+    // Keep track of the slabs that have free elements
+    void link_partial(Slab* slab);
+    void unlink_partial(Slab* slab);
+
+    // The slabs that have free elements, allocated from at the head
+    Slab* _partial_head;
+    Slab* _partial_tail;
+
+    // An empty slab kept rather than released
+    Slab* _spare;
 
     size_t _size;
+    size_t _offset;		// Offset of the first element in a slab
+    size_t _slab_bytes;
+    size_t _slab_elements;
+
+    size_t _in_use;
+    size_t _max_in_use;
+    size_t _slabs;
+    size_t _max_slabs;
+    size_t _slabs_released;
 };
 
 template <class T, size_t EXPANSION_SIZE>
 MemoryPool<T, EXPANSION_SIZE>::MemoryPool() :
-    _size((sizeof(T) > sizeof(MemoryPool<T, EXPANSION_SIZE>)) ? sizeof(T) :sizeof(MemoryPool<T, EXPANSION_SIZE>))
+    _partial_head(NULL), _partial_tail(NULL), _spare(NULL),
+    _in_use(0), _max_in_use(0), _slabs(0), _max_slabs(0), _slabs_released(0)
 {
-    expand_free_list();
+    // Each element must be large enough to hold the next pointer while
+    // it is free, and aligned for both T and the next pointer.
+    size_t align = alignof(T) > alignof(FreeElement) ?
+	alignof(T) : alignof(FreeElement);
+    _size = sizeof(T) > sizeof(FreeElement) ? sizeof(T) : sizeof(FreeElement);
+    _size = (_size + align - 1) / align * align;
+    _offset = (sizeof(Slab) + align - 1) / align * align;
+
+    // The slab size must be a power of two for slab_of() to work; any
+    // room left over once EXPANSION_SIZE elements fit holds more.
+    _slab_bytes = slab_min_bytes();
+    while (_slab_bytes < _offset + _size * EXPANSION_SIZE)
+	_slab_bytes *= 2;
+    _slab_elements = (_slab_bytes - _offset) / _size;
 }
 
 template <class T, size_t EXPANSION_SIZE>
 MemoryPool<T, EXPANSION_SIZE>::~MemoryPool()
 {
-    for (MemoryPool<T, EXPANSION_SIZE> *nextPtr = _next; nextPtr != NULL; nextPtr = _next) {
-	_next = _next->_next;
-	delete [] reinterpret_cast<char* >(nextPtr);
-    }
+    // Pools are usually static; if elements are still in use they may
+    // be freed by later static destructors, so their memory must stay.
+    if (_in_use != 0)
+	return;
+
+    // With nothing in use every slab is on the partial list.
+    while (_partial_head != NULL)
+	release_slab(_partial_head);
 }
 
 template <class T, size_t EXPANSION_SIZE>
 inline void*
 MemoryPool<T, EXPANSION_SIZE>::alloc()
 {
-    if (!_next)
-	expand_free_list();
+    Slab* slab = _partial_head;
+    if (slab == NULL)
+	slab = new_slab();
+    if (slab == _spare)
+	_spare = NULL;
+
+    void* element;
+    if (slab->_free != NULL) {
+	element = slab->_free;
+	slab->_free = slab->_free->_next;
+    } else {
+	element = reinterpret_cast<char*>(slab) + _offset
+	    + slab->_carved * _size;
+	slab->_carved++;
+    }
+    if (is_full(slab))
+	unlink_partial(slab);
+    slab->_in_use++;
 
-    MemoryPool<T, EXPANSION_SIZE>* head = _next;
-    _next = head->_next;
-    return head;
+    if (++_in_use > _max_in_use)
+	_max_in_use = _in_use;
+    return element;
 }
 
 template <class T, size_t EXPANSION_SIZE>
 inline void
 MemoryPool<T, EXPANSION_SIZE>::free(void* doomed)
 {
-    MemoryPool<T, EXPANSION_SIZE>* head = reinterpret_cast<MemoryPool<T, EXPANSION_SIZE>* >(doomed);
+    FreeElement* head = reinterpret_cast<FreeElement*>(doomed);
+    Slab* slab = slab_of(doomed);
+
+    // A full slab goes to the back, so that the slabs that are already
+    // partly free are the ones that drain.
+    if (is_full(slab))
+	link_partial(slab);
+    head->_next = slab->_free;
+    slab->_free = head;
+    _in_use--;
+
+    if (--slab->_in_use != 0)
+	return;
+
+    if (_spare == NULL) {
+	_spare = slab;
+	return;
+    }
+    release_slab(slab);
+}
+
+template <class T, size_t EXPANSION_SIZE>
+typename MemoryPool<T, EXPANSION_SIZE>::Slab*
+MemoryPool<T, EXPANSION_SIZE>::new_slab()
+{
+    Slab* slab = static_cast<Slab*>(slab_alloc(_slab_bytes));
+    if (slab == NULL)
+	throw std::bad_alloc();
+
+    slab->_free = NULL;
+    slab->_carved = 0;
+    slab->_in_use = 0;
+    link_partial(slab);
+    if (++_slabs > _max_slabs)
+	_max_slabs = _slabs;
+    return slab;
+}
+
+template <class T, size_t EXPANSION_SIZE>
+void
+MemoryPool<T, EXPANSION_SIZE>::release_slab(Slab* slab)
+{
+    if (slab == _spare)
+	_spare = NULL;
+    unlink_partial(slab);
+    slab_free(slab, _slab_bytes);
+    _slabs--;
+    _slabs_released++;
+}
 
-    head->_next = _next;
-    _next = head;
+template <class T, size_t EXPANSION_SIZE>
+inline void
+MemoryPool<T, EXPANSION_SIZE>::link_partial(Slab* slab)
+{
+    slab->_next = NULL;
+    slab->_prev = _partial_tail;
+    if (_partial_tail != NULL)
+	_partial_tail->_next = slab;
+    else
+	_partial_head = slab;
+    _partial_tail = slab;
 }
 
 template <class T, size_t EXPANSION_SIZE>
 inline void
-MemoryPool<T, EXPANSION_SIZE>::expand_free_list()
+MemoryPool<T, EXPANSION_SIZE>::unlink_partial(Slab* slab)
 {
-    // We must allocate object large enough to contain the next pointer
-    MemoryPool<T, EXPANSION_SIZE>* runner = reinterpret_cast<MemoryPool<T, EXPANSION_SIZE>* >(new char[_size]);
+    if (slab->_prev != NULL)
+	slab->_prev->_next = slab->_next;
+    else
+	_partial_head = slab->_next;
+    if (slab->_next != NULL)
+	slab->_next->_prev = slab->_prev;
+    else
+	_partial_tail = slab->_prev;
+}
 
-    _next = runner;
-    for (size_t i = 0; i < EXPANSION_SIZE; ++i) {
-	runner->_next = reinterpret_cast<MemoryPool<T, EXPANSION_SIZE>* >(new char[_size]);
-	runner = runner->_next;
-    }
-    runner->_next = NULL;
+template <class T, size_t EXPANSION_SIZE>
+string
+MemoryPool<T, EXPANSION_SIZE>::str() const
+{
+    return c_format("%u elements of %u bytes in use (max %u), "
+		    "%u slabs of %u bytes (max %u), %u slabs released",
+		    XORP_UINT_CAST(_in_use), XORP_UINT_CAST(_size),
+		    XORP_UINT_CAST(_max_in_use), XORP_UINT_CAST(_slabs),
+		    XORP_UINT_CAST(_slab_bytes), XORP_UINT_CAST(_max_slabs),
+		    XORP_UINT_CAST(_slabs_released));
 }
 
 #endif /* MEMORY_POOL_HH_ */
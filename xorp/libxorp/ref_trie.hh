@@ -33,6 +33,7 @@
 #include "xlog.h"
 #include "debug.h"
 #include "minitraits.hh"
+#include "memory_pool.hh"
 #include "stack"
 
 
@@ -95,6 +96,13 @@ public:
 	    delete_payload(_p);
     }
 
+    /**
+     * Nodes are allocated from a pool: a trie holds as many of them as
+     * it has routes and more, all the same size.
+     */
+    void* operator new(size_t/* size*/)	{ return memory_pool().alloc(); }
+    void operator delete(void* ptr)	{ memory_pool().free(ptr); }
+
     /**
      * add a node to a subtree
      * @return a pointer to the node.
@@ -346,6 +354,11 @@ private:
 	UNUSED(msg);
     }
 
+    static MemoryPool<RefTrieNode, 1024>& memory_pool() {
+	static MemoryPool<RefTrieNode, 1024> mp;
+	return mp;
+    }
+
     RefTrieNode	*_up, *_left, *_right;
     Key		_k;
     PPayload 	*_p;
@@ -36,6 +36,10 @@
 
 #include "selector.hh"
 
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#endif
+
 
 // ----------------------------------------------------------------------------
 // Helper function to deal with translating between old and new
@@ -79,6 +83,7 @@ map_ioevent_to_selectormask(const IoEventType type)
 inline
 SelectorList::Node::Node() {
     magic = GOOD_NODE_MAGIC;
+    _ready = 0;
     for (int i = 0; i<SEL_MAX_IDX; i++) {
 	_mask[i] = 0;
 	_priority[i] = XorpTask::PRIORITY_INFINITY;
@@ -100,6 +105,7 @@ SelectorList::Node& SelectorList::Node::operator=(const Node& rhs) {
     if (this == &rhs) {
 	return *this;
     }
+    _ready = rhs._ready;
     for (int i = 0; i<SEL_MAX_IDX; i++) {
 	_mask[i] = rhs._mask[i];
 	_priority[i] = rhs._priority[i];
@@ -224,6 +230,304 @@ SelectorList::Node::is_empty()
 	    (_mask[SEL_EX_IDX] == 0));
 }
 
+inline int
+SelectorList::Node::interest() const
+{
+    return (_mask[SEL_RD_IDX] | _mask[SEL_WR_IDX] | _mask[SEL_EX_IDX]);
+}
+
+// ----------------------------------------------------------------------------
+// Readiness backends
+//
+// A backend only tracks which events are of interest on each descriptor
+// and reports which of them are ready.  Callbacks, priorities and the
+// round-robin state stay in SelectorList so that the dispatch order is
+// the same whichever backend is in use.
+
+struct SelectorReadyEvent {
+    int fd;
+    int mask;	// SelectorMask
+
+    SelectorReadyEvent(int f, int m) : fd(f), mask(m) {}
+};
+
+class SelectorBackend {
+public:
+    virtual ~SelectorBackend() {}
+
+    virtual SelectorBackendType type() const = 0;
+    virtual const char* name() const = 0;
+
+    /**
+     * Change the set of events of interest on a descriptor.
+     *
+     * @param fd the file descriptor.
+     * @param old_mask the previous SelectorMask (SEL_NONE if new).
+     * @param new_mask the new SelectorMask (SEL_NONE to stop watching).
+     * @return true on success, false if the descriptor can't be watched.
+     */
+    virtual bool update(int fd, int old_mask, int new_mask) = 0;
+
+    /**
+     * Wait for events.  The ready descriptors are available from
+     * @ref ready_events until the next call.
+     *
+     * @param to the timeout, or NULL to wait forever.
+     * @param maxfd the largest descriptor ever added.
+     * @return the number of ready (fd, event) pairs, or -1 with errno set.
+     */
+    virtual int wait(struct timeval* to, int maxfd) = 0;
+
+    const vector<SelectorReadyEvent>& ready_events() const { return _ready; }
+
+protected:
+    vector<SelectorReadyEvent>	_ready;
+};
+
+class SelectBackend : public SelectorBackend {
+public:
+    SelectBackend() {
+	for (int i = 0; i < 3; i++)
+	    FD_ZERO(&_fds[i]);
+    }
+
+    SelectorBackendType type() const { return SELECTOR_BACKEND_SELECT; }
+    const char* name() const { return "select"; }
+
+    bool update(int fd, int old_mask, int new_mask) {
+	UNUSED(old_mask);
+	if (fd >= FD_SETSIZE) {
+	    XLOG_ERROR("Cannot select on fd %d, FD_SETSIZE is %d",
+		       fd, FD_SETSIZE);
+	    return false;
+	}
+	for (int i = 0; i < 3; i++) {
+	    if (new_mask & (1 << i))
+		FD_SET(fd, &_fds[i]);
+	    else
+		FD_CLR(fd, &_fds[i]);
+	}
+	return true;
+    }
+
+    int wait(struct timeval* to, int maxfd) {
+	fd_set testfds[3];
+
+	memcpy(testfds, _fds, sizeof(_fds));
+	_ready.clear();
+
+	int n = ::select(maxfd + 1, &testfds[0], &testfds[1], &testfds[2], to);
+	if (n <= 0)
+	    return n;
+
+	for (int fd = 0; fd <= maxfd; fd++) {
+	    int mask = 0;
+	    for (int i = 0; i < 3; i++) {
+		if (FD_ISSET(fd, &testfds[i]))
+		    mask |= (1 << i);
+	    }
+	    if (mask)
+		_ready.push_back(SelectorReadyEvent(fd, mask));
+	}
+	return n;
+    }
+
+private:
+    fd_set	_fds[3];
+};
+
+#ifdef HAVE_SYS_EPOLL_H
+class EpollBackend : public SelectorBackend {
+public:
+    EpollBackend() : _epfd(-1), _polled_n(0) {}
+
+    ~EpollBackend() {
+	if (_epfd >= 0)
+	    ::close(_epfd);
+    }
+
+    bool init() {
+	_epfd = ::epoll_create1(EPOLL_CLOEXEC);
+	if (_epfd < 0) {
+	    XLOG_ERROR("epoll_create1() failed: %s", strerror(errno));
+	    return false;
+	}
+	return true;
+    }
+
+    SelectorBackendType type() const { return SELECTOR_BACKEND_EPOLL; }
+    const char* name() const { return "epoll"; }
+
+    bool update(int fd, int old_mask, int new_mask) {
+	if ((size_t)fd < _polled.size() && _polled[fd]) {
+	    // A descriptor epoll refused, see below.
+	    _polled[fd] = new_mask;
+	    if (new_mask == 0)
+		_polled_n--;
+	    return true;
+	}
+
+	if ((size_t)fd >= _interest.size())
+	    _interest.resize(fd + 1, 0);
+	_interest[fd] = new_mask;
+
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.data.fd = fd;
+	if (new_mask & SEL_RD)
+	    ev.events |= EPOLLIN;
+	if (new_mask & SEL_WR)
+	    ev.events |= EPOLLOUT;
+	if (new_mask & SEL_EX)
+	    ev.events |= EPOLLPRI;
+
+	if (new_mask == 0) {
+	    // The descriptor may already be closed, which removes it from
+	    // the epoll set implicitly.
+	    if ((::epoll_ctl(_epfd, EPOLL_CTL_DEL, fd, &ev) < 0)
+		&& (errno != EBADF) && (errno != ENOENT)) {
+		XLOG_ERROR("epoll_ctl(DEL, %d) failed: %s", fd,
+			   strerror(errno));
+	    }
+	    return true;
+	}
+
+	int op = (old_mask == 0) ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+	if (::epoll_ctl(_epfd, op, fd, &ev) == 0)
+	    return true;
+
+	// The descriptor was closed and its number reused while still
+	// registered, so the kernel forgot about it.
+	if ((op == EPOLL_CTL_MOD) && (errno == ENOENT)
+	    && (::epoll_ctl(_epfd, EPOLL_CTL_ADD, fd, &ev) == 0))
+	    return true;
+
+	// Regular files and some character devices can't be epolled, but
+	// select(2) and poll(2) always report them as ready.
+	if (errno == EPERM) {
+	    if ((size_t)fd >= _polled.size())
+		_polled.resize(fd + 1, 0);
+	    _polled[fd] = new_mask;
+	    _polled_n++;
+	    return true;
+	}
+
+	XLOG_ERROR("epoll_ctl(%s, %d) failed: %s",
+		   (op == EPOLL_CTL_ADD) ? "ADD" : "MOD", fd, strerror(errno));
+	return false;
+    }
+
+    int wait(struct timeval* to, int maxfd) {
+	UNUSED(maxfd);
+	int timeout_ms = -1;
+
+	_ready.clear();
+	if ((to != NULL) && (to->tv_sec < INT_MAX / 1000 - 1)) {
+	    // Round up, so we never wake up before a timer expires.
+	    timeout_ms = to->tv_sec * 1000 + (to->tv_usec + 999) / 1000;
+	}
+	if (_polled_n > 0)
+	    timeout_ms = 0;
+
+	if (_events.size() < 64)
+	    _events.resize(64);
+
+	int n = ::epoll_wait(_epfd, &_events[0], _events.size(), timeout_ms);
+	if (n < 0)
+	    return n;
+
+	int count = 0;
+	for (int i = 0; i < n; i++) {
+	    uint32_t ev = _events[i].events;
+	    int mask = 0;
+
+	    // Map onto the select(2) semantics: errors and hangups make a
+	    // descriptor both readable and writable.
+	    if (ev & (EPOLLIN | EPOLLERR | EPOLLHUP))
+		mask |= SEL_RD;
+	    if (ev & (EPOLLOUT | EPOLLERR | EPOLLHUP))
+		mask |= SEL_WR;
+	    if (ev & EPOLLPRI)
+		mask |= SEL_EX;
+
+	    // Errors and hangups are reported whatever the interest, so
+	    // one nobody listens for would wake us up forever.  Stop
+	    // watching the descriptor; the next update() adds it back.
+	    int fd = _events[i].data.fd;
+	    mask &= ((size_t)fd < _interest.size()) ? _interest[fd] : 0;
+	    if (mask == 0) {
+		if ((ev & (EPOLLERR | EPOLLHUP))
+		    && (::epoll_ctl(_epfd, EPOLL_CTL_DEL, fd, &_events[i]) < 0)
+		    && (errno != EBADF) && (errno != ENOENT)) {
+		    XLOG_ERROR("epoll_ctl(DEL, %d) failed: %s", fd,
+			       strerror(errno));
+		}
+		continue;
+	    }
+	    _ready.push_back(SelectorReadyEvent(fd, mask));
+	    count += (mask & SEL_RD) ? 1 : 0;
+	    count += (mask & SEL_WR) ? 1 : 0;
+	    count += (mask & SEL_EX) ? 1 : 0;
+	}
+
+	if (_polled_n > 0) {
+	    for (size_t fd = 0; fd < _polled.size(); fd++) {
+		int mask = _polled[fd];
+		if (mask == 0)
+		    continue;
+		_ready.push_back(SelectorReadyEvent(fd, mask));
+		count += (mask & SEL_RD) ? 1 : 0;
+		count += (mask & SEL_WR) ? 1 : 0;
+		count += (mask & SEL_EX) ? 1 : 0;
+	    }
+	}
+
+	// Everything fitted: make room for more next time, since with
+	// level-triggered events the remainder would only be reported on a
+	// later wakeup.
+	if ((size_t)n == _events.size())
+	    _events.resize(_events.size() * 2);
+
+	return count;
+    }
+
+private:
+    int				_epfd;
+    vector<struct epoll_event>	_events;
+    vector<int>			_interest;	// SelectorMask of each fd
+    vector<int>			_polled;	// always-ready fds
+    int				_polled_n;
+};
+#endif // HAVE_SYS_EPOLL_H
+
+static SelectorBackend*
+create_selector_backend(SelectorBackendType type)
+{
+    if (type == SELECTOR_BACKEND_DEFAULT) {
+	const char* v = getenv("XORP_SELECTOR");
+
+	type = SELECTOR_BACKEND_EPOLL;
+	if (v != NULL) {
+	    if (strcmp(v, "select") == 0)
+		type = SELECTOR_BACKEND_SELECT;
+	    else if (strcmp(v, "epoll") != 0)
+		XLOG_WARNING("Unknown XORP_SELECTOR value \"%s\", ignoring", v);
+	}
+    }
+
+#ifdef HAVE_SYS_EPOLL_H
+    if (type == SELECTOR_BACKEND_EPOLL) {
+	EpollBackend* epoll_backend = new EpollBackend();
+	if (epoll_backend->init())
+	    return epoll_backend;
+	delete epoll_backend;
+	XLOG_WARNING("Falling back to select(2) for I/O multiplexing");
+    }
+#endif
+
+    return new SelectBackend();
+}
+
 // ----------------------------------------------------------------------------
 // SelectorList implementation
 
@@ -235,8 +539,10 @@ SelectorList::Node::is_empty()
 // the call to dispatch().
 // Seems like a lot of pain to fix this right, so in the meantime, will pre-allocate
 // logs of space in the selector_entries vector in hopes we do not have to resize.
-SelectorList::SelectorList(ClockBase *clock)
-    : _clock(clock), _observer(NULL), _testfds_n(0), _last_served_fd(-1),
+SelectorList::SelectorList(ClockBase *clock, SelectorBackendType backend)
+    : _clock(clock), _observer(NULL),
+      _backend(create_selector_backend(backend)),
+      _testfds_n(0), _maxpri_fd(-1), _maxpri_sel(-1), _last_served_fd(-1),
       _last_served_sel(-1),
       // XXX: Preallocate to work around use-after-free in Node::run_hooks().
       _selector_entries(1024),
@@ -244,12 +550,23 @@ SelectorList::SelectorList(ClockBase *clock)
 {
     x_static_assert(SEL_RD == (1 << SEL_RD_IDX) && SEL_WR == (1 << SEL_WR_IDX)
 		  && SEL_EX == (1 << SEL_EX_IDX) && SEL_MAX_IDX == 3);
-    for (int i = 0; i < SEL_MAX_IDX; i++)
-	FD_ZERO(&_fds[i]);
 }
 
 SelectorList::~SelectorList()
 {
+    delete _backend;
+}
+
+SelectorBackendType
+SelectorList::backend_type() const
+{
+    return _backend->type();
+}
+
+const char*
+SelectorList::backend_name() const
+{
+    return _backend->name();
 }
 
 bool
@@ -270,26 +587,27 @@ SelectorList::add_ioevent_cb(XorpFd		fd,
 		   "descriptor (fd = %s)\n", fd.str().c_str());
     }
 
-    if (fd.getSocket() >= _maxfd) {
-	_maxfd = fd;
-	if ((size_t)fd >= _selector_entries.size()) {
-	    _selector_entries.resize(fd + 32);
-	}
+    if ((size_t)fd >= _selector_entries.size()) {
+	_selector_entries.resize(fd + 32);
     }
 
-    bool no_selectors_with_fd = _selector_entries[fd].is_empty();
-    if (_selector_entries[fd].add_okay(mask, type, cb, priority) == false) {
+    Node& node = _selector_entries[fd];
+    int old_interest = node.interest();
+    bool no_selectors_with_fd = node.is_empty();
+    if (node.add_okay(mask, type, cb, priority) == false) {
+	return false;
+    }
+    if (_backend->update(fd, old_interest, node.interest()) == false) {
+	node.clear(mask);
 	return false;
     }
+    if (fd.getSocket() > _maxfd)
+	_maxfd = fd;
     if (no_selectors_with_fd)
 	_descriptor_count++;
 
-    for (int i = 0; i < SEL_MAX_IDX; i++) {
-	if (mask & (1 << i)) {
-	    FD_SET(fd, &_fds[i]);
-	    if (_observer) _observer->notify_added(fd, mask);
-	}
-    }
+    if (_observer)
+	_observer->notify_added(fd, mask);
 
     return true;
 }
@@ -297,8 +615,6 @@ SelectorList::add_ioevent_cb(XorpFd		fd,
 void
 SelectorList::remove_ioevent_cb(XorpFd fd, IoEventType type)
 {
-    bool found = false;
-
     if (fd < 0 || fd >= (int)_selector_entries.size()) {
 	XLOG_ERROR("Attempting to remove fd = %d that is outside range of "
 		   "file descriptors 0..%u", (int)fd,
@@ -307,25 +623,32 @@ SelectorList::remove_ioevent_cb(XorpFd fd, IoEventType type)
     }
 
     SelectorMask mask = map_ioevent_to_selectormask(type);
+    Node& node = _selector_entries[fd];
+    int old_interest = node.interest();
+    int found = old_interest & mask;
+
+    if (! found) {
+	// XXX: no event that needs to be removed has been found
+	return;
+    }
 
     for (int i = 0; i < SEL_MAX_IDX; i++) {
-	if (mask & (1 << i) && FD_ISSET(fd, &_fds[i])) {
-	    found = true;
-	    FD_CLR(fd, &_fds[i]);
+	if (found & (1 << i)) {
 	    if (_observer)
 		_observer->notify_removed(fd, ((SelectorMask) (1 << i)));
+	    // Drop any event from the last wait that is still undispatched.
+	    if (node._ready & (1 << i)) {
+		node._ready &= ~(1 << i);
+		_testfds_n--;
+		if ((_maxpri_fd == fd) && (_maxpri_sel == i))
+		    _maxpri_fd = -1;
+	    }
 	}
     }
-    if (! found) {
-	// XXX: no event that needs to be removed has been found
-	return;
-    }
 
-    _selector_entries[fd].clear(mask);
-    if (_selector_entries[fd].is_empty()) {
-	assert(FD_ISSET(fd, &_fds[SEL_RD_IDX]) == 0);
-	assert(FD_ISSET(fd, &_fds[SEL_WR_IDX]) == 0);
-	assert(FD_ISSET(fd, &_fds[SEL_EX_IDX]) == 0);
+    node.clear(mask);
+    _backend->update(fd, old_interest, node.interest());
+    if (node.is_empty()) {
 	_descriptor_count--;
     }
 }
@@ -333,19 +656,13 @@ SelectorList::remove_ioevent_cb(XorpFd fd, IoEventType type)
 bool
 SelectorList::ready()
 {
-    fd_set testfds[SEL_MAX_IDX];
     int n = 0;
 
-    memcpy(testfds, _fds, sizeof(_fds));
     struct timeval tv_zero;
     tv_zero.tv_sec = 0;
     tv_zero.tv_usec = 0;
 
-    n = ::select(_maxfd + 1,
-		 &testfds[SEL_RD_IDX],
-		 &testfds[SEL_WR_IDX],
-		 &testfds[SEL_EX_IDX],
-		 &tv_zero);
+    n = _backend->wait(&tv_zero, _maxfd);
 
     if (n < 0) {
 	switch (errno) {
@@ -372,6 +689,15 @@ SelectorList::ready()
 	return true;
 }
 
+void
+SelectorList::clear_ready()
+{
+    for (size_t i = 0; i < _ready_fds.size(); i++)
+	_selector_entries[_ready_fds[i]]._ready = 0;
+    _ready_fds.clear();
+    _testfds_n = 0;
+}
+
 int
 SelectorList::do_select(struct timeval* to, bool force)
 {
@@ -380,18 +706,14 @@ SelectorList::do_select(struct timeval* to, bool force)
 
     _maxpri_fd = _maxpri_sel = -1;
 
-    memcpy(_testfds, _fds, sizeof(_fds));
+    clear_ready();
 
-    _testfds_n = ::select(_maxfd + 1,
-		          &_testfds[SEL_RD_IDX],
-		          &_testfds[SEL_WR_IDX],
-		          &_testfds[SEL_EX_IDX],
-		          to);
+    int n = _backend->wait(to, _maxfd);
 
     if (!to || to->tv_sec > 0)
 	    _clock->advance_time();
 
-    if (_testfds_n < 0) {
+    if (n < 0) {
 	switch (errno) {
 	case EBADF:
 	    callback_bad_descriptors();
@@ -408,6 +730,26 @@ SelectorList::do_select(struct timeval* to, bool force)
 	    XLOG_ERROR("SelectorList::ready() failed: %s", strerror(errno));
 	    break;
 	}
+	return n;
+    }
+
+    const vector<SelectorReadyEvent>& events = _backend->ready_events();
+    for (size_t i = 0; i < events.size(); i++) {
+	int fd = events[i].fd;
+	if ((size_t)fd >= _selector_entries.size())
+	    continue;
+	Node& node = _selector_entries[fd];
+	// Only keep events someone still listens for.
+	int mask = events[i].mask & node.interest();
+	if (mask == 0)
+	    continue;
+	if (node._ready == 0)
+	    _ready_fds.push_back(fd);
+	for (int sel_idx = 0; sel_idx < SEL_MAX_IDX; sel_idx++) {
+	    if ((mask & (1 << sel_idx)) && !(node._ready & (1 << sel_idx)))
+		_testfds_n++;
+	}
+	node._ready |= mask;
     }
 
     return _testfds_n;
@@ -427,48 +769,47 @@ SelectorList::get_ready_priority(bool force)
 	return _selector_entries[_maxpri_fd]._priority[_maxpri_sel];
 
     int max_priority = XorpTask::PRIORITY_INFINITY;
+    int best_distance = 0;
+    int span = _maxfd + 1;
 
     //
-    // Test the priority of remaining events for the last served file
-    // descriptor.
+    // Pick the ready event with the best priority.  Ties are broken in
+    // round-robin order: first the remaining events for the last served
+    // file descriptor, then descriptors starting at (_last_served_fd + 1)
+    // and wrapping around.  Only descriptors reported by the last wait
+    // are visited, so the cost does not depend on the descriptor count.
     //
     bool found_one = false;
-    if ((_last_served_fd >= 0) && (_last_served_fd <= _maxfd)) {
-	for (int sel_idx = _last_served_sel + 1;
-	     sel_idx < SEL_MAX_IDX;
-	     sel_idx++) {
-	    if (FD_ISSET(_last_served_fd, &_testfds[sel_idx])) {
-		int p = _selector_entries[_last_served_fd]._priority[sel_idx];
-		if ((p < max_priority) || (!found_one)) {
-		    found_one = true;
-		    max_priority = p;
-		    _maxpri_fd   = _last_served_fd;
-		    _maxpri_sel  = sel_idx;
-		}
-	    }
-	}
-    }
-
-    for (int i = 0; i <= _maxfd; i++) {
-	//
-	// Use (_last_served_fd + 1) as a starting offset in the round-robin
-	// search for the next file descriptor with the best priority.
-	//
-	int fd = (i + _last_served_fd + 1) % (_maxfd + 1);
+    for (size_t i = 0; i < _ready_fds.size(); i++) {
+	int fd = _ready_fds[i];
+	const Node& node = _selector_entries[fd];
+	if (node._ready == 0)
+	    continue;
 	for (int sel_idx = 0; sel_idx < SEL_MAX_IDX; sel_idx++) {
-	    if (FD_ISSET(fd, &_testfds[sel_idx])) {
-		int p = _selector_entries[fd]._priority[sel_idx];
-		if ((p < max_priority) || (!found_one)) {
-		    found_one = true;
-		    max_priority = p;
-		    _maxpri_fd   = fd;
-		    _maxpri_sel  = sel_idx;
-		}
+	    if (! (node._ready & (1 << sel_idx)))
+		continue;
+	    int distance;
+	    if ((fd == _last_served_fd) && (sel_idx > _last_served_sel))
+		distance = -1;
+	    else
+		distance = (fd - _last_served_fd - 1 + span) % span;
+	    int p = node._priority[sel_idx];
+	    if ((!found_one) || (p < max_priority)
+		|| ((p == max_priority) && (distance < best_distance))) {
+		found_one = true;
+		max_priority  = p;
+		best_distance = distance;
+		_maxpri_fd    = fd;
+		_maxpri_sel   = sel_idx;
 	    }
 	}
     }
 
-    XLOG_ASSERT(_maxpri_fd != -1);
+    if (! found_one) {
+	// All the pending events were removed by callbacks.
+	clear_ready();
+	return XorpTask::PRIORITY_INFINITY;
+    }
 
     return max_priority;
 }
@@ -490,23 +831,15 @@ SelectorList::wait_and_dispatch(TimeVal& timeout)
     if (n <= 0)
 	return 0;
 
-    get_ready_priority(false);
+    if (get_ready_priority(false) == XorpTask::PRIORITY_INFINITY)
+	return 0;
 
     XLOG_ASSERT(_maxpri_fd != -1);
 
-    // I hit this assert while trying to add 5000 BGP originate-routes via call_xrl:
-    // /usr/local/xorp/bgp/harness/originate_routes.pl ip=10.1.1.0 nh=10.1.1.1 sigb=4 amt=5000
-    // I cannot figure out how this assert could happen..unless maybe there is some re-entry issue or
-    // similar.  Going to deal with things as best as possible w/out asserting.
-    // TODO:  Re-write this logic entirely to be less crufty all around.
-    if (!(FD_ISSET(_maxpri_fd, &_testfds[_maxpri_sel]))) {
-	_testfds_n = 0;
-	_maxpri_fd = -1;
-	_maxpri_sel = -1;
-	return 0;
-    }
+    Node& node = _selector_entries[_maxpri_fd];
+    XLOG_ASSERT(node._ready & (1 << _maxpri_sel));
 
-    FD_CLR(_maxpri_fd, &_testfds[_maxpri_sel]);
+    node._ready &= ~(1 << _maxpri_sel);
 
     SelectorMask sm = SEL_NONE;
 
@@ -529,16 +862,19 @@ SelectorList::wait_and_dispatch(TimeVal& timeout)
 
 
     XLOG_ASSERT((_maxpri_fd >= 0) && (_maxpri_fd < (int)(_selector_entries.size())));
-    XLOG_ASSERT(_selector_entries[_maxpri_fd].magic == GOOD_NODE_MAGIC);
-
-    _selector_entries[_maxpri_fd].run_hooks(sm, _maxpri_fd);
+    XLOG_ASSERT(node.magic == GOOD_NODE_MAGIC);
 
+    int fd = _maxpri_fd;
     _last_served_fd = _maxpri_fd;
     _last_served_sel = _maxpri_sel;
     _maxpri_fd = -1;
     _testfds_n--;
     XLOG_ASSERT(_testfds_n >= 0);
 
+    // XXX: the callback may add or remove descriptors, so the SelectorList
+    // state must be consistent before it runs.
+    _selector_entries[fd].run_hooks(sm, fd);
+
     return 1; // XXX what does the return value mean?
 }
 
@@ -552,12 +888,13 @@ SelectorList::wait_and_dispatch(int millisecs)
 void
 SelectorList::get_fd_set(SelectorMask selected_mask, fd_set& fds) const
 {
-    if (SEL_RD == selected_mask)
-	fds = _fds [SEL_RD_IDX];
-    if (SEL_WR == selected_mask)
-	fds = _fds [SEL_WR_IDX];
-    if (SEL_EX == selected_mask)
-	fds = _fds [SEL_EX_IDX];
+    FD_ZERO(&fds);
+
+    int limit = min(_maxfd, FD_SETSIZE - 1);
+    for (int fd = 0; fd <= limit; fd++) {
+	if (_selector_entries[fd].interest() & selected_mask)
+	    FD_SET(fd, &fds);
+    }
     return;
 }
 
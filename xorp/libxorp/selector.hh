@@ -42,6 +42,7 @@
 #include "task.hh"
 
 class ClockBase;
+class SelectorBackend;
 class SelectorList;
 class TimeVal;
 
@@ -57,6 +58,15 @@ enum SelectorMask {
     SEL_ALL	= SEL_RD | SEL_WR | SEL_EX	// All events
 };
 
+/**
+ * Readiness notification mechanisms a SelectorList can be built on.
+ */
+enum SelectorBackendType {
+    SELECTOR_BACKEND_DEFAULT	= 0,	// Best available (see XORP_SELECTOR)
+    SELECTOR_BACKEND_SELECT	= 1,	// select(2), fds below FD_SETSIZE only
+    SELECTOR_BACKEND_EPOLL	= 2	// Linux epoll(7)
+};
+
 class SelectorTag;
 
 typedef ref_ptr<SelectorTag> Selector;
@@ -106,8 +116,16 @@ public:
 
     /**
      * Default constructor.
+     *
+     * @param clock the clock to advance after blocking waits.
+     * @param backend the readiness notification mechanism to use.  If
+     * it is SELECTOR_BACKEND_DEFAULT, the XORP_SELECTOR environment
+     * variable ("select" or "epoll") is consulted, otherwise the best
+     * mechanism available on this host is used.  A mechanism that
+     * cannot be initialized falls back to select(2).
      */
-    SelectorList(ClockBase* clock);
+    SelectorList(ClockBase* clock,
+		 SelectorBackendType backend = SELECTOR_BACKEND_DEFAULT);
 
     /**
      * Destructor.
@@ -195,6 +213,20 @@ public:
      */
     size_t descriptor_count() const { return _descriptor_count; }
 
+    /**
+     * Get the readiness notification mechanism in use.
+     *
+     * @return the backend type (never SELECTOR_BACKEND_DEFAULT).
+     */
+    SelectorBackendType backend_type() const;
+
+    /**
+     * Get the name of the readiness notification mechanism in use.
+     *
+     * @return "select" or "epoll".
+     */
+    const char* backend_name() const;
+
     /**
      * Get a copy of the current list of monitored file descriptors in
      * Unix fd_set format
@@ -232,6 +264,7 @@ protected:
 
 private:
     int do_select(struct timeval* to, bool force);
+    void clear_ready();
 
 private:
     enum {
@@ -247,6 +280,7 @@ private:
     struct Node {
 	int magic; // catch memory errors.
 	int		_mask[SEL_MAX_IDX];
+	int		_ready;	// SelectorMask of undispatched events
 	IoEventCb	_cb[SEL_MAX_IDX];
 	// Reverse mapping of legacy UNIX event to IoEvent
 	IoEventType	_iot[SEL_MAX_IDX];
@@ -262,13 +296,14 @@ private:
 	int		run_hooks(SelectorMask m, XorpFd fd);
 	void		clear(SelectorMask m);
 	bool		is_empty();
+	int		interest() const;
     };
 
     ClockBase*		_clock;
     SelectorListObserverBase * _observer;
-    fd_set		_fds[SEL_MAX_IDX];
-    fd_set		_testfds[SEL_MAX_IDX];
-    int			_testfds_n;
+    SelectorBackend*	_backend;
+    vector<int>		_ready_fds;	// fds with events from last wait
+    int			_testfds_n;	// count of undispatched events
     int			_maxpri_fd;
     int			_maxpri_sel;
     int			_last_served_fd;
@@ -0,0 +1,215 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+// vim:set sts=4 ts=8:
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License, Version
+// 2.1, June 1999 as published by the Free Software Foundation.
+// Redistribution and/or modification of this program under the terms of
+// any other version of the GNU Lesser General Public License is not
+// permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU Lesser General Public License, Version 2.1, a copy of
+// which can be found in the XORP LICENSE.lgpl file.
+//
+// XORP, Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+#include "libxorp_module.h"
+#include "libxorp/xorp.h"
+#include "libxorp/xlog.h"
+#include "libxorp/clock.hh"
+#include "libxorp/timeval.hh"
+#include "libxorp/selector.hh"
+
+#ifdef HAVE_GETOPT_H
+#include <getopt.h>
+#endif
+#ifdef HAVE_SYS_RESOURCE_H
+#include <sys/resource.h>
+#endif
+#include <sys/socket.h>
+
+//
+// Measure the cost of one SelectorList wakeup against the number of
+// idle descriptors being watched, for each available backend.
+//
+// Every iteration makes exactly one of the watched socket pairs readable
+// and then waits for SelectorList to dispatch it, so the time per
+// iteration is the cost the event loop pays for each I/O event.
+//
+
+namespace {
+
+class Bench {
+public:
+    Bench(SelectorBackendType backend, unsigned pairs);
+    ~Bench();
+
+    bool ok() const { return _ok; }
+    SelectorBackendType backend_type() const { return _sl.backend_type(); }
+    const char* backend_name() const { return _sl.backend_name(); }
+
+    // Return the average wakeup time in microseconds.
+    double run(unsigned iterations);
+
+private:
+    void read_cb(XorpFd fd, IoEventType type);
+
+    SystemClock		_clock;
+    SelectorList	_sl;
+    vector<int>		_rd;
+    vector<int>		_wr;
+    unsigned		_dispatched;
+    bool		_ok;
+};
+
+Bench::Bench(SelectorBackendType backend, unsigned pairs)
+    : _sl(&_clock, backend), _dispatched(0), _ok(true)
+{
+    for (unsigned i = 0; i < pairs; i++) {
+	int s[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, s) < 0) {
+	    _ok = false;
+	    return;
+	}
+	_rd.push_back(s[0]);
+	_wr.push_back(s[1]);
+	if (! _sl.add_ioevent_cb(XorpFd(s[0]), IOT_READ,
+				 callback(this, &Bench::read_cb))) {
+	    _ok = false;
+	    return;
+	}
+    }
+}
+
+Bench::~Bench()
+{
+    for (size_t i = 0; i < _rd.size(); i++) {
+	_sl.remove_ioevent_cb(XorpFd(_rd[i]), IOT_READ);
+	close(_rd[i]);
+	close(_wr[i]);
+    }
+}
+
+void
+Bench::read_cb(XorpFd fd, IoEventType type)
+{
+    char c;
+
+    UNUSED(type);
+    if (read(fd, &c, 1) == 1)
+	_dispatched++;
+}
+
+double
+Bench::run(unsigned iterations)
+{
+    TimeVal start, end;
+    char c = 'x';
+
+    _clock.advance_time();
+    _clock.current_time(start);
+    for (unsigned i = 0; i < iterations; i++) {
+	// Spread the active descriptor over the whole range.
+	size_t idx = (i * 7919) % _wr.size();
+	unsigned expected = _dispatched + 1;
+
+	if (write(_wr[idx], &c, 1) != 1)
+	    return -1.0;
+	while (_dispatched != expected)
+	    _sl.wait_and_dispatch(1000);
+    }
+    _clock.advance_time();
+    _clock.current_time(end);
+
+    return (end - start).get_double() * 1.0e6 / iterations;
+}
+
+void
+raise_fd_limit(unsigned wanted)
+{
+#ifdef HAVE_SYS_RESOURCE_H
+    struct rlimit rl;
+
+    if (getrlimit(RLIMIT_NOFILE, &rl) != 0)
+	return;
+    if (rl.rlim_cur >= wanted)
+	return;
+    rl.rlim_cur = (rl.rlim_max == RLIM_INFINITY || rl.rlim_max >= wanted) ?
+	wanted : rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+#else
+    UNUSED(wanted);
+#endif
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char *argv[])
+{
+    unsigned max_pairs = 4096;
+    unsigned iterations = 20000;
+    int ch;
+
+    xlog_init(argv[0], NULL);
+    xlog_set_verbose(XLOG_VERBOSE_LOW);
+    xlog_level_set_verbose(XLOG_LEVEL_ERROR, XLOG_VERBOSE_HIGH);
+    xlog_add_default_output();
+    xlog_start();
+
+    while ((ch = getopt(argc, argv, "hn:i:")) != -1) {
+	switch (ch) {
+	case 'n':
+	    max_pairs = atoi(optarg);
+	    break;
+	case 'i':
+	    iterations = atoi(optarg);
+	    break;
+	case 'h':
+	default:
+	    printf("Usage: %s <opts>\n"
+		   "-h\thelp\n"
+		   "-n <n>\tlargest number of watched descriptors [%u]\n"
+		   "-i <n>\twakeups per measurement [%u]\n"
+		   , argv[0], max_pairs, iterations);
+	    exit(1);
+	}
+    }
+    if (iterations == 0)
+	iterations = 1;
+
+    raise_fd_limit(2 * max_pairs + 64);
+
+    SelectorBackendType backends[] = { SELECTOR_BACKEND_SELECT,
+				       SELECTOR_BACKEND_EPOLL };
+
+    printf("%-8s %8s %12s\n", "backend", "fds", "usec/wakeup");
+    for (size_t b = 0; b < sizeof(backends) / sizeof(backends[0]); b++) {
+	for (unsigned n = 16; n <= max_pairs; n *= 4) {
+	    Bench bench(backends[b], n);
+
+	    // The backend isn't available on this host.
+	    if (bench.backend_type() != backends[b])
+		break;
+	    if (! bench.ok()) {
+		printf("%-8s %8u %12s\n", bench.backend_name(), n, "n/a");
+		break;
+	    }
+	    double usec = bench.run(iterations);
+	    printf("%-8s %8u %12.2f\n", bench.backend_name(), n, usec);
+	}
+    }
+
+    xlog_stop();
+    xlog_exit();
+
+    return 0;
+}
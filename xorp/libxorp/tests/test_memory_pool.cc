@@ -0,0 +1,255 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+// vim:set sts=4 ts=8:
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License, Version
+// 2.1, June 1999 as published by the Free Software Foundation.
+// Redistribution and/or modification of this program under the terms of
+// any other version of the GNU Lesser General Public License is not
+// permitted.
+// 
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU Lesser General Public License, Version 2.1, a copy of
+// which can be found in the XORP LICENSE.lgpl file.
+// 
+// XORP, Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+#include "libxorp_module.h"
+
+#include "libxorp/xorp.h"
+#include "libxorp/xlog.h"
+#include "libxorp/exceptions.hh"
+
+#ifdef HAVE_GETOPT_H
+#include <getopt.h>
+#endif
+
+#include "memory_pool.hh"
+
+
+//
+// XXX: MODIFY FOR YOUR TEST PROGRAM
+//
+static const char *program_name		= "test_memory_pool";
+static const char *program_description	= "Test MemoryPool slab allocator";
+static const char *program_version_id	= "0.1";
+static const char *program_date		= "October 17, 2026";
+static const char *program_copyright	= "See file LICENSE";
+static const char *program_return_value	= "0 on success, 1 if test error, 2 if internal error";
+
+static bool s_verbose = false;
+bool verbose()			{ return s_verbose; }
+void set_verbose(bool v)	{ s_verbose = v; }
+
+static int s_failures = 0;
+bool failures()			{ return s_failures; }
+void incr_failures()		{ s_failures++; }
+
+#include "libxorp/xorp_tests.hh"
+
+/**
+ * Print program info to output stream.
+ *
+ * @param stream the output stream the print the program info to.
+ */
+static void
+print_program_info(FILE *stream)
+{
+    fprintf(stream, "Name:          %s\n", program_name);
+    fprintf(stream, "Description:   %s\n", program_description);
+    fprintf(stream, "Version:       %s\n", program_version_id);
+    fprintf(stream, "Date:          %s\n", program_date);
+    fprintf(stream, "Copyright:     %s\n", program_copyright);
+    fprintf(stream, "Return:        %s\n", program_return_value);
+}
+
+/**
+ * Print program usage information to the stderr.
+ *
+ * @param progname the name of the program.
+ */
+static void
+usage(const char* progname)
+{
+    print_program_info(stderr);
+    fprintf(stderr, "usage: %s [-v] [-h]\n", progname);
+    fprintf(stderr, "       -h          : usage (this message)\n");
+    fprintf(stderr, "       -v          : verbose output\n");
+    fprintf(stderr, "Return 0 on success, 1 if test error, 2 if internal error.\n");
+}
+
+struct Element {
+    double	_d;
+    uint32_t	_u[5];
+};
+
+typedef MemoryPool<Element, 100> ElementPool;
+
+/**
+ * Test the slab geometry.
+ */
+void
+test_memory_pool_geometry()
+{
+    ElementPool pool;
+
+    verbose_assert(pool.element_size() >= sizeof(Element), "element size");
+    verbose_assert(pool.element_size() % alignof(Element) == 0,
+		   "element alignment");
+    verbose_assert(pool.slab_bytes() >= slab_min_bytes(), "slab size");
+    verbose_assert((pool.slab_bytes() & (pool.slab_bytes() - 1)) == 0,
+		   "slab size is a power of two");
+    verbose_assert(pool.slab_elements() >= 100, "elements per slab");
+    verbose_assert(pool.slabs() == 0 && pool.bytes_allocated() == 0,
+		   "no slab until the first allocation");
+}
+
+/**
+ * Test that empty slabs are released, keeping one spare.
+ */
+void
+test_memory_pool_release()
+{
+    ElementPool pool;
+    size_t n = 3 * pool.slab_elements() + 1;
+    vector<Element*> elements;
+
+    for (size_t i = 0; i < n; i++) {
+	Element* e = static_cast<Element*>(pool.alloc());
+	e->_u[0] = i;
+	elements.push_back(e);
+    }
+    verbose_log("%s\n", pool.str().c_str());
+    verbose_assert(pool.in_use() == n, "elements in use");
+    verbose_assert(pool.slabs() == 4, "slabs in use");
+    verbose_assert(set<Element*>(elements.begin(), elements.end()).size() == n,
+		   "elements are distinct");
+
+    bool intact = true;
+    for (size_t i = 0; i < n; i++) {
+	if (elements[i]->_u[0] != i)
+	    intact = false;
+	pool.free(elements[i]);
+    }
+    elements.clear();
+    verbose_log("%s\n", pool.str().c_str());
+    verbose_assert(intact, "elements do not overlap");
+    verbose_assert(pool.in_use() == 0, "no elements in use");
+    verbose_assert(pool.max_in_use() == n, "max elements in use");
+    verbose_assert(pool.slabs() == 1, "one spare slab kept");
+    verbose_assert(pool.max_slabs() == 4, "max slabs");
+    verbose_assert(pool.slabs_released() == 3, "slabs released");
+    verbose_assert(pool.bytes_allocated() == pool.slab_bytes(),
+		   "bytes allocated");
+
+    // The spare is used before another slab is allocated.
+    for (size_t i = 0; i < pool.slab_elements(); i++)
+	elements.push_back(static_cast<Element*>(pool.alloc()));
+    verbose_assert(pool.slabs() == 1, "spare slab reused");
+    for (size_t i = 0; i < elements.size(); i++)
+	pool.free(elements[i]);
+}
+
+/**
+ * Test that slabs with free elements are filled before a new one
+ * is allocated.
+ */
+void
+test_memory_pool_reuse()
+{
+    ElementPool pool;
+    size_t per_slab = pool.slab_elements();
+    vector<Element*> elements;
+
+    for (size_t i = 0; i < 2 * per_slab; i++)
+	elements.push_back(static_cast<Element*>(pool.alloc()));
+    verbose_assert(pool.slabs() == 2, "two slabs in use");
+
+    // Free all but one element of each slab.
+    for (size_t i = 0; i < 2 * per_slab; i++) {
+	if (i % per_slab != 0)
+	    pool.free(elements[i]);
+    }
+    verbose_assert(pool.slabs() == 2, "partly used slabs kept");
+    verbose_assert(pool.in_use() == 2, "elements in use");
+
+    vector<Element*> more;
+    for (size_t i = 0; i < 2 * (per_slab - 1); i++)
+	more.push_back(static_cast<Element*>(pool.alloc()));
+    verbose_assert(pool.slabs() == 2, "free elements reused");
+    verbose_assert(pool.max_slabs() == 2, "no new slab allocated");
+
+    more.push_back(static_cast<Element*>(pool.alloc()));
+    verbose_assert(pool.slabs() == 3, "new slab once the others are full");
+
+    for (size_t i = 0; i < more.size(); i++)
+	pool.free(more[i]);
+    pool.free(elements[0]);
+    pool.free(elements[per_slab]);
+    verbose_assert(pool.in_use() == 0 && pool.slabs() == 1,
+		   "all but the spare released");
+}
+
+int
+main(int argc, char * const argv[])
+{
+    int ret_value = 0;
+
+    //
+    // Initialize and start xlog
+    //
+    xlog_init(argv[0], NULL);
+    xlog_set_verbose(XLOG_VERBOSE_LOW);         // Least verbose messages
+    // XXX: verbosity of the error messages temporary increased
+    xlog_level_set_verbose(XLOG_LEVEL_ERROR, XLOG_VERBOSE_HIGH);
+    xlog_add_default_output();
+    xlog_start();
+
+    int ch;
+    while ((ch = getopt(argc, argv, "hv")) != -1) {
+	switch (ch) {
+	case 'v':
+	    set_verbose(true);
+	    break;
+	case 'h':
+	case '?':
+	default:
+	    usage(argv[0]);
+	    xlog_stop();
+	    xlog_exit();
+	    if (ch == 'h')
+		return (0);
+	    else
+		return (1);
+	}
+    }
+    argc -= optind;
+    argv += optind;
+
+    XorpUnexpectedHandler x(xorp_unexpected_handler);
+    try {
+	test_memory_pool_geometry();
+	test_memory_pool_release();
+	test_memory_pool_reuse();
+	ret_value = failures() ? 1 : 0;
+    } catch (...) {
+	// Internal error
+	xorp_print_standard_exceptions();
+	ret_value = 2;
+    }
+
+    //
+    // Gracefully stop and exit xlog
+    //
+    xlog_stop();
+    xlog_exit();
+
+    return (ret_value);
+}
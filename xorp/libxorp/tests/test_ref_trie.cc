@@ -26,6 +26,8 @@
 #include "xorp.h"
 #include "ipv4net.hh"
 #include "ipv6net.hh"
+#include "timer.hh"
+#include "trie.hh"
 #include "ref_trie.hh"
 
 static bool s_verbose = false;
@@ -264,6 +266,80 @@ void test_equals_postorder()
     print_passed("");
 }
 
+//
+// Longest prefix match throughput over a table shaped roughly like a BGP
+// feed, against the same table in an indexed Trie.
+//
+
+static uint32_t
+xorshift(uint32_t& x)
+{
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+static double
+elapsed(const TimeVal& start)
+{
+    TimeVal end;
+
+    TimerList::system_gettimeofday(&end);
+    return (end - start).sec() + (end - start).usec() / 1000000.0;
+}
+
+void
+test_lookup_rate(uint32_t nprefixes, uint32_t nlookups)
+{
+    RefTrie<IPv4, IPv4RouteEntry*> reftrie;
+    Trie<IPv4, IPv4RouteEntry*> indexed;
+    vector<IPv4RouteEntry> routes(nprefixes);
+    vector<IPv4> addrs;
+    uint32_t x = 2463534242U;
+
+    indexed.set_lookup_stride(16);
+    for (uint32_t i = 0; i < nprefixes; i++) {
+	uint32_t r = xorshift(x);
+	uint32_t len = (r % 16 == 0) ? 8 + (r >> 8) % 16 : 24;
+	IPv4Net net(IPv4(htonl(xorshift(x))), len);
+
+	reftrie.insert(net, &routes[i]);
+	indexed.insert(net, &routes[i]);
+    }
+    for (uint32_t i = 0; i < nlookups; i++)
+	addrs.push_back(IPv4(htonl(xorshift(x))));
+
+    uintptr_t sum = 0;
+    TimeVal start;
+    TimerList::system_gettimeofday(&start);
+    for (size_t i = 0; i < addrs.size(); i++) {
+	RefTrie<IPv4, IPv4RouteEntry*>::iterator ti = reftrie.find(addrs[i]);
+	if (ti != reftrie.end())
+	    sum += reinterpret_cast<uintptr_t>(ti.payload());
+    }
+    double ref_secs = elapsed(start);
+
+    TimerList::system_gettimeofday(&start);
+    for (size_t i = 0; i < addrs.size(); i++) {
+	Trie<IPv4, IPv4RouteEntry*>::iterator ti = indexed.find(addrs[i]);
+	if (ti != indexed.end())
+	    sum -= reinterpret_cast<uintptr_t>(ti.payload());
+    }
+    double indexed_secs = elapsed(start);
+
+    if (sum != 0) {
+	print_failed("RefTrie and Trie lookups differ");
+	abort();
+    }
+    printf("%u prefixes, %u lookups: RefTrie %.0f lookups/s, "
+	   "indexed Trie %.0f lookups/s\n",
+	   XORP_UINT_CAST(reftrie.route_count()), XORP_UINT_CAST(nlookups),
+	   ref_secs > 0 ? nlookups / ref_secs : 0,
+	   indexed_secs > 0 ? nlookups / indexed_secs : 0);
+    print_passed("");
+}
+
 int main() {
 
     IPv4RouteEntry d1;
@@ -718,4 +794,6 @@ int main() {
 
     printf("Test Passed: " __FILE__ " " __METHOD__ " " "\n");
 #endif
+
+    test_lookup_rate(200000, 1000000);
 }
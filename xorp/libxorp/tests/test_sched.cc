@@ -495,6 +495,54 @@ test_fd_1high_2low_starve(void)
     }
 }
 
+void
+note_event(XorpFd, IoEventType type, IoEventType* seen)
+{
+    *seen = type;
+}
+
+// A hangup on a descriptor watched only for exceptions is of no interest,
+// and must not keep waking the event loop up.
+void
+test_fd_hangup_no_spin(void)
+{
+    xsock_t s[2];
+    IoEventType seen = IOT_ANY;
+
+    xprintf("Running %s\n", __FUNCTION__);
+
+    if (Libcomm::comm_sock_pair(AF_UNIX, SOCK_STREAM, 0, s) != XORP_OK)
+	xorp_throw(TestException, "comm_sock_pair()");
+
+    XorpFd fd(s[0]);
+    TEST_ASSERT(_eventloop.add_ioevent_cb(fd, IOT_EXCEPTION,
+					  callback(note_event, &seen)));
+    Libcomm::comm_sock_close(s[1]);
+
+    bool timeout = false;
+    XorpTimer t = _eventloop.set_flag_after_ms(200, &timeout);
+    unsigned runs = 0;
+    while (!timeout) {
+	_eventloop.run();
+	runs++;
+    }
+    xprintf("Event loop ran %u times\n", runs);
+    TEST_ASSERT(runs < 10);
+    TEST_ASSERT(seen == IOT_ANY);
+
+    // Watching it for reading again still reports the hangup.
+    TEST_ASSERT(_eventloop.add_ioevent_cb(fd, IOT_READ,
+					  callback(note_event, &seen)));
+    timeout = false;
+    t = _eventloop.set_flag_after_ms(1000, &timeout);
+    while (seen == IOT_ANY && !timeout)
+	_eventloop.run();
+    TEST_ASSERT(seen == IOT_READ);
+
+    _eventloop.remove_ioevent_cb(fd);
+    Libcomm::comm_sock_close(s[0]);
+}
+
 struct Test {
     void	(*_run)(void);
     bool	_fails;
@@ -505,6 +553,7 @@ struct Test _tests[] = {
     { test_fd_2read_starve, false, "Two readers, same priority, check starve" },
     { test_fd_read_write_starve, false, "RW same FD & priority, check starve" },
     { test_fd_1high_2low_starve, true, "High pri. starving some low pri." },
+    { test_fd_hangup_no_spin, false, "Unwatched hangup, check spin" },
 };
 
 void
@@ -26,6 +26,7 @@
 #include "xorp.h"
 #include "ipv4net.hh"
 #include "ipv6net.hh"
+#include "timer.hh"
 #include "trie.hh"
 
 static bool s_verbose = false;
@@ -326,6 +327,163 @@ test_find_subtree()
     print_passed("");
 }
 
+//
+// Longest prefix match over a table shaped roughly like a BGP feed:
+// mostly /24s, some shorter prefixes and a default route.  The same
+// table is kept with and without the lookup index, and every lookup
+// must agree between the two, also after half of the table is removed.
+//
+
+static uint32_t
+xorshift(uint32_t& x)
+{
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+static IPv4
+random_addr(uint32_t& x, const IPv4*)
+{
+    return IPv4(htonl(xorshift(x)));
+}
+
+static IPv6
+random_addr(uint32_t& x, const IPv6*)
+{
+    uint32_t a[4];
+
+    // keep to 2000::/3 as a real IPv6 table would
+    a[0] = htonl(0x20000000 | (xorshift(x) & 0x1fffffff));
+    for (int i = 1; i < 4; i++)
+	a[i] = htonl(xorshift(x));
+    return IPv6(a);
+}
+
+template <class A>
+static double
+lookup_rate(const Trie<A, IPv4RouteEntry*>& t, const vector<A>& addrs,
+	    uintptr_t& sum)
+{
+    TimeVal start, end;
+
+    TimerList::system_gettimeofday(&start);
+    for (size_t i = 0; i < addrs.size(); i++) {
+	typename Trie<A, IPv4RouteEntry*>::iterator ti = t.find(addrs[i]);
+	if (ti != t.end())
+	    sum += reinterpret_cast<uintptr_t>(ti.payload());
+    }
+    TimerList::system_gettimeofday(&end);
+
+    double secs = (end - start).sec() + (end - start).usec() / 1000000.0;
+    return secs > 0 ? addrs.size() / secs : 0;
+}
+
+template <class A>
+static void
+check_same(const Trie<A, IPv4RouteEntry*>& plain,
+	   const Trie<A, IPv4RouteEntry*>& indexed,
+	   const vector<A>& addrs, const vector<IPNet<A> >& nets)
+{
+    typedef typename Trie<A, IPv4RouteEntry*>::iterator Iter;
+
+    for (size_t i = 0; i < addrs.size(); i++) {
+	Iter a = plain.find(addrs[i]);
+	Iter b = indexed.find(addrs[i]);
+	if ((a == plain.end()) != (b == indexed.end())
+	    || (a != plain.end() && a.payload() != b.payload())) {
+	    print_failed(c_format("lookup of %s differs",
+				  addrs[i].str().c_str()).c_str());
+	    abort();
+	}
+    }
+    for (size_t i = 0; i < nets.size(); i++) {
+	Iter a = plain.find_less_specific(nets[i]);
+	Iter b = indexed.find_less_specific(nets[i]);
+	if ((a == plain.end()) != (b == indexed.end())
+	    || (a != plain.end() && a.payload() != b.payload())) {
+	    print_failed(c_format("less specific of %s differs",
+				  nets[i].str().c_str()).c_str());
+	    abort();
+	}
+	a = plain.lookup_node(nets[i]);
+	b = indexed.lookup_node(nets[i]);
+	if ((a == plain.end()) != (b == indexed.end())) {
+	    print_failed(c_format("exact lookup of %s differs",
+				  nets[i].str().c_str()).c_str());
+	    abort();
+	}
+    }
+}
+
+template <class A>
+void
+test_lookup_index(uint32_t nprefixes, uint32_t nlookups, uint32_t shortest,
+		  uint32_t typical)
+{
+    Trie<A, IPv4RouteEntry*> plain, indexed;
+    vector<IPv4RouteEntry> routes(nprefixes + 1);
+    vector<IPNet<A> > nets;
+    vector<A> addrs;
+    uint32_t x = 2463534242U;
+
+    indexed.set_lookup_stride(16);
+
+    for (uint32_t i = 0; i < nprefixes; i++) {
+	uint32_t r = xorshift(x);
+	uint32_t len = (r % 16 == 0) ? shortest + (r >> 8) % (typical - shortest)
+	    : typical;
+	IPNet<A> net(random_addr(x, (const A*)0), len);
+
+	plain.insert(net, &routes[i]);
+	indexed.insert(net, &routes[i]);
+	nets.push_back(net);
+    }
+    IPNet<A> def;
+    plain.insert(def, &routes[nprefixes]);
+    indexed.insert(def, &routes[nprefixes]);
+
+    for (uint32_t i = 0; i < nlookups; i++)
+	addrs.push_back(random_addr(x, (const A*)0));
+    // also look up inside the prefixes we know are there
+    for (uint32_t i = 0; i < nets.size() && i < nlookups; i++)
+	addrs[i] = nets[i].masked_addr();
+
+    check_same(plain, indexed, addrs, nets);
+
+    uintptr_t sum = 0;
+    double plain_rate = lookup_rate(plain, addrs, sum);
+    double indexed_rate = lookup_rate(indexed, addrs, sum);
+    printf("%u prefixes, %u lookups: %.0f lookups/s, "
+	   "%.0f lookups/s with a 16 bit index\n",
+	   XORP_UINT_CAST(plain.route_count()), XORP_UINT_CAST(nlookups),
+	   plain_rate, indexed_rate);
+
+    // the index must follow nodes coming and going
+    for (size_t i = 0; i < nets.size(); i += 2) {
+	if (plain.lookup_node(nets[i]) == plain.end())
+	    continue;
+	plain.erase(nets[i]);
+	indexed.erase(nets[i]);
+    }
+    plain.erase(def);
+    indexed.erase(def);
+    check_same(plain, indexed, addrs, nets);
+
+    indexed.set_lookup_stride(0);
+    indexed.set_lookup_stride(12);
+    check_same(plain, indexed, addrs, nets);
+
+    plain.delete_all_nodes();
+    indexed.delete_all_nodes();
+    if (indexed.find(addrs[0]) != indexed.end()) {
+	print_failed("lookup in an emptied trie found something");
+	abort();
+    }
+    print_passed("lookup index agrees with the trie");
+}
+
 int main() {
     //test that find works OK with an empty trie (ie finds nothing).
     IPv4 a("1.0.0.0");
@@ -728,4 +886,7 @@ int main() {
     print_passed("");
 
     test_find_subtree();
+
+    test_lookup_index<IPv4>(200000, 1000000, 8, 24);
+    test_lookup_index<IPv6>(20000, 100000, 16, 48);
 }
@@ -32,6 +32,7 @@
 #include "xlog.h"
 #include "debug.h"
 #include "minitraits.hh"
+#include "memory_pool.hh"
 
 #ifndef XORP_USE_USTL
 #include <stack>
@@ -74,7 +75,7 @@ public:
      */
     TrieNode() : _up(0), _left(0), _right(0), _k(Key()), _p(0) {}
     TrieNode(const Key& key, const Payload& p, TrieNode* up = 0) :
-	_up(up), _left(0), _right(0), _k(key), _p(new PPayload(p)) {}
+	_up(up), _left(0), _right(0), _k(key), _p(new_payload(p)) {}
 
     explicit TrieNode(const Key& key, TrieNode* up = 0) :
 	_up(up), _left(0), _right(0), _k(key), _p(0) {}
@@ -131,7 +132,7 @@ public:
     void set_payload(const Payload& p) {
 	if (_p)
 	    delete_payload(_p);
-	_p = new PPayload(p);
+	_p = new_payload(p);
     }
 
     const Key &k() const			{ return _k;		}
@@ -276,10 +277,32 @@ public:
 	return n->_k.top_addr();
     }
 
+    void* operator new(size_t/* size*/)	{ return memory_pool().alloc(); }
+    void operator delete(void* ptr)	{ memory_pool().free(ptr); }
+
 private:
+    /*
+     * Payloads are kept apart from the nodes, as a node need not have
+     * one, but come from a pool as well.
+     */
+    static PPayload* new_payload(const Payload& p) {
+	return new (payload_pool().alloc()) PPayload(p);
+    }
+
     /* delete_payload is a separate method to allow specialization */
-    void delete_payload(Payload* p) {
-	delete p;
+    void delete_payload(PPayload* p) {
+	p->~PPayload();
+	payload_pool().free(p);
+    }
+
+    static MemoryPool<TrieNode, 1024>& memory_pool() {
+	static MemoryPool<TrieNode, 1024> mp;
+	return mp;
+    }
+
+    static MemoryPool<PPayload, 1024>& payload_pool() {
+	static MemoryPool<PPayload, 1024> mp;
+	return mp;
     }
 
     void dump(const char *msg) const
@@ -510,6 +533,126 @@ private:
     stack<Node*> _stack;
 };
 
+/**
+ * @short Direct-pointing first level for a Trie.
+ *
+ * A binary trie walks the top of the address space one node at a time
+ * on every lookup, and those nodes are scattered across the heap.  This
+ * table is indexed by the top _stride bits of an address instead, in the
+ * manner of the first level of an LC-trie or Poptrie.  Slot i holds the
+ * deepest node whose key covers all of block i, and the most specific
+ * node with a payload on the way to it.  A lookup for a key at least
+ * _stride bits long starts from there, and only descends the part of the
+ * trie below the block.
+ *
+ * Only nodes with a prefix no longer than _stride appear in the table,
+ * so inserting or erasing a longer prefix leaves it untouched unless the
+ * trie had to add or remove an internal node above it.
+ */
+template <class A, class Payload>
+class TrieLookupIndex {
+public:
+    typedef IPNet<A> Key;
+    typedef TrieNode<A, Payload> Node;
+
+    TrieLookupIndex(uint32_t stride) : _stride(stride), _slots(1U << stride)
+    {}
+
+    uint32_t stride() const			{ return _stride; }
+
+    /**
+     * Longest match for a key at least _stride bits long.
+     */
+    Node* find(Node* root, const Key& key) const {
+	const Slot& s = _slots[slot(key.masked_addr())];
+	Node* cand = s._cand;
+	Node* r = s._node ? s._node : root;
+
+	while (r && r->k().contains(key)) {
+	    if (r->has_payload())
+		cand = r;
+	    if (r->get_left() && r->get_left()->k().contains(key))
+		r = r->get_left();
+	    else
+		r = r->get_right();
+	}
+	return cand;
+    }
+
+    /**
+     * Recompute the slots covered by key after the trie changed below
+     * it.  Keys longer than _stride do not appear in the table.
+     */
+    void update(Node* root, const Key& key) {
+	if (key.prefix_len() > _stride)
+	    return;
+
+	Node* d = NULL;
+	Node* cand = NULL;
+	for (Node* r = root; r && r->k().prefix_len() <= _stride
+		 && r->k().contains(key); ) {
+	    d = r;
+	    if (r->has_payload())
+		cand = r;
+	    if (r->get_left() && r->get_left()->k().contains(key))
+		r = r->get_left();
+	    else
+		r = r->get_right();
+	}
+	fill(key, d, cand);
+	if (d != NULL) {
+	    paint_children(d, cand, key);
+	} else if (root && key.contains(root->k())
+		   && root->k().prefix_len() <= _stride) {
+	    paint(root, root->has_payload() ? root : NULL);
+	}
+    }
+
+    void clear() {
+	for (size_t i = 0; i < _slots.size(); i++)
+	    _slots[i] = Slot();
+    }
+
+private:
+    struct Slot {
+	Slot() : _node(NULL), _cand(NULL) {}
+	Node*	_node;
+	Node*	_cand;
+    };
+
+    uint32_t slot(const A& a) const {
+	return a.bits(a.addr_bitlen() - _stride, _stride);
+    }
+
+    void fill(const Key& key, Node* node, Node* cand) {
+	uint32_t first = slot(key.masked_addr());
+	uint32_t n = 1U << (_stride - key.prefix_len());
+
+	for (uint32_t i = first; i < first + n; i++) {
+	    _slots[i]._node = node;
+	    _slots[i]._cand = cand;
+	}
+    }
+
+    void paint(Node* node, Node* cand) {
+	fill(node->k(), node, cand);
+	paint_children(node, cand, node->k());
+    }
+
+    void paint_children(Node* node, Node* cand, const Key& key) {
+	Node* children[2] = { node->get_left(), node->get_right() };
+
+	for (int i = 0; i < 2; i++) {
+	    Node* c = children[i];
+	    if (c && c->k().prefix_len() <= _stride && key.contains(c->k()))
+		paint(c, c->has_payload() ? c : cand);
+	}
+    }
+
+    uint32_t		_stride;
+    vector<Slot>	_slots;
+};
+
 /**
  * The Trie itself
  *
@@ -530,9 +673,34 @@ public:
     /**
      * stl map interface
      */
-    Trie() : _root(0), _payload_count(0)	{}
+    Trie() : _root(0), _payload_count(0), _index(0)	{}
+
+    ~Trie()					{
+	delete_all_nodes();
+	delete _index;
+    }
+
+    /**
+     * Index the top bits of the address space in a flat table, so that
+     * lookups skip the top levels of the trie.  The table takes
+     * 2^stride slots of two pointers each, so this is meant for large,
+     * lookup-heavy tables.
+     *
+     * @param stride the number of bits to index, or 0 to drop the index.
+     */
+    void set_lookup_stride(uint32_t stride)	{
+	XLOG_ASSERT(stride <= 24);
+	delete _index;
+	_index = NULL;
+	if (stride == 0)
+	    return;
+	_index = new TrieLookupIndex<A, Payload>(stride);
+	_index->update(_root, Key());
+    }
 
-    ~Trie()					{ delete_all_nodes(); }
+    uint32_t lookup_stride() const		{
+	return _index ? _index->stride() : 0;
+    }
 
     /**
      * insert a key,payload pair, returns an iterator
@@ -551,6 +719,12 @@ public:
 	    fprintf(stderr, "overwriting a full node"); //XXX
 	}
 #endif
+	if (_index) {
+	    // an empty parent may have been created to hold the new node
+	    Node *up = out->get_parent();
+	    _index->update(_root, up && !up->has_payload() ? up->k()
+			   : out->k());
+	}
 	return iterator(out);
     }
 
@@ -566,8 +740,13 @@ public:
     void erase(iterator i)			{
 	if (_root && i.cur() && i.cur()->has_payload()) {
 	    _payload_count--;
+	    // an empty parent goes away with the node
+	    Node *up = i.cur()->get_parent();
+	    Key k = up && !up->has_payload() ? up->k() : i.cur()->k();
 	    _root = const_cast<Node *>(i.cur())->erase();
 	    // XXX should invalidate i ?
+	    if (_index)
+		_index->update(_root, k);
 	}
     }
 
@@ -589,7 +768,7 @@ public:
      */
     iterator find(const Key &k) const {
 	if (_root)
-	    return iterator(_root->find(k));
+	    return iterator(find_node(k));
 	return end();
     }
 
@@ -618,6 +797,8 @@ public:
 	    _root->delete_subtree();
 	_root = NULL;
 	_payload_count = 0;
+	if (_index)
+	    _index->clear();
     }
 
     /**
@@ -625,7 +806,7 @@ public:
      *
      */
     iterator lookup_node(const Key & k) const	{
-	Node *n = (_root) ? _root->find(k) : NULL;
+	Node *n = (_root) ? find_node(k) : NULL;
 	return (n && n->k() == k) ? iterator(n) : end();
     }
 
@@ -650,7 +831,7 @@ public:
 
 	Key x(key.masked_addr(), key.prefix_len() - 1);
 
-	return (_root) ? iterator(_root->find(x)) : end();
+	return (_root) ? iterator(find_node(x)) : end();
     }
 
     /**
@@ -690,8 +871,15 @@ private:
 	    _root->validate(NULL);
     }
 
+    Node *find_node(const Key &k) const		{
+	if (_index && k.prefix_len() >= _index->stride())
+	    return _index->find(_root, k);
+	return _root->find(k);
+    }
+
     Node	*_root;
     size_t	_payload_count;
+    TrieLookupIndex<A, Payload> *_index;
 };
 
 
@@ -54,6 +54,7 @@ AreaRouter<A>::AreaRouter(Ospf<A>& ospf, OspfTypes::AreaID area,
     : _ospf(ospf), _area(area), _area_type(area_type),
       _summaries(true), _stub_default_announce(false), _stub_default_cost(0),
       _external_flooding(false),
+      _spt(ospf.trace()._spt),
       _last_entry(0), _allocated_entries(0), _readers(0),
       _queue(ospf.get_eventloop(),
 	     OspfTypes::MinLSInterval,
@@ -65,6 +66,7 @@ AreaRouter<A>::AreaRouter(Ospf<A>& ospf, OspfTypes::AreaID area,
       _TransitCapability(false),
 #endif
       _routing_recompute_delay(1),	// In seconds.
+      _routing_total(false),
       _translator_role(OspfTypes::CANDIDATE),
       _translator_state(OspfTypes::DISABLED),
       _type7_propagate(false)	// Default from RFC 3210 Appendix A
@@ -77,6 +79,9 @@ AreaRouter<A>::AreaRouter(Ospf<A>& ospf, OspfTypes::AreaID area,
     _invalid_lsa = Lsa::LsaRef(new RouterLsa(_ospf.get_version()));
     _invalid_lsa->invalidate();
 
+    _router_lsa_type = RouterLsa(_ospf.get_version()).get_ls_type();
+    _network_lsa_type = NetworkLsa(_ospf.get_version()).get_ls_type();
+
     // Never need to delete this as the ref_ptr will tidy up.
     RouterLsa *rlsa = new RouterLsa(_ospf.get_version());
     rlsa->set_self_originating(true);
@@ -2611,6 +2616,9 @@ AreaRouter<A>::receive_lsas(OspfTypes::PeerID peerid,
 		    // invalidated by the external code. So the new
 		    // LSA just needs to added to the database.
 		    XLOG_ASSERT(!_db[index]->valid());
+		    // The old LSA may not describe the same network as
+		    // the new one, withdraw its route as update_lsa() does.
+		    routing_delete(_db[index]);
 		    add_lsa((*i));
 		} else {
 		    update_lsa((*i), index);
@@ -2859,6 +2867,7 @@ AreaRouter<A>::add_lsa(Lsa::LsaRef lsar)
 	    _last_entry = esi + 1;
 	_db[esi] = lsar;
 	_empty_slots.pop_front();
+	index_lsa(esi);
 	return true;
     }
 
@@ -2868,6 +2877,7 @@ AreaRouter<A>::add_lsa(Lsa::LsaRef lsar)
 	_db.push_back(lsar);
 	_allocated_entries++;
     }
+    index_lsa(_last_entry);
     _last_entry++;
 
     return true;
@@ -2891,6 +2901,7 @@ AreaRouter<A>::delete_lsa(Lsa::LsaRef lsar, size_t index, bool invalidate)
 
     _db[index]->invalidate(invalidate);
 
+    unindex_lsa(index);
     _db[index] = _invalid_lsa;
     _empty_slots.push_back(index);
 
@@ -2921,6 +2932,10 @@ AreaRouter<A>::update_lsa(Lsa::LsaRef lsar, size_t index)
     // A LSA arriving over the wire should never replace a
     // self originating LSA.
     XLOG_ASSERT(!_db[index]->get_self_originating());
+
+    // The routes from the old LSA need to be recomputed, it may not
+    // describe the same network as the new one.
+    routing_delete(_db[index]);
     if (0 == _readers) {
 	_db[index]->invalidate();
 	_db[index] = lsar;
@@ -2933,26 +2948,64 @@ AreaRouter<A>::update_lsa(Lsa::LsaRef lsar, size_t index)
 }
 
 template <typename A>
-bool
-AreaRouter<A>::find_lsa(const Ls_request& lsr, size_t& index) const
+void
+AreaRouter<A>::index_lsa(size_t index)
 {
-    for(index = 0 ; index < _last_entry; index++) {
-	if (!_db[index]->valid())
-	    continue;
-	Lsa_header& dblsah = _db[index]->get_header();
-	if (dblsah.get_ls_type() != lsr.get_ls_type())
-	    continue;
+    const Lsa_header& header = _db[index]->get_header();
 
-	if (dblsah.get_link_state_id() != lsr.get_link_state_id())
-	    continue;
+    _db_index[LsaKey(header)] = index;
 
-	if (dblsah.get_advertising_router() != lsr.get_advertising_router())
-	    continue;
+    if (header.get_ls_type() == _network_lsa_type)
+	_network_lsa_index[header.get_link_state_id()].insert(index);
+    else if (header.get_ls_type() == _router_lsa_type)
+	_router_lsa_index[header.get_advertising_router()].insert(index);
+}
 
-	return true;
+template <typename A>
+void
+AreaRouter<A>::unindex_lsa(size_t index)
+{
+    const Lsa_header& header = _db[index]->get_header();
+
+    typename map<LsaKey, size_t>::iterator i = _db_index.find(LsaKey(header));
+    if (i != _db_index.end() && i->second == index)
+	_db_index.erase(i);
+
+    map<uint32_t, set<size_t> >* secondary = 0;
+    uint32_t key = 0;
+    if (header.get_ls_type() == _network_lsa_type) {
+	secondary = &_network_lsa_index;
+	key = header.get_link_state_id();
+    } else if (header.get_ls_type() == _router_lsa_type) {
+	secondary = &_router_lsa_index;
+	key = header.get_advertising_router();
     }
+    if (0 == secondary)
+	return;
 
-    return false;
+    map<uint32_t, set<size_t> >::iterator j = secondary->find(key);
+    if (j == secondary->end())
+	return;
+    j->second.erase(index);
+    if (j->second.empty())
+	secondary->erase(j);
+}
+
+template <typename A>
+bool
+AreaRouter<A>::find_lsa(const Ls_request& lsr, size_t& index) const
+{
+    typename map<LsaKey, size_t>::const_iterator i =
+	_db_index.find(LsaKey(lsr));
+    if (i == _db_index.end())
+	return false;
+
+    index = i->second;
+    XLOG_ASSERT(index < _last_entry);
+    if (!_db[index]->valid())
+	return false;
+
+    return true;
 }
 
 template <typename A>
@@ -2970,20 +3023,18 @@ template <typename A>
 bool
 AreaRouter<A>::find_network_lsa(uint32_t link_state_id, size_t& index) const
 {
-    uint32_t ls_type = NetworkLsa(_ospf.get_version()).get_ls_type();
+    map<uint32_t, set<size_t> >::const_iterator i =
+	_network_lsa_index.find(link_state_id);
+    if (i == _network_lsa_index.end())
+	return false;
 
-    for(index = 0 ; index < _last_entry; index++) {
+    // Note we deliberately don't check for advertising router.
+    // The slots are ordered so the result is the same as a linear search.
+    set<size_t>::const_iterator j;
+    for (j = i->second.begin(); j != i->second.end(); j++) {
+	index = *j;
 	if (!_db[index]->valid())
 	    continue;
-	Lsa_header& dblsah = _db[index]->get_header();
-	if (dblsah.get_ls_type() != ls_type)
-	    continue;
-
-	if (dblsah.get_link_state_id() != link_state_id)
-	    continue;
-
-	// Note we deliberately don't check for advertising router.
-
 	return true;
     }
 
@@ -2997,21 +3048,18 @@ AreaRouter<A>::find_router_lsa(uint32_t advertising_router,
 {
     XLOG_ASSERT(OspfTypes::V3 == _ospf.get_version());
 
-    uint32_t ls_type = RouterLsa(_ospf.get_version()).get_ls_type();
+    map<uint32_t, set<size_t> >::const_iterator i =
+	_router_lsa_index.find(advertising_router);
+    if (i == _router_lsa_index.end())
+	return false;
 
     // The index is set by the caller.
-    for(; index < _last_entry; index++) {
+    // Note we deliberately don't check for the Link State ID.
+    set<size_t>::const_iterator j;
+    for (j = i->second.lower_bound(index); j != i->second.end(); j++) {
+	index = *j;
 	if (!_db[index]->valid())
 	    continue;
-	Lsa_header& dblsah = _db[index]->get_header();
-	if (dblsah.get_ls_type() != ls_type)
-	    continue;
-
-	if (dblsah.get_advertising_router() != advertising_router)
-	    continue;
-
-	// Note we deliberately don't check for the Link State ID.
-
 	return true;
     }
 
@@ -3262,6 +3310,7 @@ AreaRouter<A>::clear_database(bool preserve_link_lsas)
 	if (!_db[index]->valid())
 	    continue;
 	if (_db[index]->external()) {
+	    unindex_lsa(index);
 	    _db[index] = _invalid_lsa;
 	    continue;
 	}
@@ -3864,6 +3913,8 @@ void
 AreaRouter<A>::routing_add(Lsa::LsaRef lsar, bool known)
 {
     debug_msg("%s known %s\n", cstring(*lsar), bool_c_str(known));
+
+    routing_schedule_recompute(lsar);
 }
 
 template <typename A>
@@ -3872,20 +3923,24 @@ AreaRouter<A>::routing_delete(Lsa::LsaRef lsar)
 {
     debug_msg("%s\n", cstring(*lsar));
 
-    routing_schedule_total_recompute();
+    routing_schedule_recompute(lsar);
 }
 
 template <typename A>
 void
 AreaRouter<A>::routing_end()
 {
-    routing_schedule_total_recompute();
+    // Every LSA that was added has already scheduled the recompute
+    // that it requires. If nothing new arrived nothing needs doing.
 }
 
 template <typename A>
 void 
 AreaRouter<A>::routing_schedule_total_recompute()
 {
+    _routing_total = true;
+    _routing_partial.clear();
+
     if (_routing_recompute_timer.scheduled())
 	return;
 
@@ -3895,17 +3950,111 @@ AreaRouter<A>::routing_schedule_total_recompute()
     
 }
 
+template <typename A>
+void 
+AreaRouter<A>::routing_schedule_recompute(Lsa::LsaRef lsar)
+{
+    IPNet<A> net;
+    if (!routing_partial_net(lsar, net)) {
+	routing_schedule_total_recompute();
+	return;
+    }
+
+    // A pending total recompute covers this network.
+    if (_routing_total)
+	return;
+
+    _routing_partial.insert(net);
+
+    if (_routing_recompute_timer.scheduled())
+	return;
+
+    _routing_recompute_timer = _ospf.get_eventloop().
+	new_oneoff_after(TimeVal(_routing_recompute_delay, 0),
+			 callback(this, &AreaRouter<A>::routing_timer));
+}
+
 template <typename A>
 void 
 AreaRouter<A>::routing_timer()
 {
-    routing_total_recompute();
+    if (_routing_total)
+	routing_total_recompute();
+    else
+	routing_partial_recompute();
+}
+
+template <>
+bool
+AreaRouter<IPv4>::routing_partial_net(Lsa::LsaRef lsar, IPNet<IPv4>& net)
+{
+    SummaryNetworkLsa *snlsa;	// Type 3
+    ASExternalLsa *aselsa;	// Type 5 and Type 7
+
+    if (0 != (snlsa = dynamic_cast<SummaryNetworkLsa *>(lsar.get()))) {
+	uint32_t lsid = lsar->get_header().get_link_state_id();
+	IPv4 mask = IPv4(htonl(snlsa->get_network_mask()));
+	net = IPNet<IPv4>(IPv4(htonl(lsid)), mask.mask_len());
+	return true;
+    }
+
+    // Note that Type7Lsa is derived from ASExternalLsa so will
+    // pass this test.
+    if (0 != (aselsa = dynamic_cast<ASExternalLsa *>(lsar.get()))) {
+	net = aselsa->get_network<IPv4>(IPv4::ZERO());
+	return true;
+    }
+
+    return false;
+}
+
+template <>
+bool
+AreaRouter<IPv6>::routing_partial_net(Lsa::LsaRef, IPNet<IPv6>&)
+{
+    // OSPFv3 always performs a total recompute.
+    return false;
+}
+
+template <typename A>
+void
+AreaRouter<A>::routing_partial_recompute()
+{
+    if (_routing_partial.empty())
+	return;
+
+    switch (_ospf.get_version()) {
+    case OspfTypes::V2:
+	routing_partial_recomputeV2();
+	break;
+    case OspfTypes::V3:
+	routing_total_recompute();
+	break;
+    }
+}
+
+template <typename A>
+void
+AreaRouter<A>::routing_partial_slots(uint16_t ls_type, uint32_t lsid,
+				     set<size_t>& slots)
+{
+    Ls_request lsr(_ospf.get_version(), ls_type, lsid, 0);
+
+    typename map<LsaKey, size_t>::const_iterator i;
+    for (i = _db_index.lower_bound(LsaKey(lsr)); i != _db_index.end(); i++) {
+	if (i->first._ls_type != ls_type || i->first._link_state_id != lsid)
+	    break;
+	slots.insert(i->second);
+    }
 }
 
 template <typename A>
 void 
 AreaRouter<A>::routing_total_recompute()
 {
+    _routing_total = false;
+    _routing_partial.clear();
+
     switch (_ospf.get_version()) {
     case OspfTypes::V2:
 	routing_total_recomputeV2();
@@ -3921,6 +4070,8 @@ routing_area_rangesV2(const list<RouteCmd<Vertex> >& r);
 template <> void AreaRouter<IPv4>::routing_inter_areaV2();
 template <> void AreaRouter<IPv4>::routing_transit_areaV2();
 template <> void AreaRouter<IPv4>::routing_as_externalV2();
+template <> void AreaRouter<IPv4>::routing_inter_area_lsaV2(Lsa::LsaRef lsar);
+template <> void AreaRouter<IPv4>::routing_as_external_lsaV2(Lsa::LsaRef lsar);
 
 template <> void AreaRouter<IPv6>::
 routing_area_rangesV3(const list<RouteCmd<Vertex> >& r,
@@ -4009,9 +4160,14 @@ AreaRouter<IPv4>::routing_total_recomputeV2()
     RoutingTable<IPv4>& routing_table = _ospf.get_routing_table();
     routing_table.begin(_area);
 
-    // Compute the SPT.
+    // Compute the SPT. The graph is built from scratch but the tree
+    // is kept between computations, only the part of the tree
+    // affected by the changes to the graph is recomputed.
     list<RouteCmd<Vertex> > r;
-    spt.compute(r);
+    _spt.sync(spt);
+    _spt.compute(r);
+    r.clear();
+    _spt.current_routes(r);
 
     // Compute the area range summaries.
     routing_area_rangesV2(r);
@@ -4101,6 +4257,145 @@ AreaRouter<IPv6>::routing_total_recomputeV2()
     XLOG_FATAL("OSPFv2 with IPv6 not valid");
 }
 
+template <>
+bool
+AreaRouter<IPv4>::routing_partial_forwardingV2(const set<IPNet<IPv4> >& nets)
+{
+    Trie<IPv4, bool> changed;
+    set<IPNet<IPv4> >::const_iterator ni;
+    for (ni = nets.begin(); ni != nets.end(); ni++)
+	changed.insert(*ni, true);
+
+    // Mirror the forwarding address selection in routing_as_external_lsaV2.
+    RoutingTable<IPv4>& routing_table = _ospf.get_routing_table();
+    for (size_t index = 0 ; index < _last_entry; index++) {
+	Lsa::LsaRef lsar = _db[index];
+	if (!lsar->valid() || lsar->maxage() || lsar->get_self_originating())
+	    continue;
+	if (!lsar->external() && !lsar->type7())
+	    continue;
+
+	ASExternalLsa *aselsa;
+	if (0 == (aselsa = dynamic_cast<ASExternalLsa *>(lsar.get())))
+	    continue;
+
+	IPv4 forwarding = aselsa->get_forwarding_address_ipv4();
+	if (IPv4(static_cast<uint32_t>(0)) == forwarding) {
+	    RouteEntry<IPv4> rt;
+	    uint32_t adv = lsar->get_header().get_advertising_router();
+	    if (!routing_table.lookup_entry_by_advertising_router(_area, adv,
+								 rt))
+		continue;
+	    forwarding = rt.get_nexthop();
+	}
+
+	if (changed.end() != changed.find(forwarding))
+	    return true;
+    }
+
+    return false;
+}
+
+template <>
+void
+AreaRouter<IPv4>::routing_partial_recomputeV2()
+{
+    set<IPNet<IPv4> > nets;
+    nets.swap(_routing_partial);
+
+    RoutingTable<IPv4>& routing_table = _ospf.get_routing_table();
+    PeerManager<IPv4>& pm = _ospf.get_peer_manager();
+
+    // RFC 2328 Section 16.3. The summaries in a transit area can
+    // improve the routes through the backbone, leave that to a total
+    // recompute.
+    if (get_transit_capability() && pm.area_border_router_p()) {
+	routing_total_recompute();
+	return;
+    }
+
+    // Intra-area routes and area range discard routes come from the
+    // SPT, they can't be recomputed here.
+    set<IPNet<IPv4> >::const_iterator ni;
+    for (ni = nets.begin(); ni != nets.end(); ni++) {
+	RouteEntry<IPv4> rt;
+	if (routing_table.lookup_entry(_area, *ni, rt) &&
+	    (RouteEntry<IPv4>::intra_area == rt.get_path_type() ||
+	     rt.get_discard())) {
+	    routing_total_recompute();
+	    return;
+	}
+    }
+
+    // If an AS external route is reached through one of these networks
+    // it may change as well.
+    if (routing_partial_forwardingV2(nets)) {
+	routing_total_recompute();
+	return;
+    }
+
+    XLOG_TRACE(_ospf.trace()._spt,
+	       "Partial route computation area %s networks %u",
+	       pr_id(_area).c_str(), XORP_UINT_CAST(nets.size()));
+
+    // Find the LSAs that may describe these networks, the Link State
+    // ID may have the host bits set (RFC 2328 Appendix E).
+    OspfTypes::Version version = _ospf.get_version();
+    uint16_t summary_type = SummaryNetworkLsa(version).get_ls_type();
+    uint16_t external_type = ASExternalLsa(version).get_ls_type();
+    uint16_t type7_type = Type7Lsa(version).get_ls_type();
+    set<size_t> summaries, externals;
+    for (ni = nets.begin(); ni != nets.end(); ni++) {
+	uint32_t lsids[] = { ntohl(ni->masked_addr().addr()),
+			     ntohl(ni->top_addr().addr()) };
+	for (size_t i = 0; i < sizeof(lsids) / sizeof(lsids[0]); i++) {
+	    routing_partial_slots(summary_type, lsids[i], summaries);
+	    routing_partial_slots(external_type, lsids[i], externals);
+	    routing_partial_slots(type7_type, lsids[i], externals);
+	}
+    }
+
+    // Only the routes from this area to these networks are removed,
+    // everything else in the routing table stays as it is.
+    routing_table.begin_partial(_area);
+
+    for (ni = nets.begin(); ni != nets.end(); ni++)
+	routing_table.delete_entry(_area, *ni);
+
+    // The slots are visited in database order as they would be by a
+    // total recompute.
+    set<size_t>::const_iterator si;
+
+    // RFC 2328 Section 16.2.  Calculating the inter-area routes
+    if (pm.internal_router_p() ||
+	(backbone() && pm.area_border_router_p())) {
+	for (si = summaries.begin(); si != summaries.end(); si++) {
+	    IPNet<IPv4> net;
+	    if (routing_partial_net(_db[*si], net) && 0 != nets.count(net))
+		routing_inter_area_lsaV2(_db[*si]);
+	}
+    }
+
+    // RFC 2328 Section 16.4.  Calculating AS external routes
+    for (si = externals.begin(); si != externals.end(); si++) {
+	IPNet<IPv4> net;
+	if (routing_partial_net(_db[*si], net) && 0 != nets.count(net))
+	    routing_as_external_lsaV2(_db[*si]);
+    }
+
+    routing_table.end();
+
+    if (backbone())
+	pm.routing_recompute_all_transit_areas();
+}
+
+template <>
+void
+AreaRouter<IPv6>::routing_partial_recomputeV2()
+{
+    XLOG_FATAL("OSPFv2 with IPv6 not valid");
+}
+
 template <>
 void 
 AreaRouter<IPv4>::routing_total_recomputeV3()
@@ -4226,9 +4521,14 @@ AreaRouter<IPv6>::routing_total_recomputeV3()
     RoutingTable<IPv6>& routing_table = _ospf.get_routing_table();
     routing_table.begin(_area);
 
-    // Compute the SPT.
+    // Compute the SPT. The graph is built from scratch but the tree
+    // is kept between computations, only the part of the tree
+    // affected by the changes to the graph is recomputed.
     list<RouteCmd<Vertex> > r;
-    spt.compute(r);
+    _spt.sync(spt);
+    _spt.compute(r);
+    r.clear();
+    _spt.current_routes(r);
 
     // Compute the area range summaries.
     routing_area_rangesV3(r, lsa_temp_store);
@@ -4674,105 +4974,110 @@ void
 AreaRouter<IPv4>::routing_inter_areaV2()
 {
     // RFC 2328 Section 16.2.  Calculating the inter-area routes
-    for (size_t index = 0 ; index < _last_entry; index++) {
-	Lsa::LsaRef lsar = _db[index];
-	if (!lsar->valid() || lsar->maxage())
-	    continue;
+    for (size_t index = 0 ; index < _last_entry; index++)
+	routing_inter_area_lsaV2(_db[index]);
+}
 
-	SummaryNetworkLsa *snlsa;	// Type 3
-	SummaryRouterLsa *srlsa;	// Type 4
-	uint32_t metric = 0;
-	IPv4 mask;
+template <>
+void 
+AreaRouter<IPv4>::routing_inter_area_lsaV2(Lsa::LsaRef lsar)
+{
+    if (!lsar->valid() || lsar->maxage())
+	return;
 
-	if (0 != (snlsa = dynamic_cast<SummaryNetworkLsa *>(lsar.get()))) {
-	    metric = snlsa->get_metric();
-	    mask = IPv4(htonl(snlsa->get_network_mask()));
-	}
-	if (0 != (srlsa = dynamic_cast<SummaryRouterLsa *>(lsar.get()))) {
-	    metric = srlsa->get_metric();
-	    mask = IPv4::ALL_ONES();
-	}
-	if (0 == snlsa && 0 == srlsa)
-	    continue;
-	if (OspfTypes::LSInfinity == metric)
-	    continue;
+    SummaryNetworkLsa *snlsa;	// Type 3
+    SummaryRouterLsa *srlsa;	// Type 4
+    uint32_t metric = 0;
+    IPv4 mask;
 
-	// (2)
-	if (lsar->get_self_originating())
-	    continue;
+    if (0 != (snlsa = dynamic_cast<SummaryNetworkLsa *>(lsar.get()))) {
+	metric = snlsa->get_metric();
+	mask = IPv4(htonl(snlsa->get_network_mask()));
+    }
+    if (0 != (srlsa = dynamic_cast<SummaryRouterLsa *>(lsar.get()))) {
+	metric = srlsa->get_metric();
+	mask = IPv4::ALL_ONES();
+    }
+    if (0 == snlsa && 0 == srlsa)
+	return;
+    if (OspfTypes::LSInfinity == metric)
+	return;
 
-	uint32_t lsid = lsar->get_header().get_link_state_id();
-	IPNet<IPv4> n = IPNet<IPv4>(IPv4(htonl(lsid)), mask.mask_len());
+    // (2)
+    if (lsar->get_self_originating())
+	return;
 
-	// (3) 
-	if (snlsa) {
-	    bool active;
-	    if (area_range_covered(n, active)) {
-		if (active)
-		    continue;
-	    }
+    uint32_t lsid = lsar->get_header().get_link_state_id();
+    IPNet<IPv4> n = IPNet<IPv4>(IPv4(htonl(lsid)), mask.mask_len());
+
+    // (3) 
+    if (snlsa) {
+	bool active;
+	if (area_range_covered(n, active)) {
+	    if (active)
+		return;
 	}
+    }
 
-	// (4)
-	uint32_t adv = lsar->get_header().get_advertising_router();
-	RoutingTable<IPv4>& routing_table = _ospf.get_routing_table();
-	RouteEntry<IPv4> rt;
-	if (!routing_table.lookup_entry_by_advertising_router(_area, adv, rt))
-	    continue;
+    // (4)
+    uint32_t adv = lsar->get_header().get_advertising_router();
+    RoutingTable<IPv4>& routing_table = _ospf.get_routing_table();
+    RouteEntry<IPv4> rt;
+    if (!routing_table.lookup_entry_by_advertising_router(_area, adv, rt))
+	return;
 
-	if (rt.get_advertising_router() != adv || rt.get_area() != _area)
-	    continue;
+    if (rt.get_advertising_router() != adv || rt.get_area() != _area)
+	return;
 
-	uint32_t iac = rt.get_cost() + metric;
+    uint32_t iac = rt.get_cost() + metric;
 
-	// (5)
-	bool add_entry = false;
-	bool replace_entry = false;
-	RouteEntry<IPv4> rtnet;
-	if (routing_table.lookup_entry(n, rtnet)) {
-	    switch(rtnet.get_path_type()) {
-	    case RouteEntry<IPv4>::intra_area:
-		break;
-	    case RouteEntry<IPv4>::inter_area:
-		// XXX - Should be dealing with equal cost here.
-		if (iac < rtnet.get_cost())
-		    replace_entry = true;
-		break;
-	    case RouteEntry<IPv4>::type1:
-	    case RouteEntry<IPv4>::type2:
+    // (5)
+    bool add_entry = false;
+    bool replace_entry = false;
+    RouteEntry<IPv4> rtnet;
+    if (routing_table.lookup_entry(n, rtnet)) {
+	switch(rtnet.get_path_type()) {
+	case RouteEntry<IPv4>::intra_area:
+	    break;
+	case RouteEntry<IPv4>::inter_area:
+	    // XXX - Should be dealing with equal cost here.
+	    if (iac < rtnet.get_cost())
 		replace_entry = true;
-		break;
-	    }
-	} else {
-	    add_entry = true;
+	    break;
+	case RouteEntry<IPv4>::type1:
+	case RouteEntry<IPv4>::type2:
+	    replace_entry = true;
+	    break;
 	}
-	if (!add_entry && !replace_entry)
-	    continue;
+    } else {
+	add_entry = true;
+    }
+    if (!add_entry && !replace_entry)
+	return;
 
-	RouteEntry<IPv4> rtentry;
-	if (snlsa) {
-	    rtentry.set_destination_type(OspfTypes::Network);
-	    rtentry.set_address(lsid);
-	} else if (srlsa) {
-	    rtentry.set_destination_type(OspfTypes::Router);
-	    rtentry.set_router_id(lsid);
-	    rtentry.set_as_boundary_router(true);
-	} else
-	    XLOG_UNREACHABLE();
-	rtentry.set_area(_area);
+    RouteEntry<IPv4> rtentry;
+    if (snlsa) {
+	rtentry.set_destination_type(OspfTypes::Network);
+	rtentry.set_address(lsid);
+    } else if (srlsa) {
+	rtentry.set_destination_type(OspfTypes::Router);
+	rtentry.set_router_id(lsid);
+	rtentry.set_as_boundary_router(true);
+    } else
+	XLOG_UNREACHABLE();
+    rtentry.set_area(_area);
 //	rtentry.set_directly_connected(rt.get_directly_connected());
-	rtentry.set_directly_connected(false);
-	rtentry.set_path_type(RouteEntry<IPv4>::inter_area);
-	rtentry.set_cost(iac);
-	rtentry.set_nexthop(rt.get_nexthop());
-	rtentry.set_advertising_router(rt.get_advertising_router());
-	rtentry.set_lsa(lsar);
+    rtentry.set_directly_connected(false);
+    rtentry.set_path_type(RouteEntry<IPv4>::inter_area);
+    rtentry.set_cost(iac);
+    rtentry.set_nexthop(rt.get_nexthop());
+    rtentry.set_advertising_router(rt.get_advertising_router());
+    rtentry.set_lsa(lsar);
 
-	if (add_entry)
-	    routing_table.add_entry(_area, n, rtentry, __PRETTY_FUNCTION__);
-	if (replace_entry)
-	    routing_table.replace_entry(_area, n, rtentry);
-    }
+    if (add_entry)
+	routing_table.add_entry(_area, n, rtentry, __PRETTY_FUNCTION__);
+    if (replace_entry)
+	routing_table.replace_entry(_area, n, rtentry);
 }
 
 template <>
@@ -5085,151 +5390,155 @@ AreaRouter<IPv4>::routing_as_externalV2()
 {
     // RFC 2328 Section 16.4.  Calculating AS external routes
     // RFC 3101 Section 2.5.   Calculating Type-7 AS external routes
-    for (size_t index = 0 ; index < _last_entry; index++) {
-	Lsa::LsaRef lsar = _db[index];
-	if (!lsar->valid() || lsar->maxage() || lsar->get_self_originating())
-	    continue;
+    for (size_t index = 0 ; index < _last_entry; index++)
+	routing_as_external_lsaV2(_db[index]);
+}
 
-	// Note that Type7Lsa is derived from ASExternalLsa so will
-	// pass this test.
-	ASExternalLsa *aselsa;
-	if (0 == (aselsa = dynamic_cast<ASExternalLsa *>(lsar.get()))) {
-	    continue;
-	}
+template <>
+void
+AreaRouter<IPv4>::routing_as_external_lsaV2(Lsa::LsaRef lsar)
+{
+    if (!lsar->valid() || lsar->maxage() || lsar->get_self_originating())
+	return;
+
+    // Note that Type7Lsa is derived from ASExternalLsa so will
+    // pass this test.
+    ASExternalLsa *aselsa;
+    if (0 == (aselsa = dynamic_cast<ASExternalLsa *>(lsar.get()))) {
+	return;
+    }
+
+    if (OspfTypes::LSInfinity == aselsa->get_metric())
+	return;
 
-	if (OspfTypes::LSInfinity == aselsa->get_metric())
-	    continue;
-	
 // 	IPv4 mask = IPv4(htonl(aselsa->get_network_mask()));
- 	uint32_t lsid = lsar->get_header().get_link_state_id();
-	uint32_t adv = lsar->get_header().get_advertising_router();
+    uint32_t lsid = lsar->get_header().get_link_state_id();
+    uint32_t adv = lsar->get_header().get_advertising_router();
 // 	IPNet<IPv4> n = IPNet<IPv4>(IPv4(htonl(lsid)), mask.mask_len());
-	IPNet<IPv4> n = aselsa->get_network<IPv4>(IPv4::ZERO());
-	
-	// (3)
-	RoutingTable<IPv4>& routing_table = _ospf.get_routing_table();
-	RouteEntry<IPv4> rt;
- 	if (!routing_table.lookup_entry_by_advertising_router(_area, adv, rt))
- 	    continue;
+    IPNet<IPv4> n = aselsa->get_network<IPv4>(IPv4::ZERO());
 
-	if (!rt.get_as_boundary_router())
-	    return;
-
-	// If a routing entry has been found it must be from this area.
-	XLOG_ASSERT(rt.get_area() == _area);
+    // (3)
+    RoutingTable<IPv4>& routing_table = _ospf.get_routing_table();
+    RouteEntry<IPv4> rt;
+    if (!routing_table.lookup_entry_by_advertising_router(_area, adv, rt))
+	return;
 
-	if (aselsa->type7() && 0 == n.prefix_len()) {
-	    if (_ospf.get_peer_manager().area_border_router_p()) {
-		if (!external_propagate_bit(lsar))
-		    continue;
-		if (!_summaries)
-		    continue;
-	    }
-	}
+    if (!rt.get_as_boundary_router())
+	return;
 
-	IPv4 forwarding = aselsa->get_forwarding_address_ipv4();
-	if (IPv4(static_cast<uint32_t>(0)) == forwarding) {
-	    forwarding = rt.get_nexthop();
-	}
+    // If a routing entry has been found it must be from this area.
+    XLOG_ASSERT(rt.get_area() == _area);
 
-	RouteEntry<IPv4> rtf;
-	if (!routing_table.longest_match_entry(forwarding, rtf))
-	    continue;
-	if (!rtf.get_directly_connected())
-	    forwarding = rtf.get_nexthop();
-	if (aselsa->external()) {
-	    if (RouteEntry<IPv4>::intra_area != rtf.get_path_type() &&
-		RouteEntry<IPv4>::inter_area != rtf.get_path_type())
-		continue;
-	}
-	if (aselsa->type7()) {
-	    if (RouteEntry<IPv4>::intra_area != rtf.get_path_type())
-		continue;
+    if (aselsa->type7() && 0 == n.prefix_len()) {
+	if (_ospf.get_peer_manager().area_border_router_p()) {
+	    if (!external_propagate_bit(lsar))
+		return;
+	    if (!_summaries)
+		return;
 	}
-	// (4)
-	uint32_t x = rtf.get_cost();	// Cost specified by
-					// ASBR/forwarding address
-	uint32_t y = aselsa->get_metric();
+    }
 
-	// (5)
-	RouteEntry<IPv4> rtentry;
-	if (!aselsa->get_e_bit()) {	// Type 1
-	    rtentry.set_path_type(RouteEntry<IPv4>::type1);
-	    rtentry.set_cost(x + y);
-	} else {			// Type 2
-	    rtentry.set_path_type(RouteEntry<IPv4>::type2);
-	    rtentry.set_cost(x);
-	    rtentry.set_type_2_cost(y);
-	}
+    IPv4 forwarding = aselsa->get_forwarding_address_ipv4();
+    if (IPv4(static_cast<uint32_t>(0)) == forwarding) {
+	forwarding = rt.get_nexthop();
+    }
 
-	// (6)
-	bool add_entry = false;
-	bool replace_entry = false;
-	bool identical = false;
-	RouteEntry<IPv4> rtnet;
-	if (routing_table.lookup_entry(n, rtnet)) {
-	    switch(rtnet.get_path_type()) {
-	    case RouteEntry<IPv4>::intra_area:
-		if (!_ospf.get_rfc1583_compatibility()) {
-		    if (RouteEntry<IPv4>::intra_area == rtf.get_path_type()) {
-			if (!backbone(rtf.get_area()) &&
-			    backbone(rtnet.get_area())) {
-				replace_entry = true;
-			    }
-		    }
+    RouteEntry<IPv4> rtf;
+    if (!routing_table.longest_match_entry(forwarding, rtf))
+	return;
+    if (!rtf.get_directly_connected())
+	forwarding = rtf.get_nexthop();
+    if (aselsa->external()) {
+	if (RouteEntry<IPv4>::intra_area != rtf.get_path_type() &&
+	    RouteEntry<IPv4>::inter_area != rtf.get_path_type())
+	    return;
+    }
+    if (aselsa->type7()) {
+	if (RouteEntry<IPv4>::intra_area != rtf.get_path_type())
+	    return;
+    }
+    // (4)
+    uint32_t x = rtf.get_cost();	// Cost specified by
+					// ASBR/forwarding address
+    uint32_t y = aselsa->get_metric();
+
+    // (5)
+    RouteEntry<IPv4> rtentry;
+    if (!aselsa->get_e_bit()) {	// Type 1
+	rtentry.set_path_type(RouteEntry<IPv4>::type1);
+	rtentry.set_cost(x + y);
+    } else {			// Type 2
+	rtentry.set_path_type(RouteEntry<IPv4>::type2);
+	rtentry.set_cost(x);
+	rtentry.set_type_2_cost(y);
+    }
+
+    // (6)
+    bool add_entry = false;
+    bool replace_entry = false;
+    bool identical = false;
+    RouteEntry<IPv4> rtnet;
+    if (routing_table.lookup_entry(n, rtnet)) {
+	switch(rtnet.get_path_type()) {
+	case RouteEntry<IPv4>::intra_area:
+	    if (!_ospf.get_rfc1583_compatibility()) {
+		if (RouteEntry<IPv4>::intra_area == rtf.get_path_type()) {
+		    if (!backbone(rtf.get_area()) &&
+			backbone(rtnet.get_area())) {
+			    replace_entry = true;
+			}
 		}
+	    }
+	    break;
+	case RouteEntry<IPv4>::inter_area:
+	    break;
+	case RouteEntry<IPv4>::type1:
+	    if (RouteEntry<IPv4>::type2 == rtentry.get_path_type()) {
 		break;
-	    case RouteEntry<IPv4>::inter_area:
-		break;
-	    case RouteEntry<IPv4>::type1:
-		if (RouteEntry<IPv4>::type2 == rtentry.get_path_type()) {
-		    break;
-		}
-		if (rtentry.get_cost() < rtnet.get_cost()) {
-		    replace_entry = true;
-		    break;
-		}
-		if (rtentry.get_cost() == rtnet.get_cost())
-		    identical = true;
+	    }
+	    if (rtentry.get_cost() < rtnet.get_cost()) {
+		replace_entry = true;
 		break;
-	    case RouteEntry<IPv4>::type2:
-		if (RouteEntry<IPv4>::type1 == rtentry.get_path_type()) {
-		    replace_entry = true;
-		    break;
-		}
-		if (rtentry.get_type_2_cost() < rtnet.get_type_2_cost()) {
-		    replace_entry = true;
-		    break;
-		}
-		if (rtentry.get_type_2_cost() == rtnet.get_type_2_cost())
-		    identical = true;
+	    }
+	    if (rtentry.get_cost() == rtnet.get_cost())
+		identical = true;
+	    break;
+	case RouteEntry<IPv4>::type2:
+	    if (RouteEntry<IPv4>::type1 == rtentry.get_path_type()) {
+		replace_entry = true;
 		break;
 	    }
-	    // (e)
-	    if (identical) {
-		replace_entry = routing_compare_externals(rtnet.get_lsa(),
-							  lsar);
+	    if (rtentry.get_type_2_cost() < rtnet.get_type_2_cost()) {
+		replace_entry = true;
+		break;
 	    }
-	} else {
-	    add_entry = true;
+	    if (rtentry.get_type_2_cost() == rtnet.get_type_2_cost())
+		identical = true;
+	    break;
 	}
-	if (!add_entry && !replace_entry)
-	    continue;
-
-	rtentry.set_lsa(lsar);
-	rtentry.set_destination_type(OspfTypes::Network);
-	rtentry.set_address(lsid);
-	rtentry.set_area(_area);
-	rtentry.set_nexthop(forwarding);
-	rtentry.set_advertising_router(aselsa->get_header().
-				       get_advertising_router());
-
-	if (add_entry)
-	    routing_table.add_entry(_area, n, rtentry, __PRETTY_FUNCTION__);
-	if (replace_entry)
-	    routing_table.replace_entry(_area, n, rtentry);
-	
+	// (e)
+	if (identical) {
+	    replace_entry = routing_compare_externals(rtnet.get_lsa(),
+						      lsar);
+	}
+    } else {
+	add_entry = true;
     }
+    if (!add_entry && !replace_entry)
+	return;
+
+    rtentry.set_lsa(lsar);
+    rtentry.set_destination_type(OspfTypes::Network);
+    rtentry.set_address(lsid);
+    rtentry.set_area(_area);
+    rtentry.set_nexthop(forwarding);
+    rtentry.set_advertising_router(aselsa->get_header().
+				   get_advertising_router());
+
+    if (add_entry)
+	routing_table.add_entry(_area, n, rtentry, __PRETTY_FUNCTION__);
+    if (replace_entry)
+	routing_table.replace_entry(_area, n, rtentry);
 }
 
 template <>
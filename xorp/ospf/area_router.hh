@@ -747,6 +747,14 @@ class AreaRouter : public ServiceBase {
 	return add_lsa(lsar);
     }
 
+    /**
+     * Testing entry point to find an LSA in the database.
+     */
+    bool testing_find_lsa(Lsa::LsaRef lsar) const {
+	size_t index;
+	return find_lsa(lsar, index);
+    }
+
     /**
      * Testing entry point to delete an LSA from the database.
      */
@@ -783,9 +791,9 @@ class AreaRouter : public ServiceBase {
     bool _external_flooding;		// True if AS-External-LSAs
 					// are being flooded.
 
-#ifdef	UNFINISHED_INCREMENTAL_UPDATE
-    Spt<Vertex> _spt;			// SPT computation unit.
-#endif
+    Spt<Vertex> _spt;			// SPT computation unit, kept
+					// between computations so that
+					// only the changes are recomputed.
 
     Lsa::LsaRef _invalid_lsa;		// An invalid LSA to overwrite slots
     Lsa::LsaRef _router_lsa;		// This routers router LSA.
@@ -795,6 +803,46 @@ class AreaRouter : public ServiceBase {
 					// database. A value of 0 is
 					// an empty database.
     uint32_t _allocated_entries;	// Number of allocated entries.
+
+    /**
+     * The (LS type, Link State ID, Advertising Router) triple that
+     * uniquely identifies an LSA (RFC 2328 Section 12.1).
+     */
+    struct LsaKey {
+	LsaKey(const Lsa_header& header)
+	    : _ls_type(header.get_ls_type()),
+	      _link_state_id(header.get_link_state_id()),
+	      _advertising_router(header.get_advertising_router())
+	{}
+	LsaKey(const Ls_request& lsr)
+	    : _ls_type(lsr.get_ls_type()),
+	      _link_state_id(lsr.get_link_state_id()),
+	      _advertising_router(lsr.get_advertising_router())
+	{}
+
+	bool operator<(const LsaKey& other) const {
+	    if (_ls_type != other._ls_type)
+		return _ls_type < other._ls_type;
+	    if (_link_state_id != other._link_state_id)
+		return _link_state_id < other._link_state_id;
+	    return _advertising_router < other._advertising_router;
+	}
+
+	uint16_t _ls_type;
+	uint32_t _link_state_id;
+	uint32_t _advertising_router;
+    };
+
+    // Indexes into _db, kept in step with the slots by add_lsa(),
+    // delete_lsa() and clear_database(). A slot found through an index
+    // must still be checked for validity, LSAs may be invalidated in place.
+    map<LsaKey, size_t> _db_index;	// Slot of each LSA.
+    map<uint32_t, set<size_t> > _network_lsa_index; // Network-LSA slots
+					// by Link State ID.
+    map<uint32_t, set<size_t> > _router_lsa_index; // Router-LSA slots
+					// by Advertising Router.
+    uint16_t _router_lsa_type;		// LS type of a Router-LSA.
+    uint16_t _network_lsa_type;		// LS type of a Network-LSA.
     
     uint32_t _readers;			// Number of database readers.
     
@@ -849,6 +897,9 @@ class AreaRouter : public ServiceBase {
     uint32_t _routing_recompute_delay;	// How many seconds to wait
 					// before recompting.
     XorpTimer _routing_recompute_timer;	// Timer to cause recompute.
+    bool _routing_total;		// A total recompute is pending.
+    set<IPNet<A> > _routing_partial;	// Networks whose routes are
+					// pending a partial recompute.
     
     // How to handle Type-7 LSAs at the border.
     OspfTypes::NSSATranslatorRole _translator_role;
@@ -987,6 +1038,20 @@ class AreaRouter : public ServiceBase {
      */
     bool update_lsa(Lsa::LsaRef lsar, size_t index);
 
+    /**
+     * Add the LSA in this database slot to the indexes.
+     *
+     * @param index into database.
+     */
+    void index_lsa(size_t index);
+
+    /**
+     * Remove the LSA in this database slot from the indexes.
+     *
+     * @param index into database.
+     */
+    void unindex_lsa(size_t index);
+
     /**
      * Find LSA matching this request.
      *
@@ -1231,6 +1296,47 @@ class AreaRouter : public ServiceBase {
      */
     void routing_schedule_total_recompute();
 
+    /**
+     * Schedule the recompute required by a change to this LSA.
+     *
+     * A change to a Summary-LSA for a network or to an
+     * AS-external-LSA only requires the routes to the network that it
+     * describes to be recomputed (partial route calculation), any
+     * other change requires a total recompute.
+     */
+    void routing_schedule_recompute(Lsa::LsaRef lsar);
+
+    /**
+     * The network described by a Summary-LSA for a network or by an
+     * AS-external-LSA.
+     *
+     * @param lsar the LSA.
+     * @param net the network described.
+     * @return false if the LSA is of any other type.
+     */
+    bool routing_partial_net(Lsa::LsaRef lsar, IPNet<A>& net);
+
+    /**
+     * Recompute the routes to the networks in _routing_partial,
+     * falling back to a total recompute if that could give a
+     * different answer.
+     */
+    void routing_partial_recompute();
+    void routing_partial_recomputeV2();
+
+    /**
+     * @return true if any AS external route resolves its forwarding
+     * address through one of these networks.
+     */
+    bool routing_partial_forwardingV2(const set<IPNet<A> >& nets);
+
+    /**
+     * Add the database slots of all the LSAs with this LS type and
+     * Link State ID.
+     */
+    void routing_partial_slots(uint16_t ls_type, uint32_t lsid,
+			       set<size_t>& slots);
+
     /**
      * Callback routine that causes route recomputation.
      */
@@ -1265,6 +1371,11 @@ class AreaRouter : public ServiceBase {
     void routing_inter_areaV2();
     void routing_inter_areaV3();
 
+    /**
+     * Compute the inter-area route from a single Summary-LSA.
+     */
+    void routing_inter_area_lsaV2(Lsa::LsaRef lsar);
+
     /**
      * Compute the transit area routes.
      */
@@ -1279,6 +1390,11 @@ class AreaRouter : public ServiceBase {
     void routing_as_externalV2();
     void routing_as_externalV3();
 
+    /**
+     * Compute the AS external route from a single AS-external-LSA.
+     */
+    void routing_as_external_lsaV2(Lsa::LsaRef lsar);
+
 
 #if	0
     /**
@@ -56,10 +56,8 @@ template <>
 void
 OspfVarRW<IPv4>::start_read()
 {
-    initialize(VAR_NETWORK, _ef.create(ElemIPv4Net::id,
-				       _network.str().c_str()));
-    initialize(VAR_NEXTHOP, _ef.create(ElemIPv4NextHop::id,
-	       _nexthop.str().c_str()));
+    initialize(VAR_NETWORK, arena().create<ElemIPv4Net>(&_network));
+    initialize(VAR_NEXTHOP, arena().create<ElemIPv4NextHop>(_nexthop));
 
     start_read_common();
 }
@@ -68,10 +66,8 @@ template <>
 void
 OspfVarRW<IPv6>::start_read()
 {
-    initialize(VAR_NETWORK, _ef.create(ElemIPv6Net::id,
-				       _network.str().c_str()));
-    initialize(VAR_NEXTHOP, _ef.create(ElemIPv6NextHop::id,
-               _nexthop.str().c_str()));
+    initialize(VAR_NETWORK, arena().create<ElemIPv6Net>(&_network));
+    initialize(VAR_NEXTHOP, arena().create<ElemIPv6NextHop>(_nexthop));
 
     start_read_common();
 }
@@ -81,21 +77,14 @@ void
 OspfVarRW<A>::start_read_common()
 {
     initialize(VAR_POLICYTAGS, _policytags.element());
-    initialize(VAR_METRIC, _ef.create(ElemU32::id,
-				      c_format("%u", _metric).c_str()));
-    initialize(VAR_EBIT, _ef.create(ElemU32::id,
-				    c_format("%u", _e_bit ? 2 : 1).c_str()));
+    initialize(VAR_METRIC, arena().create<ElemU32>(_metric));
+    initialize(VAR_EBIT, arena().create<ElemU32>(_e_bit ? 2 : 1));
 
     // XXX which tag wins?
-    Element* element = _policytags.element_tag();
-    ElemU32* e = dynamic_cast<ElemU32*>(element);
-    if (e != NULL && e->val())
-	_tag = e->val();
+    if (_policytags.tag())
+	_tag = _policytags.tag();
 
-    delete element;
-
-    initialize(VAR_TAG, _ef.create(ElemU32::id,
-				   c_format("%u", _tag).c_str()));
+    initialize(VAR_TAG, arena().create<ElemU32>(_tag));
 }
 
 template <typename A>
@@ -24,7 +24,6 @@
 #define __OSPF_POLICY_VARRRW_HH__
 
 #include "policy/backend/single_varrw.hh"
-#include "policy/common/element_factory.hh"
 #include "policy/backend/policy_filters.hh"
 #include "policy/backend/policytags.hh"
 
@@ -57,7 +56,6 @@ class OspfVarRW : public SingleVarRW {
     uint32_t&	    _tag;
     bool&	    _tag_set;
     PolicyTags&	    _policytags;
-    ElementFactory  _ef;
 };
 
 #endif // __OSPF_POLICY_VARRRW_HH__
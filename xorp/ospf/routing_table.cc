@@ -92,6 +92,37 @@ RoutingTable<A>::begin(OspfTypes::AreaID area)
     }
 }
 
+template <typename A>
+void
+RoutingTable<A>::begin_partial(OspfTypes::AreaID area)
+{
+    debug_msg("area %s\n", pr_id(area).c_str());
+    XLOG_ASSERT(!_in_transaction);
+    _in_transaction = true;
+    _partial = true;
+    _touched.clear();
+
+    UNUSED(area);
+
+    if (0 == _current)
+	_current = new Trie<A, InternalRouteEntry<A> >;
+}
+
+template <typename A>
+void
+RoutingTable<A>::touch(IPNet<A> net)
+{
+    if (!_partial || 0 != _touched.count(net))
+	return;
+
+    typename Trie<A, InternalRouteEntry<A> >::iterator i;
+    i = _current->lookup_node(net);
+    if (_current->end() == i)
+	_touched[net] = InternalRouteEntry<A>();
+    else
+	_touched[net] = i.payload();
+}
+
 template <typename A>
 bool
 RoutingTable<A>::add_entry(OspfTypes::AreaID area, IPNet<A> net,
@@ -122,6 +153,8 @@ RoutingTable<A>::add_entry(OspfTypes::AreaID area, IPNet<A> net,
 	}
     }
 
+    touch(net);
+
     typename Trie<A, InternalRouteEntry<A> >::iterator i;
     i = _current->lookup_node(net);
     if (_current->end() == i) {
@@ -155,6 +188,8 @@ RoutingTable<A>::replace_entry(OspfTypes::AreaID area, IPNet<A> net,
  	}
     }
 
+    touch(net);
+
     typename Trie<A, InternalRouteEntry<A> >::iterator i;
     i = _current->lookup_node(net);
     if (_current->end() == i) {
@@ -167,6 +202,31 @@ RoutingTable<A>::replace_entry(OspfTypes::AreaID area, IPNet<A> net,
     return status;
 }
 
+template <typename A>
+bool
+RoutingTable<A>::delete_entry(OspfTypes::AreaID area, IPNet<A> net)
+{
+    debug_msg("area %s %s\n", pr_id(area).c_str(), cstring(net));
+    XLOG_ASSERT(_in_transaction);
+
+    typename Trie<A, InternalRouteEntry<A> >::iterator i;
+    i = _current->lookup_node(net);
+    if (_current->end() == i)
+	return false;
+
+    touch(net);
+
+    InternalRouteEntry<A>& irentry = i.payload();
+    bool winner_changed;
+    if (!irentry.delete_entry(area, winner_changed))
+	return false;
+
+    if (irentry.empty())
+	_current->erase(i);
+
+    return true;
+}
+
 template <typename A>
 bool
 RoutingTable<A>::lookup_entry(A router, RouteEntry<A>& rt)
@@ -296,6 +356,11 @@ RoutingTable<A>::end()
     XLOG_ASSERT(_in_transaction);
     _in_transaction = false;
 
+    if (_partial) {
+	end_partial();
+	return;
+    }
+
     typename Trie<A, InternalRouteEntry<A> >::iterator tip;
     typename Trie<A, InternalRouteEntry<A> >::iterator tic;
 
@@ -356,6 +421,54 @@ RoutingTable<A>::end()
     }
 }
 
+template <typename A>
+void
+RoutingTable<A>::end_partial()
+{
+    _partial = false;
+
+    // The same comparison as a full end() but only for the networks
+    // that were touched, the rest of the table can't have changed.
+    typename map<IPNet<A>, InternalRouteEntry<A> >::iterator ti;
+    for (ti = _touched.begin(); ti != _touched.end(); ti++) {
+	const IPNet<A>& net = ti->first;
+	InternalRouteEntry<A>& ire_previous = ti->second;
+	typename Trie<A, InternalRouteEntry<A> >::iterator tic;
+	tic = _current->lookup_node(net);
+	if (_current->end() == tic) {
+	    if (ire_previous.empty())
+		continue;
+	    RouteEntry<A>& rt_previous = ire_previous.get_entry();
+	    if (!delete_route(rt_previous.get_area(), net, rt_previous, true)) {
+		XLOG_WARNING("Delete of %s failed", cstring(net));
+	    }
+	    continue;
+	}
+
+	RouteEntry<A>& rt = tic.payload().get_entry();
+	if (ire_previous.empty()) {
+	    if (!add_route(rt.get_area(), net,
+			   rt.get_nexthop(), rt.get_cost(), rt, true)) {
+		XLOG_WARNING("Add of %s failed", cstring(net));
+	    }
+	    continue;
+	}
+
+	RouteEntry<A>& rt_previous = ire_previous.get_entry();
+	if (rt.get_nexthop() != rt_previous.get_nexthop() ||
+	    rt.get_cost() != rt_previous.get_cost()) {
+	    if (!replace_route(rt.get_area(), net,
+			       rt.get_nexthop(), rt.get_cost(),
+			       rt, rt_previous, rt_previous.get_area())) {
+		XLOG_WARNING("Replace of %s failed", cstring(net));
+	    }
+	} else {
+	    rt.set_filtered(rt_previous.get_filtered());
+	}
+    }
+    _touched.clear();
+}
+
 template <typename A>
 void
 RoutingTable<A>::remove_area(OspfTypes::AreaID area)
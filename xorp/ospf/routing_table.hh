@@ -402,7 +402,8 @@ template <typename A>
 class RoutingTable {
  public:
     RoutingTable(Ospf<A> &ospf)
-	: _ospf(ospf), _in_transaction(false), _current(0), _previous(0)
+	: _ospf(ospf), _in_transaction(false), _partial(false),
+	  _current(0), _previous(0)
     {}
 
     ~RoutingTable() {
@@ -418,6 +419,15 @@ class RoutingTable {
      */
     void begin(OspfTypes::AreaID area);
 
+    /**
+     * Start a transaction that only revises some of the routes from
+     * this area. The current table is edited in place rather than
+     * being rebuilt, the caller must first delete_entry() every
+     * network that it is about to recompute. On end() only the
+     * networks that were touched are compared and sent downstream.
+     */
+    void begin_partial(OspfTypes::AreaID area);
+
     bool add_entry(OspfTypes::AreaID area, IPNet<A> net,
 		   const RouteEntry<A>& rt, const char* message);
 
@@ -518,6 +528,12 @@ class RoutingTable {
     bool _in_transaction;		// Flag to verify that the
 					// routing table is only
 					// manipulated during a transaction.
+    bool _partial;			// The transaction is partial.
+
+    // The state of every network touched during a partial
+    // transaction, as it was before the transaction started. An empty
+    // entry means that the network was not present.
+    map<IPNet<A>, InternalRouteEntry<A> > _touched;
 
     Adv<A> _adv;			// Routing entries indexed by
 					// advertising router.
@@ -525,6 +541,16 @@ class RoutingTable {
     Trie<A, InternalRouteEntry<A> > *_current;
     Trie<A, InternalRouteEntry<A> > *_previous;
 
+    /**
+     * In a partial transaction save the state of this network before
+     * it is first modified.
+     */
+    void touch(IPNet<A> net);
+
+    /**
+     * Complete a partial transaction.
+     */
+    void end_partial();
 
     // Yes the RouteEntry contains the area, nexthop and metric but they
     // are functionally distinct.
@@ -369,6 +369,97 @@ routing(TestInfo& info, OspfTypes::Version version, string fname, string areas)
     return true;
 }
 
+inline
+double
+elapsed(const TimeVal& start)
+{
+    TimeVal now;
+    TimerList::system_gettimeofday(&now);
+
+    return (now - start).get_double();
+}
+
+/**
+ * Time adding, looking up and deleting a large number of LSAs, to
+ * check that the database lookups don't degrade with the database size.
+ */
+bool
+scale(TestInfo& info, uint32_t lsas)
+{
+    OspfTypes::Version version = OspfTypes::V2;
+    EventLoop eventloop;
+    TestInfo ioinfo("scale", false, 0, info.out());
+    DebugIO<IPv4> io(ioinfo, version, eventloop);
+    io.startup();
+
+    Ospf<IPv4> ospf(version, eventloop, &io);
+    ospf.set_testing(true);
+    ospf.set_router_id(set_id("0.0.0.1"));
+
+    OspfTypes::AreaID area = set_id("0.0.0.0");
+    PeerManager<IPv4>& pm = ospf.get_peer_manager();
+    pm.create_area_router(area, OspfTypes::NORMAL);
+    AreaRouter<IPv4> *ar = pm.get_area_router(area);
+    XLOG_ASSERT(ar);
+
+    uint32_t options = compute_options(version, OspfTypes::NORMAL);
+
+    // One in ten LSAs is a Router-LSA, the rest are Summary-LSAs
+    // spread across those routers, which is roughly what an area full
+    // of ABRs looks like.
+    vector<Lsa::LsaRef> db;
+    uint32_t routers = max(lsas / 10, static_cast<uint32_t>(1));
+    for (uint32_t i = 0; i < routers; i++) {
+	RouterLsa *rlsa = new RouterLsa(version);
+	rlsa->get_header().set_options(options);
+	rlsa->get_header().set_link_state_id(0x0a000000 + i + 2);
+	rlsa->get_header().set_advertising_router(0x0a000000 + i + 2);
+	db.push_back(Lsa::LsaRef(rlsa));
+    }
+    for (uint32_t i = 0; db.size() < lsas; i++) {
+	SummaryNetworkLsa *snlsa = new SummaryNetworkLsa(version);
+	snlsa->get_header().set_options(options);
+	snlsa->set_network_mask(0xffffff00);
+	snlsa->get_header().set_link_state_id(0x14000000 + (i << 8));
+	snlsa->get_header().
+	    set_advertising_router(0x0a000000 + (i % routers) + 2);
+	snlsa->set_metric(1);
+	db.push_back(Lsa::LsaRef(snlsa));
+    }
+
+    TimeVal start;
+    TimerList::system_gettimeofday(&start);
+    for (size_t i = 0; i < db.size(); i++)
+	ar->testing_add_lsa(db[i]);
+    double add_time = elapsed(start);
+
+    TimerList::system_gettimeofday(&start);
+    for (size_t i = 0; i < db.size(); i++) {
+	if (!ar->testing_find_lsa(db[i])) {
+	    DOUT(info) << "LSA not found " << cstring(*db[i]) << endl;
+	    return false;
+	}
+    }
+    double find_time = elapsed(start);
+
+    TimerList::system_gettimeofday(&start);
+    for (size_t i = 0; i < db.size(); i++)
+	ar->testing_delete_lsa(db[i]);
+    double delete_time = elapsed(start);
+
+    for (size_t i = 0; i < db.size(); i++) {
+	if (ar->testing_find_lsa(db[i])) {
+	    DOUT(info) << "LSA not deleted " << cstring(*db[i]) << endl;
+	    return false;
+	}
+    }
+
+    DOUT(info) << lsas << " LSAs: add " << add_time << "s find " <<
+	find_time << "s delete " << delete_time << "s" << endl;
+
+    return true;
+}
+
 int
 main(int argc, char **argv)
 {
@@ -385,6 +476,10 @@ main(int argc, char **argv)
 	t.get_optional_args("-t", "--test", "run only the specified test");
     string fname = t.get_optional_args("-f", "--filename", "lsa database");
     string areas = t.get_optional_args("-a", "--area", "areas to compute");
+    string lsas = t.get_optional_args("-n", "--lsas",
+				      "database size for the scale test");
+    if (lsas.empty())
+	lsas = "20000";
     t.complete_args_parsing();
 
     struct test {
@@ -394,6 +489,8 @@ main(int argc, char **argv)
 	{"pp", callback(pp, fname)},
 	{"v2", callback(routing<IPv4>, OspfTypes::V2, fname, areas)},
 	{"v3", callback(routing<IPv6>, OspfTypes::V3, fname, areas)},
+	{"scale", callback(scale,
+			   static_cast<uint32_t>(atoi(lsas.c_str())))},
     };
 
     try {
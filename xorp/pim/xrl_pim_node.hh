@@ -490,6 +490,48 @@ protected:
 	const string&	cookie,
 	const string&	protocol_origin);
 
+    /**
+     *  Add/delete many routing entries in one call.
+     *
+     *  The updates are applied in list order, as if each had been sent
+     *  with add_route or delete_route.
+     *
+     *  @param tid the transaction ID of this transaction.
+     *
+     *  @param adds true for a route add, false for a route delete.
+     *
+     *  @param dsts destination networks.
+     *
+     *  @param nexthops nexthop router addresses.
+     *
+     *  @param ifnames interface names associated with the nexthops.
+     *
+     *  @param vifnames virtual interface names with the nexthops.
+     *
+     *  @param metrics origin routing protocol metrics for the routes.
+     *
+     *  @param admin_distances administrative distances of the origin
+     *  routing protocols.
+     *
+     *  @param cookie value set by the requestor to identify redistribution
+     *  source. Typical value is the originating protocol name.
+     *
+     *  @param protocol_origins the names of the protocols that originated
+     *  the routing entries.
+     */
+    XrlCmdError redist_transaction4_0_1_update_routes(
+	// Input values,
+	const uint32_t&		tid,
+	const XrlAtomList&	adds,
+	const XrlAtomList&	dsts,
+	const XrlAtomList&	nexthops,
+	const XrlAtomList&	ifnames,
+	const XrlAtomList&	vifnames,
+	const XrlAtomList&	metrics,
+	const XrlAtomList&	admin_distances,
+	const string&		cookie,
+	const XrlAtomList&	protocol_origins);
+
     /**
      *  Delete all routing entries.
      *
@@ -578,6 +620,48 @@ protected:
 	const string&	cookie,
 	const string&	protocol_origin);
 
+    /**
+     *  Add/delete many routing entries in one call.
+     *
+     *  The updates are applied in list order, as if each had been sent
+     *  with add_route or delete_route.
+     *
+     *  @param tid the transaction ID of this transaction.
+     *
+     *  @param adds true for a route add, false for a route delete.
+     *
+     *  @param dsts destination networks.
+     *
+     *  @param nexthops nexthop router addresses.
+     *
+     *  @param ifnames interface names associated with the nexthops.
+     *
+     *  @param vifnames virtual interface names with the nexthops.
+     *
+     *  @param metrics origin routing protocol metrics for the routes.
+     *
+     *  @param admin_distances administrative distances of the origin
+     *  routing protocols.
+     *
+     *  @param cookie value set by the requestor to identify redistribution
+     *  source. Typical value is the originating protocol name.
+     *
+     *  @param protocol_origins the names of the protocols that originated
+     *  the routing entries.
+     */
+    XrlCmdError redist_transaction6_0_1_update_routes(
+	// Input values,
+	const uint32_t&		tid,
+	const XrlAtomList&	adds,
+	const XrlAtomList&	dsts,
+	const XrlAtomList&	nexthops,
+	const XrlAtomList&	ifnames,
+	const XrlAtomList&	vifnames,
+	const XrlAtomList&	metrics,
+	const XrlAtomList&	admin_distances,
+	const string&		cookie,
+	const XrlAtomList&	protocol_origins);
+
     /**
      *  Delete all routing entries.
      *
@@ -0,0 +1,61 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+// vim:set sts=4 ts=8:
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+#include "policy/policy_module.h"
+#include "libxorp/xorp.h"
+#include "element_arena.hh"
+
+ElementArena::ElementArena() : _used(0), _dtorc(0)
+{
+}
+
+ElementArena::~ElementArena()
+{
+    reset();
+}
+
+void*
+ElementArena::alloc(size_t size, bool trivial)
+{
+    size = (size + ALIGN - 1) & ~(ALIGN - 1);
+
+    if (_used + size > SIZE)
+	return NULL;
+
+    if (!trivial && _dtorc >= MAX_DTORS)
+	return NULL;
+
+    void* p = &_buf.c[_used];
+    _used += size;
+
+    return p;
+}
+
+void
+ElementArena::reset()
+{
+    for (unsigned i = 0; i < _dtorc; i++)
+	_dtors[i]->~Element();
+
+    _dtorc = 0;
+    _used = 0;
+}
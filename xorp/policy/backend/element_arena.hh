@@ -0,0 +1,165 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+// vim:set sts=4 ts=8:
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+#ifndef __POLICY_BACKEND_ELEMENT_ARENA_HH__
+#define __POLICY_BACKEND_ELEMENT_ARENA_HH__
+
+#include <new>
+
+#include "policy/common/element.hh"
+#include "policy/common/elem_null.hh"
+
+/**
+ * Elements which hold nothing that needs freeing.  The arena does not run
+ * their destructor, so releasing them costs nothing.
+ */
+template <class T>
+struct ElementArenaTrivial { static const bool value = false; };
+
+template <> struct ElementArenaTrivial<ElemNull> {
+    static const bool value = true;
+};
+template <> struct ElementArenaTrivial<ElemInt32> {
+    static const bool value = true;
+};
+template <> struct ElementArenaTrivial<ElemU32> {
+    static const bool value = true;
+};
+template <> struct ElementArenaTrivial<ElemCom32> {
+    static const bool value = true;
+};
+template <> struct ElementArenaTrivial<ElemBool> {
+    static const bool value = true;
+};
+template <> struct ElementArenaTrivial<ElemIPv6> {
+    static const bool value = true;
+};
+template <class A> struct ElementArenaTrivial<ElemNextHop<A> > {
+    static const bool value = true;
+};
+
+/**
+ * @short Scratch memory for the elements of a single filter evaluation.
+ *
+ * Elements are placed in a fixed buffer one after the other, and are all
+ * released at once by reset().  Only the elements which own memory, such as
+ * sets or networks, have their destructor run on reset, so for the common
+ * scalar variables a reset is O(1).
+ *
+ * If the buffer is exhausted, create() falls back to the heap.  The caller
+ * can tell the two cases apart with owns(), and must delete the elements
+ * the arena does not own.
+ */
+class ElementArena : public NONCOPYABLE {
+public:
+    ElementArena();
+    ~ElementArena();
+
+    /**
+     * Construct an element in the arena.
+     *
+     * @return the new element.
+     */
+    template <class T>
+    T* create() {
+	void* p = alloc(sizeof(T), ElementArenaTrivial<T>::value);
+
+	if (!p)
+	    return new T();
+
+	return keep(new (p) T());
+    }
+
+    /**
+     * Construct an element in the arena.
+     *
+     * @return the new element.
+     * @param a1 argument of the element constructor.
+     */
+    template <class T, class A1>
+    T* create(const A1& a1) {
+	void* p = alloc(sizeof(T), ElementArenaTrivial<T>::value);
+
+	if (!p)
+	    return new T(a1);
+
+	return keep(new (p) T(a1));
+    }
+
+    /**
+     * Construct an element in the arena.
+     *
+     * @return the new element.
+     * @param a1 first argument of the element constructor.
+     * @param a2 second argument of the element constructor.
+     */
+    template <class T, class A1, class A2>
+    T* create(const A1& a1, const A2& a2) {
+	void* p = alloc(sizeof(T), ElementArenaTrivial<T>::value);
+
+	if (!p)
+	    return new T(a1, a2);
+
+	return keep(new (p) T(a1, a2));
+    }
+
+    /**
+     * @return true if the element lives in the arena.
+     * @param e element to check.
+     */
+    bool owns(const Element* e) const {
+	const char* p = reinterpret_cast<const char*>(e);
+
+	return p >= _buf.c && p < _buf.c + sizeof(_buf.c);
+    }
+
+    /**
+     * Release all elements.  Pointers to them become invalid.
+     */
+    void reset();
+
+private:
+    static const size_t	ALIGN = sizeof(uint64_t);
+    static const size_t	SIZE = 4096;
+    static const size_t	MAX_DTORS = 32;
+
+    void* alloc(size_t size, bool trivial);
+
+    template <class T>
+    T* keep(T* e) {
+	if (!ElementArenaTrivial<T>::value)
+	    _dtors[_dtorc++] = e;
+
+	return e;
+    }
+
+    union {
+	char		c[SIZE];
+	double		d;
+	uint64_t	u;
+	void*		p;
+    } _buf;
+    size_t	_used;
+    Element*	_dtors[MAX_DTORS];
+    unsigned	_dtorc;
+};
+
+#endif // __POLICY_BACKEND_ELEMENT_ARENA_HH__
@@ -56,6 +56,14 @@ public:
      * @param varrw the VarRW associated with the route being filtered.
      */
     virtual bool acceptRoute(VarRW& varrw) = 0;
+
+    /**
+     * See if the current configuration of the filter reads a variable.
+     *
+     * @return true if any term or subroutine loads the variable.
+     * @param id the variable to look for.
+     */
+    virtual bool reads(const VarRW::Id& id) const = 0;
 };
 
 #endif // __POLICY_BACKEND_FILTER_BASE_HH__
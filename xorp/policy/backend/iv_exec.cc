@@ -25,23 +25,31 @@
 #include "policy/common/policy_utils.hh"
 #include "policy/common/elem_null.hh"
 #include "policy/common/element.hh"
+#include "policy/common/register_operations.hh"
 #include "iv_exec.hh"
 
 IvExec::IvExec() : 
-	       _policies(NULL), _policy_count(0), _stack_bottom(NULL), 
+	       _policies(NULL), _policy_count(0), _dirty(true),
+	       _stack_bottom(NULL), 
 	       _sman(NULL), _varrw(NULL), _finished(false), _fa(DEFAULT),
 	       _trash(NULL), _trashc(0), _trashs(2000)
 #ifndef XORP_DISABLE_PROFILE
 	       , _profiler(NULL)
 #endif
+	       , _subr(NULL), _true(true), _false(false)
 {
     unsigned ss = 128;
     _trash = new Element*[_trashs];
 
-    _stack_bottom = _stack = new const Element*[ss];
+    _stack_bottom = _stack = new Slot[ss];
     _stackptr = &_stack[0];
     _stackptr--;
     _stackend = &_stack[ss];
+
+    // shared results, never trashed
+    _true.ref();
+    _false.ref();
+    _null.ref();
 }
 
 IvExec::~IvExec()
@@ -65,6 +73,9 @@ IvExec::run(VarRW* varrw)
     XLOG_ASSERT(_sman);
     XLOG_ASSERT(_varrw);
 
+    if (_dirty)
+	compile();
+
     FlowAction ret = DEFAULT;
 
     // clear stack
@@ -73,7 +84,7 @@ IvExec::run(VarRW* varrw)
 
     // execute all policies
     for (int i = _policy_count-1; i>= 0; --i) {
-	FlowAction fa = runPolicy(*_policies[i]);
+	FlowAction fa = run_policy(i);
 
 	// if a policy rejected/accepted a route then terminate.
 	if (fa != DEFAULT) {
@@ -94,18 +105,18 @@ IvExec::run(VarRW* varrw)
 }
 
 IvExec::FlowAction 
-IvExec::runPolicy(PolicyInstr& pi)
+IvExec::run_policy(unsigned policy)
 {
-    TermInstr** terms  = pi.terms();
-    int termc	       = pi.termc();
+    const Policy& p    = _compiled[policy];
+    PolicyInstr& pi    = *p._instr;
     FlowAction outcome = DEFAULT;
 
     // create a "stack frame".  We do this just so we can "clear" the stack
     // frame when running terms and keep the asserts.  In reality if we get rid
     // of asserts and clearing of stack, we're fine, but we gotta be bug free.
     //  -sorbo
-    const Element** stack_bottom = _stack;
-    const Element** stack_ptr    = _stackptr;
+    Slot* stack_bottom = _stack;
+    Slot* stack_ptr    = _stackptr;
     _stack = _stackptr + 1;
     XLOG_ASSERT(_stack < _stackend && _stack >= _stack_bottom);
 
@@ -123,8 +134,8 @@ IvExec::runPolicy(PolicyInstr& pi)
     _ctr_flow = Next::TERM;
 
     // run all terms
-    for (int i = 0; i < termc ; ++i) {
-	FlowAction fa = runTerm(*terms[i]);
+    for (unsigned i = p._begin; i < p._end; ++i) {
+	FlowAction fa = run_term(_terms[i]);
 
 	// if term accepted/rejected route, then terminate.
 	if (fa != DEFAULT) {
@@ -147,7 +158,7 @@ IvExec::runPolicy(PolicyInstr& pi)
 }
 
 IvExec::FlowAction 
-IvExec::runTerm(TermInstr& ti)
+IvExec::run_term(const Term& term)
 {
 
     // we just started
@@ -158,19 +169,181 @@ IvExec::runTerm(TermInstr& ti)
     _stackptr = _stack;
     _stackptr--;
 
-    int instrc = ti.instrc();
-    Instruction** instr = ti.instructions();
-
     if (_do_trace)
-	_os << "Running term: " << ti.name() << endl;
+	_os << "Running term: " << *term._name << endl;
 
     // run all instructions
-    for (int i = 0; i < instrc; ++i) {
+    for (unsigned i = term._begin; i < term._end; ++i) {
+	Code& c = _code[i];
+
 #ifndef XORP_DISABLE_PROFILE
 	if (_profiler)
 	    _profiler->start();
 #endif
-	(instr[i])->accept(*this);
+	switch (c._op) {
+	case OP_PUSH:
+	    // node owns element [no need to trash]
+	    push(c._elem, c._hash);
+
+	    if (_do_trace)
+		_os << "PUSH " << c._elem->type() << " " << c._elem->str()
+		    << endl;
+	    break;
+
+	case OP_PUSH_SET:
+	    // the set was not there when compiling, this throws SetNotFound
+	    if (!c._elem) {
+		const Element& s = _sman->getSet(*c._name);
+
+		c._elem = &s;
+		c._hash = s.hash();
+	    }
+
+	    // set manager owns set [no need to trash]
+	    push(c._elem, c._hash);
+
+	    if (_do_trace)
+		_os << "PUSH_SET " << c._elem->type() << " " << *c._name
+		    << ": " << c._elem->str() << endl;
+	    break;
+
+	case OP_ONFALSE_EXIT:
+	    if (_stackptr < _stack)
+		xorp_throw(RuntimeError, "Got empty stack on ON_FALSE_EXIT");
+
+	    // we expect a bool at the top.
+	    if (_stackptr->_hash != ElemBool::_hash) {
+		// but maybe it is a ElemNull... in which case its a NOP
+		if (_stackptr->_hash == ElemNull::_hash) {
+		    if (_do_trace)
+			_os << "GOT NULL ON TOP OF STACK, GOING TO NEXT TERM"
+			    << endl;
+		    _finished = true;
+		    break;
+		}
+
+		// if it is anything else, its an error
+		xorp_throw(RuntimeError,
+			   "Expected bool on top of stack instead: ");
+	    }
+
+	    // we do not pop the element!!!
+	    // The reason is, that maybe we want to stick ONFALSE_EXIT's here
+	    // and there for optimizations to peek on the stack. Consider a
+	    // giant AND, we may stick an ON_FALSEEXIT after earch clause of
+	    // the and. In that case we do not wish to pop the element from the
+	    // stack, as if it is true, we want to continue computing the AND.
+
+	    // it is false, so lets go to next term
+	    if (!static_cast<const ElemBool*>(_stackptr->_elem)->val())
+		_finished = true;
+
+	    if (_do_trace)
+		_os << "ONFALSE_EXIT: " << _stackptr->_elem->str() << endl;
+	    break;
+
+	case OP_LOAD:
+	{
+	    const Element& x = _varrw->read_trace(c._var);
+
+	    if (_do_trace)
+		_os << "LOAD " << c._var << ": " << x.str() << endl;
+
+	    // varrw owns element [do not trash]
+	    push(&x, x.hash());
+	    break;
+	}
+
+	case OP_STORE:
+	{
+	    if (_stackptr < _stack)
+		xorp_throw(RuntimeError, "Stack empty on assign of "
+			   + policy_utils::to_str(c._var));
+
+	    const Slot& arg = *_stackptr;
+	    _stackptr--;
+	    XLOG_ASSERT(_stackptr >= (_stack-1));
+
+	    if (arg._hash == ElemNull::_hash) {
+		if (_do_trace)
+		    _os << "STORE NULL [treated as NOP]" << endl;
+		break;
+	    }
+
+	    // we still own the element.
+	    // if it had to be trashed, it would have been trashed on
+	    // creation, so do NOT trash now.
+	    _varrw->write_trace(c._var, *arg._elem);
+
+	    if (_do_trace)
+		_os << "STORE " << c._var << ": " << arg._elem->str() << endl;
+	    break;
+	}
+
+	case OP_ACCEPT:
+	    // ok we like the route, so exit all execution
+	    _finished = true;
+	    _fa = ACCEPT;
+	    if (_do_trace)
+		_os << "ACCEPT" << endl;
+	    break;
+
+	case OP_REJECT:
+	    // we don't like it, get out of here.
+	    _finished = true;
+	    _fa = REJ;
+	    if (_do_trace)
+		_os << "REJECT" << endl;
+	    break;
+
+	case OP_NEXT:
+	    _finished = true;
+	    _ctr_flow = c._flow;
+
+	    if (_do_trace) {
+		_os << "NEXT ";
+
+		switch (_ctr_flow) {
+		case Next::TERM:
+		    _os << "TERM";
+		    break;
+
+		case Next::POLICY:
+		    _os << "POLICY";
+		    break;
+		}
+	    }
+	    break;
+
+	case OP_SUBR:
+	{
+	    XLOG_ASSERT(c._subr >= 0);
+
+	    if (_do_trace)
+		_os << "POLICY " << _compiled[c._subr]._instr->name() << endl;
+
+	    FlowAction old_fa = _fa;
+	    bool old_finished = _finished;
+
+	    FlowAction fa = run_policy(c._subr);
+
+	    _fa       = old_fa;
+	    _finished = old_finished;
+
+	    // DEFAULT and ACCEPT are true
+	    if (fa == REJ)
+		push(&_false, ElemBool::_hash);
+	    else
+		push(&_true, ElemBool::_hash);
+	    break;
+	}
+
+	case OP_UNARY:
+	case OP_BINARY:
+	case OP_CTR:
+	    run_oper(c);
+	    break;
+	}
 
 #ifndef XORP_DISABLE_PROFILE
 	if (_profiler)
@@ -188,188 +361,264 @@ IvExec::runTerm(TermInstr& ti)
     return _fa;
 }
 
-void 
-IvExec::visit(Push& p)
+void
+IvExec::push(const Element* e, Element::Hash h)
 {
-    const Element& e = p.elem();
-    // node owns element [no need to trash]
     _stackptr++;
     XLOG_ASSERT(_stackptr < _stackend);
-    *_stackptr = &e;
-    
-    if(_do_trace)
-	_os << "PUSH " << e.type() << " " << e.str() << endl;
+
+    _stackptr->_elem = e;
+    _stackptr->_hash = h;
 }
 
-void 
-IvExec::visit(PushSet& ps)
+void
+IvExec::run_oper(Code& c)
 {
-    string name = ps.setid();
-    const Element& s = _sman->getSet(name);
+    unsigned arity = c._op == OP_UNARY ? 1 : 2;
 
-    // set manager owns set [no need to trash]
-    _stackptr++;
-    XLOG_ASSERT(_stackptr < _stackend);
-    *_stackptr = &s;
+    Slot* args = _stackptr - arity + 1;
+
+    XLOG_ASSERT(args >= _stack);
+
+    // same order as Dispatcher::run()
+    const Element* argv[2];
+    Element::Hash hashes[2] = { 0, 0 };
+    bool null = false;
+
+    for (unsigned i = 0; i < arity; i++) {
+	const Slot& arg = args[i];
+
+	argv[i]   = arg._elem;
+	hashes[i] = arg._hash;
+
+	if (hashes[i] == ElemNull::_hash)
+	    null = true;
+    }
+
+    Element* r;
+
+    if (null) {
+	r = &_null;
+    } else if (c._op == OP_CTR) {
+	if (hashes[1] != ElemStr::_hash)
+	    xorp_throw(Dispatcher::OpNotFound,
+		       "First argument of ctr must be txt type, but is: "
+		       + string(argv[1]->type()));
+
+	r = operations::ctr(*static_cast<const ElemStr*>(argv[1]),
+			    *argv[0]);
+    } else {
+	// argument types changed since last time, resolve again
+	if (c._funct.bin == NULL
+	    || hashes[0] != c._args[0] || hashes[1] != c._args[1]) {
+	    c._funct   = _disp.resolve(*c._oper, arity, hashes);
+	    c._args[0] = hashes[0];
+	    c._args[1] = hashes[1];
+	}
+
+	if (c._funct.bin == NULL)
+	    r = _disp.run(*c._oper, arity, argv);	// reports the error
+	else if (arity == 1)
+	    r = c._funct.un(*argv[0]);
+	else
+	    r = c._funct.bin(*argv[1], *argv[0]);
+    }
+
+    _stackptr -= arity - 1;
+
+    // trash the result.
+    // XXX only if it's a new element.
+    if (r->refcount() == 1) {
+	_trash[_trashc] = r;
+	_trashc++;
+
+	XLOG_ASSERT(_trashc < _trashs);
+    }
+
+    // store result on stack
+    XLOG_ASSERT(_stackptr < _stackend && _stackptr >= _stack);
+    _stackptr->_elem = r;
+    _stackptr->_hash = r->hash();
 
-    if(_do_trace)
-	_os << "PUSH_SET " << s.type() << " " << name
-	     << ": " << s.str() << endl;
+    // output trace
+    if (_do_trace)
+	_os << c._oper->str() << endl;
 }
 
-void 
-IvExec::visit(OnFalseExit& /* x */)
+void
+IvExec::compile()
 {
-    if (_stackptr < _stack)
-	xorp_throw(RuntimeError, "Got empty stack on ON_FALSE_EXIT");
-
-    // we expect a bool at the top.
-    const ElemBool* t = dynamic_cast<const ElemBool*>(*_stackptr);
-    if(!t) {
-	// but maybe it is a ElemNull... in which case its a NOP
-	const Element* e = *_stackptr;
-	if(e->hash() == ElemNull::_hash) {
-	    if(_do_trace)
-		_os << "GOT NULL ON TOP OF STACK, GOING TO NEXT TERM" << endl;
-	    _finished = true;
-	    return;
-        }
+    _compiled.clear();
+    _terms.clear();
+    _code.clear();
+
+    // subroutines go after the policies.  Number them first, as they may
+    // call each other.
+    _subr_index.clear();
+    if (_subr) {
+	int i = _policy_count;
+
+	for (SUBR::iterator j = _subr->begin(); j != _subr->end(); ++j)
+	    _subr_index[j->first] = i++;
+    }
 
-	// if it is anything else, its an error
-        else {
-	   xorp_throw(RuntimeError, "Expected bool on top of stack instead: ");
-	}
-	    
+    for (unsigned i = 0; i < _policy_count; i++)
+	compile_policy(*_policies[i]);
+
+    if (_subr) {
+	for (SUBR::iterator j = _subr->begin(); j != _subr->end(); ++j)
+	    compile_policy(*j->second);
     }
 
-    // we do not pop the element!!!
-    // The reason is, that maybe we want to stick ONFALSE_EXIT's here and there
-    // for optimizations to peek on the stack. Consider a giant AND, we may
-    // stick an ON_FALSEEXIT after earch clause of the and. In that case we do
-    // not wish to pop the element from the stack, as if it is true, we want to
-    // continue computing the AND.
+    _subr_index.clear();
+    _dirty = false;
+}
 
-    // it is false, so lets go to next term
-    if(!t->val())
-	_finished = true;
+void
+IvExec::compile_policy(PolicyInstr& pi)
+{
+    TermInstr** terms = pi.terms();
+    int termc	      = pi.termc();
+    Policy p;
+
+    p._instr = &pi;
+    p._begin = _terms.size();
+
+    for (int i = 0; i < termc; ++i) {
+	TermInstr& ti = *terms[i];
+	Instruction** instr = ti.instructions();
+	int instrc = ti.instrc();
+	Term t;
+
+	t._name  = &ti.name();
+	t._begin = _code.size();
+
+	for (int j = 0; j < instrc; ++j)
+	    instr[j]->accept(*this);
 
-    if(_do_trace)
-	_os << "ONFALSE_EXIT: " << t->str() << endl;
+	t._end = _code.size();
+	_terms.push_back(t);
+    }
+
+    p._end = _terms.size();
+    _compiled.push_back(p);
 }
 
-void 
-IvExec::visit(Load& l)
+IvExec::Code&
+IvExec::emit(Opcode op)
 {
-    const Element& x = _varrw->read_trace(l.var());
+    _code.push_back(Code());
+
+    Code& c = _code.back();
+
+    c._op	 = op;
+    c._elem	 = NULL;
+    c._hash	 = 0;
+    c._name	 = NULL;
+    c._var	 = 0;
+    c._flow	 = Next::TERM;
+    c._subr	 = -1;
+    c._oper	 = NULL;
+    c._args[0]	 = 0;
+    c._args[1]	 = 0;
+    c._funct.bin = NULL;
+
+    return c;
+}
 
-    if (_do_trace)
-	_os << "LOAD " << l.var() << ": " << x.str() << endl;
+void 
+IvExec::visit(Push& p)
+{
+    Code& c = emit(OP_PUSH);
 
-    // varrw owns element [do not trash]
-    _stackptr++;
-    XLOG_ASSERT(_stackptr < _stackend);
-    *_stackptr = &x;
+    c._elem = &p.elem();
+    c._hash = c._elem->hash();
 }
 
 void 
-IvExec::visit(Store& s)
+IvExec::visit(PushSet& ps)
 {
-    if (_stackptr < _stack)
-	xorp_throw(RuntimeError, "Stack empty on assign of " + s.var());
+    Code& c = emit(OP_PUSH_SET);
 
-    const Element* arg = *_stackptr;
-    _stackptr--;
-    XLOG_ASSERT(_stackptr >= (_stack-1));
+    c._name = &ps.setid();
 
-    if (arg->hash() == ElemNull::_hash) {
-	if (_do_trace)
-	    _os << "STORE NULL [treated as NOP]" << endl;
+    // resolved now, as the sets only change with the policies.  A missing
+    // set is looked up again when run, which reports the error.
+    try {
+	const Element& s = _sman->getSet(*c._name);
 
-	return;
+	c._elem = &s;
+	c._hash = s.hash();
+    } catch (const SetManager::SetNotFound&) {
     }
+}
 
-    // we still own the element.
-    // if it had to be trashed, it would have been trashed on creation, so do
-    // NOT trash now. And yes, it likely is an element we do not have to
-    // trash anyway.
-    _varrw->write_trace(s.var(), *arg);
+void 
+IvExec::visit(OnFalseExit& /* x */)
+{
+    emit(OP_ONFALSE_EXIT);
+}
 
-    if (_do_trace)
-	_os << "STORE " << s.var() << ": " << arg->str() << endl;
+void 
+IvExec::visit(Load& l)
+{
+    emit(OP_LOAD)._var = l.var();
+}
+
+void 
+IvExec::visit(Store& s)
+{
+    emit(OP_STORE)._var = s.var();
 }
 
 void 
 IvExec::visit(Accept& /* a */)
 {
-    // ok we like the route, so exit all execution
-    _finished = true;
-    _fa = ACCEPT;
-    if(_do_trace)
-	_os << "ACCEPT" << endl;
+    emit(OP_ACCEPT);
 }
 
 void
 IvExec::visit(Next& next)
 {
-    _finished = true;
-    _ctr_flow = next.flow();
-
-    if (_do_trace) {
-	_os << "NEXT ";
-
-	switch (_ctr_flow) {
-	case Next::TERM:
-	    _os << "TERM";
-	    break;
-
-	case Next::POLICY:
-	    _os << "POLICY";
-	    break;
-	}
-    }
+    emit(OP_NEXT)._flow = next.flow();
 }
 
 void 
 IvExec::visit(Reject& /* r */)
 {
-    // we don't like it, get out of here.
-    _finished = true;
-    _fa = REJ;
-
-    if(_do_trace)
-	_os << "REJECT" << endl;
+    emit(OP_REJECT);
 }
 
 void
 IvExec::visit(NaryInstr& nary)
 {
-    unsigned arity = nary.op().arity();
-
-    XLOG_ASSERT((_stackptr - arity + 1) >= _stack);
+    const Oper& op = nary.op();
+    Opcode code;
 
-    // execute the operation
-    Element* r = _disp.run(nary.op(), arity, _stackptr - arity + 1);
-    if (arity)
-	_stackptr -= arity -1;
-    else
-	_stackptr++;
+    switch (op.arity()) {
+    case 1:
+	code = OP_UNARY;
+	break;
 
-    // trash the result.
-    // XXX only if it's a new element.
-    if (r->refcount() == 1) {
-	_trash[_trashc] = r;
-	_trashc++;
+    case 2:
+	code = op.hash() == HASH_OP_CTR ? OP_CTR : OP_BINARY;
+	break;
 
-	XLOG_ASSERT(_trashc < _trashs);
+    default:
+	xorp_throw(Dispatcher::OpNotFound, "Operations of arity: " +
+		   policy_utils::to_str(op.arity()) + " not supported");
     }
 
-    // store result on stack
-    XLOG_ASSERT(_stackptr < _stackend && _stackptr >= _stack);
-    *_stackptr = r;
+    emit(code)._oper = &op;
+}
 
-    // output trace
-    if (_do_trace)
-	_os << nary.op().str() << endl;
+void
+IvExec::visit(Subr& sub)
+{
+    map<string, int>::iterator i = _subr_index.find(sub.target());
+
+    // checked when run, like a missing set
+    emit(OP_SUBR)._subr = i == _subr_index.end() ? -1 : i->second;
 }
 
 void
@@ -406,6 +655,12 @@ IvExec::set_policies(vector<PolicyInstr*>* policies)
 	_policies = NULL;
     }
 
+    // the compiled code points into the old policies
+    _compiled.clear();
+    _terms.clear();
+    _code.clear();
+    _dirty = true;
+
     // resetting...
     if (!policies) {
 	_policy_count = 0;
@@ -428,7 +683,8 @@ IvExec::set_policies(vector<PolicyInstr*>* policies)
 void
 IvExec::set_set_manager(SetManager* sman)
 {
-    _sman = sman;
+    _sman  = sman;
+    _dirty = true;
 }
 
 #ifndef XORP_DISABLE_PROFILE
@@ -445,51 +701,9 @@ IvExec::tracelog()
     return _os.str();
 }
 
-void
-IvExec::visit(Subr& sub)
-{
-    SUBR::iterator i = _subr->find(sub.target());
-    XLOG_ASSERT(i != _subr->end());
-
-    PolicyInstr* policy = i->second;
-
-    if (_do_trace)
-	_os << "POLICY " << policy->name() << endl;
-
-    FlowAction old_fa = _fa;
-    bool old_finished = _finished;
-
-    FlowAction fa = runPolicy(*policy);
-
-    _fa       = old_fa;
-    _finished = old_finished;
-
-    bool result = true;
-
-    switch (fa) {
-    case DEFAULT:
-    case ACCEPT:
-	result = true;
-	break;
-
-    case REJ:
-	result = false;
-	break;
-    }
-
-    Element* e = new ElemBool(result);
-
-    _stackptr++;
-    XLOG_ASSERT(_stackptr < _stackend);
-    *_stackptr = e;
-
-    _trash[_trashc] = e;
-    _trashc++;
-    XLOG_ASSERT(_trashc < _trashs);
-}
-
 void
 IvExec::set_subr(SUBR* subr)
 {
-    _subr = subr;
+    _subr  = subr;
+    _dirty = true;
 }
@@ -17,7 +17,6 @@
 // 
 // XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
 // http://xorp.net
-
 // $XORP: xorp/policy/backend/iv_exec.hh,v 1.19 2008/10/02 21:58:04 bms Exp $
 
 #ifndef __POLICY_BACKEND_IV_EXEC_HH__
@@ -28,6 +27,8 @@
 #include "policy/common/dispatcher.hh"
 #include "policy/common/varrw.hh"
 #include "policy/common/policy_exception.hh"
+#include "policy/common/element.hh"
+#include "policy/common/elem_null.hh"
 #ifndef XORP_DISABLE_PROFILE
 #include "policy_profiler.hh"
 #endif
@@ -39,10 +40,15 @@
 #include "policy_backend_parser.hh"
 
 /**
- * @short Visitor that executes instructions
+ * @short Executes policies.
  *
- * The execution process may be optimized by not using visitors. Having
- * instructions implement a method that returns a flow action directly.
+ * Walking the instructions of every term for every route is too slow, so the
+ * instructions are visited only once, when the policies change, and compiled
+ * into a flat array of codes.  Sets and subroutines are resolved at that
+ * point, and each operation caches the dispatcher callback for the argument
+ * types it last saw.  The stack holds the type of each element next to it,
+ * and boolean results are shared, so running a filter normally allocates
+ * nothing.
  */
 class IvExec :
     public NONCOPYABLE,
@@ -74,6 +80,15 @@ public:
     IvExec();
     ~IvExec();
    
+    /**
+     * Set the policies to execute.  They are compiled on the next run, and
+     * must not be deleted before they are replaced.
+     *
+     * The sets of the set manager are resolved when compiling, so the
+     * policies must be set again whenever the sets are replaced.
+     *
+     * @param policies policies to execute, or NULL to reset.
+     */
     void set_policies(vector<PolicyInstr*>* policies);
     void set_set_manager(SetManager* sman);
    
@@ -83,56 +98,42 @@ public:
     FlowAction run(VarRW* varrw);
 
     /**
-     * Execute a policy.
-     *
-     * @param pi policy to execute
-     */
-    FlowAction runPolicy(PolicyInstr& pi);
-
-    /**
-     * Execute a term.
-     *
-     * @param ti term to execute.
-     */
-    FlowAction runTerm(TermInstr& ti);
-
-    /**
-     * @param p push to execute.
+     * @param p push to compile.
      */
     void visit(Push& p);
 
     /**
-     * @param ps push of a set to execute.
+     * @param ps push of a set to compile.
      */
     void visit(PushSet& ps);
     
     /**
-     * @param x OnFalseExit to execute.
+     * @param x OnFalseExit to compile.
      */
     void visit(OnFalseExit& x);
 
     /**
-     * @param l Load to execute.
+     * @param l Load to compile.
      */
     void visit(Load& l);
 
     /**
-     * @param s Store to execute.
+     * @param s Store to compile.
      */
     void visit(Store& s);
 
     /**
-     * @param a accept the route.
+     * @param a accept to compile.
      */
     void visit(Accept& a);
     
     /**
-     * @param r reject the route.
+     * @param r reject to compile.
      */
     void visit(Reject& r);
 
     /**
-     * @param nary N-ary instruction to execute.
+     * @param nary N-ary instruction to compile.
      */
     void visit(NaryInstr& nary);
 
@@ -152,6 +153,104 @@ public:
     void    set_subr(SUBR* subr);
 
 private:
+    enum Opcode {
+	OP_PUSH,
+	OP_PUSH_SET,
+	OP_ONFALSE_EXIT,
+	OP_LOAD,
+	OP_STORE,
+	OP_ACCEPT,
+	OP_REJECT,
+	OP_NEXT,
+	OP_SUBR,
+	OP_UNARY,
+	OP_BINARY,
+	OP_CTR
+    };
+
+    /**
+     * A compiled instruction.  Only the fields of its opcode are used.
+     */
+    struct Code {
+	Opcode		    _op;
+	const Element*	    _elem;	// PUSH, PUSH_SET: NULL if no such set
+	Element::Hash	    _hash;	// of _elem
+	const string*	    _name;	// PUSH_SET
+	VarRW::Id	    _var;	// LOAD, STORE
+	Next::Flow	    _flow;	// NEXT
+	int		    _subr;	// SUBR: index of policy, or -1
+	const Oper*	    _oper;	// UNARY, BINARY, CTR
+	Element::Hash	    _args[2];	// argument types of _funct
+	Dispatcher::Value   _funct;	// callback for _args, or NULL
+    };
+
+    struct Term {
+	const string*	_name;
+	unsigned	_begin;		// first code
+	unsigned	_end;		// one past last code
+    };
+
+    struct Policy {
+	PolicyInstr*	_instr;
+	unsigned	_begin;		// first term
+	unsigned	_end;		// one past last term
+    };
+
+    /**
+     * An element on the stack, together with its type.
+     */
+    struct Slot {
+	const Element*	_elem;
+	Element::Hash	_hash;
+    };
+
+    /**
+     * Compile the policies and subroutines into flat code.
+     */
+    void compile();
+
+    /**
+     * Add a compiled policy.
+     *
+     * @param pi policy to compile.
+     */
+    void compile_policy(PolicyInstr& pi);
+
+    /**
+     * @return a new code for the term being compiled.
+     * @param op opcode of the code.
+     */
+    Code& emit(Opcode op);
+
+    /**
+     * Execute a policy.
+     *
+     * @param policy index of policy to execute.
+     */
+    FlowAction run_policy(unsigned policy);
+
+    /**
+     * Execute a term.
+     *
+     * @param term term to execute.
+     */
+    FlowAction run_term(const Term& term);
+
+    /**
+     * Execute an operation, and push the result in place of the arguments.
+     *
+     * @param c code of the operation.
+     */
+    void run_oper(Code& c);
+
+    /**
+     * Push an element on the stack.
+     *
+     * @param e element to push.
+     * @param h hash of the element.
+     */
+    void push(const Element* e, Element::Hash h);
+
     /**
      * Do garbage collection.
      */
@@ -159,10 +258,15 @@ private:
 
     PolicyInstr**   _policies;
     unsigned	    _policy_count;
-    const Element** _stack_bottom;
-    const Element** _stack;
-    const Element** _stackend;
-    const Element** _stackptr;
+    vector<Policy>  _compiled;
+    vector<Term>    _terms;
+    vector<Code>    _code;
+    bool	    _dirty;
+    map<string, int> _subr_index;	// only used while compiling
+    Slot*	    _stack_bottom;
+    Slot*	    _stack;
+    Slot*	    _stackend;
+    Slot*	    _stackptr;
     SetManager*	    _sman;
     VarRW*	    _varrw;
     bool	    _finished;
@@ -179,6 +283,9 @@ private:
     bool	    _did_trace;
     Next::Flow	    _ctr_flow;
     SUBR*	    _subr;
+    ElemBool	    _true;
+    ElemBool	    _false;
+    ElemNull	    _null;
 };
 
 #endif // __POLICY_BACKEND_IV_EXEC_HH__
@@ -36,7 +36,9 @@ PolicyFilter::PolicyFilter() : _policies(NULL),
 #ifndef XORP_DISABLE_PROFILE
 			       _profiler_exec(NULL),
 #endif
-			       _subr(NULL)
+			       _subr(NULL),
+			       _loads(0),
+			       _stores(0)
 {
     _exec.set_set_manager(&_sman);
 }
@@ -68,6 +70,8 @@ void PolicyFilter::configure(const string& str)
     _sman.replace_sets(sets);
     _exec.set_policies(_policies);
     _exec.set_subr(_subr);
+
+    scan_vars();
 }
 
 PolicyFilter::~PolicyFilter()
@@ -90,6 +94,8 @@ void PolicyFilter::reset()
     }
 
     _sman.clear();
+
+    _loads = _stores = 0;
 }
 
 bool PolicyFilter::acceptRoute(VarRW& varrw)
@@ -168,6 +174,62 @@ bool PolicyFilter::acceptRoute(VarRW& varrw)
     return default_action;
 }
 
+namespace {
+
+void
+policy_vars(PolicyInstr* pi, uint32_t& loads, uint32_t& stores)
+{
+    TermInstr** terms = pi->terms();
+
+    for (int i = 0; i < pi->termc(); i++) {
+	Instruction** instr = terms[i]->instructions();
+
+	for (int j = 0; j < terms[i]->instrc(); j++) {
+	    Load* load = dynamic_cast<Load*>(instr[j]);
+	    if (load != NULL) {
+		loads |= 1U << load->var();
+		continue;
+	    }
+
+	    Store* store = dynamic_cast<Store*>(instr[j]);
+	    if (store != NULL)
+		stores |= 1U << store->var();
+	}
+    }
+}
+
+} // anonymous namespace
+
+void
+PolicyFilter::scan_vars()
+{
+    _loads = _stores = 0;
+
+    if (_policies != NULL) {
+	for (vector<PolicyInstr*>::const_iterator i = _policies->begin();
+	     i != _policies->end(); ++i)
+	    policy_vars(*i, _loads, _stores);
+    }
+
+    // Look at every subroutine rather than following the calls.
+    if (_subr != NULL) {
+	for (SUBR::const_iterator i = _subr->begin(); i != _subr->end(); ++i)
+	    policy_vars(i->second, _loads, _stores);
+    }
+}
+
+bool
+PolicyFilter::reads(const VarRW::Id& id) const
+{
+    return _loads & (1U << id);
+}
+
+bool
+PolicyFilter::writes(const VarRW::Id& id) const
+{
+    return _stores & (1U << id);
+}
+
 #ifndef XORP_DISABLE_PROFILE
 void
 PolicyFilter::set_profiler_exec(PolicyProfiler* profiler)
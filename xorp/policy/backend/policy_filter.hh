@@ -82,11 +82,32 @@ public:
      */
     bool acceptRoute(VarRW& varrw);
 
+    /**
+     * See if the current configuration of the filter reads a variable.
+     *
+     * @return true if any term or subroutine loads the variable.
+     * @param id the variable to look for.
+     */
+    bool reads(const VarRW::Id& id) const;
+
+    /**
+     * See if the current configuration of the filter writes a variable.
+     *
+     * @return true if any term or subroutine stores the variable.
+     * @param id the variable to look for.
+     */
+    bool writes(const VarRW::Id& id) const;
+
 #ifndef XORP_DISABLE_PROFILE
     void set_profiler_exec(PolicyProfiler* profiler);
 #endif
 
 private:
+    /**
+     * Record which variables the configuration loads and stores.
+     */
+    void scan_vars();
+
     vector<PolicyInstr*>*   _policies;
     SetManager		    _sman;
     IvExec		    _exec;
@@ -94,6 +115,8 @@ private:
     PolicyProfiler*	    _profiler_exec;
 #endif
     SUBR*		    _subr;
+    uint32_t		    _loads;	// bit per VarRW::Id
+    uint32_t		    _stores;
 };
 
 typedef ref_ptr<PolicyFilter> RefPf;
@@ -65,6 +65,13 @@ PolicyFilters::reset(const uint32_t& ftype)
     pf.reset();
 }
 
+bool
+PolicyFilters::reads(const uint32_t& ftype, const VarRW::Id& id)
+{
+    FilterBase& pf = whichFilter(ftype);
+    return pf.reads(id);
+}
+
 FilterBase& 
 PolicyFilters::whichFilter(const uint32_t& ftype)
 {
@@ -80,7 +80,16 @@ public:
      */
     void reset(const uint32_t& type);
 
-private:
+    /**
+     * See if the current configuration of a filter reads a variable.
+     *
+     * @return true if the filter loads the variable.
+     * @param type the filter to look at.
+     * @param id the variable to look for.
+     */
+    bool reads(const uint32_t& type, const VarRW::Id& id);
+
+protected:
     /**
      * Decide which filter to run based on its type.
      *
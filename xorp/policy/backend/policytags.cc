@@ -52,7 +52,7 @@ PolicyTags::PolicyTags(const XrlAtomList& alist) : _tag(0)
 	}
 
 	// it's good, insert it
-	_tags.insert(val);
+	insert(val);
     }
 }
 
@@ -73,7 +73,7 @@ PolicyTags::set_ptags(const Element& element)
 
 	// all ElemSet elements are represented as string, so convert and
 	// insert.
-	_tags.insert(x.val());
+	insert(x.val());
     }
 }
 
@@ -146,29 +146,42 @@ PolicyTags::set_tag(const Element& e)
 void
 PolicyTags::insert(const PolicyTags& ptags)
 {
+    if (_tags.empty()) {
+	_tags = ptags._tags;
+	return;
+    }
+
     // go through all the elements in ptags and insert them.
     for(Set::const_iterator i = ptags._tags.begin();
 	i != ptags._tags.end(); ++i)
 
-	_tags.insert(*i);
+	insert(*i);
 }
 
 bool
 PolicyTags::contains_atleast_one(const PolicyTags& tags) const
 {
-    Set output;
-
     // The two sets must not be dis-joint.
     // The intersection must contain atleast one element.
-    set_intersection(tags._tags.begin(), tags._tags.end(),
-		     _tags.begin(), _tags.end(),
-		     insert_iterator<Set>(output,output.begin()));
-	
-    return !output.empty();
+    Set::const_iterator i = tags._tags.begin();
+    Set::const_iterator j = _tags.begin();
+
+    while (i != tags._tags.end() && j != _tags.end()) {
+	if (*i < *j)
+	    ++i;
+	else if (*j < *i)
+	    ++j;
+	else
+	    return true;
+    }
+    return false;
 }
 
 void
 PolicyTags::insert(uint32_t tag)
 {
-    _tags.insert(tag);
+    Set::iterator i = lower_bound(_tags.begin(), _tags.end(), tag);
+
+    if (i == _tags.end() || *i != tag)
+	_tags.insert(i, tag);
 }
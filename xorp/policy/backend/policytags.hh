@@ -82,6 +82,7 @@ public:
     Element* element() const;
 
     Element* element_tag() const;
+    uint32_t tag() const { return _tag; }
     void     set_tag(const Element& e);
     void     set_ptags(const Element& e);
 
@@ -110,7 +111,9 @@ public:
     bool contains_atleast_one(const PolicyTags& tags) const;
 
 private:
-    typedef set<uint32_t> Set;
+    // Most routes carry no tags or only a few, so they are kept sorted
+    // in a vector: one allocation at most, and none when empty.
+    typedef vector<uint32_t> Set;
 
     Set		_tags;
     uint32_t	_tag;
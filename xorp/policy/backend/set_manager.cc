@@ -24,6 +24,30 @@
 
 #include "set_manager.hh"
 #include "policy/common/policy_utils.hh"
+#include "policy/common/prefix_set.hh"
+
+namespace {
+
+typedef map<string, ref_ptr<const ElemSetIndex> > IndexMap;
+
+// tries of all network sets in use, by contents
+IndexMap _indexes;
+
+// forget the tries no set uses anymore
+void
+prune_indexes()
+{
+    IndexMap::iterator i = _indexes.begin();
+
+    while (i != _indexes.end()) {
+	if (i->second.is_only())
+	    _indexes.erase(i++);
+	else
+	    ++i;
+    }
+}
+
+} // anonymous namespace
 
 SetManager::SetManager() : _sets(NULL) {
 }
@@ -51,6 +75,32 @@ SetManager::replace_sets(SetMap* sets) {
     clear();
 
     _sets = sets;
+
+    index_sets();
+}
+
+void
+SetManager::index_sets() {
+    for (SetMap::iterator i = _sets->begin(); i != _sets->end(); ++i) {
+	Element* e = i->second;
+	bool v4 = e->hash() == ElemSetIPv4Net::_hash;
+
+	if (!v4 && e->hash() != ElemSetIPv6Net::_hash)
+	    continue;
+
+	ElemSet* set = static_cast<ElemSet*>(e);
+	string key = string(set->type()) + " " + set->str();
+	ref_ptr<const ElemSetIndex>& index = _indexes[key];
+
+	if (index.is_empty()) {
+	    if (v4)
+		index = new PrefixSetIPv4(*static_cast<ElemSetIPv4Net*>(e));
+	    else
+		index = new PrefixSetIPv6(*static_cast<ElemSetIPv6Net*>(e));
+	}
+
+	set->set_index(index);
+    }
 }
 
 void
@@ -59,5 +109,7 @@ SetManager::clear() {
 	policy_utils::clear_map(*_sets);
 	delete _sets;
 	_sets = NULL;
+
+	prune_indexes();
     }
 }
@@ -78,6 +78,12 @@ public:
     void clear();
 
 private:
+    /**
+     * Attach a prefix trie to every network set.  Filters holding sets with
+     * the same contents share one trie.
+     */
+    void index_sets();
+
     SetMap* _sets;
 };
 
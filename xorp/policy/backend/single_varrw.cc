@@ -130,6 +130,8 @@ SingleVarRW::sync()
     for (unsigned i = 0; i < _trashc; i++)
         delete _trash[i];
     _trashc = 0;
+
+    _arena.reset();
 }
 
 void
@@ -143,7 +145,7 @@ SingleVarRW::initialize(const Id& id, Element* e)
     // SingleVarRW will already have the correct value for that variable, so we
     // need to ignore any initialize() called for that variable.
     if(_elems[id]) {
-	if(e)
+	if(e && !_arena.owns(e))
 	    delete e;
 	return;
     }
@@ -151,10 +153,14 @@ SingleVarRW::initialize(const Id& id, Element* e)
     // special case nulls [for supported variables, but not present in this
     // particular case].
     if(!e)
-	e = new ElemNull();
+	e = _arena.create<ElemNull>();
 
     _elems[id] = e;
 
+    // the arena releases its own elements on sync
+    if (_arena.owns(e))
+	return;
+
     // we own the pointers.
     XLOG_ASSERT(_trashc < sizeof(_trash)/sizeof(Element*));
     _trash[_trashc] = e;
@@ -167,5 +173,5 @@ SingleVarRW::initialize(PolicyTags& pt)
     _pt = &pt;
 
     initialize(VAR_POLICYTAGS, _pt->element());
-    initialize(VAR_TAG, _pt->element_tag());
+    initialize(VAR_TAG, _arena.create<ElemU32>(_pt->tag()));
 }
@@ -31,6 +31,7 @@
 #include "policy/common/policy_utils.hh"
 #include "policy/common/element_base.hh"
 #include "policytags.hh"
+#include "element_arena.hh"
 
 /**
  * @short An interface to VarRW which deals with memory management.
@@ -139,7 +140,18 @@ public:
      */
     virtual void end_write() {}
 
+protected:
+    /**
+     * Elements returned by single_read() may be created in the arena rather
+     * than on the heap.  They are released when the cache is cleared on
+     * sync(), so they may reference the route being filtered.
+     *
+     * @return arena for the elements of the current route.
+     */
+    ElementArena& arena() { return _arena; }
+
 private:
+    ElementArena    _arena;
     Element*	    _trash[16];
     unsigned	    _trashc;
     const Element*  _elems[VAR_MAX];    // Map that caches element read/writes 
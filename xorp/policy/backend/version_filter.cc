@@ -101,3 +101,9 @@ VersionFilter::acceptRoute(VarRW& varrw)
     XLOG_ASSERT(!_filter.is_empty());
     return _filter->acceptRoute(varrw);
 }
+
+bool
+VersionFilter::reads(const VarRW::Id& id) const
+{
+    return _filter->reads(id);
+}
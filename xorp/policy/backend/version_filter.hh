@@ -74,6 +74,26 @@ public:
      */
     bool acceptRoute(VarRW& varrw);
 
+    /**
+     * See if the latest version of the filter reads a variable.
+     *
+     * Routes which are still bound to an older version are not
+     * considered.
+     *
+     * @return true if the latest filter loads the variable.
+     * @param id the variable to look for.
+     */
+    bool reads(const VarRW::Id& id) const;
+
+    /**
+     * The filter which routes that are not bound to a filter yet will run.
+     * A new filter is created on every configuration, so a change of the
+     * returned filter means the filter was reconfigured.
+     *
+     * @return the latest configuration of the filter.
+     */
+    const RefPf& latest() const { return _filter; }
+
 private:
     RefPf _filter;
     VarRW::Id _fname;
@@ -22,6 +22,7 @@
 
 #include "libxorp/xorp.h"
 
+#include "policy/common/policy_utils.hh"
 #include "version_filters.hh"
 #include "version_filter.hh"
 
@@ -31,4 +32,23 @@ VersionFilters::VersionFilters() : PolicyFilters(
 				    new VersionFilter(VarRW::VAR_FILTER_SM),
 				    new VersionFilter(VarRW::VAR_FILTER_EX))
 {
+    _import = &dynamic_cast<VersionFilter&>(whichFilter(filter::IMPORT));
+    _export_sm = &dynamic_cast<VersionFilter&>(
+				whichFilter(filter::EXPORT_SOURCEMATCH));
+    _export = &dynamic_cast<VersionFilter&>(whichFilter(filter::EXPORT));
+}
+
+const RefPf&
+VersionFilters::latest(const uint32_t& type) const
+{
+    switch (type) {
+    case filter::IMPORT:
+	return _import->latest();
+    case filter::EXPORT_SOURCEMATCH:
+	return _export_sm->latest();
+    case filter::EXPORT:
+	return _export->latest();
+    }
+    xorp_throw(PolicyFiltersErr,
+	       "Unknown filter: " + policy_utils::to_str(type));
 }
@@ -23,6 +23,7 @@
 #define __POLICY_BACKEND_VERSION_FILTERS_HH__
 
 #include "policy_filters.hh"
+#include "version_filter.hh"
 
 /**
  * @short Policy filters which support versioning [i.e. keep old version].
@@ -43,6 +44,17 @@
 class VersionFilters : public PolicyFilters {
 public:
     VersionFilters();
+
+    /**
+     * @return the latest configuration of a filter.
+     * @param type the filter to look at.
+     */
+    const RefPf& latest(const uint32_t& type) const;
+
+private:
+    VersionFilter*	_import;
+    VersionFilter*	_export_sm;
+    VersionFilter*	_export;
 };
 
 #endif // __POLICY_BACKEND_VERSION_FILTERS_HH__
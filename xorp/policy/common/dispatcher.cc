@@ -22,10 +22,6 @@
 
 #include "libxorp/xorp.h"
 
-#ifndef XORP_USE_USTL
-#include <typeinfo>
-#endif
-
 #include "dispatcher.hh"
 #include "elem_null.hh"
 #include "policy_utils.hh"
@@ -125,7 +121,7 @@ Dispatcher::run(const Oper& op, unsigned argc, const Element** argv) const
     }
 
     // check for constructor
-    if (argc == 2 && typeid(op) == typeid(OpCtr)) {
+    if (argc == 2 && op.hash() == HASH_OP_CTR) {
 	string arg1type = argv[1]->type();
 
 	if (arg1type != ElemStr::id)
@@ -174,6 +170,33 @@ Dispatcher::run(const Oper& op, unsigned argc, const Element** argv) const
     // unreach
 }
 
+Dispatcher::Value
+Dispatcher::resolve(const Oper& op, unsigned argc,
+		    const Element::Hash* hashes) const
+{
+    XLOG_ASSERT(op.arity() == argc);
+    XLOG_ASSERT(argc <= 2);
+
+    unsigned int key = op.hash();
+    Value funct;
+
+    funct.bin = NULL;
+
+    if (argc == 2 && key == HASH_OP_CTR)
+	return funct;
+
+    // same key as run()
+    for (unsigned i = 0; i < argc; i++) {
+	if (hashes[i] == ElemNull::_hash)
+	    return funct;
+
+	key |= hashes[i] << (5*(argc-i));
+    }
+
+    XLOG_ASSERT(key < DISPATCHER_MAP_SZ);
+
+    return _map[key];
+}
 
 Element* 
 Dispatcher::run(const UnOper& op, const Element& arg) const
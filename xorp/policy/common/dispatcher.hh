@@ -44,6 +44,18 @@ class Dispatcher {
 public:
     typedef vector<const Element*> ArgList;
 
+    // Callback for binary operation
+    typedef Element* (*CB_bin)(const Element&, const Element&);
+    
+    // Callback for unary operation
+    typedef Element* (*CB_un)(const Element&);
+
+    // A key relates to either a binary (x)or unary operation.
+    typedef union {
+	CB_un un;
+        CB_bin bin;
+    } Value;
+
     Dispatcher();
 
     /**
@@ -128,6 +140,22 @@ public:
      */
     Element* run(const Oper& op, unsigned argc, const Element** argv) const;
 
+    /**
+     * Find the callback which executes an operation on arguments of the
+     * given types, without executing it.
+     *
+     * Lets callers which run the same operation over and over resolve it
+     * once.  Null arguments and the constructor are special cased by run()
+     * and have no callback.
+     *
+     * @return the callback, which is NULL if there is none.
+     * @param op operation to resolve.
+     * @param argc number of arguments.
+     * @param hashes hashes of the arguments, in the same order as for run().
+     */
+    Value resolve(const Oper& op, unsigned argc,
+		  const Element::Hash* hashes) const;
+
     /**
      * Execute an unary operation.
      *
@@ -150,18 +178,6 @@ public:
 		 const Element& right) const;
 
 private:
-    // Callback for binary operation
-    typedef Element* (*CB_bin)(const Element&, const Element&);
-    
-    // Callback for unary operation
-    typedef Element* (*CB_un)(const Element&);
-
-    // A key relates to either a binary (x)or unary operation.
-    typedef union {
-	CB_un un;
-        CB_bin bin;
-    } Value;
-
     // Hashtable would be better
     typedef map<unsigned int, Value> Map;
 
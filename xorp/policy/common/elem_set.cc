@@ -86,6 +86,7 @@ void
 ElemSetAny<T>::insert(const T& s) 
 {
     _val.insert(s);
+    _index.release();
 }
 
 template <class T>
@@ -93,6 +94,7 @@ void
 ElemSetAny<T>::insert(const ElemSetAny<T>& s)
 {
     _val.insert(s._val.begin(), s._val.end());
+    _index.release();
 }
 
 template <class T>
@@ -236,6 +238,7 @@ ElemSetAny<T>::erase(const ElemSetAny<T>& rhs)
 	if (j != _val.end())
 	    _val.erase(j);
     }
+    _index.release();
 }
 
 template <class T>
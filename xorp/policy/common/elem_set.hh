@@ -22,9 +22,21 @@
 #ifndef __POLICY_COMMON_ELEM_SET_HH__
 #define __POLICY_COMMON_ELEM_SET_HH__
 
+#include "libxorp/ref_ptr.hh"
+
 #include "element_base.hh"
 #include "element.hh"
 
+/**
+ * @short Lookup structure built from the contents of a set.
+ *
+ * A set may carry an index which speeds up matching against it.  The index
+ * is owned by whoever built it and is dropped as soon as the set changes.
+ */
+class ElemSetIndex {
+public:
+    virtual ~ElemSetIndex() {}
+};
 
 class ElemSet : public Element {
 public:
@@ -32,6 +44,20 @@ public:
     virtual ~ElemSet() {}
 
     virtual void erase(const ElemSet&) = 0;
+
+    /**
+     * @param index the index to use for this set.  It must have been built
+     * from the current contents of the set.
+     */
+    void set_index(const ref_ptr<const ElemSetIndex>& index) { _index = index; }
+
+    /**
+     * @return the index of this set, or NULL if it has none.
+     */
+    const ElemSetIndex* index() const { return _index.get(); }
+
+protected:
+    ref_ptr<const ElemSetIndex> _index;
 };
 
 /**
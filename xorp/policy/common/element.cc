@@ -122,14 +122,15 @@ ElemCom32::str() const {
 }
 
 template<class A>
-ElemNet<A>::ElemNet() : Element(_hash), _net(NULL), _mod(MOD_NONE), _op(NULL)
+ElemNet<A>::ElemNet() : Element(_hash), _net(NULL), _free(true),
+			_mod(MOD_NONE), _op(NULL)
 {
     _net = new A();
 }
 
 template<class A>
 ElemNet<A>::ElemNet(const char* str) : Element(_hash), _net(NULL),
-				       _mod(MOD_NONE), _op(NULL)
+				       _free(true), _mod(MOD_NONE), _op(NULL)
 {
     if (!str) {
 	_net = new A();
@@ -144,7 +145,17 @@ ElemNet<A>::ElemNet(const char* str) : Element(_hash), _net(NULL),
     if (p) {
 	in = in.substr(0, p - str);
 
-	_mod = str_to_mod(++p);
+	// a range of prefix lengths, such as 10.0.0.0/8~16..24
+	if (strstr(++p, "..")) {
+	    try {
+		_range = U32Range(p);
+	    } catch (...) {
+		xorp_throw(PolicyException,
+			   "Can't parse prefix length range: " + string(p));
+	    }
+	    _mod = MOD_RANGE;
+	} else
+	    _mod = str_to_mod(p);
     }
 
     // parse net
@@ -157,11 +168,20 @@ ElemNet<A>::ElemNet(const char* str) : Element(_hash), _net(NULL),
 
 	xorp_throw(PolicyException, oss.str());
     }
+
+    if (_mod == MOD_RANGE
+	&& (_range.low() > _range.high()
+	    || _range.high() > _net->masked_addr().addr_bitlen())) {
+	string err = "Bad prefix length range: " + _range.str();
+
+	delete _net;
+	xorp_throw(PolicyException, err);
+    }
 }
 
 template<class A>
-ElemNet<A>::ElemNet(const A& net) : Element(_hash), _net(NULL), _mod(MOD_NONE),
-				    _op(NULL)
+ElemNet<A>::ElemNet(const A& net) : Element(_hash), _net(NULL), _free(true),
+				    _mod(MOD_NONE), _op(NULL)
 {
     _net = new A(net);
 }
@@ -169,17 +189,26 @@ ElemNet<A>::ElemNet(const A& net) : Element(_hash), _net(NULL), _mod(MOD_NONE),
 template<class A>
 ElemNet<A>::ElemNet(const ElemNet<A>& net) : Element(_hash),
 					     _net(net._net),
+					     _free(true),
 					     _mod(net._mod),
+					     _range(net._range),
 					     _op(NULL)
 {
     if (_net)
 	_net = new A(*_net);
 }
 
+template<class A>
+ElemNet<A>::ElemNet(const A* net) : Element(_hash), _net(net), _free(false),
+				    _mod(MOD_NONE), _op(NULL)
+{
+}
+
 template<class A>
 ElemNet<A>::~ElemNet()
 {
-    delete _net;
+    if (_free)
+	delete _net;
 }
 
 template<class A>
@@ -188,7 +217,12 @@ ElemNet<A>::str() const
 {
     string str = _net->str();
 
-    if (_mod != MOD_NONE) {
+    if (_mod == MOD_RANGE) {
+	str += "~";
+	str += policy_utils::to_str(_range.low());
+	str += "..";
+	str += policy_utils::to_str(_range.high());
+    } else if (_mod != MOD_NONE) {
 	str += "~";
 	str += mod_to_str(_mod);
     }
@@ -214,14 +248,34 @@ template<class A>
 bool
 ElemNet<A>::operator<(const ElemNet<A>& rhs) const
 {
-    return *_net < *rhs._net;
+    // a set may hold several elements on one network, e.g. two ranges
+    if (*_net != *rhs._net)
+	return *_net < *rhs._net;
+
+    if (_mod != rhs._mod)
+	return _mod < rhs._mod;
+
+    if (_mod != MOD_RANGE)
+	return false;
+
+    if (_range.low() != rhs._range.low())
+	return _range.low() < rhs._range.low();
+
+    return _range.high() < rhs._range.high();
 }
 
 template<class A>
 bool
 ElemNet<A>::operator==(const ElemNet<A>& rhs) const
 {
-    return *_net == *rhs._net;
+    if (*_net != *rhs._net || _mod != rhs._mod)
+	return false;
+
+    if (_mod != MOD_RANGE)
+	return true;
+
+    return _range.low() == rhs._range.low()
+	   && _range.high() == rhs._range.high();
 }
 
 template<class A>
@@ -283,6 +337,9 @@ ElemNet<A>::mod_to_str(Mod mod)
 
     case MOD_NOT:
 	return "!=";
+
+    case MOD_RANGE:
+	return "..";
     }
 
     // unreach
@@ -325,7 +382,9 @@ ElemNet<A>::op() const
 	_op = &LT;
 	break;
 
+    // the prefix length of a range is checked by the caller
     case MOD_ORLONGER:
+    case MOD_RANGE:
 	_op = &LE;
 	break;
     }
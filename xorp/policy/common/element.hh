@@ -28,6 +28,7 @@
 #include "libxorp/ipv6.hh"
 #include "libxorp/ipv4net.hh"
 #include "libxorp/ipv6net.hh"
+#include "libxorp/range.hh"
 #include "element_base.hh"
 #include "policy_exception.hh"
 #include "policy_utils.hh"
@@ -483,7 +484,8 @@ public:
 	MOD_ORSHORTER,
 	MOD_LONGER,
 	MOD_ORLONGER,
-	MOD_NOT
+	MOD_NOT,
+	MOD_RANGE	// orlonger, with a prefix length in _range
     };
 
     static const char*	id;
@@ -492,12 +494,15 @@ public:
     ElemNet();
     ElemNet(const char*);
     ElemNet(const A&);
+    explicit ElemNet(const A* net); // refers to net, which must outlive it
     ElemNet(const ElemNet<A>&);	    // copyable
     ~ElemNet();
 
     string	    str() const;
     const char*	    type() const;
     const A&	    val() const;
+    Mod		    mod() const { return _mod; }
+    const U32Range& range() const { return _range; }
     static Mod	    str_to_mod(const char* p);
     static string   mod_to_str(Mod mod);
     BinOper&	    op() const;
@@ -520,11 +525,13 @@ public:
 #ifdef XORP_USE_USTL
     ElemNet& operator=(const ElemNet<A>& rhs) {
 	if (this != &rhs) {
-	    if (_net) {
+	    if (_free) {
 		delete _net;
 	    }
 	    _net = new A(*rhs._net);
+	    _free = true;
 	    _mod = rhs._mod;
+	    _range = rhs._range;
 	    _op = rhs._op;
 	}
 	return *this;
@@ -535,7 +542,9 @@ private:
 #endif
 
     const A*		_net;
+    bool		_free;
     Mod			_mod;
+    U32Range		_range;
     mutable BinOper*	_op;
 };
 
@@ -145,19 +145,50 @@ count_nl(const char* x)
     return nl;
 }
 
-bool
-regex(const string& str, const string& reg)
+namespace {
+
+/**
+ * Compiled regular expressions, by pattern.
+ *
+ * Filters match every route against the same few patterns, so compiling
+ * them each time would cost more than matching.  The cache is flushed if it
+ * ever gets big.
+ */
+class RegexCache {
+public:
+    ~RegexCache() { clear(); }
+
+    const regex_t& get(const string& reg);
+
+private:
+    static const size_t MAX_SIZE = 256;
+
+    typedef map<string, regex_t*> Map;
+
+    void clear();
+
+    Map _map;
+};
+
+const regex_t&
+RegexCache::get(const string& reg)
 {
+    Map::iterator i = _map.find(reg);
+
+    if (i != _map.end())
+	return *i->second;
+
     // compile the regex
-    regex_t re;
-    int res = regcomp(&re, reg.c_str(), REG_EXTENDED);
+    regex_t* re = new regex_t;
+    int res = regcomp(re, reg.c_str(), REG_EXTENDED);
 
     if (res) {
 	char tmp[128];
 	string err;
 
-	regerror(res, &re, tmp, sizeof(tmp));
-	regfree(&re);
+	regerror(res, re, tmp, sizeof(tmp));
+	regfree(re);
+	delete re;
 
 	err = "Unable to compile regex (" + reg;
 	err += "): ";
@@ -166,11 +197,36 @@ regex(const string& str, const string& reg)
 	xorp_throw(PolicyUtilsErr, err);
     }
 
-    // execute the regex [XXX: check for errors!!]
-    bool result = !regexec(&re, str.c_str(), 0, 0, 0);
-    regfree(&re);
+    if (_map.size() >= MAX_SIZE)
+	clear();
+
+    _map[reg] = re;
+
+    return *re;
+}
+
+void
+RegexCache::clear()
+{
+    for (Map::iterator i = _map.begin(); i != _map.end(); ++i) {
+	regfree(i->second);
+	delete i->second;
+    }
+
+    _map.clear();
+}
 
-    return result;
+RegexCache _regex_cache;
+
+} // anonymous namespace
+
+bool
+regex(const string& str, const string& reg)
+{
+    const regex_t& re = _regex_cache.get(reg);
+
+    // execute the regex [XXX: check for errors!!]
+    return !regexec(&re, str.c_str(), 0, 0, 0);
 }
 
 } // namespace
@@ -0,0 +1,266 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+// vim:set sts=4 ts=8:
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+#include "libxorp/xorp.h"
+#include "prefix_set.hh"
+
+
+template <class N>
+PrefixSet<N>::PrefixSet(const Set& s) : _root(-1), _not(0)
+{
+    for (typename Set::const_iterator i = s.begin(); i != s.end(); ++i) {
+	const Elem& e = *i;
+
+	if (e.mod() == Elem::MOD_NOT)
+	    _not++;
+
+	_root = insert(_root, e);
+    }
+
+    if (_root >= 0)
+	aggregate(_root);
+}
+
+namespace {
+
+template <class A>
+int
+net_bit(const IPNet<A>& net, uint32_t pos)
+{
+    A b = A::make_prefix(pos + 1) ^ A::make_prefix(pos);
+
+    return (net.masked_addr() & b) != A::ZERO();
+}
+
+} // anonymous namespace
+
+template <class N>
+int
+PrefixSet<N>::bit(const N& net, uint32_t pos)
+{
+    return net_bit(net, pos);
+}
+
+template <class N>
+int32_t
+PrefixSet<N>::add_node(const N& net)
+{
+    _nodes.push_back(Node(net));
+
+    return _nodes.size() - 1;
+}
+
+template <class N>
+int32_t
+PrefixSet<N>::insert(int32_t node, const Elem& e)
+{
+    const N& net = e.val();
+
+    if (node < 0) {
+	node = add_node(net);
+    } else if (_nodes[node]._net == net) {
+	// glue node becomes an element
+    } else if (_nodes[node]._net.contains(net)) {
+	uint32_t pos = _nodes[node]._net.prefix_len();
+	int b = bit(net, pos);
+	int32_t child = insert(_nodes[node]._child[b], e);
+
+	_nodes[node]._child[b] = child;
+
+	return node;
+    } else if (net.contains(_nodes[node]._net)) {
+	int32_t n = add_node(net);
+
+	_nodes[n]._child[bit(_nodes[node]._net, net.prefix_len())] = node;
+	node = n;
+    } else {
+	N glue = N::common_subnet(_nodes[node]._net, net);
+	int32_t g = add_node(glue);
+	int32_t n = add_node(net);
+
+	_nodes[g]._child[bit(_nodes[node]._net, glue.prefix_len())] = node;
+	_nodes[g]._child[bit(net, glue.prefix_len())] = n;
+	set_elem(n, e);
+
+	return g;
+    }
+
+    set_elem(node, e);
+
+    return node;
+}
+
+template <class N>
+void
+PrefixSet<N>::set_elem(int32_t node, const Elem& e)
+{
+    // further elements on a network are chained off its trie node
+    if (_nodes[node]._elem) {
+	int32_t next = add_node(e.val());
+
+	_nodes[next]._next = _nodes[node]._next;
+	_nodes[node]._next = next;
+	node = next;
+    }
+
+    Node& n = _nodes[node];
+
+    n._elem = true;
+    n._mod = e.mod();
+    n._range = e.range();
+}
+
+template <class N>
+uint32_t
+PrefixSet<N>::aggregate(int32_t node)
+{
+    uint32_t below = 0;
+
+    for (int i = 0; i < 2; i++) {
+	int32_t child = _nodes[node]._child[i];
+
+	if (child >= 0)
+	    below |= aggregate(child);
+    }
+
+    for (int32_t e = node; e >= 0; e = _nodes[e]._next) {
+	if (_nodes[e]._elem)
+	    below |= mask(_nodes[e]._mod);
+    }
+
+    _nodes[node]._below = below;
+
+    return below;
+}
+
+//
+// Match an element which contains (or is equal to) net.
+//
+template <class N>
+bool
+PrefixSet<N>::match_node(const Node& node, const N& net) const
+{
+    uint32_t len = net.prefix_len();
+
+    switch (node._mod) {
+    case Elem::MOD_NONE:
+    case Elem::MOD_EXACT:
+    case Elem::MOD_ORSHORTER:
+	return node._net == net;
+
+    case Elem::MOD_ORLONGER:
+	return true;
+
+    case Elem::MOD_LONGER:
+	return node._net.prefix_len() < len;
+
+    case Elem::MOD_RANGE:
+	return node._range.low() <= len && len <= node._range.high();
+
+    case Elem::MOD_SHORTER:
+    case Elem::MOD_NOT:
+	return false;
+    }
+
+    return false;
+}
+
+//
+// Match any of the elements on the network of node.
+//
+template <class N>
+bool
+PrefixSet<N>::match_elems(int32_t node, const N& net) const
+{
+    for (int32_t e = node; e >= 0; e = _nodes[e]._next) {
+	if (_nodes[e]._elem && match_node(_nodes[e], net))
+	    return true;
+    }
+
+    return false;
+}
+
+template <class N>
+bool
+PrefixSet<N>::match(const N& net) const
+{
+    const uint32_t below = mask(Elem::MOD_SHORTER) | mask(Elem::MOD_ORSHORTER);
+    int32_t i = _root;
+
+    while (i >= 0) {
+	const Node& node = _nodes[i];
+
+	// a subtree which is strictly below net
+	if (!node._net.contains(net)) {
+	    if (net.contains(node._net) && (node._below & below))
+		return true;
+	    break;
+	}
+
+	if (match_elems(i, net))
+	    return true;
+
+	if (node._net == net) {
+	    // elements strictly below net
+	    for (int c = 0; c < 2; c++) {
+		int32_t child = node._child[c];
+
+		if (child >= 0 && (_nodes[child]._below & below))
+		    return true;
+	    }
+	    break;
+	}
+
+	i = node._child[bit(net, node._net.prefix_len())];
+    }
+
+    if (!_not)
+	return false;
+
+    // != matches unless net is the only such element
+    if (_not > 1)
+	return true;
+
+    i = _root;
+    while (i >= 0) {
+	const Node& node = _nodes[i];
+
+	if (!node._net.contains(net))
+	    break;
+
+	if (node._net == net) {
+	    for (int32_t e = i; e >= 0; e = _nodes[e]._next) {
+		if (_nodes[e]._elem && _nodes[e]._mod == Elem::MOD_NOT)
+		    return false;
+	    }
+	    return true;
+	}
+
+	i = node._child[bit(net, node._net.prefix_len())];
+    }
+
+    return true;
+}
+
+// instantiate
+template class PrefixSet<IPv4Net>;
+template class PrefixSet<IPv6Net>;
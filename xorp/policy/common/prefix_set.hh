@@ -0,0 +1,96 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+// vim:set sts=4 ts=8:
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+#ifndef __POLICY_COMMON_PREFIX_SET_HH__
+#define __POLICY_COMMON_PREFIX_SET_HH__
+
+#include "elem_set.hh"
+
+/**
+ * @short Index of a network set for matching routes against it.
+ *
+ * The networks of the set are held in a path compressed binary trie.  Every
+ * node remembers which modifiers are used in its subtree, so a route is
+ * matched by walking down to it and, at most, looking once below it.  A
+ * match costs O(prefix length) whatever the size of the set.
+ *
+ * The answer is the same as matching the route against each element of the
+ * set in turn, with the element's modifier.
+ */
+template <class N>
+class PrefixSet : public ElemSetIndex {
+public:
+    typedef ElemNet<N>			Elem;
+    typedef ElemSetAny<Elem>		Set;
+
+    /**
+     * @param s the set to build the index from.
+     */
+    PrefixSet(const Set& s);
+
+    /**
+     * @return true if the network matches any element of the set.
+     * @param net the network to match.
+     */
+    bool match(const N& net) const;
+
+    /**
+     * @return number of nodes in the trie, including glue nodes.
+     */
+    size_t nodes() const { return _nodes.size(); }
+
+private:
+    typedef typename Elem::Mod Mod;
+
+    // bits used in Node::_below
+    static uint32_t mask(Mod mod) { return 1 << mod; }
+
+    struct Node {
+	Node(const N& net) : _net(net), _elem(false), _mod(Elem::MOD_NONE),
+			     _below(0), _next(-1)
+			     { _child[0] = _child[1] = -1; }
+
+	N		_net;
+	bool		_elem;		// false for glue nodes
+	Mod		_mod;
+	U32Range	_range;
+	uint32_t	_below;		// modifiers used in this subtree
+	int32_t		_child[2];
+	int32_t		_next;		// next element on the same network
+    };
+
+    static int	bit(const N& net, uint32_t pos);
+    int32_t	insert(int32_t node, const Elem& e);
+    int32_t	add_node(const N& net);
+    void	set_elem(int32_t node, const Elem& e);
+    uint32_t	aggregate(int32_t node);
+    bool	match_node(const Node& node, const N& net) const;
+    bool	match_elems(int32_t node, const N& net) const;
+
+    vector<Node>	_nodes;
+    int32_t		_root;
+    uint32_t		_not;		// elements with the != modifier
+};
+
+typedef PrefixSet<IPv4Net> PrefixSetIPv4;
+typedef PrefixSet<IPv6Net> PrefixSetIPv6;
+
+#endif // __POLICY_COMMON_PREFIX_SET_HH__
@@ -25,6 +25,7 @@
 #include "dispatcher.hh"
 #include "element.hh"
 #include "elem_set.hh"
+#include "prefix_set.hh"
 #include "elem_null.hh"
 #include "elem_bgp.hh"
 #include "operator.hh"
@@ -34,11 +35,28 @@
 
 namespace operations {
 
+// We'd like partial template specialization for functions, but it's not
+// standard.  We special case when a bool is returned and optimize returning
+// true / false.  We return one of these global objects rather than creating a
+// new one each time.
+ElemBool _true(true);
+ElemBool _false(false);
+
+Element*
+return_bool(bool x)
+{
+    Element* r = x ? &_true : &_false;
+
+    XLOG_ASSERT(r->refcount() > 1);
+
+    return r;
+}
+
 // Unary operations
 Element* 
 op_not(const ElemBool& x)
 {
-    return new ElemBool(!x.val());
+    return return_bool(!x.val());
 }
 
 Element* 
@@ -65,23 +83,6 @@ Element* name(const Left& x, const Right& y) \
     return new Result(x.val() op y.val()); \
 }
 
-// We'd like partial template specialization for functions, but it's not
-// standard.  We special case when a bool is returned and optimize returning
-// true / false.  We return one of these global objects rather than creating a
-// new one each time.
-ElemBool _true(true);
-ElemBool _false(false);
-
-Element*
-return_bool(bool x)
-{
-    Element* r = x ? &_true : &_false;
-
-    XLOG_ASSERT(r->refcount() > 1);
-
-    return r;
-}
-
 #define DEFINE_BINOP_BOOL(name, op) \
 template<class Unused, class Left, class Right> \
 Element* name(const Left& x, const Right& y) \
@@ -116,10 +117,10 @@ DEFINE_BINOP(op_bit_xor,^);
 // Operations for which .val() is not needed. [operation performed on element
 // itself].
 #define DEFINE_BINOP_NOVAL(name,op) \
-template <class Result, class Left, class Right> \
+template <class Unused, class Left, class Right> \
 Element* \
 name(const Left& x, const Right& y) { \
-    return new Result(x op y); \
+    return return_bool(x op y); \
 }
 
 DEFINE_BINOP_NOVAL(op_eq_nv,==)
@@ -137,11 +138,11 @@ DEFINE_BINOP_NOVAL(op_ge_nv,>=)
 // not want that... so we switch the parameters and obtain
 // Set::operator>(Element)
 #define DEFINE_BINOP_SWITCHPARAMS(name,op) \
-template <class Result, class Left, class Right> \
+template <class Unused, class Left, class Right> \
 Element* \
 name(const Left& x, const Right& y) \
 { \
-    return new Result(y op x); \
+    return return_bool(y op x); \
 }
 
 DEFINE_BINOP_SWITCHPARAMS(op_eq_sw,==)
@@ -227,7 +228,7 @@ template <class T>
 Element* 
 set_ne_int(const ElemSetAny<T>& l, const ElemSetAny<T>& r)
 {
-    return new ElemBool(l.nonempty_intersection(r));
+    return return_bool(l.nonempty_intersection(r));
 }
 
 Element* 
@@ -273,7 +274,7 @@ ctr(const ElemStr& type, const T& arg)
 Element*
 str_regex(const ElemStr& left, const ElemStr& right)
 {
-    return new ElemBool(policy_utils::regex(left.val(), right.val()));
+    return return_bool(policy_utils::regex(left.val(), right.val()));
 }
 
 Element*
@@ -287,10 +288,10 @@ str_setregex(const ElemStr& left, const ElemSetStr& right)
 	const ElemStr& re = *i;
 
 	if (policy_utils::regex(str, re.val()))
-	    return new ElemBool(true);
+	    return return_bool(true);
     }
 
-    return new ElemBool(false);
+    return return_bool(false);
 }
 
 Element*
@@ -324,13 +325,14 @@ aspath_expand(const ElemU32& left, const ElemASPath& right)
 Element*
 aspath_contains(const ElemASPath& left, const ElemU32& right)
 {
-    return new ElemBool(left.val().contains(AsNum(right.val())));
+    return return_bool(left.val().contains(AsNum(right.val())));
 }
 
 Element*
 aspath_regex(const ElemASPath& left, const ElemStr& right)
 {
-    return new ElemBool(policy_utils::regex(left.val().short_str(), right.val()));
+    return return_bool(policy_utils::regex(left.val().short_str(),
+				   right.val()));
 }
 
 Element*
@@ -344,10 +346,10 @@ aspath_regex(const ElemASPath& left, const ElemSetStr& right)
 	const ElemStr& re = *i;
 
 	if (policy_utils::regex(str, re.val()))
-	    return new ElemBool(true);
+	    return return_bool(true);
     }
 
-    return new ElemBool(false);
+    return return_bool(false);
 }
 
 template<class A>
@@ -359,8 +361,14 @@ net_match(const ElemNet<A>& left, const ElemNet<A>& right)
 
     r = d.run(right.op(), left, right);
 
-    if (r == &_true)
+    if (r == &_true) {
+	if (right.mod() == ElemNet<A>::MOD_RANGE) {
+	    uint32_t len = left.val().prefix_len();
+
+	    return right.range().low() <= len && len <= right.range().high();
+	}
 	return true;
+    }
     else if (r == &_false)
 	return false;
     else
@@ -371,6 +379,12 @@ template<class A>
 Element*
 net_set_match(const ElemNet<A>& left, const ElemSetAny<ElemNet<A> >& right)
 {
+    // sets handed out by the SetManager carry a trie
+    const PrefixSet<A>* index = static_cast<const PrefixSet<A>*>(right.index());
+
+    if (index)
+	return return_bool(index->match(left.val()));
+
     bool ret = false;
 
     for (typename ElemSetAny<ElemNet<A> >::const_iterator i = right.begin();
@@ -246,7 +246,8 @@ benchmark_run(void)
 
     read_file(_conf.c_policy_file, policy);
     filter.configure(policy);
-    filter.set_profiler_exec(&_conf.c_exec);
+    if (_conf.c_profiler)
+	filter.set_profiler_exec(&_conf.c_exec);
 
     varrws = new VarRW* [iters];
     for (unsigned i = 0; i < iters; i++)
@@ -0,0 +1,237 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+// vim:set sts=4 ts=8:
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+#include "policy/policy_module.h"
+#include "libxorp/xorp.h"
+#include "libxorp/xlog.h"
+#include "libxorp/test_main.hh"
+#include "policy/backend/element_arena.hh"
+
+
+/**
+ * An element that counts its destructions.
+ */
+class CountedElem : public Element {
+public:
+    CountedElem(int* count) : Element(ElemNull::_hash), _count(count) {}
+    ~CountedElem() { (*_count)++; }
+
+    string str() const		{ return "counted"; }
+    string dbgstr() const	{ return "counted"; }
+    const char* type() const	{ return ElemNull::id; }
+
+private:
+    int*	_count;
+};
+
+/*
+ * Scalars are placed one after the other, and a reset hands the same
+ * memory out again.
+ */
+bool
+test_trivial(TestInfo& info)
+{
+    ElementArena arena;
+
+    ElemU32* first = arena.create<ElemU32>(1);
+    for (uint32_t i = 2; i <= 10; i++) {
+	ElemU32* e = arena.create<ElemU32>(i);
+	if (!arena.owns(e) || e->val() != i) {
+	    DOUT(info) << "element " << i << " not in the arena\n";
+	    return false;
+	}
+    }
+
+    arena.reset();
+    ElemU32* again = arena.create<ElemU32>(11);
+    if (again != first || again->val() != 11) {
+	DOUT(info) << "memory not reused after reset\n";
+	return false;
+    }
+
+    return true;
+}
+
+/*
+ * Elements that own memory have their destructor run by reset(), and
+ * once the destructor list is full the rest go to the heap.
+ */
+bool
+test_destructors(TestInfo& info)
+{
+    ElementArena arena;
+    int count = 0;
+
+    for (int i = 0; i < 5; i++)
+	arena.create<CountedElem>(&count);
+    arena.reset();
+    if (count != 5) {
+	DOUT(info) << count << " destructors run, expected 5\n";
+	return false;
+    }
+
+    count = 0;
+    vector<CountedElem*> heap;
+    int kept = 0;
+    for (int i = 0; i < 64; i++) {
+	CountedElem* e = arena.create<CountedElem>(&count);
+	if (arena.owns(e))
+	    kept++;
+	else
+	    heap.push_back(e);
+    }
+    if (kept == 0 || heap.empty()) {
+	DOUT(info) << kept << " in the arena, " << heap.size()
+		   << " on the heap\n";
+	return false;
+    }
+
+    arena.reset();
+    if (count != kept) {
+	DOUT(info) << count << " destructors run, expected " << kept << endl;
+	return false;
+    }
+    for (vector<CountedElem*>::iterator i = heap.begin(); i != heap.end(); ++i)
+	delete *i;
+
+    return true;
+}
+
+/*
+ * Once the buffer is exhausted create() falls back to the heap.
+ */
+bool
+test_overflow(TestInfo& info)
+{
+    ElementArena arena;
+    ElemU32* e;
+    int kept = 0;
+
+    for (;;) {
+	e = arena.create<ElemU32>(kept);
+	if (!arena.owns(e))
+	    break;
+	kept++;
+    }
+    if (kept == 0 || e->val() != static_cast<uint32_t>(kept)) {
+	DOUT(info) << "no heap element after " << kept << endl;
+	return false;
+    }
+    delete e;
+
+    arena.reset();
+    e = arena.create<ElemU32>(0);
+    if (!arena.owns(e)) {
+	DOUT(info) << "arena still full after reset\n";
+	return false;
+    }
+
+    return true;
+}
+
+/*
+ * A network referred to by the arena is neither copied nor freed; one
+ * built from a value is a copy the arena frees.
+ */
+bool
+test_network(TestInfo& info)
+{
+    ElementArena arena;
+    IPv4Net net("10.0.0.0/8");
+
+    ElemIPv4Net* ref = arena.create<ElemIPv4Net>(&net);
+    if (&ref->val() != &net) {
+	DOUT(info) << "network copied\n";
+	return false;
+    }
+
+    ElemIPv4Net* own = arena.create<ElemIPv4Net>(net);
+    if (&own->val() == &net || own->val() != net) {
+	DOUT(info) << "network not copied\n";
+	return false;
+    }
+
+    ElemIPv4Net copy(*ref);
+    if (&copy.val() == &net || copy.val() != net) {
+	DOUT(info) << "copy refers to the network\n";
+	return false;
+    }
+
+    // Freeing net here would corrupt the stack.
+    arena.reset();
+    if (net != IPv4Net("10.0.0.0/8")) {
+	DOUT(info) << "network changed by reset\n";
+	return false;
+    }
+
+    return true;
+}
+
+int
+main(int argc, char** argv)
+{
+    XorpUnexpectedHandler x(xorp_unexpected_handler);
+
+    xlog_init(argv[0], NULL);
+    xlog_set_verbose(XLOG_VERBOSE_HIGH);
+    xlog_add_default_output();
+    xlog_start();
+
+    TestMain t(argc, argv);
+
+    string test_name =
+	t.get_optional_args("-t", "--test", "run only the specified test");
+    t.complete_args_parsing();
+
+    try {
+	struct test {
+	    string test_name;
+	    XorpCallback1<bool, TestInfo&>::RefPtr cb;
+	} tests[] = {
+	    {"trivial", callback(test_trivial)},
+	    {"destructors", callback(test_destructors)},
+	    {"overflow", callback(test_overflow)},
+	    {"network", callback(test_network)},
+	};
+
+	if ("" == test_name) {
+	    for (unsigned int i = 0; i < sizeof(tests) / sizeof(struct test);
+		 i++)
+		t.run(tests[i].test_name, tests[i].cb);
+	} else {
+	    for (unsigned int i = 0; i < sizeof(tests) / sizeof(struct test);
+		 i++)
+		if (test_name == tests[i].test_name) {
+		    t.run(tests[i].test_name, tests[i].cb);
+		    return t.exit();
+		}
+	    t.failed("No test with name " + test_name + " found\n");
+	}
+    } catch (...) {
+	xorp_catch_standard_exceptions();
+    }
+
+    xlog_stop();
+    xlog_exit();
+
+    return t.exit();
+}
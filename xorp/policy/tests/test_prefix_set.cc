@@ -0,0 +1,336 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+// vim:set sts=4 ts=8:
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+#include "policy/policy_module.h"
+#include "libxorp/xorp.h"
+#include "libxorp/xlog.h"
+#include "libxorp/random.h"
+#include "libxorp/test_main.hh"
+#include "policy/common/dispatcher.hh"
+#include "policy/common/operator.hh"
+#include "policy/common/prefix_set.hh"
+
+
+/*
+ * A random network of prefix_len bits.  Half the time it is carved out of
+ * near, so that it falls inside, or just outside, networks of the set.
+ */
+template <class A>
+static IPNet<A>
+random_net(uint32_t prefix_len, const IPNet<A>* near)
+{
+    uint8_t addr[A::ADDR_BYTELEN];
+
+    for (size_t i = 0; i < sizeof(addr); i++)
+	addr[i] = xorp_random() & 0xff;
+
+    A a;
+    a.copy_in(addr);
+
+    if (near != NULL && (xorp_random() & 1)) {
+	uint32_t keep = min(static_cast<uint32_t>(near->prefix_len()),
+			    static_cast<uint32_t>(xorp_random()
+						  % (A::ADDR_BITLEN + 1)));
+	A mask = A::make_prefix(keep);
+	a = (near->masked_addr() & mask) | (a & ~mask);
+    }
+
+    return IPNet<A>(a, prefix_len);
+}
+
+/*
+ * Match routes against the set one element at a time, and through a
+ * PrefixSet, and check that both agree.
+ *
+ * @param mods the modifiers the elements of the set are given, in turn.
+ */
+template <class A>
+static bool
+check_prefix_set(TestInfo& info, const vector<string>& mods, size_t elems,
+		 size_t routes)
+{
+    typedef ElemNet<IPNet<A> >		Elem;
+    typedef ElemSetAny<Elem>		Set;
+
+    Set set;
+    vector<IPNet<A> > nets;
+    for (size_t i = 0; i < elems; i++) {
+	const IPNet<A>* near = nets.empty() ? NULL
+	    : &nets[xorp_random() % nets.size()];
+	uint32_t len = xorp_random() % (A::ADDR_BITLEN + 1);
+	IPNet<A> net = random_net<A>(len, near);
+
+	string mod = mods[i % mods.size()];
+	if (mod == "range") {
+	    uint32_t low = len + xorp_random() % (A::ADDR_BITLEN - len + 1);
+	    uint32_t high = low + xorp_random() % (A::ADDR_BITLEN - low + 1);
+	    mod = c_format("%u..%u", low, high);
+	}
+
+	nets.push_back(net);
+	set.insert(Elem((net.str() + "~" + mod).c_str()));
+    }
+
+    Set indexed(set);
+    ref_ptr<const ElemSetIndex> index = new PrefixSet<IPNet<A> >(indexed);
+    indexed.set_index(index);
+
+    Dispatcher d;
+    OpLe op;
+    for (size_t i = 0; i < routes; i++) {
+	const IPNet<A>& near = nets[xorp_random() % nets.size()];
+	int32_t len = near.prefix_len() + xorp_random() % 9 - 4;
+	if (xorp_random() % 4 == 0)
+	    len = xorp_random() % (A::ADDR_BITLEN + 1);
+	len = max(0, min(len, static_cast<int32_t>(A::ADDR_BITLEN)));
+	Elem route(random_net<A>(len, &near));
+
+	bool want = static_cast<ElemBool*>(d.run(op, route, set))->val();
+	bool got = static_cast<ElemBool*>(d.run(op, route, indexed))->val();
+	if (got != want) {
+	    DOUT(info) << route.str() << (want ? " matches" : " misses")
+		       << " the set but not the index\n";
+	    return false;
+	}
+    }
+
+    return true;
+}
+
+bool
+test_exact(TestInfo& info)
+{
+    vector<string> mods(1, "exact");
+
+    return check_prefix_set<IPv4>(info, mods, 200, 20000)
+	&& check_prefix_set<IPv6>(info, mods, 200, 20000);
+}
+
+bool
+test_orlonger(TestInfo& info)
+{
+    vector<string> mods(1, "orlonger");
+
+    return check_prefix_set<IPv4>(info, mods, 200, 20000)
+	&& check_prefix_set<IPv6>(info, mods, 200, 20000);
+}
+
+bool
+test_longer(TestInfo& info)
+{
+    vector<string> mods(1, "longer");
+
+    return check_prefix_set<IPv4>(info, mods, 200, 20000)
+	&& check_prefix_set<IPv6>(info, mods, 200, 20000);
+}
+
+bool
+test_range(TestInfo& info)
+{
+    vector<string> mods(1, "range");
+
+    return check_prefix_set<IPv4>(info, mods, 200, 20000)
+	&& check_prefix_set<IPv6>(info, mods, 200, 20000);
+}
+
+bool
+test_mixed(TestInfo& info)
+{
+    vector<string> mods;
+    mods.push_back("exact");
+    mods.push_back("orlonger");
+    mods.push_back("longer");
+    mods.push_back("range");
+    mods.push_back("shorter");
+    mods.push_back("orshorter");
+    mods.push_back("not");
+
+    // Small sets too, where networks and modifiers nest more often.
+    for (size_t elems = 1; elems <= 16; elems++) {
+	if (!check_prefix_set<IPv4>(info, mods, elems, 2000)
+	    || !check_prefix_set<IPv6>(info, mods, elems, 2000))
+	    return false;
+    }
+
+    return check_prefix_set<IPv4>(info, mods, 500, 20000)
+	&& check_prefix_set<IPv6>(info, mods, 500, 20000);
+}
+
+/*
+ * Match routes against a set which holds several elements on one network,
+ * both one element at a time and through a PrefixSet.
+ *
+ * @param elems the elements of the set.
+ * @param routes each route, followed by whether it matches the set.
+ */
+template <class A>
+static bool
+check_same_net(TestInfo& info, const char* const elems[], size_t nelems,
+	       const char* const routes[], size_t nroutes)
+{
+    typedef ElemNet<IPNet<A> >		Elem;
+    typedef ElemSetAny<Elem>		Set;
+
+    Set set;
+    for (size_t i = 0; i < nelems; i++)
+	set.insert(Elem(elems[i]));
+
+    size_t held = distance(set.begin(), set.end());
+    if (held != nelems) {
+	DOUT(info) << "the set holds " << held << " of "
+		   << nelems << " elements: " << set.str() << "\n";
+	return false;
+    }
+
+    Set indexed(set);
+    ref_ptr<const ElemSetIndex> index = new PrefixSet<IPNet<A> >(indexed);
+    indexed.set_index(index);
+
+    Dispatcher d;
+    OpLe op;
+    for (size_t i = 0; i + 1 < nroutes; i += 2) {
+	Elem route(routes[i]);
+	bool want = string(routes[i + 1]) == "match";
+
+	bool linear = static_cast<ElemBool*>(d.run(op, route, set))->val();
+	bool got = static_cast<ElemBool*>(d.run(op, route, indexed))->val();
+	if (linear != want || got != want) {
+	    DOUT(info) << route.str() << (want ? " matches" : " misses")
+		       << " " << set.str() << " but the set"
+		       << (linear ? " matches" : " misses")
+		       << " and the index" << (got ? " matches" : " misses")
+		       << "\n";
+	    return false;
+	}
+    }
+
+    return true;
+}
+
+bool
+test_same_net(TestInfo& info)
+{
+    const char* const elems4[] = {
+	"10.0.0.0/8~16..24",
+	"10.0.0.0/8~25..28",
+	"10.0.0.0/8~exact",
+    };
+    const char* const routes4[] = {
+	"10.1.0.0/16",		"match",
+	"10.1.2.0/24",		"match",
+	"10.1.2.0/26",		"match",
+	"10.1.2.16/28",		"match",
+	"10.0.0.0/8",		"match",
+	"10.0.0.0/12",		"miss",
+	"10.1.2.0/29",		"miss",
+	"10.1.2.3/32",		"miss",
+	"172.16.0.0/12",	"miss",
+    };
+    // != matches all but its own network, unless another element does
+    const char* const elems_not[] = {
+	"192.168.0.0/16~not",
+	"192.168.0.0/16~longer",
+    };
+    const char* const routes_not[] = {
+	"192.168.1.0/24",	"match",
+	"172.16.0.0/12",	"match",
+	"192.168.0.0/16",	"miss",
+    };
+    const char* const elems6[] = {
+	"2001:db8::/32~40..48",
+	"2001:db8::/32~56..64",
+	"2001:db8::/32~orshorter",
+    };
+    const char* const routes6[] = {
+	"2001:db8:100::/40",	"match",
+	"2001:db8:1::/48",	"match",
+	"2001:db8:1:100::/56",	"match",
+	"2001:db8:1:1::/64",	"match",
+	"2001:db8::/32",	"match",
+	"2001::/16",		"match",
+	"2001:db8:1:100::/52",	"miss",
+	"2001:db8:1:1::/80",	"miss",
+    };
+
+    return check_same_net<IPv4>(info, elems4, sizeof(elems4) / sizeof(*elems4),
+				routes4, sizeof(routes4) / sizeof(*routes4))
+	&& check_same_net<IPv4>(info, elems_not,
+				sizeof(elems_not) / sizeof(*elems_not),
+				routes_not,
+				sizeof(routes_not) / sizeof(*routes_not))
+	&& check_same_net<IPv6>(info, elems6, sizeof(elems6) / sizeof(*elems6),
+				routes6, sizeof(routes6) / sizeof(*routes6));
+}
+
+int
+main(int argc, char** argv)
+{
+    XorpUnexpectedHandler x(xorp_unexpected_handler);
+
+    xlog_init(argv[0], NULL);
+    xlog_set_verbose(XLOG_VERBOSE_HIGH);
+    xlog_add_default_output();
+    xlog_start();
+
+    TestMain t(argc, argv);
+
+    string test_name =
+	t.get_optional_args("-t", "--test", "run only the specified test");
+    t.complete_args_parsing();
+
+    xorp_srandom(1);
+
+    try {
+	struct test {
+	    string test_name;
+	    XorpCallback1<bool, TestInfo&>::RefPtr cb;
+	} tests[] = {
+	    {"exact", callback(test_exact)},
+	    {"orlonger", callback(test_orlonger)},
+	    {"longer", callback(test_longer)},
+	    {"range", callback(test_range)},
+	    {"mixed", callback(test_mixed)},
+	    {"same_net", callback(test_same_net)},
+	};
+
+	if ("" == test_name) {
+	    for (unsigned int i = 0; i < sizeof(tests) / sizeof(struct test);
+		 i++)
+		t.run(tests[i].test_name, tests[i].cb);
+	} else {
+	    for (unsigned int i = 0; i < sizeof(tests) / sizeof(struct test);
+		 i++)
+		if (test_name == tests[i].test_name) {
+		    t.run(tests[i].test_name, tests[i].cb);
+		    return t.exit();
+		}
+	    t.failed("No test with name " + test_name + " found\n");
+	}
+    } catch (...) {
+	xorp_catch_standard_exceptions();
+    }
+
+    xlog_stop();
+    xlog_exit();
+
+    return t.exit();
+}
@@ -564,9 +564,11 @@ RedistXrlOutput<A>::start_next_task()
 	RedistXrlTask<A>* t = _taskq.front();
 	if (t->dispatch(_xrl_router, _profile) == false) {
 	    // Dispatch of task failed.  XrlRouter is presumeably
-	    // backlogged.
-	    XLOG_WARNING("Dispatch failed, %d XRLs inflight", _inflight);
+	    // backlogged.  With XRLs in flight that is only back
+	    // pressure, and the task is retried as they complete.
+	    debug_msg("Dispatch failed, %d XRLs inflight\n", _inflight);
 	    if (_inflight == 0) {
+		XLOG_WARNING("Dispatch failed, no XRLs inflight");
 		// Insert a delay and dispatch that to cause later
 		// attempt at failing task.
 		// This should never happen under normal circumstances!
@@ -622,25 +624,28 @@ RedistXrlOutput<A>::task_failed_fatally(RedistXrlTask<A>* task)
 // RedistTransactionXrlOutput Commands
 
 template <typename A>
-class AddTransactionRoute : public AddRoute<A> {
+class UpdateTransactionRoutes : public RedistXrlTask<A> {
 public:
-    AddTransactionRoute(RedistTransactionXrlOutput<A>* parent,
-			const IPRouteEntry<A>& ipr)
-	: AddRoute<A>(parent, ipr) {
-	parent->incr_transaction_size();
-    }
-    virtual bool dispatch(XrlRouter& xrl_router, Profile& profile);
-};
-
-template <typename A>
-class DeleteTransactionRoute : public DeleteRoute<A> {
-public:
-    DeleteTransactionRoute(RedistTransactionXrlOutput<A>* parent,
-			   const IPRouteEntry<A>& ipr)
-	: DeleteRoute<A>(parent, ipr) {
-	parent->incr_transaction_size();
-    }
+    UpdateTransactionRoutes(RedistTransactionXrlOutput<A>* parent)
+	: RedistXrlTask<A>(parent) {}
+    void add_update(const IPRouteEntry<A>& ipr, bool add);
+    size_t updates() const			{ return _adds.size(); }
     virtual bool dispatch(XrlRouter& xrl_router, Profile& profile);
+    void dispatch_complete(const XrlError& xe);
+protected:
+    bool transaction_usable(XrlRouter& xrl_router);
+    void skip();
+
+    // Entry i of each list is the i'th update, as sent in update_routes
+    XrlAtomList	_adds;
+    XrlAtomList	_nets;
+    XrlAtomList	_nexthops;
+    XrlAtomList	_ifnames;
+    XrlAtomList	_vifnames;
+    XrlAtomList	_metrics;
+    XrlAtomList	_admin_distances;
+    XrlAtomList	_protocol_origins;
+    XorpTimer	_skip_timer;
 };
 
 template <typename A>
@@ -658,11 +663,14 @@ template <typename A>
 class CommitTransaction : public RedistXrlTask<A> {
 public:
     CommitTransaction(RedistTransactionXrlOutput<A>* parent)
-	: RedistXrlTask<A>(parent) {
+	: RedistXrlTask<A>(parent), _routes(parent->transaction_size()) {
 	parent->reset_transaction_size();
     }
     virtual bool dispatch(XrlRouter&  xrl_router, Profile& profile);
     void dispatch_complete(const XrlError& xe);
+private:
+    size_t	_routes;	// Routes in the transaction
+    TimeVal	_started;	// When the transaction was started
 };
 
 template <typename A>
@@ -678,154 +686,193 @@ public:
 
 
 // ----------------------------------------------------------------------------
-// AddTransactionRoute implementation
+// UpdateTransactionRoutes implementation
 
-template <>
-bool
-AddTransactionRoute<IPv4>::dispatch(XrlRouter& xrl_router, Profile& profile)
+template <typename A>
+void
+UpdateTransactionRoutes<A>::add_update(const IPRouteEntry<A>& ipr, bool add)
 {
-    RedistTransactionXrlOutput<IPv4>* p =
-	reinterpret_cast<RedistTransactionXrlOutput<IPv4>*>(this->parent());
-
-    if (p->transaction_in_error() || ! p->transaction_in_progress()) {
-	XLOG_ERROR("Transaction error: failed to redistribute "
-		   "route add for %s", _net.str().c_str());
-	this->signal_complete_ok();
-	return true;	// XXX: we return true to avoid retransmission
-    }
-
-#ifndef XORP_DISABLE_PROFILE
-    if (profile.enabled(profile_route_rpc_out))
-	profile.log(profile_route_rpc_out,
-		     c_format("add %s %s %s %u",
-			      p->xrl_target_name().c_str(),
-			      _net.str().c_str(),
-			      _nexthop.str().c_str(),
-			      XORP_UINT_CAST(_metric)));
-#else
-    UNUSED(profile);
-#endif
-
-    XrlRedistTransaction4V0p1Client cl(&xrl_router);
-    return cl.send_add_route(p->xrl_target_name().c_str(),
-			     p->tid(),
-			     _net, _nexthop, _ifname, _vifname, _metric,
-			     _admin_distance, p->cookie(),
-			     _protocol_origin,
-			     callback(static_cast<AddRoute<IPv4>*>(this),
-				      &AddRoute<IPv4>::dispatch_complete)
-	);
+    _adds.append(XrlAtom(add));
+    _nets.append(XrlAtom(ipr.net()));
+    _nexthops.append(XrlAtom(ipr.nexthop_addr()));
+    _ifnames.append(XrlAtom(ipr.vif()->ifname()));
+    _vifnames.append(XrlAtom(ipr.vif()->name()));
+    _metrics.append(XrlAtom(ipr.metric()));
+    _admin_distances.append(
+	XrlAtom(static_cast<uint32_t>(ipr.admin_distance())));
+    _protocol_origins.append(XrlAtom(ipr.protocol()->name()));
 }
 
-template <>
+template <typename A>
 bool
-AddTransactionRoute<IPv6>::dispatch(XrlRouter& xrl_router, Profile& profile)
+UpdateTransactionRoutes<A>::transaction_usable(XrlRouter& xrl_router)
 {
-    RedistTransactionXrlOutput<IPv6>* p =
-	reinterpret_cast<RedistTransactionXrlOutput<IPv6>*>(this->parent());
+    RedistTransactionXrlOutput<A>* p =
+	reinterpret_cast<RedistTransactionXrlOutput<A>*>(this->parent());
+
+    p->updates_dispatched(this);
 
     if (p->transaction_in_error() || ! p->transaction_in_progress()) {
 	XLOG_ERROR("Transaction error: failed to redistribute "
-		   "route add for %s", _net.str().c_str());
-	this->signal_complete_ok();
-	return true;	// XXX: we return true to avoid retransmission
+		   "%u route updates", XORP_UINT_CAST(updates()));
+	// Complete once this task has been accounted as in flight
+	_skip_timer = xrl_router.eventloop().new_oneoff_after_ms(
+	    0, callback(this, &UpdateTransactionRoutes<A>::skip));
+	return false;
     }
-
-#ifndef XORP_DISABLE_PROFILE
-    if (profile.enabled(profile_route_rpc_out))
-	profile.log(profile_route_rpc_out,
-		     c_format("add %s %s %s %u",
-			      p->xrl_target_name().c_str(),
-			      _net.str().c_str(),
-			      _nexthop.str().c_str(),
-			      XORP_UINT_CAST(_metric)));
-#else
-    UNUSED(profile);
-#endif
-
-    XrlRedistTransaction6V0p1Client cl(&xrl_router);
-    return cl.send_add_route(p->xrl_target_name().c_str(),
-			     p->tid(),
-			     _net, _nexthop, _ifname, _vifname, _metric,
-			     _admin_distance, p->cookie(),
-			     _protocol_origin,
-			     callback(static_cast<AddRoute<IPv6>*>(this),
-				      &AddRoute<IPv6>::dispatch_complete)
-	);
+    return true;
 }
 
-
-// ----------------------------------------------------------------------------
-// DeleteTransactionRoute implementation
+template <typename A>
+void
+UpdateTransactionRoutes<A>::skip()
+{
+    this->signal_complete_ok();
+}
 
 template <>
 bool
-DeleteTransactionRoute<IPv4>::dispatch(XrlRouter& xrl_router, Profile& profile)
+UpdateTransactionRoutes<IPv4>::dispatch(XrlRouter& xrl_router,
+					Profile& profile)
 {
     RedistTransactionXrlOutput<IPv4>* p =
 	reinterpret_cast<RedistTransactionXrlOutput<IPv4>*>(this->parent());
 
-    if (p->transaction_in_error() || ! p->transaction_in_progress()) {
-	XLOG_ERROR("Transaction error: failed to redistribute "
-		   "route delete for %s", _net.str().c_str());
-	this->signal_complete_ok();
+    if (! transaction_usable(xrl_router))
 	return true;	// XXX: we return true to avoid retransmission
-    }
 
 #ifndef XORP_DISABLE_PROFILE
-    if (profile.enabled(profile_route_rpc_out))
-	profile.log(profile_route_rpc_out,
-		     c_format("delete %s %s",
-			      p->xrl_target_name().c_str(),
-			      _net.str().c_str()));
+    if (profile.enabled(profile_route_rpc_out)) {
+	for (size_t i = 0; i < updates(); i++) {
+	    if (_adds.get(i).boolean()) {
+		profile.log(profile_route_rpc_out,
+			    c_format("add %s %s %s %u",
+				     p->xrl_target_name().c_str(),
+				     _nets.get(i).ipv4net().str().c_str(),
+				     _nexthops.get(i).ipv4().str().c_str(),
+				     XORP_UINT_CAST(_metrics.get(i).uint32())));
+	    } else {
+		profile.log(profile_route_rpc_out,
+			    c_format("delete %s %s",
+				     p->xrl_target_name().c_str(),
+				     _nets.get(i).ipv4net().str().c_str()));
+	    }
+	}
+    }
 #else
     UNUSED(profile);
 #endif
 
     XrlRedistTransaction4V0p1Client cl(&xrl_router);
-    return cl.send_delete_route(p->xrl_target_name().c_str(),
-				p->tid(),
-				_net, _nexthop, _ifname, _vifname, _metric,
-				_admin_distance, p->cookie(),
-				_protocol_origin,
-				callback(static_cast<DeleteRoute<IPv4>*>(this),
-					 &DeleteRoute<IPv4>::dispatch_complete)
-	);
+
+    if (updates() == 1) {
+	// A lone update goes in the XRL it always used
+	if (_adds.get(0).boolean()) {
+	    return cl.send_add_route(
+		p->xrl_target_name().c_str(), p->tid(),
+		_nets.get(0).ipv4net(), _nexthops.get(0).ipv4(),
+		_ifnames.get(0).text(), _vifnames.get(0).text(),
+		_metrics.get(0).uint32(), _admin_distances.get(0).uint32(),
+		p->cookie(), _protocol_origins.get(0).text(),
+		callback(this, &UpdateTransactionRoutes<IPv4>::dispatch_complete));
+	}
+	return cl.send_delete_route(
+	    p->xrl_target_name().c_str(), p->tid(),
+	    _nets.get(0).ipv4net(), _nexthops.get(0).ipv4(),
+	    _ifnames.get(0).text(), _vifnames.get(0).text(),
+	    _metrics.get(0).uint32(), _admin_distances.get(0).uint32(),
+	    p->cookie(), _protocol_origins.get(0).text(),
+	    callback(this, &UpdateTransactionRoutes<IPv4>::dispatch_complete));
+    }
+
+    return cl.send_update_routes(
+	p->xrl_target_name().c_str(), p->tid(),
+	_adds, _nets, _nexthops, _ifnames, _vifnames, _metrics,
+	_admin_distances, p->cookie(), _protocol_origins,
+	callback(this, &UpdateTransactionRoutes<IPv4>::dispatch_complete));
 }
 
 template <>
 bool
-DeleteTransactionRoute<IPv6>::dispatch(XrlRouter& xrl_router, Profile& profile)
+UpdateTransactionRoutes<IPv6>::dispatch(XrlRouter& xrl_router,
+					Profile& profile)
 {
     RedistTransactionXrlOutput<IPv6>* p =
 	reinterpret_cast<RedistTransactionXrlOutput<IPv6>*>(this->parent());
 
-    if (p->transaction_in_error() || ! p->transaction_in_progress()) {
-	XLOG_ERROR("Transaction error: failed to redistribute "
-		   "route delete for %s", _net.str().c_str());
-	this->signal_complete_ok();
+    if (! transaction_usable(xrl_router))
 	return true;	// XXX: we return true to avoid retransmission
-    }
 
 #ifndef XORP_DISABLE_PROFILE
-    if (profile.enabled(profile_route_rpc_out))
-	profile.log(profile_route_rpc_out,
-		     c_format("delete %s %s",
-			      p->xrl_target_name().c_str(),
-			      _net.str().c_str()));
+    if (profile.enabled(profile_route_rpc_out)) {
+	for (size_t i = 0; i < updates(); i++) {
+	    if (_adds.get(i).boolean()) {
+		profile.log(profile_route_rpc_out,
+			    c_format("add %s %s %s %u",
+				     p->xrl_target_name().c_str(),
+				     _nets.get(i).ipv6net().str().c_str(),
+				     _nexthops.get(i).ipv6().str().c_str(),
+				     XORP_UINT_CAST(_metrics.get(i).uint32())));
+	    } else {
+		profile.log(profile_route_rpc_out,
+			    c_format("delete %s %s",
+				     p->xrl_target_name().c_str(),
+				     _nets.get(i).ipv6net().str().c_str()));
+	    }
+	}
+    }
 #else
     UNUSED(profile);
 #endif
 
     XrlRedistTransaction6V0p1Client cl(&xrl_router);
-    return cl.send_delete_route(p->xrl_target_name().c_str(),
-				p->tid(),
-				_net, _nexthop, _ifname, _vifname, _metric,
-				_admin_distance, p->cookie(),
-				_protocol_origin,
-				callback(static_cast<DeleteRoute<IPv6>*>(this),
-					 &DeleteRoute<IPv6>::dispatch_complete)
-	);
+
+    if (updates() == 1) {
+	// A lone update goes in the XRL it always used
+	if (_adds.get(0).boolean()) {
+	    return cl.send_add_route(
+		p->xrl_target_name().c_str(), p->tid(),
+		_nets.get(0).ipv6net(), _nexthops.get(0).ipv6(),
+		_ifnames.get(0).text(), _vifnames.get(0).text(),
+		_metrics.get(0).uint32(), _admin_distances.get(0).uint32(),
+		p->cookie(), _protocol_origins.get(0).text(),
+		callback(this, &UpdateTransactionRoutes<IPv6>::dispatch_complete));
+	}
+	return cl.send_delete_route(
+	    p->xrl_target_name().c_str(), p->tid(),
+	    _nets.get(0).ipv6net(), _nexthops.get(0).ipv6(),
+	    _ifnames.get(0).text(), _vifnames.get(0).text(),
+	    _metrics.get(0).uint32(), _admin_distances.get(0).uint32(),
+	    p->cookie(), _protocol_origins.get(0).text(),
+	    callback(this, &UpdateTransactionRoutes<IPv6>::dispatch_complete));
+    }
+
+    return cl.send_update_routes(
+	p->xrl_target_name().c_str(), p->tid(),
+	_adds, _nets, _nexthops, _ifnames, _vifnames, _metrics,
+	_admin_distances, p->cookie(), _protocol_origins,
+	callback(this, &UpdateTransactionRoutes<IPv6>::dispatch_complete));
+}
+
+template <typename A>
+void
+UpdateTransactionRoutes<A>::dispatch_complete(const XrlError& xe)
+{
+    if (xe == XrlError::OKAY()) {
+	this->signal_complete_ok();
+	return;
+    } else if (xe == XrlError::COMMAND_FAILED()) {
+	XLOG_ERROR("Failed to redistribute %u route updates: %s",
+		   XORP_UINT_CAST(updates()),
+		   xe.str().c_str());
+	this->signal_complete_ok();
+	return;
+    }
+    // For now all errors are signalled fatal
+    XLOG_ERROR("Fatal error during route redistribution: %s",
+	       xe.str().c_str());
+
+    this->signal_fatal_failure();
 }
 
 
@@ -844,6 +891,10 @@ StartTransaction<IPv4>::dispatch(XrlRouter& xrl_router, Profile&)
     p->set_transaction_in_progress(true);
     p->set_transaction_in_error(false);
 
+    TimeVal now;
+    TimerList::system_gettimeofday(&now);
+    p->set_transaction_started(now);
+
     XrlRedistTransaction4V0p1Client cl(&xrl_router);
     return cl.send_start_transaction(
 	p->xrl_target_name().c_str(),
@@ -862,6 +913,10 @@ StartTransaction<IPv6>::dispatch(XrlRouter& xrl_router, Profile&)
     p->set_transaction_in_progress(true);
     p->set_transaction_in_error(false);
 
+    TimeVal now;
+    TimerList::system_gettimeofday(&now);
+    p->set_transaction_started(now);
+
     XrlRedistTransaction6V0p1Client cl(&xrl_router);
     return cl.send_start_transaction(
 	p->xrl_target_name().c_str(),
@@ -909,6 +964,7 @@ CommitTransaction<IPv4>::dispatch(XrlRouter& xrl_router, Profile&)
     p->set_tid(0);	// XXX: reset the tid
     p->set_transaction_in_progress(false);
     p->set_transaction_in_error(false);
+    _started = p->transaction_started();
 
     XrlRedistTransaction4V0p1Client cl(&xrl_router);
     return cl.send_commit_transaction(
@@ -929,6 +985,7 @@ CommitTransaction<IPv6>::dispatch(XrlRouter& xrl_router, Profile&)
     p->set_tid(0);	// XXX: reset the tid
     p->set_transaction_in_progress(false);
     p->set_transaction_in_error(false);
+    _started = p->transaction_started();
 
     XrlRedistTransaction6V0p1Client cl(&xrl_router);
     return cl.send_commit_transaction(
@@ -942,6 +999,9 @@ void
 CommitTransaction<A>::dispatch_complete(const XrlError& xe)
 {
     if (xe == XrlError::OKAY()) {
+	RedistTransactionXrlOutput<A>* p =
+	    reinterpret_cast<RedistTransactionXrlOutput<A>*>(this->parent());
+	p->transaction_committed(_routes, _started);
 	this->signal_complete_ok();
 	return;
     } else if (xe == XrlError::COMMAND_FAILED()) {
@@ -1038,7 +1098,9 @@ RedistTransactionXrlOutput<A>::RedistTransactionXrlOutput(
       _tid(0),
       _transaction_in_progress(false),
       _transaction_in_error(false),
-      _transaction_size(0)
+      _transaction_size(0),
+      _transaction_limit(MIN_TRANSACTION_SIZE),
+      _open_updates(NULL)
 {
 }
 
@@ -1054,23 +1116,7 @@ RedistTransactionXrlOutput<A>::add_route(const IPRouteEntry<A>& ipr)
 					    ipr.nexthop()->str().c_str(),
 					    XORP_UINT_CAST(ipr.metric()))));
 
-    bool no_running_tasks = (this->_queued == 0);
-
-    if (this->transaction_size() == 0)
-	this->enqueue_task(new StartTransaction<A>(this));
-
-    //
-    // If the accumulated transaction size is too large, commit the
-    // current transaction and start a new one.
-    //
-    if (this->transaction_size() >= MAX_TRANSACTION_SIZE) {
-	this->enqueue_task(new CommitTransaction<A>(this));
-	this->enqueue_task(new StartTransaction<A>(this));
-    }
-
-    this->enqueue_task(new AddTransactionRoute<A>(this, ipr));
-    if (no_running_tasks)
-	this->start_next_task();
+    enqueue_update(ipr, true);
 }
 
 template <typename A>
@@ -1083,6 +1129,14 @@ RedistTransactionXrlOutput<A>::delete_route(const IPRouteEntry<A>& ipr)
 					    ipr.protocol()->name().c_str(),
 					    ipr.net().str().c_str())));
 
+    enqueue_update(ipr, false);
+}
+
+template <typename A>
+void
+RedistTransactionXrlOutput<A>::enqueue_update(const IPRouteEntry<A>& ipr,
+					      bool add)
+{
     bool no_running_tasks = (this->_queued == 0);
 
     if (this->transaction_size() == 0)
@@ -1092,16 +1146,61 @@ RedistTransactionXrlOutput<A>::delete_route(const IPRouteEntry<A>& ipr)
     // If the accumulated transaction size is too large, commit the
     // current transaction and start a new one.
     //
-    if (this->transaction_size() >= MAX_TRANSACTION_SIZE) {
+    if (this->transaction_size() >= _transaction_limit) {
 	this->enqueue_task(new CommitTransaction<A>(this));
 	this->enqueue_task(new StartTransaction<A>(this));
     }
 
-    this->enqueue_task(new DeleteTransactionRoute<A>(this, ipr));
+    //
+    // Add the route to the last update XRL if it is still waiting at
+    // the back of the queue and has room.  A backlog is so sent many
+    // routes to an XRL.
+    //
+    if (_open_updates == NULL || this->_taskq.empty()
+	|| this->_taskq.back() != _open_updates
+	|| _open_updates->updates() >= MAX_UPDATES_PER_XRL) {
+	_open_updates = new UpdateTransactionRoutes<A>(this);
+	this->enqueue_task(_open_updates);
+    }
+    _open_updates->add_update(ipr, add);
+    incr_transaction_size();
+
     if (no_running_tasks)
 	this->start_next_task();
 }
 
+template <typename A>
+void
+RedistTransactionXrlOutput<A>::transaction_committed(size_t routes,
+						     const TimeVal& started)
+{
+    //
+    // Only a transaction that was cut off at the limit tells how fast
+    // the target goes.  A smaller one ran out of routes first.
+    //
+    if (routes < _transaction_limit)
+	return;
+
+    TimeVal now;
+    TimerList::system_gettimeofday(&now);
+    int64_t ms = (now - started).to_ms();
+    if (ms < 1)
+	ms = 1;
+
+    //
+    // Aim for transactions that the target gets through in
+    // TRANSACTION_TARGET_MS, moving half way there each time so that
+    // one slow or quick commit does not swing the size.
+    //
+    size_t target = static_cast<size_t>(routes * TRANSACTION_TARGET_MS / ms);
+    size_t limit = (_transaction_limit + target) / 2;
+    if (limit < MIN_TRANSACTION_SIZE)
+	limit = MIN_TRANSACTION_SIZE;
+    if (limit > MAX_TRANSACTION_SIZE)
+	limit = MAX_TRANSACTION_SIZE;
+    _transaction_limit = limit;
+}
+
 template <typename A>
 void
 RedistTransactionXrlOutput<A>::starting_route_dump()
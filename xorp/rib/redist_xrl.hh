@@ -24,10 +24,12 @@
 
 #include "rt_tab_redist.hh"
 #include "libxorp/profile.hh"
+#include "libxorp/timeval.hh"
 
 class XrlRouter;
 
 template <typename A> class RedistXrlTask;
+template <typename A> class UpdateTransactionRoutes;
 
 /**
  * Route Redistributor output that sends route add and deletes to
@@ -110,6 +112,10 @@ protected:
  * Route Redistributor output that sends route add and deletes to
  * remote redistribution target via the redist_transaction{4,6} xrl
  * interfaces.
+ *
+ * Updates that queue up behind the XRLs in flight are sent many to an
+ * XRL.  Transactions are committed after a number of routes that
+ * follows how fast the target acknowledges them.
  */
 template <typename A>
 class RedistTransactionXrlOutput : public RedistXrlOutput<A>
@@ -150,13 +156,49 @@ public:
     void reset_transaction_size() { _transaction_size = 0; }
     void incr_transaction_size() { _transaction_size++; }
 
-    static const size_t MAX_TRANSACTION_SIZE	 = 100;
+    /**
+     * @return the number of routes after which the transaction being
+     * built is committed and another one started.
+     */
+    size_t transaction_limit() const { return _transaction_limit; }
+
+    /**
+     * Note that the target acknowledged the commit of a transaction,
+     * and size the transactions that follow by the rate at which it
+     * got through it.
+     *
+     * @param routes the number of routes in the transaction.
+     * @param started when the transaction was started.
+     */
+    void transaction_committed(size_t routes, const TimeVal& started);
+
+    const TimeVal& transaction_started() const;
+    void set_transaction_started(const TimeVal& v);
+
+    /**
+     * Note that an update XRL is being sent, so no more routes may be
+     * added to it.
+     */
+    void updates_dispatched(UpdateTransactionRoutes<A>* task);
+
+    static const size_t MIN_TRANSACTION_SIZE	 = 100;
+    static const size_t MAX_TRANSACTION_SIZE	 = 10000;
+    static const uint32_t TRANSACTION_TARGET_MS	 = 250;
+    static const size_t MAX_UPDATES_PER_XRL	 = 100;
+
+protected:
+    void enqueue_update(const IPRouteEntry<A>& ipr, bool add);
 
 protected:
     uint32_t	_tid;			// Send-in-progress transaction ID
     bool	_transaction_in_progress;
     bool	_transaction_in_error;
     size_t	_transaction_size;	// Build-in-progress transaction size
+    size_t	_transaction_limit;	// Routes per transaction
+    TimeVal	_transaction_started;	// Send-in-progress transaction start
+
+    // Last update XRL queued, if routes may still be added to it
+    UpdateTransactionRoutes<A>* _open_updates;
 };
 
 
@@ -238,6 +280,29 @@ RedistTransactionXrlOutput<A>::set_transaction_in_progress(bool v)
     _transaction_in_progress = v;
 }
 
+template <typename A>
+inline const TimeVal&
+RedistTransactionXrlOutput<A>::transaction_started() const
+{
+    return _transaction_started;
+}
+
+template <typename A>
+inline void
+RedistTransactionXrlOutput<A>::set_transaction_started(const TimeVal& v)
+{
+    _transaction_started = v;
+}
+
+template <typename A>
+inline void
+RedistTransactionXrlOutput<A>::updates_dispatched(
+    UpdateTransactionRoutes<A>* task)
+{
+    if (_open_updates == task)
+	_open_updates = NULL;
+}
+
 template <typename A>
 inline bool
 RedistTransactionXrlOutput<A>::transaction_in_error() const
@@ -26,6 +26,7 @@
 #include "libxorp/xorp.h"
 #include "libxorp/xlog.h"
 #include "libxorp/debug.h"
+#include "libxorp/timer.hh"
 #include "libxipc/xrl_router.hh"
 
 #include "register_server.hh"
@@ -34,29 +35,130 @@
 NotifyQueue::NotifyQueue(const string& module_name)
     : _module_name(module_name),
       _active(false),
-      _response_sender(NULL)
+      _response_sender(NULL),
+      _max_queue_depth(0),
+      _entries_queued(0),
+      _entries_coalesced(0),
+      _entries_sent(0),
+      _xrls_sent(0)
 {
 }
 
+NotifyQueue::~NotifyQueue()
+{
+    while (! _queue.empty()) {
+	delete _queue.front();
+	_queue.pop_front();
+    }
+}
+
 void
 NotifyQueue::add_entry(NotifyQueueEntry* e) 
 {
-    _queue.push_back(e);
+    _entries_queued++;
+
+    //
+    // If the registration already has an entry waiting, the client
+    // only needs to hear about the latest state.  An invalidation
+    // has to reach the client before anything that follows it though,
+    // as the registration it is for has gone; only a repeat of it can
+    // be dropped.
+    //
+    PendingMap::iterator pi = _pending.find(pending_key(e));
+    if (pi != _pending.end()) {
+	NotifyQueueEntry* old = *pi->second;
+	if (old->type() != NotifyQueueEntry::INVALIDATE) {
+	    debug_msg("NQ: replacing queued entry\n");
+	    e->set_queued(old->queued());
+	    *pi->second = e;
+	    delete old;
+	    _entries_coalesced++;
+	    return;
+	}
+	if (e->type() == NotifyQueueEntry::INVALIDATE) {
+	    debug_msg("NQ: dropping repeated invalidate\n");
+	    delete e;
+	    _entries_coalesced++;
+	    return;
+	}
+    }
+
+    TimeVal now;
+    TimerList::system_gettimeofday(&now);
+    e->set_queued(now);
+    _pending[pending_key(e)] = _queue.insert(_queue.end(), e);
+    if (_queue.size() > _max_queue_depth)
+	_max_queue_depth = _queue.size();
 }
 
 void
 NotifyQueue::send_next() 
 {
-    XrlCompleteCB cb = callback(this, &NotifyQueue::xrl_done);
+    TimeVal now;
+    TimerList::system_gettimeofday(&now);
+
+    // Take as many entries of the same address family as fit in a batch
+    list<NotifyQueueEntry* > entries;
+    int family = _queue.front()->subnet().af();
+    while (! _queue.empty() && entries.size() < MAX_BATCH_SIZE) {
+	NotifyQueueEntry* e = _queue.front();
+	IPvXNet subnet = e->subnet();
+	if (subnet.af() != family)
+	    break;
+
+	PendingMap::iterator pi = _pending.find(pending_key(e));
+	if (pi != _pending.end() && pi->second == _queue.begin())
+	    _pending.erase(pi);
+	_queue.pop_front();
+
+	TimeVal latency = now - e->queued();
+	_total_latency += latency;
+	if (latency > _max_latency)
+	    _max_latency = latency;
+	entries.push_back(e);
+    }
+
+    send_batch(entries);
+
+    while (! entries.empty()) {
+	delete entries.front();
+	entries.pop_front();
+    }
 
-    _queue.front()->send(_response_sender, _module_name, cb);
-    _queue.pop_front();
     if (_queue.empty()) {
 	_active = false;
 	_response_sender = NULL;
     }
 }
 
+NotifyQueue::PendingKey
+NotifyQueue::pending_key(const NotifyQueueEntry* e)
+{
+    return PendingKey(e->subnet(), e->multicast());
+}
+
+void
+NotifyQueue::send_batch(const list<NotifyQueueEntry* >& entries)
+{
+    XrlCompleteCB cb = callback(this, &NotifyQueue::xrl_done);
+
+    _entries_sent += entries.size();
+    _xrls_sent++;
+
+    // A single entry goes as it always did
+    if (entries.size() == 1) {
+	entries.front()->send(_response_sender, _module_name, cb);
+	return;
+    }
+
+    NotifyQueueBatch batch;
+    list<NotifyQueueEntry* >::const_iterator iter;
+    for (iter = entries.begin(); iter != entries.end(); ++iter)
+	(*iter)->add_to_batch(batch);
+    batch.send(_response_sender, _module_name,
+	       entries.front()->subnet().af(), cb);
+}
+
 void
 NotifyQueue::flush(ResponseSender* response_sender) 
 {
@@ -91,6 +193,58 @@ NotifyQueue::xrl_done(const XrlError& e)
     }
 }
 
+void
+NotifyQueueBatch::add_changed(const XrlAtom& addr, uint32_t prefix_len,
+			      const XrlAtom& nexthop, uint32_t metric,
+			      uint32_t admin_distance,
+			      const string& protocol_origin)
+{
+    _addrs.append(addr);
+    _prefix_lens.append(XrlAtom(prefix_len));
+    _nexthops.append(nexthop);
+    _metrics.append(XrlAtom(metric));
+    _admin_distances.append(XrlAtom(admin_distance));
+    _protocol_origins.append(XrlAtom(protocol_origin));
+}
+
+void
+NotifyQueueBatch::add_invalidate(const XrlAtom& addr, uint32_t prefix_len)
+{
+    _invalid_addrs.append(addr);
+    _invalid_prefix_lens.append(XrlAtom(prefix_len));
+}
+
+void
+NotifyQueueBatch::send(ResponseSender* response_sender,
+		       const string& module_name, int family,
+		       NotifyQueue::XrlCompleteCB& cb)
+{
+    switch (family) {
+    case AF_INET:
+	response_sender->send_route_info_batch4(module_name.c_str(),
+						_invalid_addrs,
+						_invalid_prefix_lens,
+						_addrs, _prefix_lens,
+						_nexthops, _metrics,
+						_admin_distances,
+						_protocol_origins, cb);
+	break;
+#ifdef HAVE_IPV6
+    case AF_INET6:
+	response_sender->send_route_info_batch6(module_name.c_str(),
+						_invalid_addrs,
+						_invalid_prefix_lens,
+						_addrs, _prefix_lens,
+						_nexthops, _metrics,
+						_admin_distances,
+						_protocol_origins, cb);
+	break;
+#endif
+    default:
+	XLOG_UNREACHABLE();
+    }
+}
+
 template <>
 void
 NotifyQueueChangedEntry<IPv4>::send(ResponseSender* response_sender,
@@ -116,6 +270,22 @@ NotifyQueueInvalidateEntry<IPv4>::send(ResponseSender* response_sender,
 					      _net.prefix_len(), cb);
 }
 
+template <>
+void
+NotifyQueueChangedEntry<IPv4>::add_to_batch(NotifyQueueBatch& batch) const
+{
+    batch.add_changed(XrlAtom(_net.masked_addr()), _net.prefix_len(),
+		      XrlAtom(_nexthop), _metric, _admin_distance,
+		      _protocol_origin);
+}
+
+template <>
+void
+NotifyQueueInvalidateEntry<IPv4>::add_to_batch(NotifyQueueBatch& batch) const
+{
+    batch.add_invalidate(XrlAtom(_net.masked_addr()), _net.prefix_len());
+}
+
 
 RegisterServer::RegisterServer(XrlRouter* xrl_router)
     : _response_sender(xrl_router)
@@ -168,6 +338,17 @@ RegisterServer::send_invalidate(const string& module_name,
 		       reinterpret_cast<NotifyQueueEntry *>(q_entry));
 }
 
+const NotifyQueue*
+RegisterServer::notify_queue(const string& module_name) const
+{
+    map<string, NotifyQueue* >::const_iterator qmi;
+
+    qmi = _queuemap.find(module_name);
+    if (qmi == _queuemap.end())
+	return NULL;
+    return qmi->second;
+}
+
 void
 RegisterServer::flush() 
 {
@@ -206,6 +387,22 @@ NotifyQueueInvalidateEntry<IPv6>::send(ResponseSender* response_sender,
 					      _net.prefix_len(), cb);
 }
 
+template <>
+void
+NotifyQueueChangedEntry<IPv6>::add_to_batch(NotifyQueueBatch& batch) const
+{
+    batch.add_changed(XrlAtom(_net.masked_addr()), _net.prefix_len(),
+		      XrlAtom(_nexthop), _metric, _admin_distance,
+		      _protocol_origin);
+}
+
+template <>
+void
+NotifyQueueInvalidateEntry<IPv6>::add_to_batch(NotifyQueueBatch& batch) const
+{
+    batch.add_invalidate(XrlAtom(_net.masked_addr()), _net.prefix_len());
+}
+
 
 void
 RegisterServer::send_route_changed(const string& module_name,
@@ -29,12 +29,15 @@
 #include "libxorp/ipv4.hh"
 #include "libxorp/ipv6.hh"
 #include "libxorp/ipnet.hh"
+#include "libxorp/ipvxnet.hh"
+#include "libxorp/timeval.hh"
 
 #include "xrl/interfaces/rib_client_xif.hh"
 
 
 class XrlRouter;
 class NotifyQueueEntry;
+class NotifyQueueBatch;
 
 typedef XrlRibClientV0p1Client ResponseSender;
 
@@ -46,9 +49,19 @@ typedef XrlRibClientV0p1Client ResponseSender;
  * changes that affected one or more routes.  When a lot of routes
  * change, we need to queue the changes because we may generate them
  * faster than the recipient can handle being told about them.
+ *
+ * While a notification waits in the queue, a later one for the same
+ * registration replaces it, so the recipient only hears about the
+ * latest state.  The waiting notifications are sent in batches, many
+ * to an XRL.
  */
 class NotifyQueue {
 public:
+    /**
+     * The most notifications sent in one XRL.
+     */
+    static const size_t MAX_BATCH_SIZE = 100;
+
     /**
      * NotifyQueue constructor
      *
@@ -58,24 +71,32 @@ public:
     NotifyQueue(const string& module_name);
 
     /**
-     * Add an notification entry to the queue.
+     * NotifyQueue destructor
+     */
+    ~NotifyQueue();
+
+    /**
+     * Add an notification entry to the queue.  If a notification
+     * for the same registration is still waiting to be sent, the new
+     * one replaces it, unless the waiting one is an invalidation: a
+     * repeated invalidation is dropped, and a change is queued after
+     * it.
      *
      * @param e the notification entry to be queued.
      */
     void add_entry(NotifyQueueEntry* e);
 
     /**
-     * Send the next entry in the queue to this queue's XRL target.
+     * Send the next batch of entries in the queue to this queue's
+     * XRL target.
      */
     void send_next();
 
     /**
      * Flush is an indication to the queue that the changes since the
-     * last flush can be checked for consolidation.  Several add_entry
-     * events might occur in rapid succession affecting the same
-     * route.  A flush indicates that it is OK to start sending this
-     * batch of changes (and to consolidate those changes to avoid
-     * thrashing, but we don't currently do this).
+     * last flush can be sent.  Several add_entry events might occur
+     * in rapid succession affecting the same route; those that are
+     * still queued when their turn comes have been consolidated.
      */
     void flush(ResponseSender* response_sender);
 
@@ -89,11 +110,120 @@ public:
 
     typedef XorpCallback1<void, const XrlError&>::RefPtr XrlCompleteCB;
 
+    /**
+     * @return the number of entries waiting to be sent.
+     */
+    size_t queue_depth() const		{ return _queue.size(); }
+
+    /**
+     * @return the largest number of entries that have waited at once.
+     */
+    size_t max_queue_depth() const	{ return _max_queue_depth; }
+
+    /**
+     * @return the number of entries added to the queue.
+     */
+    uint32_t entries_queued() const	{ return _entries_queued; }
+
+    /**
+     * @return the number of entries that replaced a waiting one.
+     */
+    uint32_t entries_coalesced() const	{ return _entries_coalesced; }
+
+    /**
+     * @return the number of entries sent.
+     */
+    uint32_t entries_sent() const	{ return _entries_sent; }
+
+    /**
+     * @return the number of XRLs the entries were sent in.
+     */
+    uint32_t xrls_sent() const		{ return _xrls_sent; }
+
+    /**
+     * @return the total time the sent entries waited in the queue.
+     * An entry that was coalesced waited from when the registration
+     * first changed.
+     */
+    const TimeVal& total_latency() const { return _total_latency; }
+
+    /**
+     * @return the longest time an entry waited in the queue.
+     */
+    const TimeVal& max_latency() const	{ return _max_latency; }
+
 private:
+    typedef list<NotifyQueueEntry* > Queue;
+
+    // The last entry queued for each registration.  The unicast and
+    // multicast RIBs share the queue, so a registration is keyed by
+    // its subnet and the RIB it is in.
+    typedef pair<IPvXNet, bool> PendingKey;
+    typedef map<PendingKey, Queue::iterator> PendingMap;
+
+    static PendingKey pending_key(const NotifyQueueEntry* e);
+
+    void send_batch(const list<NotifyQueueEntry* >& entries);
+
     string		_module_name;
-    list<NotifyQueueEntry* > _queue;
+    Queue		_queue;
+    PendingMap		_pending;
     bool		_active;
     ResponseSender*	_response_sender;
+
+    size_t		_max_queue_depth;
+    uint32_t		_entries_queued;
+    uint32_t		_entries_coalesced;
+    uint32_t		_entries_sent;
+    uint32_t		_xrls_sent;
+    TimeVal		_total_latency;
+    TimeVal		_max_latency;
+};
+
+/**
+ * @short A batch of notifications sent in one XRL.
+ *
+ * All the notifications in a batch are for the same address family.
+ * The recipient applies the invalidations before the changes; a
+ * @ref NotifyQueue never holds an invalidation behind a change for
+ * the same registration, so this keeps their order.
+ */
+class NotifyQueueBatch {
+public:
+    /**
+     * Add a changed route notification to the batch.
+     */
+    void add_changed(const XrlAtom& addr, uint32_t prefix_len,
+		     const XrlAtom& nexthop, uint32_t metric,
+		     uint32_t admin_distance, const string& protocol_origin);
+
+    /**
+     * Add an invalidated registration to the batch.
+     */
+    void add_invalidate(const XrlAtom& addr, uint32_t prefix_len);
+
+    /**
+     * Send the batch to the registered process.
+     *
+     * @param response_sender the auto-generated stub class instance
+     * that will do the parameter marchalling.
+     * @param module_name the XRL module target name to send this
+     * information to.
+     * @param family the address family of the notifications.
+     * @param cb the method to call back when this XRL completes.
+     */
+    void send(ResponseSender* response_sender, const string& module_name,
+	      int family, NotifyQueue::XrlCompleteCB& cb);
+
+private:
+    XrlAtomList	_invalid_addrs;
+    XrlAtomList	_invalid_prefix_lens;
+    XrlAtomList	_addrs;
+    XrlAtomList	_prefix_lens;
+    XrlAtomList	_nexthops;
+    XrlAtomList	_metrics;
+    XrlAtomList	_admin_distances;
+    XrlAtomList	_protocol_origins;
 };
 
 /**
@@ -127,13 +257,41 @@ public:
 		      const string& module_name,
 		      NotifyQueue::XrlCompleteCB& cb) = 0;
 
+    /**
+     * Add the queue entry to a batch (pure virtual)
+     */
+    virtual void add_to_batch(NotifyQueueBatch& batch) const = 0;
+
     /**
      * @return The type of queue entry
      * @see NotifyQueueEntry::EntryType
      */
     virtual EntryType type() const = 0;
 
+    /**
+     * @return the valid_subnet of the registration this entry is for.
+     */
+    virtual IPvXNet subnet() const = 0;
+
+    /**
+     * @return true if the registration this entry is for is in the
+     * multicast RIB, false if it is in the unicast RIB.
+     */
+    virtual bool multicast() const = 0;
+
+    /**
+     * @return when the registration this entry is for was first
+     * changed since it was last notified.
+     */
+    const TimeVal& queued() const { return _queued; }
+
+    /**
+     * Set when the registration this entry is for was first changed.
+     */
+    void set_queued(const TimeVal& queued) { _queued = queued; }
+
 private:
+    TimeVal	_queued;
 };
 
 /**
@@ -174,6 +332,16 @@ class NotifyQueueChangedEntry : public NotifyQueueEntry {
      */
     EntryType type() const { return CHANGED; }
 
+    /**
+     * @return the subnet of the registration that changed.
+     */
+    IPvXNet subnet() const { return IPvXNet(_net); }
+
+    /**
+     * @return true if the change occured in the multicast RIB.
+     */
+    bool multicast() const { return _multicast; }
+
     /**
      * Actually send the XRL that communicates this change to the
      * registered process.
@@ -188,6 +356,13 @@ class NotifyQueueChangedEntry : public NotifyQueueEntry {
 	      const string& module_name,
 	      NotifyQueue::XrlCompleteCB& cb);
 
+    /**
+     * Add this change to a batch of notifications.
+     *
+     * @param batch the batch to add to.
+     */
+    void add_to_batch(NotifyQueueBatch& batch) const;
+
  private:
     IPNet<A>	_net;	// The route's full subnet (not the valid_subnet)
     A		_nexthop;	// The new nexthop of the route
@@ -230,6 +405,16 @@ public:
      */
     EntryType type() const { return INVALIDATE; }
 
+    /**
+     * @return the subnet of the registration that is now invalid.
+     */
+    IPvXNet subnet() const { return IPvXNet(_net); }
+
+    /**
+     * @return true if the change occured in the multicast RIB.
+     */
+    bool multicast() const { return _multicast; }
+
     /**
      * Actually send the XRL that communicates this change to the
      * registered process.
@@ -244,6 +429,13 @@ public:
 	      const string& module_name,
 	      NotifyQueue::XrlCompleteCB& cb);
 
+    /**
+     * Add this invalidation to a batch of notifications.
+     *
+     * @param batch the batch to add to.
+     */
+    void add_to_batch(NotifyQueueBatch& batch) const;
+
 private:
     IPNet<A>	_net;	// The valid_subnet from the RouteRegister
 			// instance.  The other end already knows the
@@ -354,6 +546,15 @@ public:
      */
     virtual void flush();
 
+    /**
+     * Get the queue of notifications for a module, to look at its
+     * queue depth and latency counters.
+     *
+     * @param module_name the XRL target name of the module.
+     * @return the queue, or NULL if nothing was ever queued for it.
+     */
+    const NotifyQueue* notify_queue(const string& module_name) const;
+
 protected:
     void add_entry_to_queue(const string& module_name, NotifyQueueEntry* e);
     map<string, NotifyQueue* > _queuemap;
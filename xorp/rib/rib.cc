@@ -217,17 +217,57 @@ RIB<A>::get_protocol_admin_distance(const string& protocol_name)
 }
 
 template <typename A>
-inline IPExternalNextHop<A>*
+inline smart_ptr<IPNextHop<A> >
 RIB<A>::create_external_nexthop(const A& addr)
 {
-    return new IPExternalNextHop<A>(addr);
+    typename NextHopMap::const_iterator iter = _external_nexthops.find(addr);
+    if (iter != _external_nexthops.end())
+	return iter->second;
+
+    sweep_nexthops();
+    smart_ptr<IPNextHop<A> > nexthop(new IPExternalNextHop<A>(addr));
+    _external_nexthops.insert(make_pair(addr, nexthop));
+    return nexthop;
 }
 
 template <typename A>
-inline IPPeerNextHop<A>*
+inline smart_ptr<IPNextHop<A> >
 RIB<A>::create_peer_nexthop(const A& addr)
 {
-    return new IPPeerNextHop<A>(addr);
+    typename NextHopMap::const_iterator iter = _peer_nexthops.find(addr);
+    if (iter != _peer_nexthops.end())
+	return iter->second;
+
+    sweep_nexthops();
+    smart_ptr<IPNextHop<A> > nexthop(new IPPeerNextHop<A>(addr));
+    _peer_nexthops.insert(make_pair(addr, nexthop));
+    return nexthop;
+}
+
+template <typename A>
+void
+RIB<A>::sweep_nexthops()
+{
+    if (_external_nexthops.size() + _peer_nexthops.size()
+	< _nexthop_sweep_size) {
+	return;
+    }
+
+    NextHopMap* maps[] = { &_external_nexthops, &_peer_nexthops };
+    for (size_t i = 0; i < sizeof(maps) / sizeof(maps[0]); i++) {
+	typename NextHopMap::iterator iter = maps[i]->begin();
+	while (iter != maps[i]->end()) {
+	    if (smart_ptr_is_only(iter->second))
+		maps[i]->erase(iter++);
+	    else
+		++iter;
+	}
+    }
+
+    _nexthop_sweep_size = 2 * (_external_nexthops.size()
+			       + _peer_nexthops.size());
+    if (_nexthop_sweep_size < NEXTHOP_SWEEP_MIN)
+	_nexthop_sweep_size = NEXTHOP_SWEEP_MIN;
 }
 
 // ----------------------------------------------------------------------------
@@ -252,7 +292,8 @@ RIB<A>::RIB(RibTransportType t, RibManager& rib_manager, EventLoop& eventloop)
       _register_table(NULL),
       _policy_redist_table(NULL),
       _policy_connected_table(NULL),
-      _ext_int_table(NULL)
+      _ext_int_table(NULL),
+      _nexthop_sweep_size(NEXTHOP_SWEEP_MIN)
 {
     if (t == UNICAST) {
 	_multicast = false;
@@ -795,7 +836,7 @@ RIB<A>::add_route(const string&		tablename,
     const Protocol& protocol = ot->protocol();
 
     RibVif<A>* vif = NULL;
-    IPNextHop<A>* nexthop = NULL;
+    smart_ptr<IPNextHop<A> > nexthop;
 
     if (!vifname.empty()) {
 	//
@@ -812,7 +853,7 @@ RIB<A>::add_route(const string&		tablename,
 	    return XORP_ERROR;
 	}
 
-	IPNextHop<A>* nexthop = create_peer_nexthop(nexthop_addr);
+	smart_ptr<IPNextHop<A> > nexthop = create_peer_nexthop(nexthop_addr);
 	ot->add_route(new IPRouteEntry<A>(net, vif, nexthop, &protocol, metric, policytags));
 	flush();
 	return XORP_OK;
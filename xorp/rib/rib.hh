@@ -681,28 +681,35 @@ private:
     RibVif<A>* find_vif(const string& vifname);
 
     /**
-     * Create the IP External Nexthop class instance
+     * Find or create the IP External Nexthop class instance
      * associated with an IP address.
      *
-     * IPRouteEntry IS RESPONSIBLE for freeing
-     * allocated memory for IPExternalNextHop.
+     * The instance is shared by all the routes with that nexthop, and
+     * is freed once the last of them is gone.
      *
      * @param addr the IP address of the nexthop router.
      * @return the IPExternalNextHop class instance for @ref addr
      */
-    IPExternalNextHop<A>* create_external_nexthop(const A& addr);
+    smart_ptr<IPNextHop<A> > create_external_nexthop(const A& addr);
 
     /**
      * Find or create the IP Peer Nexthop class instance
      * associated with an IP address.
      *
-     * IPRouteEntry IS RESPONSIBLE for freeing
-     * allocated memory for IPPeerNextHop.
+     * The instance is shared by all the routes with that nexthop, and
+     * is freed once the last of them is gone.
      *
      * @param addr the IP address of the nexthop router.
      * @return the IPPeerNextHop class instance for @ref addr.
      */
-    IPPeerNextHop<A>* create_peer_nexthop(const A& addr);
+    smart_ptr<IPNextHop<A> > create_peer_nexthop(const A& addr);
+
+    /**
+     * Forget the shared nexthops no route uses any more.  This is done
+     * when the number of nexthops has doubled since the last time, so
+     * that it costs constant time per nexthop created.
+     */
+    void sweep_nexthops();
 
     /**
      * Flush out routing table changes to other processes.
@@ -712,6 +719,10 @@ private:
 protected:
     typedef map<string, OriginTable<A>* > OriginTableMap;
     typedef map<string, RedistTable<A>* > RedistTableMap;
+    typedef map<A, smart_ptr<IPNextHop<A> > > NextHopMap;
+
+    // Shared nexthops are swept once there are at least this many
+    static const size_t NEXTHOP_SWEEP_MIN = 1024;
 
     RibManager&		_rib_manager;
     EventLoop&		_eventloop;
@@ -740,8 +751,9 @@ protected:
     map<string, RibVif<A>*>		_vifs;
     map<string, RibVif<A>*>		_deleted_vifs;
     map<string, uint32_t>		_admin_distances;
-    map<A, IPExternalNextHop<A> >	_external_nexthops;
-    map<A, IPPeerNextHop<A> >		_peer_nexthops;
+    NextHopMap				_external_nexthops;
+    NextHopMap				_peer_nexthops;
+    size_t				_nexthop_sweep_size;
 };
 
 typedef RIB<IPv4> IPv4RIB;
@@ -36,15 +36,16 @@ template <class A>
 void
 RIBVarRW<A>::start_read()
 {
-    initialize(_route.policytags());
+    // Read the tags through a const route: routes without tags share
+    // one set, which is only copied if the filter writes to it.
+    const PolicyTags& tags = static_cast<const IPRouteEntry<A>&>(_route)
+	.policytags();
+    initialize(VAR_POLICYTAGS, tags.element());
+    initialize(VAR_TAG, arena().create<ElemU32>(tags.tag()));
 
     read_route_nexthop(_route);
 
-    ostringstream oss;
-
-    oss << _route.metric();
-
-    initialize(VAR_METRIC, _ef.create(ElemU32::id, oss.str().c_str()));
+    initialize(VAR_METRIC, arena().create<ElemU32>(_route.metric()));
 }
 
 template <>
@@ -52,9 +53,9 @@ void
 RIBVarRW<IPv4>::read_route_nexthop(IPRouteEntry<IPv4>& route)
 {
     initialize(VAR_NETWORK4,
-	       _ef.create(ElemIPv4Net::id, route.net().str().c_str()));
-    initialize(VAR_NEXTHOP4, _ef.create(ElemIPv4NextHop::id,
-               route.nexthop_addr().str().c_str()));
+	       arena().create<ElemIPv4Net>(&route.net()));
+    initialize(VAR_NEXTHOP4,
+	       arena().create<ElemIPv4NextHop>(route.nexthop_addr()));
     initialize(VAR_NETWORK6, NULL);
     initialize(VAR_NEXTHOP6, NULL);
 }
@@ -64,9 +65,9 @@ void
 RIBVarRW<IPv6>::read_route_nexthop(IPRouteEntry<IPv6>& route)
 {
     initialize(VAR_NETWORK6,
-	       _ef.create(ElemIPv6Net::id, route.net().str().c_str()));
-    initialize(VAR_NEXTHOP6, _ef.create(ElemIPv6NextHop::id,
-               route.nexthop_addr().str().c_str()));
+	       arena().create<ElemIPv6Net>(&route.net()));
+    initialize(VAR_NEXTHOP6,
+	       arena().create<ElemIPv6NextHop>(route.nexthop_addr()));
 
     initialize(VAR_NETWORK4, NULL);
     initialize(VAR_NEXTHOP4, NULL);
@@ -74,8 +75,17 @@ RIBVarRW<IPv6>::read_route_nexthop(IPRouteEntry<IPv6>& route)
 
 template <class A>
 void
-RIBVarRW<A>::single_write(const Id& /* id */, const Element& /* e */)
+RIBVarRW<A>::single_write(const Id& id, const Element& e)
 {
+    switch (id) {
+    case VAR_POLICYTAGS:
+	_route.policytags().set_ptags(e);
+	break;
+
+    case VAR_TAG:
+	_route.policytags().set_tag(e);
+	break;
+    }
 }
 
 template <class A>
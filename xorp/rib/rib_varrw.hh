@@ -24,7 +24,6 @@
 #define __RIB_RIB_VARRW_HH__
 
 #include "policy/backend/single_varrw.hh"
-#include "policy/common/element_factory.hh"
 #include "route.hh"
 
 /**
@@ -73,7 +72,6 @@ private:
     void read_route_nexthop(IPRouteEntry<A>& r);
 
     IPRouteEntry<A>&	_route;
-    ElementFactory	_ef;
 };
 
 #endif // __RIB_RIB_VARRW_HH__
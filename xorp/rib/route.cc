@@ -30,12 +30,32 @@
 #include "rib.hh"
 #include "route.hh"
 
+/**
+ * @return the policy-tags shared by the routes that have no tags.
+ */
+static smart_ptr<PolicyTags>&
+untagged()
+{
+    // Never freed, as routes may outlive static destruction.
+    static smart_ptr<PolicyTags>* tags
+	= new smart_ptr<PolicyTags>(new PolicyTags());
+    return *tags;
+}
+
+static smart_ptr<PolicyTags>
+share_policytags(const PolicyTags& policytags)
+{
+    if (policytags == *untagged())
+	return untagged();
+    return smart_ptr<PolicyTags>(new PolicyTags(policytags));
+}
+
 template<class A>
 RouteEntry<A>::RouteEntry(RibVif<A>* vif, const Protocol* protocol,
 		       uint32_t metric, const PolicyTags& policytags, const IPNet<A>& net, uint16_t admin_distance)
     : _vif(vif), _protocol(protocol),
       _admin_distance(admin_distance), _metric(metric),
-      _policytags(new PolicyTags(policytags)), _net(net)
+      _policytags(share_policytags(policytags)), _net(net)
 {
     if (_vif != NULL)
 	_vif->incr_usage_counter();
@@ -46,7 +66,7 @@ RouteEntry<A>::RouteEntry(RibVif<A>* vif, const Protocol* protocol,
 			uint32_t metric, const IPNet<A>& net, uint16_t admin_distance)
     : _vif(vif), _protocol(protocol),
       _admin_distance(admin_distance), _metric(metric),
-      _policytags(new PolicyTags()), _net(net)
+      _policytags(untagged()), _net(net)
 {
     if (_vif != NULL)
 	_vif->incr_usage_counter();
@@ -100,6 +120,15 @@ RouteEntry<A>::~RouteEntry()
 	_vif->decr_usage_counter();
 }
 
+template<class A>
+PolicyTags&
+RouteEntry<A>::policytags()
+{
+    if (_policytags.get() == untagged().get())
+	_policytags = smart_ptr<PolicyTags>(new PolicyTags());
+    return *_policytags;
+}
+
 template class RouteEntry<IPv4>;
 template class RouteEntry<IPv6>;
 
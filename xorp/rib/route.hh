@@ -37,11 +37,13 @@
 
 #include <boost/shared_ptr.hpp>
 #define smart_ptr boost::shared_ptr
+#define smart_ptr_is_only(p) ((p).unique())
 
 #else
 
 #include "libxorp/ref_ptr.hh"
 #define smart_ptr ref_ptr
+#define smart_ptr_is_only(p) ((p).is_only())
 
 #endif
 
@@ -158,9 +160,12 @@ public:
     /**
      * Get the policy-tags for this route.
      *
+     * Routes without tags share one empty set, so asking for tags that
+     * may be changed gives the route a set of its own.
+     *
      * @return the policy-tags for this route.
      */
-    PolicyTags& policytags() { return *_policytags; }
+    PolicyTags& policytags();
     const PolicyTags& policytags() const { return *_policytags; }
 
     smart_ptr<PolicyTags>& policytags_shared() { return _policytags; }
@@ -218,6 +223,24 @@ public:
 		 const PolicyTags& policytags)
 	: RouteEntry<A>(vif, protocol, metric, policytags, net), _nexthop(nexthop) { XLOG_ASSERT(nexthop); }
 
+    /**
+     * Constructor for IPRouteEntry with a shared nexthop.
+     *
+     * @param net the Subnet (address and mask) of the routing table entry.
+     * @param vif the Virtual Interface on which packets matching this
+     * routing table entry should be forwarded.
+     * @param nexthop the NextHop router to which packets matching this
+     * entry should be forwarded, shared with the other routes using it.
+     * @param protocol the routing protocol that originated this route.
+     * @param metric the routing protocol metric for this route.
+     * @param policytags the policy-tags for this route.
+     */
+    IPRouteEntry(const IPNet<A>& net, RibVif<A>* vif,
+		 const smart_ptr<IPNextHop<A> >& nexthop,
+		 const Protocol* protocol, uint32_t metric,
+		 const PolicyTags& policytags)
+	: RouteEntry<A>(vif, protocol, metric, policytags, net), _nexthop(nexthop) { XLOG_ASSERT(nexthop.get()); }
+
     IPRouteEntry(const IPNet<A>& net, RibVif<A>* vif,
 	smart_ptr<IPNextHop<A> >& nexthop, const Protocol* protocol, uint32_t metric,
 	smart_ptr<PolicyTags>& policytags, uint16_t admin_distance)
@@ -250,6 +273,14 @@ public:
      */
     const A& nexthop_addr() const { return _nexthop->addr(); }
 
+    /**
+     * Get the EGP parent.
+     *
+     * @return the original EGP route if this entry is the resolved copy
+     * made by the ExtIntTable, otherwise NULL.
+     */
+    virtual const IPRouteEntry<A>* egp_parent() const { return NULL; }
+
     /**
      * Get the route entry as a string for debugging purposes.
      *
@@ -284,7 +315,7 @@ typedef IPRouteEntry<IPv6> IPv6RouteEntry;
 template <class A>
 class ResolvedIPRouteEntry : public IPRouteEntry<A> {
 public:
-    typedef multimap<const IPNet<A> , ResolvedIPRouteEntry<A>* > RouteBackLink;
+    typedef list<ResolvedIPRouteEntry<A>* > RouteBackLink;
 
 public:
     /**
@@ -332,14 +363,14 @@ public:
 
     /**
      * Set the backlink.  When a resolved route is created, the
-     * ExtIntTable will store a link to it in a multimap that is
-     * indexed by the IGP parent.  This will allow all the routes
-     * affected by a change in the IGP parent to be found easily.
+     * ExtIntTable will store a link to it in the list of routes that
+     * share its nexthop.  This will allow all the routes affected by
+     * a change in the resolution of that nexthop to be found easily.
      * However, if the EGP parent goes away, we need to remove the
-     * links from this multimap, and the backlink provides an iterator
-     * into the multimap that makes this operation very efficient.
+     * link from this list, and the backlink provides an iterator
+     * into the list that makes this operation very efficient.
      *
-     * @param backlink the ExtIntTable multimap iterator for this route.
+     * @param backlink the ExtIntTable list iterator for this route.
      */
     void set_backlink(typename RouteBackLink::iterator v) { _backlink = v; }
 
@@ -361,7 +392,7 @@ private:
     const IPRouteEntry<A>* _egp_parent;
 
     // _backlink is used for removing the corresponding entry from the
-    // RouteTable's map that is indexed by igp_parent.  Without it,
+    // RouteTable's list of routes with the same nexthop.  Without it,
     // route deletion would be expensive.
     typename RouteBackLink::iterator _backlink;
 };
@@ -49,10 +49,12 @@ ExtIntTable<A>::~ExtIntTable()
 	_ip_unresolved_table.erase(_ip_unresolved_table.begin());
     }
 
-    while (! _ip_resolved_table.empty()) {
-	delete *_ip_resolved_table.begin();
-	_ip_resolved_table.erase(_ip_resolved_table.begin());
+    for (typename RouteTrie::iterator iter = _wining_routes.begin();
+	 iter != _wining_routes.end(); ++iter) {
+	if ((*iter)->egp_parent() != NULL)
+	    delete *iter;
     }
+    _wining_routes.delete_all_nodes();
 
     _igp_ad_set.clear();
     _egp_ad_set.clear();
@@ -149,6 +151,7 @@ ExtIntTable<A>::add_igp_route(const IPRouteEntry<A>& route)
     if (!best_igp_route(route))
 	return XORP_ERROR;
 
+    bool masked = false;
     if (!_egp_ad_set.empty()) {
 	// Try to find existing EGP routes, that are installed
 	// We're looking for EGP route in all wining routes.
@@ -158,21 +161,26 @@ ExtIntTable<A>::add_igp_route(const IPRouteEntry<A>& route)
 	// It should have been deleted. We check for that in the XLOG_ASSERT
 	const IPRouteEntry<A>* found = lookup_route(route.net());
 	if (found != NULL) {
-	    if (found->admin_distance() < route.admin_distance())
-		// The admin distance of the existing EGP route is better
-		return XORP_ERROR;
+	    // The admin distance of the existing EGP route may be better
+	    masked = (found->admin_distance() < route.admin_distance());
+	    if (!masked) {
+		XLOG_ASSERT(found->admin_distance() != route.admin_distance());
 
-	    XLOG_ASSERT(found->admin_distance() != route.admin_distance());
-
-	    this->delete_ext_route(found);
+		this->delete_ext_route(found);
+	    }
 	}
     }
 
-    _wining_routes.insert(route.net(), &route);
+    if (!masked) {
+	_wining_routes.insert(route.net(), &route);
 
-    this->next_table()->add_igp_route(route);
+	this->next_table()->add_igp_route(route);
+    }
 
     if (!_egp_ad_set.empty()) {
+	// Nexthops resolve through the winning IGP routes, even one
+	// that an EGP route beats at its own subnet.
+
 	// Does this cause any previously resolved nexthops to resolve
 	// differently?
 	recalculate_nexthops(route);
@@ -181,7 +189,7 @@ ExtIntTable<A>::add_igp_route(const IPRouteEntry<A>& route)
 	resolve_unresolved_nexthops(route);
     }
 
-    return XORP_OK;
+    return (masked ? XORP_ERROR : XORP_OK);
 }
 
 template <class A>
@@ -201,12 +209,8 @@ ExtIntTable<A>::add_direct_egp_route(const IPRouteEntry<A>& route)
     //
     debug_msg("nexthop %s was directly connected\n", route.nexthop()->addr().str().c_str());
 
-    if (found != NULL) {
-	// Delete the IGP route that has worse admin distance
-	_wining_routes.erase(found->net());
-
-	this->next_table()->delete_igp_route(found);
-    }
+    if (found != NULL)
+	delete_worse_route(found);
 
     _wining_routes.insert(route.net(), &route);
 
@@ -234,7 +238,7 @@ ExtIntTable<A>::add_indirect_egp_route(const IPRouteEntry<A>& route)
 {
     IPNextHop<A>* rt_nexthop = route.nexthop();
 
-    const IPRouteEntry<A>* nexthop_route = lookup_winning_igp_route(rt_nexthop->addr());
+    const IPRouteEntry<A>* nexthop_route = lookup_nexthop_route(rt_nexthop->addr());
 
     if (nexthop_route == NULL) {
 	// Store the fact that this was unresolved for later
@@ -250,12 +254,8 @@ ExtIntTable<A>::add_indirect_egp_route(const IPRouteEntry<A>& route)
 	XLOG_ASSERT(found ? (found->admin_distance() != route.admin_distance()) : true);
 
 	// The EGP route is resolvable
-	if (found != NULL) {
-	    // Delete the IGP route that has worse admin distance
-	    _wining_routes.erase(found->net());
-
-	    this->next_table()->delete_igp_route(found);
-	}
+	if (found != NULL)
+	    delete_worse_route(found);
 
 	debug_msg("nexthop resolved to \n   %s\n", nexthop_route->str().c_str());
 
@@ -296,16 +296,14 @@ ExtIntTable<A>::resolve_and_store_route(const IPRouteEntry<A>& route,
     resolved_route = new ResolvedIPRouteEntry<A>(nexthop_route,
 						 &route);
     resolved_route->set_admin_distance(route.admin_distance());
-    _ip_resolved_table.insert(resolved_route->net(), resolved_route);
-    if (_resolving_routes.lookup_node(nexthop_route->net())
-	== _resolving_routes.end()) {
-	_resolving_routes.insert(nexthop_route->net(), nexthop_route);
-    }
 
+    ResolvedNexthop& nexthop = _resolved_nexthops[route.nexthop()->addr()];
+    XLOG_ASSERT(nexthop.resolving_parent == NULL
+		|| nexthop.resolving_parent == nexthop_route);
+    nexthop.resolving_parent = nexthop_route;
 
     typename ResolvedRouteBackLink::iterator backlink
-	= _ip_resolving_parents.insert(make_pair(nexthop_route->net(),
-						resolved_route));
+	= nexthop.routes.insert(nexthop.routes.end(), resolved_route);
     resolved_route->set_backlink(backlink);
 
     return resolved_route;
@@ -346,39 +344,79 @@ template <class A>
 void
 ExtIntTable<A>::delete_resolved_routes(const IPRouteEntry<A>* route, bool b)
 {
-    const ResolvedIPRouteEntry<A>* found_resolved
-	= lookup_by_igp_parent(route->net());
+    // The nexthops resolved by this route are all within its subnet
+    const IPNet<A>& net = route->net();
+    typename ResolvedNexthopMap::iterator iter, next;
+
+    iter = _resolved_nexthops.lower_bound(net.masked_addr());
+    while (iter != _resolved_nexthops.end() && net.contains(iter->first)) {
+	next = iter;
+	++next;
+	if (iter->second.resolving_parent == route) {
+	    debug_msg("found nexthop using this route: %s\n",
+		      iter->first.str().c_str());
+	    // The route has already gone from the winning IGP routes,
+	    // so this finds whatever resolves the nexthop now.
+	    reresolve_nexthop(iter,
+			      b ? NULL : lookup_winning_igp_route(iter->first));
+	}
+	iter = next;
+    }
+}
 
-    if (found_resolved)
-	_resolving_routes.erase(route->net());
+template <class A>
+void
+ExtIntTable<A>::reresolve_nexthop(typename ResolvedNexthopMap::iterator nexthop,
+				  const IPRouteEntry<A>* nexthop_route)
+{
+    // Take the routes off the nexthop first; it is recreated as the
+    // routes are resolved again.
+    ResolvedRouteBackLink routes;
+    routes.swap(nexthop->second.routes);
+    _resolved_nexthops.erase(nexthop);
+
+    typename ResolvedRouteBackLink::iterator iter;
+    for (iter = routes.begin(); iter != routes.end(); ++iter) {
+	const ResolvedIPRouteEntry<A>* found = *iter;
+	const IPRouteEntry<A>* egp_parent = found->egp_parent();
 
-    while (found_resolved) {
-	debug_msg("found route using this nexthop:\n    %s\n", found_resolved->str().c_str());
+	debug_msg("found route using this nexthop:\n    %s\n",
+		  found->str().c_str());
 	// Erase from table first to prevent lookups on this entry
-	_ip_resolved_table.erase(found_resolved->net());
-	_ip_resolving_parents.erase(found_resolved->backlink());
+	_wining_routes.erase(found->net());
 
 	// Propagate the delete next
-	_wining_routes.erase(found_resolved->net());
-
-	this->next_table()->delete_egp_route(found_resolved);
+	this->next_table()->delete_egp_route(found);
 
-	// Now delete the local resolved copy, and reinstantiate it
-	const IPRouteEntry<A>* egp_parent = found_resolved->egp_parent();
-	delete found_resolved;
-
-	// egp_parent route is one of the wining EGP routes.
-	// Re-adding will overwrite it the in trie
-	// That's no problem because we're overwriting
-	// old pointer with the existing pointer.
-	// That way we don't have any memory leaking.
+	// Now delete the local resolved copy, and reinstantiate it.
+	// egp_parent is still the wining route for its subnet, so there
+	// is no need to go through add_egp_route again.
+	delete found;
 
-	if (!b)
-	    add_egp_route(*egp_parent);
-	else
+	if (nexthop_route == NULL) {
 	    create_unresolved_route(*egp_parent);
+	    continue;
+	}
+
+	const ResolvedIPRouteEntry<A>* resolved_route
+	    = resolve_and_store_route(*egp_parent, nexthop_route);
+	_wining_routes.insert(resolved_route->net(), resolved_route);
+	this->next_table()->add_egp_route(*resolved_route);
+    }
+}
 
-	found_resolved = lookup_by_igp_parent(route->net());
+template <class A>
+void
+ExtIntTable<A>::delete_worse_route(const IPRouteEntry<A>* route)
+{
+    // The winning route for this subnet is being replaced by one with
+    // a better admin distance.  It may be an EGP route, and then maybe
+    // our resolved copy of one, which has to go too.
+    if (_igp_ad_set.find(route->admin_distance()) != _igp_ad_set.end()) {
+	_wining_routes.erase(route->net());
+	this->next_table()->delete_igp_route(route);
+    } else {
+	delete_ext_route(route);
     }
 }
 
@@ -394,9 +432,13 @@ ExtIntTable<A>::delete_best_igp_route(const IPRouteEntry<A>* route, bool b)
     const IPRouteEntry<A>* found_route = lookup_route(route->net());
 
     if (found_route) {
-	if (found_route->admin_distance() < route->admin_distance())
-	    // This route wasn't the best route overall
+	if (found_route->admin_distance() < route->admin_distance()) {
+	    // This route wasn't the best route overall, but it was the
+	    // winning IGP route, so nexthops may still resolve through it.
+	    if (!_egp_ad_set.empty())
+		delete_resolved_routes(route, b);
 	    return XORP_ERROR;
+	}
 
 	// Our route was the best route overall
 	XLOG_ASSERT(found_route->admin_distance() == route->admin_distance());
@@ -483,18 +525,11 @@ ExtIntTable<A>::delete_ext_route(const IPRouteEntry<A>* route, bool winning_rout
     found = lookup_in_resolved_table(route->net());
     if (found != NULL) {
 	// Erase from table first to prevent lookups on this entry
-	_ip_resolved_table.erase(found->net());
-	_ip_resolving_parents.erase(found->backlink());
-
-	// Delete the route's IGP parent from _resolving_routes if
-	// no-one is using it anymore
-	if (lookup_by_igp_parent(found->resolving_parent()->net()) == NULL)
-	    _resolving_routes.erase(found->resolving_parent()->net());
+	_wining_routes.erase(found->net());
+	unlink_resolved_route(found);
 
 	if (winning_route == true) {
 	    // Propagate the delete next
-	    _wining_routes.erase(found->net());
-
 	    this->next_table()->delete_egp_route(found);
 	    is_delete_propagated = true;
 	}
@@ -524,9 +559,11 @@ ExtIntTable<A>::lookup_in_resolved_table(const IPNet<A>& net)
     debug_msg("------------------\nlookup_route in resolved table %s\n",
 	      this->tablename().c_str());
 
-    typename Trie<A, const ResolvedIPRouteEntry<A>* >::iterator iter;
-    iter = _ip_resolved_table.lookup_node(net);
-    return ((iter == _ip_resolved_table.end()) ? NULL : *iter);
+    // Resolved routes only live in the winning routes
+    const IPRouteEntry<A>* route = lookup_route(net);
+    if (route == NULL || route->egp_parent() == NULL)
+	return NULL;
+    return static_cast<const ResolvedIPRouteEntry<A>*>(route);
 }
 
 template<class A>
@@ -604,44 +641,29 @@ ExtIntTable<A>::delete_unresolved_nexthop(const IPRouteEntry<A>* route)
 }
 
 template<class A>
-const ResolvedIPRouteEntry<A>*
-ExtIntTable<A>::lookup_by_igp_parent(const IPNet<A>& route_net)
+const IPRouteEntry<A>*
+ExtIntTable<A>::lookup_nexthop_route(const A& nexthop) const
 {
-    debug_msg("lookup_by_igp_parent %s\n",
-	      route_net.str().c_str());
+    // A nexthop that resolved routes already use resolves the same way
+    typename ResolvedNexthopMap::const_iterator iter;
+    iter = _resolved_nexthops.find(nexthop);
+    if (iter != _resolved_nexthops.end())
+	return iter->second.resolving_parent;
 
-    typename ResolvedRouteBackLink::iterator iter;
-    iter = _ip_resolving_parents.find(route_net);
-    if (iter == _ip_resolving_parents.end()) {
-	debug_msg("Found no routes with this IGP parent\n");
-	return NULL;
-    } else {
-	debug_msg("Found route with IGP parent %s:\n    %s\n",
-		  route_net.str().c_str(), (iter->second)->str().c_str());
-	return iter->second;
-    }
+    return lookup_winning_igp_route(nexthop);
 }
 
 template<class A>
-const ResolvedIPRouteEntry<A>*
-ExtIntTable<A>::lookup_next_by_igp_parent(const IPNet<A>& route_net,
-			const typename ResolvingParentMultiMap::iterator& previous)
-{
-    debug_msg("lookup_next_by_igp_parent %s, starting from %p -> %s\n",
-	      route_net.str().c_str(),
-	      previous->second, previous->second->net().str().c_str());
-
-    pair<typename ResolvingParentMultiMap::iterator, typename ResolvingParentMultiMap::iterator> route_range = _ip_resolving_parents.equal_range(route_net);
-    typename ResolvingParentMultiMap::iterator iter = previous;
-    if (iter++ == route_range.second ||
-        iter == route_range.second) {
-	debug_msg("Found no more routes with this IGP parent\n");
-	return NULL;
-    }
+void
+ExtIntTable<A>::unlink_resolved_route(const ResolvedIPRouteEntry<A>* route)
+{
+    typename ResolvedNexthopMap::iterator iter;
+    iter = _resolved_nexthops.find(route->egp_parent()->nexthop()->addr());
+    XLOG_ASSERT(iter != _resolved_nexthops.end());
 
-    debug_msg("Found next route with IGP parent %s:\n    %s\n",
-	      route_net.str().c_str(), (iter->second)->str().c_str());
-    return iter->second;
+    iter->second.routes.erase(route->backlink());
+    if (iter->second.routes.empty())
+	_resolved_nexthops.erase(iter);
 }
 
 template<class A>
@@ -650,66 +672,23 @@ ExtIntTable<A>::recalculate_nexthops(const IPRouteEntry<A>& new_route)
 {
     debug_msg("recalculate_nexthops: %s\n", new_route.str().c_str());
 
-    const IPRouteEntry<A>* old_route;
-    typename RouteTrie::iterator iter;
-
-    iter = _resolving_routes.find_less_specific(new_route.net());
-    if (iter == _resolving_routes.end()) {
-	debug_msg("no old route\n");
-	return;
-    }
-    old_route = *iter;
-    debug_msg("old route was: %s\n", old_route->str().c_str());
-
-    const ResolvedIPRouteEntry<A>* found;
-    typename ResolvingParentMultiMap::iterator last_not_deleted = _ip_resolving_parents.end();
-    const IPRouteEntry<A>* egp_parent;
-    found = lookup_by_igp_parent(old_route->net());
-    while (found != NULL) {
-	egp_parent = found->egp_parent();
-	XLOG_ASSERT(egp_parent->nexthop()->type() != DISCARD_NEXTHOP);
-	XLOG_ASSERT(egp_parent->nexthop()->type() != UNREACHABLE_NEXTHOP);
-
-	if (new_route.net().contains((egp_parent->nexthop())->addr())) {
-	    debug_msg("found route using this nexthop:\n    %s\n",
-		      found->str().c_str());
-	    // Erase from table first to prevent lookups on this entry
-	    _ip_resolved_table.erase(found->net());
-	    _ip_resolving_parents.erase(found->backlink());
-
-	    // Delete the route's IGP parent from _resolving_routes if
-	    // no-one's using it anymore
-	    if (lookup_by_igp_parent(found->resolving_parent()->net()) == NULL) {
-		_resolving_routes.erase(found->resolving_parent()->net());
-	    }
-
-	    // Propagate the delete next
-	    _wining_routes.erase(found->net());
-
-	    this->next_table()->delete_egp_route(found);
-
-	    // Now delete the local resolved copy, and reinstantiate it
-	    delete found;
-
-	    // egp_parent route is one of the wining EGP routes.
-	    // Re-adding will overwrite it the in trie
-	    // That's no problem because we're overwriting
-	    // old pointer with the existing pointer.
-	    // That way we don't have any memory leaking.
-
-	    add_egp_route(*egp_parent);
-	} else {
-	    debug_msg("route matched but nexthop didn't: nexthop: %s\n    %s\n",
-		    (egp_parent->nexthop())->addr().str().c_str(),
-		   found->str().c_str());
-	    last_not_deleted = found->backlink();
-	}
-
-	if (last_not_deleted == _ip_resolving_parents.end()) {
-	    found = lookup_by_igp_parent(old_route->net());
-	} else {
-	    found = lookup_next_by_igp_parent(old_route->net(), last_not_deleted);
+    // Only the nexthops within the new route's subnet can resolve
+    // differently, and they do if they were resolved by a less
+    // specific route.
+    const IPNet<A>& net = new_route.net();
+    typename ResolvedNexthopMap::iterator iter, next;
+
+    iter = _resolved_nexthops.lower_bound(net.masked_addr());
+    while (iter != _resolved_nexthops.end() && net.contains(iter->first)) {
+	next = iter;
+	++next;
+	const IPRouteEntry<A>* old_route = iter->second.resolving_parent;
+	if (old_route->net().prefix_len() < net.prefix_len()) {
+	    debug_msg("nexthop %s was resolved by: %s\n",
+		      iter->first.str().c_str(), old_route->str().c_str());
+	    reresolve_nexthop(iter, &new_route);
 	}
+	iter = next;
     }
     debug_msg("done recalculating nexthops\n------------------------------------------------\n");
 }
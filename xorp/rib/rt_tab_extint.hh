@@ -176,7 +176,6 @@ public:
 private:
     typedef typename ResolvedIPRouteEntry<A>::RouteBackLink ResolvedRouteBackLink;
     typedef typename UnresolvedIPRouteEntry<A>::RouteBackLink UnresolvedRouteBackLink;
-    typedef multimap<const IPNet<A>, ResolvedIPRouteEntry<A>* > ResolvingParentMultiMap;
     typedef map<IPNet<A>, UnresolvedIPRouteEntry<A>* > IpUnresolvedTableMap;
     typedef Trie<A, const IPRouteEntry<A>* > RouteTrie;
     typedef map<uint16_t, OriginTable<A>* > RouteTableMap;
@@ -197,12 +196,9 @@ private:
 
     void recalculate_nexthops(const IPRouteEntry<A>& route);
 
-    const ResolvedIPRouteEntry<A>* lookup_by_igp_parent(
-	const IPNet<A>& route_net);
+    const IPRouteEntry<A>* lookup_nexthop_route(const A& nexthop) const;
 
-    const ResolvedIPRouteEntry<A>* lookup_next_by_igp_parent(
-	const IPNet<A>& route_net,
-	const typename ResolvingParentMultiMap::iterator& previous);
+    void unlink_resolved_route(const ResolvedIPRouteEntry<A>* route);
 
     const IPRouteEntry<A>* lookup_winning_igp_route(
 	const IPNet<A>& subnet) const;
@@ -216,6 +212,26 @@ private:
 
     void delete_resolved_routes(const IPRouteEntry<A>* route, bool b);
 
+    /**
+     * @short The resolution of one EGP nexthop.
+     *
+     * All the resolved routes with the same nexthop share one of
+     * these, so a change of IGP route is worked out once per nexthop
+     * rather than once per route.
+     */
+    struct ResolvedNexthop {
+	ResolvedNexthop() : resolving_parent(NULL) {}
+
+	const IPRouteEntry<A>*	resolving_parent; // The IGP route it uses
+	ResolvedRouteBackLink	routes;		  // The routes using it
+    };
+    typedef map<A, ResolvedNexthop> ResolvedNexthopMap;
+
+    void reresolve_nexthop(typename ResolvedNexthopMap::iterator nexthop,
+			   const IPRouteEntry<A>* nexthop_route);
+
+    void delete_worse_route(const IPRouteEntry<A>* route);
+
     void create_unresolved_route(const IPRouteEntry<A>& route);
 
     int add_direct_egp_route(const IPRouteEntry<A>& route);
@@ -225,19 +241,18 @@ private:
     AdminDistanceSet _egp_ad_set;
 
     RouteTableMap _all_tables;
-    Trie<A, const ResolvedIPRouteEntry<A>* >	_ip_resolved_table;
     multimap<A, UnresolvedIPRouteEntry<A>* >	_ip_unresolved_nexthops;
     IpUnresolvedTableMap			_ip_unresolved_table;
 
-    // _ip_igp_parents gives us a fast way of finding a route
-    // affected by a change in an igp parent route
-    ResolvingParentMultiMap _ip_resolving_parents;
-
-    // _resolving_routes is a Trie of all the routes that are used to
-    // resolve external routes
-    RouteTrie _resolving_routes;
+    // _resolved_nexthops holds every nexthop that resolved routes
+    // use.  It is ordered by address, so the nexthops affected by a
+    // change in an IGP route are the ones within its subnet.
+    ResolvedNexthopMap _resolved_nexthops;
 
-    // Tries where we cache wining IGP, EGP and overall routes
+    // Tries where we cache wining IGP, EGP and overall routes.
+    // An EGP route with a resolved nexthop is held in _wining_routes
+    // as the ResolvedIPRouteEntry we made for it, so this is also
+    // where resolved routes are found by prefix.
     RouteTrie _wining_igp_routes;
     RouteTrie _wining_routes;	    // Overall wining routes!
 
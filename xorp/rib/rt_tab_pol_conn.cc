@@ -165,7 +165,8 @@ PolicyConnectedTable<A>::push_routes()
 	do_filtering(*prev);
 
 	// only policytags may change
-	next->replace_policytags(*prev, prev->policytags());
+	const IPRouteEntry<A>& route = *prev;
+	next->replace_policytags(route, route.policytags());
     }
 }
 
@@ -156,7 +156,7 @@ Redistributor<A>::schedule_dump_timer()
     debug_msg("schedule dump timer\n");
     _dtimer = _e.new_oneoff_after_ms(0,
 				     callback(this,
-					      &Redistributor<A>::dump_a_route)
+					      &Redistributor<A>::dump_routes)
 				     );
 }
 
@@ -170,7 +170,7 @@ Redistributor<A>::unschedule_dump_timer()
 
 template <typename A>
 void
-Redistributor<A>::dump_a_route()
+Redistributor<A>::dump_routes()
 {
     XLOG_ASSERT(_dumping == true);
 
@@ -179,28 +179,35 @@ Redistributor<A>::dump_a_route()
 
     typename RedistTable<A>::RouteIndex::const_iterator ci;
 
-    // Find net associated with route to dump
-    if (_last_net == NO_LAST_NET) {
-	ci = _table->route_index().begin();
-    } else {
-	ci = _table->route_index().find(_last_net);
-	XLOG_ASSERT(ci != end);
-	ci++;
-    }
+    //
+    // Announce a slice of routes per timer expiry, so the output sees
+    // them together and may send them together, but the eventloop is
+    // not held up for a whole table.
+    //
+    for (uint32_t n = 0; n < DUMP_SLICE_ROUTES && _blocked == false; n++) {
+	// Find net associated with route to dump
+	if (_last_net == NO_LAST_NET) {
+	    ci = _table->route_index().begin();
+	} else {
+	    ci = _table->route_index().find(_last_net);
+	    XLOG_ASSERT(ci != end);
+	    ci++;
+	}
 
-    if (ci == end) {
-	finish_dump();
-	return;
-    }
+	if (ci == end) {
+	    finish_dump();
+	    return;
+	}
 
-    // Lookup route and announce it via output
-    const IPRouteEntry<A>* ipr = _table->lookup_ip_route(*ci);
-    XLOG_ASSERT(ipr != 0);
-    if (policy_accepts(*ipr))
-	_output->add_route(*ipr);
+	// Lookup route and announce it via output
+	const IPRouteEntry<A>* ipr = _table->lookup_ip_route(*ci);
+	XLOG_ASSERT(ipr != 0);
+	if (policy_accepts(*ipr))
+	    _output->add_route(*ipr);
 
-    // Record last net dumped and reschedule
-    _last_net = *ci;
+	// Record last net dumped
+	_last_net = *ci;
+    }
 
     // Check blocked as it may have been set by output's add_route()
     if (_blocked == false)
@@ -408,9 +415,10 @@ template <typename A>
 void
 RedistTable<A>::generic_add_route(const IPRouteEntry<A>& route)
 {
-    XLOG_ASSERT(_rt_index.find(route.net()) == _rt_index.end());
+    bool inserted = _rt_index.insert(route.net()).second;
+    XLOG_ASSERT(inserted);
+    UNUSED(inserted);
 
-    _rt_index.insert(route.net());
     _ip_route_table.insert(route.net(), &route);
 
     typename list<Redistributor<A>*>::iterator i = _outputs.begin();
@@ -254,7 +254,7 @@ private:
 
     void schedule_dump_timer();
     void unschedule_dump_timer();
-    void dump_a_route();
+    void dump_routes();
 
     const IPNet<A>& last_dumped_net() const	{ return _last_net; }
     RedistTable<A>* redist_table()		{ return _table; }
@@ -283,6 +283,7 @@ private:
     XorpTimer			_dtimer;
 
     static const IPNet<A> NO_LAST_NET;		// Indicator for last net inval
+    static const uint32_t DUMP_SLICE_ROUTES = 100;	// Routes per dump timer
 #ifndef XORP_USE_USTL
     static const RedistNetCmp<A> redist_net_cmp;
 #endif
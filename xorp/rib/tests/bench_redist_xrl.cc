@@ -0,0 +1,407 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+// vim:set sts=4 ts=8:
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+//
+// Measure how fast routes are redistributed over the
+// redist_transaction4 XRL interface.
+//
+// Routes are added to an origin table and then deleted again.  A
+// RedistTransactionXrlOutput sends them to a stand-in receiver in the
+// same process, which applies each transaction when it is committed.
+// The rate is taken from the first route added until the receiver
+// has committed the last one.
+//
+
+#include "rib_module.h"
+
+#include "libxorp/xorp.h"
+#include "libxorp/xlog.h"
+#include "libxorp/debug.h"
+#include "libxorp/eventloop.hh"
+#include "libxorp/timer.hh"
+#include "libxorp/profile.hh"
+#include "libxorp/test_main.hh"
+
+#include "libxipc/finder_server.hh"
+#include "libxipc/xrl_std_router.hh"
+
+#include "xrl/targets/test_redist_transaction_base.hh"
+
+#include "route.hh"
+#include "rib.hh"
+#include "rt_tab_origin.hh"
+#include "rt_tab_redist.hh"
+#include "redist_xrl.hh"
+
+
+bool verbose = false;
+
+/**
+ * A redist_transaction4 target that keeps the routes it is sent.
+ */
+class RedistReceiver : public XrlTestRedistTransactionTargetBase {
+public:
+    RedistReceiver(XrlRouter* r, uint32_t commit_cost_us)
+	: XrlTestRedistTransactionTargetBase(r),
+	  _commit_cost_us(commit_cost_us), _next_tid(1), _xrls(0),
+	  _transactions(0), _committed(0)
+    {}
+
+    XrlCmdError redist_transaction4_0_1_start_transaction(
+	// Output values,
+	uint32_t&	tid)
+    {
+	_xrls++;
+	tid = _next_tid++;
+	_pending[tid].clear();
+	return XrlCmdError::OKAY();
+    }
+
+    XrlCmdError redist_transaction4_0_1_commit_transaction(
+	// Input values,
+	const uint32_t&	tid)
+    {
+	_xrls++;
+	Pending::iterator pi = _pending.find(tid);
+	if (pi == _pending.end())
+	    return XrlCmdError::COMMAND_FAILED("No such transaction");
+
+	// Stand in for the work of installing the routes
+	TimeVal cost(0, _commit_cost_us * pi->second.size());
+	if (cost != TimeVal::ZERO())
+	    TimerList::system_sleep(cost);
+
+	Updates::const_iterator ui;
+	for (ui = pi->second.begin(); ui != pi->second.end(); ++ui) {
+	    if (ui->first)
+		_routes.insert(ui->second);
+	    else
+		_routes.erase(ui->second);
+	}
+	_committed += pi->second.size();
+	_transactions++;
+	_pending.erase(pi);
+	return XrlCmdError::OKAY();
+    }
+
+    XrlCmdError redist_transaction4_0_1_abort_transaction(
+	// Input values,
+	const uint32_t&	tid)
+    {
+	_xrls++;
+	_pending.erase(tid);
+	return XrlCmdError::OKAY();
+    }
+
+    XrlCmdError redist_transaction4_0_1_add_route(
+	// Input values,
+	const uint32_t&	tid,
+	const IPv4Net&	dst,
+	const IPv4&	/* nexthop */,
+	const string&	/* ifname */,
+	const string&	/* vifname */,
+	const uint32_t&	/* metric */,
+	const uint32_t&	/* admin_distance */,
+	const string&	/* cookie */,
+	const string&	/* protocol_origin */)
+    {
+	_xrls++;
+	return update(tid, true, dst);
+    }
+
+    XrlCmdError redist_transaction4_0_1_delete_route(
+	// Input values,
+	const uint32_t&	tid,
+	const IPv4Net&	dst,
+	const IPv4&	/* nexthop */,
+	const string&	/* ifname */,
+	const string&	/* vifname */,
+	const uint32_t&	/* metric */,
+	const uint32_t&	/* admin_distance */,
+	const string&	/* cookie */,
+	const string&	/* protocol_origin */)
+    {
+	_xrls++;
+	return update(tid, false, dst);
+    }
+
+    XrlCmdError redist_transaction4_0_1_update_routes(
+	// Input values,
+	const uint32_t&		tid,
+	const XrlAtomList&	adds,
+	const XrlAtomList&	dsts,
+	const XrlAtomList&	/* nexthops */,
+	const XrlAtomList&	/* ifnames */,
+	const XrlAtomList&	/* vifnames */,
+	const XrlAtomList&	/* metrics */,
+	const XrlAtomList&	/* admin_distances */,
+	const string&		/* cookie */,
+	const XrlAtomList&	/* protocol_origins */)
+    {
+	_xrls++;
+	if (dsts.size() != adds.size())
+	    return XrlCmdError::BAD_ARGS("Mismatched list lengths");
+	XrlCmdError result = XrlCmdError::OKAY();
+	for (size_t i = 0; i < adds.size(); i++) {
+	    XrlCmdError e = update(tid, adds.get(i).boolean(),
+				   dsts.get(i).ipv4net());
+	    if (! e.isOK() && result.isOK())
+		result = e;
+	}
+	return result;
+    }
+
+    XrlCmdError redist_transaction4_0_1_delete_all_routes(
+	// Input values,
+	const uint32_t&	/* tid */,
+	const string&	/* cookie */)
+    {
+	return XrlCmdError::COMMAND_FAILED("Not supported");
+    }
+
+    XrlCmdError redist_transaction6_0_1_start_transaction(
+	// Output values,
+	uint32_t&	/* tid */)
+    {
+	return XrlCmdError::COMMAND_FAILED("Not supported");
+    }
+
+    XrlCmdError redist_transaction6_0_1_commit_transaction(
+	// Input values,
+	const uint32_t&	/* tid */)
+    {
+	return XrlCmdError::COMMAND_FAILED("Not supported");
+    }
+
+    XrlCmdError redist_transaction6_0_1_abort_transaction(
+	// Input values,
+	const uint32_t&	/* tid */)
+    {
+	return XrlCmdError::COMMAND_FAILED("Not supported");
+    }
+
+    XrlCmdError redist_transaction6_0_1_add_route(
+	// Input values,
+	const uint32_t&	/* tid */,
+	const IPv6Net&	/* dst */,
+	const IPv6&	/* nexthop */,
+	const string&	/* ifname */,
+	const string&	/* vifname */,
+	const uint32_t&	/* metric */,
+	const uint32_t&	/* admin_distance */,
+	const string&	/* cookie */,
+	const string&	/* protocol_origin */)
+    {
+	return XrlCmdError::COMMAND_FAILED("Not supported");
+    }
+
+    XrlCmdError redist_transaction6_0_1_delete_route(
+	// Input values,
+	const uint32_t&	/* tid */,
+	const IPv6Net&	/* dst */,
+	const IPv6&	/* nexthop */,
+	const string&	/* ifname */,
+	const string&	/* vifname */,
+	const uint32_t&	/* metric */,
+	const uint32_t&	/* admin_distance */,
+	const string&	/* cookie */,
+	const string&	/* protocol_origin */)
+    {
+	return XrlCmdError::COMMAND_FAILED("Not supported");
+    }
+
+    XrlCmdError redist_transaction6_0_1_update_routes(
+	// Input values,
+	const uint32_t&		/* tid */,
+	const XrlAtomList&	/* adds */,
+	const XrlAtomList&	/* dsts */,
+	const XrlAtomList&	/* nexthops */,
+	const XrlAtomList&	/* ifnames */,
+	const XrlAtomList&	/* vifnames */,
+	const XrlAtomList&	/* metrics */,
+	const XrlAtomList&	/* admin_distances */,
+	const string&		/* cookie */,
+	const XrlAtomList&	/* protocol_origins */)
+    {
+	return XrlCmdError::COMMAND_FAILED("Not supported");
+    }
+
+    XrlCmdError redist_transaction6_0_1_delete_all_routes(
+	// Input values,
+	const uint32_t&	/* tid */,
+	const string&	/* cookie */)
+    {
+	return XrlCmdError::COMMAND_FAILED("Not supported");
+    }
+
+    size_t routes() const		{ return _routes.size(); }
+    uint32_t xrls() const		{ return _xrls; }
+    uint32_t transactions() const	{ return _transactions; }
+    uint32_t committed() const		{ return _committed; }
+
+private:
+    XrlCmdError update(uint32_t tid, bool add, const IPv4Net& dst) {
+	Pending::iterator pi = _pending.find(tid);
+	if (pi == _pending.end())
+	    return XrlCmdError::COMMAND_FAILED("No such transaction");
+	pi->second.push_back(make_pair(add, dst));
+	return XrlCmdError::OKAY();
+    }
+
+    typedef vector<pair<bool, IPv4Net> > Updates;
+    typedef map<uint32_t, Updates> Pending;
+
+    uint32_t		_commit_cost_us;	// Per route in a commit
+    uint32_t		_next_tid;
+    Pending		_pending;		// Updates by transaction
+    set<IPv4Net>	_routes;		// Committed routes
+    uint32_t		_xrls;			// XRLs received
+    uint32_t		_transactions;		// Transactions committed
+    uint32_t		_committed;		// Updates committed
+};
+
+static IPv4Net
+route_net(uint32_t i)
+{
+    return IPv4Net(IPv4(htonl(0x14000000 + (i << 8))), 24);
+}
+
+/**
+ * Run the event loop until the receiver has committed a number of
+ * updates, and report the rate since a start time.
+ */
+static void
+run_until_committed(EventLoop& eventloop, RedistReceiver& receiver,
+		    RedistTransactionXrlOutput<IPv4>* output,
+		    const char* what, uint32_t n, const TimeVal& start,
+		    uint32_t xrls, uint32_t transactions)
+{
+    uint32_t committed = receiver.committed() + n;
+    while (receiver.committed() < committed)
+	eventloop.run();
+
+    TimeVal end;
+    TimerList::system_gettimeofday(&end);
+    double secs = (end - start).get_double();
+
+    printf("%s %u routes, %.0f routes/s, %u XRLs, %u transactions, "
+	   "transaction limit %u\n", what, XORP_UINT_CAST(n),
+	   secs > 0 ? n / secs : 0,
+	   XORP_UINT_CAST(receiver.xrls() - xrls),
+	   XORP_UINT_CAST(receiver.transactions() - transactions),
+	   XORP_UINT_CAST(output->transaction_limit()));
+}
+
+int
+main(int argc, char** argv)
+{
+    XorpUnexpectedHandler x(xorp_unexpected_handler);
+
+    xlog_init(argv[0], NULL);
+    xlog_set_verbose(XLOG_VERBOSE_LOW);
+    xlog_add_default_output();
+    xlog_start();
+
+    TestMain t(argc, argv);
+
+    string routes_arg = t.get_optional_args("-n", "--routes",
+					    "number of routes");
+    string cost_arg = t.get_optional_args("-c", "--commit-cost",
+					  "receiver microseconds per route "
+					  "committed");
+    t.complete_args_parsing();
+    if (t.exit() != 0)
+	return t.exit();
+
+    uint32_t nroutes = routes_arg.empty() ? 100000 : atoi(routes_arg.c_str());
+    uint32_t commit_cost = cost_arg.empty() ? 0 : atoi(cost_arg.c_str());
+
+    EventLoop eventloop;
+
+    FinderServer fs(eventloop, FinderConstants::FINDER_DEFAULT_HOST(),
+		    FinderConstants::FINDER_DEFAULT_PORT());
+
+    XrlStdRouter rib_router(eventloop, "rib", fs.addr(), fs.port());
+    rib_router.finalize();
+    XrlStdRouter receiver_router(eventloop, "test_redist_transaction",
+				 fs.addr(), fs.port());
+    RedistReceiver receiver(&receiver_router, commit_cost);
+    receiver_router.finalize();
+
+    wait_until_xrl_router_is_ready(eventloop, rib_router);
+    wait_until_xrl_router_is_ready(eventloop, receiver_router);
+
+    TypedOriginTable<IPv4, IGP> typed_origin("static", 1, eventloop);
+    OriginTable<IPv4>& origin = typed_origin;
+    Protocol& protocol = typed_origin.protocol();
+    protocol.increment_genid();
+    IPPeerNextHop<IPv4> nh("10.0.0.2");
+
+    Vif tmp_vif("vif0");
+    RibVif<IPv4> vif(NULL, tmp_vif);
+
+    RedistTable<IPv4> redist_table("StaticRedistTable", &origin);
+    Redistributor<IPv4>* r = new Redistributor<IPv4>(eventloop,
+						     "static_redist");
+    r->set_redist_table(&redist_table);
+
+    Profile profile;
+    RedistTransactionXrlOutput<IPv4>* output =
+	new RedistTransactionXrlOutput<IPv4>(r, rib_router, profile, "static",
+					     "test_redist_transaction",
+					     IPv4Net("0.0.0.0/0"), "static");
+    r->set_output(output);
+
+    TimeVal start;
+    uint32_t xrls = receiver.xrls();
+    uint32_t transactions = receiver.transactions();
+    TimerList::system_gettimeofday(&start);
+    for (uint32_t i = 0; i < nroutes; i++) {
+	origin.add_route(new IPRouteEntry<IPv4>(route_net(i), &vif,
+						nh.get_copy(), &protocol, 1));
+    }
+    run_until_committed(eventloop, receiver, output, "add:   ", nroutes,
+			start, xrls, transactions);
+    if (receiver.routes() != nroutes) {
+	fprintf(stderr, "FAILED: receiver has %u routes, expected %u\n",
+		XORP_UINT_CAST(receiver.routes()), XORP_UINT_CAST(nroutes));
+	return 1;
+    }
+
+    xrls = receiver.xrls();
+    transactions = receiver.transactions();
+    TimerList::system_gettimeofday(&start);
+    for (uint32_t i = 0; i < nroutes; i++)
+	origin.delete_route(route_net(i));
+    run_until_committed(eventloop, receiver, output, "delete:", nroutes,
+			start, xrls, transactions);
+    if (receiver.routes() != 0) {
+	fprintf(stderr, "FAILED: receiver has %u routes, expected none\n",
+		XORP_UINT_CAST(receiver.routes()));
+	return 1;
+    }
+
+    xlog_stop();
+    xlog_exit();
+
+    return 0;
+}
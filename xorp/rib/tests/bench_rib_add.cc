@@ -0,0 +1,209 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+// vim:set sts=4 ts=8:
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+//
+// Measure how fast routes go through the RIB pipeline.
+//
+// EGP routes are added to an "ebgp" table, and optionally the same
+// prefixes to an "ibgp" table too so that the admin distance merge has
+// work to do.  Their nexthops resolve through a static route, which is
+// then flapped to force every EGP route to be re-resolved.  Host routes
+// for a few of the nexthops are then added and deleted, which moves
+// only the EGP routes using those nexthops.  The growth of the resident
+// set while the EGP routes are added is reported per route.
+//
+
+#include "rib_module.h"
+
+#include "libxorp/xorp.h"
+#include "libxorp/xlog.h"
+#include "libxorp/debug.h"
+#include "libxorp/eventloop.hh"
+#include "libxorp/timer.hh"
+#include "libxorp/test_main.hh"
+
+#ifdef HAVE_SYS_RESOURCE_H
+#include <sys/resource.h>
+#endif
+
+#include "rib_manager.hh"
+#include "rib.hh"
+#include "dummy_register_server.hh"
+
+
+bool verbose = false;
+
+// The number of nexthops the EGP routes are spread over
+static const uint32_t NEXTHOPS = 250;
+
+static double
+rate(uint32_t n, const TimeVal& start)
+{
+    TimeVal end;
+
+    TimerList::system_gettimeofday(&end);
+    double secs = (end - start).sec() + (end - start).usec() / 1000000.0;
+    return secs > 0 ? n / secs : 0;
+}
+
+/**
+ * @return the peak resident set size in kilobytes.
+ */
+static long
+max_rss_kb()
+{
+#ifdef HAVE_SYS_RESOURCE_H
+    struct rusage ru;
+
+    if (getrusage(RUSAGE_SELF, &ru) == 0)
+	return ru.ru_maxrss;
+#endif
+    return 0;
+}
+
+static IPv4Net
+route_net(uint32_t i)
+{
+    return IPv4Net(IPv4(htonl(0x14000000 + (i << 8))), 24);
+}
+
+static IPv4
+route_nexthop(uint32_t i)
+{
+    return IPv4(htonl(0x01000001 + i % NEXTHOPS));
+}
+
+int
+main(int argc, char** argv)
+{
+    XorpUnexpectedHandler x(xorp_unexpected_handler);
+
+    xlog_init(argv[0], NULL);
+    xlog_set_verbose(XLOG_VERBOSE_LOW);
+    xlog_add_default_output();
+    xlog_start();
+
+    TestMain t(argc, argv);
+
+    string routes_arg = t.get_optional_args("-n", "--routes",
+					    "number of EGP routes");
+    bool both = t.get_optional_flag("-i", "--ibgp",
+				    "also add every prefix to ibgp");
+    t.complete_args_parsing();
+    if (t.exit() != 0)
+	return t.exit();
+
+    uint32_t nroutes = routes_arg.empty() ? 500000 : atoi(routes_arg.c_str());
+
+    EventLoop eventloop;
+    XrlStdRouter xrl_std_router_rib(eventloop, "rib");
+    RibManager rib_manager(eventloop, xrl_std_router_rib, "fea");
+    rib_manager.enable();
+
+    RIB<IPv4> rib(UNICAST, rib_manager, eventloop);
+    DummyRegisterServer register_server;
+    rib.initialize(register_server);
+    rib.add_igp_table("connected", "", "");
+
+    Vif vif0("vif0");
+    vif0.set_underlying_vif_up(true);
+    rib.new_vif("vif0", vif0);
+    rib.add_vif_address("vif0", IPv4("10.0.0.1"), IPv4Net("10.0.0.0", 24),
+			IPv4::ZERO(), IPv4::ZERO());
+
+    rib.add_igp_table("static", "", "");
+    rib.add_egp_table("ebgp", "", "");
+    rib.add_egp_table("ibgp", "", "");
+
+    IPv4Net igp_net("1.0.0.0", 16);
+    rib.add_route("static", igp_net, IPv4("10.0.0.2"), "", "", 0,
+		  PolicyTags());
+
+    long rss_start = max_rss_kb();
+    TimeVal start;
+    TimerList::system_gettimeofday(&start);
+    for (uint32_t i = 0; i < nroutes; i++) {
+	rib.add_route("ebgp", route_net(i), route_nexthop(i), "", "", 0,
+		      PolicyTags());
+    }
+    printf("add ebgp:     %u routes, %.0f routes/s\n", nroutes,
+	   rate(nroutes, start));
+
+    if (both) {
+	TimerList::system_gettimeofday(&start);
+	for (uint32_t i = 0; i < nroutes; i++) {
+	    rib.add_route("ibgp", route_net(i), route_nexthop(i), "", "", 0,
+			  PolicyTags());
+	}
+	printf("add ibgp:     %u routes, %.0f routes/s\n", nroutes,
+	       rate(nroutes, start));
+    }
+
+    long rss_end = max_rss_kb();
+    uint32_t stored = both ? 2 * nroutes : nroutes;
+    if (rss_end > 0 && stored > 0) {
+	printf("resident set grew %ld kB, %.1f bytes per route\n",
+	       rss_end - rss_start, (rss_end - rss_start) * 1024.0 / stored);
+    }
+
+    TimerList::system_gettimeofday(&start);
+    rib.delete_route("static", igp_net);
+    rib.add_route("static", igp_net, IPv4("10.0.0.2"), "", "", 0,
+		  PolicyTags());
+    printf("igp flap:     %u routes, %.0f routes/s\n", nroutes,
+	   rate(nroutes, start));
+
+    // A host route for a nexthop moves the routes using it there and
+    // deleting it moves them back.
+    static const uint32_t HOSTS = 10;
+    uint32_t moved = 0;
+    for (uint32_t i = 0; i < HOSTS && i < nroutes; i++)
+	moved += 2 * ((nroutes - i + NEXTHOPS - 1) / NEXTHOPS);
+    TimerList::system_gettimeofday(&start);
+    for (uint32_t i = 0; i < HOSTS; i++) {
+	rib.add_route("static", IPv4Net(route_nexthop(i), 32),
+		      IPv4("10.0.0.3"), "", "", 0, PolicyTags());
+    }
+    for (uint32_t i = 0; i < HOSTS; i++)
+	rib.delete_route("static", IPv4Net(route_nexthop(i), 32));
+    printf("igp hosts:    %u routes, %.0f routes/s\n", moved,
+	   rate(moved, start));
+
+    TimerList::system_gettimeofday(&start);
+    for (uint32_t i = 0; i < nroutes; i++)
+	rib.delete_route("ebgp", route_net(i));
+    printf("delete ebgp:  %u routes, %.0f routes/s\n", nroutes,
+	   rate(nroutes, start));
+
+    if (both) {
+	TimerList::system_gettimeofday(&start);
+	for (uint32_t i = 0; i < nroutes; i++)
+	    rib.delete_route("ibgp", route_net(i));
+	printf("delete ibgp:  %u routes, %.0f routes/s\n", nroutes,
+	       rate(nroutes, start));
+    }
+
+    xlog_stop();
+    xlog_exit();
+
+    return 0;
+}
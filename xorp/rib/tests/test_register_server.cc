@@ -0,0 +1,345 @@
+// -*- c-basic-offset: 4; tab-width: 8; indent-tabs-mode: t -*-
+// vim:set sts=4 ts=8:
+
+// Copyright (c) 2001-2011 XORP, Inc and Others
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License, Version 2, June
+// 1991 as published by the Free Software Foundation. Redistribution
+// and/or modification of this program under the terms of any other
+// version of the GNU General Public License is not permitted.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. For more details,
+// see the GNU General Public License, Version 2, a copy of which can be
+// found in the XORP LICENSE.gpl file.
+//
+// XORP Inc, 2953 Bunker Hill Lane, Suite 204, Santa Clara, CA 95054, USA;
+// http://xorp.net
+
+
+
+//
+// Test that the RegisterServer coalesces the notifications waiting for
+// a client and sends the rest in batches.
+//
+
+#include "rib_module.h"
+
+#include "libxorp/xorp.h"
+#include "libxorp/xlog.h"
+#include "libxorp/debug.h"
+#include "libxorp/eventloop.hh"
+
+#include "libxipc/finder_server.hh"
+#include "libxipc/xrl_std_router.hh"
+
+#include "xrl/targets/ribclient_base.hh"
+
+#include "register_server.hh"
+
+
+/**
+ * A RIB client that records the notifications it is sent.
+ */
+class RibClientTarget : public XrlRibclientTargetBase {
+public:
+    RibClientTarget(XrlRouter* r)
+	: XrlRibclientTargetBase(r), _received(0), _singles(0), _batches(0)
+    {}
+
+    XrlCmdError rib_client_0_1_route_info_changed4(
+	// Input values,
+	const IPv4&	addr,
+	const uint32_t&	prefix_len,
+	const IPv4&	nexthop,
+	const uint32_t&	metric,
+	const uint32_t&	admin_distance,
+	const string&	protocol_origin)
+    {
+	_singles++;
+	changed(addr, prefix_len, nexthop, metric, admin_distance,
+		protocol_origin);
+	return XrlCmdError::OKAY();
+    }
+
+    XrlCmdError rib_client_0_1_route_info_changed6(
+	// Input values,
+        const IPv6&	/* addr */,
+	const uint32_t&	/* prefix_len */,
+	const IPv6&	/* nexthop */,
+	const uint32_t&	/* metric */,
+	const uint32_t&	/* admin_distance */,
+	const string&	/* protocol_origin */)
+    {
+	return XrlCmdError::OKAY();
+    }
+
+    XrlCmdError rib_client_0_1_route_info_invalid4(
+	// Input values,
+	const IPv4&	addr,
+	const uint32_t&	prefix_len)
+    {
+	_singles++;
+	invalid(addr, prefix_len);
+	return XrlCmdError::OKAY();
+    }
+
+    XrlCmdError rib_client_0_1_route_info_invalid6(
+	// Input values,
+        const IPv6&	/* addr */,
+	const uint32_t&	/* prefix_len */)
+    {
+	return XrlCmdError::OKAY();
+    }
+
+    XrlCmdError rib_client_0_1_route_info_batch4(
+	// Input values,
+	const XrlAtomList&	invalid_addrs,
+	const XrlAtomList&	invalid_prefix_lens,
+	const XrlAtomList&	addrs,
+	const XrlAtomList&	prefix_lens,
+	const XrlAtomList&	nexthops,
+	const XrlAtomList&	metrics,
+	const XrlAtomList&	admin_distances,
+	const XrlAtomList&	protocol_origins)
+    {
+	_batches++;
+	for (size_t i = 0; i < invalid_addrs.size(); i++)
+	    invalid(invalid_addrs.get(i).ipv4(),
+		    invalid_prefix_lens.get(i).uint32());
+	for (size_t i = 0; i < addrs.size(); i++)
+	    changed(addrs.get(i).ipv4(), prefix_lens.get(i).uint32(),
+		    nexthops.get(i).ipv4(), metrics.get(i).uint32(),
+		    admin_distances.get(i).uint32(),
+		    protocol_origins.get(i).text());
+	return XrlCmdError::OKAY();
+    }
+
+    XrlCmdError rib_client_0_1_route_info_batch6(
+	// Input values,
+	const XrlAtomList&	/* invalid_addrs */,
+	const XrlAtomList&	/* invalid_prefix_lens */,
+	const XrlAtomList&	/* addrs */,
+	const XrlAtomList&	/* prefix_lens */,
+	const XrlAtomList&	/* nexthops */,
+	const XrlAtomList&	/* metrics */,
+	const XrlAtomList&	/* admin_distances */,
+	const XrlAtomList&	/* protocol_origins */)
+    {
+	return XrlCmdError::OKAY();
+    }
+
+    /**
+     * @return the notifications received, in the order they were
+     * applied, and forget them.
+     */
+    list<string> take_log() {
+	list<string> log;
+	log.swap(_log);
+	return log;
+    }
+
+    uint32_t received() const	{ return _received; }
+    uint32_t singles() const	{ return _singles; }
+    uint32_t batches() const	{ return _batches; }
+
+private:
+    void changed(const IPv4& addr, uint32_t prefix_len, const IPv4& nexthop,
+		 uint32_t metric, uint32_t admin_distance,
+		 const string& protocol_origin) {
+	_received++;
+	_log.push_back(c_format("changed %s %s %u %u %s",
+				IPv4Net(addr, prefix_len).str().c_str(),
+				nexthop.str().c_str(),
+				XORP_UINT_CAST(metric),
+				XORP_UINT_CAST(admin_distance),
+				protocol_origin.c_str()));
+    }
+
+    void invalid(const IPv4& addr, uint32_t prefix_len) {
+	_received++;
+	_log.push_back(c_format("invalid %s",
+				IPv4Net(addr, prefix_len).str().c_str()));
+    }
+
+    list<string>	_log;
+    uint32_t		_received;	// Notifications received
+    uint32_t		_singles;	// XRLs with one notification
+    uint32_t		_batches;	// XRLs with a batch
+};
+
+static IPv4Net
+test_net(uint32_t i)
+{
+    return IPv4Net(IPv4(htonl(0x0b000000 + (i << 8))), 24);
+}
+
+static void
+expect(bool ok, const char* what)
+{
+    if (!ok) {
+	fprintf(stderr, "FAILED: %s\n", what);
+	abort();
+    }
+}
+
+static void
+wait_for(EventLoop& eventloop, RibClientTarget& client, uint32_t received)
+{
+    while (client.received() < received)
+	eventloop.run();
+}
+
+int
+main(int /* argc */, char* argv[])
+{
+    //
+    // Initialize and start xlog
+    //
+    xlog_init(argv[0], NULL);
+    xlog_set_verbose(XLOG_VERBOSE_LOW);		// Least verbose messages
+    // XXX: verbosity of the error messages temporary increased
+    xlog_level_set_verbose(XLOG_LEVEL_ERROR, XLOG_VERBOSE_HIGH);
+    xlog_add_default_output();
+    xlog_start();
+
+    EventLoop eventloop;
+
+    // Finder Server
+    FinderServer fs(eventloop, FinderConstants::FINDER_DEFAULT_HOST(),
+		    FinderConstants::FINDER_DEFAULT_PORT());
+
+    XrlStdRouter rib_router(eventloop, "rib", fs.addr(), fs.port());
+    rib_router.finalize();
+    XrlStdRouter client_router(eventloop, "ribclient", fs.addr(), fs.port());
+    RibClientTarget client(&client_router);
+    client_router.finalize();
+
+    wait_until_xrl_router_is_ready(eventloop, rib_router);
+    wait_until_xrl_router_is_ready(eventloop, client_router);
+
+    RegisterServer register_server(&rib_router);
+
+    //
+    // A notification on its own goes in the XRL it always used.
+    //
+    register_server.send_route_changed("ribclient", test_net(0),
+				       IPv4("1.0.0.2"), 5, 110, "ospf", false);
+    register_server.flush();
+    wait_for(eventloop, client, 1);
+    expect(client.singles() == 1 && client.batches() == 0,
+	   "single notification sent on its own");
+    expect(client.take_log().front()
+	   == "changed 11.0.0.0/24 1.0.0.2 5 110 ospf",
+	   "single notification contents");
+
+    const NotifyQueue* queue = register_server.notify_queue("ribclient");
+    expect(queue != NULL, "queue exists");
+    expect(register_server.notify_queue("nobody") == NULL, "no queue");
+
+    //
+    // Changes to the same registration while they wait are coalesced
+    // into the last one, as are repeated invalidations.  A change
+    // that follows an invalidation is kept, and reaches the client
+    // after it.
+    //
+    const uint32_t changes = 150;
+    for (uint32_t i = 0; i < changes; i++) {
+	register_server.send_route_changed("ribclient", test_net(i),
+					   IPv4("1.0.0.2"), 5, 110, "ospf",
+					   false);
+	register_server.send_route_changed("ribclient", test_net(i),
+					   IPv4("1.0.0.3"), 6, 110, "ospf",
+					   false);
+    }
+    register_server.send_invalidate("ribclient", IPv4Net("12.0.0.0/24"),
+				    false);
+    register_server.send_invalidate("ribclient", IPv4Net("12.0.0.0/24"),
+				    false);
+    register_server.send_invalidate("ribclient", IPv4Net("13.0.0.0/24"),
+				    false);
+    register_server.send_route_changed("ribclient", IPv4Net("13.0.0.0/24"),
+				       IPv4("1.0.0.4"), 7, 110, "ospf", false);
+
+    uint32_t queued = changes + 3;
+    expect(queue->queue_depth() == queued, "queue depth");
+    expect(queue->entries_coalesced() == changes + 1, "entries coalesced");
+
+    register_server.flush();
+    wait_for(eventloop, client, 1 + queued);
+
+    uint32_t batches = (queued + NotifyQueue::MAX_BATCH_SIZE - 1)
+	/ NotifyQueue::MAX_BATCH_SIZE;
+    expect(client.singles() == 1, "no more single notifications");
+    expect(client.batches() == batches, "notifications batched");
+
+    list<string> log = client.take_log();
+    set<string> expected;
+    for (uint32_t i = 0; i < changes; i++) {
+	expected.insert(c_format("changed %s 1.0.0.3 6 110 ospf",
+				 test_net(i).str().c_str()));
+    }
+    expected.insert("invalid 12.0.0.0/24");
+    expected.insert("invalid 13.0.0.0/24");
+    expected.insert("changed 13.0.0.0/24 1.0.0.4 7 110 ospf");
+    expect(set<string>(log.begin(), log.end()) == expected,
+	   "latest state of each registration received");
+
+    list<string>::iterator invalid = find(log.begin(), log.end(),
+					  "invalid 13.0.0.0/24");
+    list<string>::iterator change
+	= find(log.begin(), log.end(),
+	       "changed 13.0.0.0/24 1.0.0.4 7 110 ospf");
+    expect(distance(log.begin(), invalid) < distance(log.begin(), change),
+	   "invalidation received before the change that follows it");
+
+    expect(queue->queue_depth() == 0, "queue drained");
+    expect(queue->max_queue_depth() == queued, "max queue depth");
+    expect(queue->entries_queued() == 1 + 2 * changes + 4, "entries queued");
+    expect(queue->entries_sent() == 1 + queued, "entries sent");
+    expect(queue->xrls_sent() == 1 + batches, "XRLs sent");
+    expect(queue->max_latency() >= TimeVal::ZERO(), "latency");
+
+    //
+    // The unicast and multicast RIBs share the queue; a change to a
+    // registration in one must not replace a change to the same
+    // subnet in the other.
+    //
+    uint32_t coalesced = queue->entries_coalesced();
+    register_server.send_route_changed("ribclient", test_net(0),
+				       IPv4("1.0.0.5"), 8, 110, "ospf", false);
+    register_server.send_route_changed("ribclient", test_net(0),
+				       IPv4("1.0.0.6"), 9, 110, "ospf", true);
+    expect(queue->queue_depth() == 2, "unicast and multicast both queued");
+    expect(queue->entries_coalesced() == coalesced,
+	   "unicast and multicast not coalesced");
+
+    register_server.flush();
+    wait_for(eventloop, client, 1 + queued + 2);
+
+    log = client.take_log();
+    expected.clear();
+    expected.insert("changed 11.0.0.0/24 1.0.0.5 8 110 ospf");
+    expected.insert("changed 11.0.0.0/24 1.0.0.6 9 110 ospf");
+    expect(set<string>(log.begin(), log.end()) == expected,
+	   "unicast and multicast changes received");
+
+    printf("%u notifications queued, %u sent in %u XRLs, "
+	   "max queue depth %u, max latency %s s\n",
+	   XORP_UINT_CAST(queue->entries_queued()),
+	   XORP_UINT_CAST(queue->entries_sent()),
+	   XORP_UINT_CAST(queue->xrls_sent()),
+	   XORP_UINT_CAST(queue->max_queue_depth()),
+	   queue->max_latency().str().c_str());
+    printf("Test Passed\n");
+
+    //
+    // Gracefully stop and exit xlog
+    //
+    xlog_stop();
+    xlog_exit();
+
+    return 0;
+}
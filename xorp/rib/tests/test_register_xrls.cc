@@ -103,6 +103,46 @@ public:
 	return XrlCmdError::OKAY();
     }
 
+    XrlCmdError rib_client_0_1_route_info_batch4(
+	// Input values,
+	const XrlAtomList&	invalid_addrs,
+	const XrlAtomList&	invalid_prefix_lens,
+	const XrlAtomList&	addrs,
+	const XrlAtomList&	prefix_lens,
+	const XrlAtomList&	nexthops,
+	const XrlAtomList&	metrics,
+	const XrlAtomList&	admin_distances,
+	const XrlAtomList&	protocol_origins)
+    {
+	for (size_t i = 0; i < invalid_addrs.size(); i++) {
+	    rib_client_0_1_route_info_invalid4(invalid_addrs.get(i).ipv4(),
+					       invalid_prefix_lens.get(i).uint32());
+	}
+	for (size_t i = 0; i < addrs.size(); i++) {
+	    rib_client_0_1_route_info_changed4(addrs.get(i).ipv4(),
+					       prefix_lens.get(i).uint32(),
+					       nexthops.get(i).ipv4(),
+					       metrics.get(i).uint32(),
+					       admin_distances.get(i).uint32(),
+					       protocol_origins.get(i).text());
+	}
+	return XrlCmdError::OKAY();
+    }
+
+    XrlCmdError rib_client_0_1_route_info_batch6(
+	// Input values,
+	const XrlAtomList&	/* invalid_addrs */,
+	const XrlAtomList&	/* invalid_prefix_lens */,
+	const XrlAtomList&	/* addrs */,
+	const XrlAtomList&	/* prefix_lens */,
+	const XrlAtomList&	/* nexthops */,
+	const XrlAtomList&	/* metrics */,
+	const XrlAtomList&	/* admin_distances */,
+	const XrlAtomList&	/* protocol_origins */)
+    {
+	return XrlCmdError::OKAY();
+    }
+
     bool verify_invalidated(const string& invalid);
     bool verify_changed(const string& changed);
     bool verify_no_info();
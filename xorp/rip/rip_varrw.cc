@@ -40,17 +40,13 @@ RIPVarRW<A>::start_read()
 
     read_route_nexthop(_route);
 
-    initialize(VAR_METRIC, new ElemU32(_route.cost()));
+    initialize(VAR_METRIC, arena().create<ElemU32>(_route.cost()));
 
     // XXX which tag wins?
-    Element* element = _route.policytags().element_tag();
-    ElemU32* e = dynamic_cast<ElemU32*>(element);
-    if (e != NULL && e->val())
-	_route.set_tag(e->val());
+    if (_route.policytags().tag())
+	_route.set_tag(_route.policytags().tag());
 
-    delete element;
-
-    initialize(VAR_TAG, new ElemU32(_route.tag()));
+    initialize(VAR_TAG, arena().create<ElemU32>(_route.tag()));
 }
 
 template <class A>
@@ -118,8 +114,8 @@ template <>
 void
 RIPVarRW<IPv4>::read_route_nexthop(RouteEntry<IPv4>& route)
 {
-    initialize(VAR_NETWORK4, new ElemIPv4Net(route.net()));
-    initialize(VAR_NEXTHOP4, new ElemIPv4NextHop(route.nexthop()));
+    initialize(VAR_NETWORK4, arena().create<ElemIPv4Net>(&route.net()));
+    initialize(VAR_NEXTHOP4, arena().create<ElemIPv4NextHop>(route.nexthop()));
     
     initialize(VAR_NETWORK6, NULL);
     initialize(VAR_NEXTHOP6, NULL);
@@ -150,8 +146,8 @@ template <>
 void
 RIPVarRW<IPv6>::read_route_nexthop(RouteEntry<IPv6>& route)
 {
-    initialize(VAR_NETWORK6, new ElemIPv6Net(route.net()));
-    initialize(VAR_NEXTHOP6, new ElemIPv6NextHop(route.nexthop()));
+    initialize(VAR_NETWORK6, arena().create<ElemIPv6Net>(&route.net()));
+    initialize(VAR_NEXTHOP6, arena().create<ElemIPv6NextHop>(route.nexthop()));
     
     initialize(VAR_NETWORK4, NULL);
     initialize(VAR_NEXTHOP4, NULL);
@@ -209,6 +209,7 @@ def DoAllConfig(env, conf, host_os):
     # linux
     has_linux_types_h = conf.CheckHeader('linux/types.h')
     has_linux_sockios_h = conf.CheckHeader('linux/sockios.h')
+    has_sys_epoll_h = conf.CheckHeader('sys/epoll.h')
 
     # XXX needs header conditionals
     has_struct_iovec = conf.CheckType('struct iovec', includes='#include <sys/uio.h>')